@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * A regular expression compiled once, typically at configuration load time, and then matched
+ * against many values. Implementations must be safe to use concurrently from multiple threads.
+ */
+class CompiledMatcher {
+public:
+  virtual ~CompiledMatcher() {}
+
+  /**
+   * @param value supplies the value to match.
+   * @return bool true if the regular expression matches the whole of value.
+   */
+  virtual bool match(absl::string_view value) const PURE;
+
+  /**
+   * Searches for the leftmost match of the regular expression anywhere in value.
+   * @param value supplies the value to search.
+   * @param captures supplies an array of num_captures views which receive the leading capture
+   *        groups of the match, starting with the first group. Each view points into value. Groups
+   *        that did not take part in the match, or that do not exist, receive a view with a null
+   *        data().
+   * @param num_captures supplies the number of capture groups to extract.
+   * @return bool true if the regular expression matches somewhere in value.
+   */
+  virtual bool search(absl::string_view value, absl::string_view* captures,
+                      uint32_t num_captures) const PURE;
+
+  /**
+   * @return uint32_t the number of capture groups in the regular expression.
+   */
+  virtual uint32_t numCaptureGroups() const PURE;
+};
+
+typedef std::unique_ptr<const CompiledMatcher> CompiledMatcherPtr;
+
+} // namespace Regex
+} // namespace Envoy
@@ -197,6 +197,15 @@ struct Http1Settings {
   bool accept_http_10_{false};
   // Set a default host if no Host: header is present for HTTP/1.0 requests.`
   std::string default_host_for_http_10_;
+
+  enum class ParserEngine {
+    // Parse requests with http_parser.
+    HttpParser,
+    // Parse common requests with the vectorized parser, falling back to http_parser.
+    Simd
+  };
+  // The parser used for requests from downstream.
+  ParserEngine parser_engine_{ParserEngine::HttpParser};
 };
 
 /**
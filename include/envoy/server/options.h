@@ -128,6 +128,11 @@ public:
    */
   virtual std::chrono::milliseconds fileFlushIntervalMsec() const PURE;
 
+  /**
+   * @return uint32_t the number of threads that flush buffered file data to disk.
+   */
+  virtual uint32_t fileFlushThreads() const PURE;
+
   /**
    * @return const std::string& the server's cluster.
    */
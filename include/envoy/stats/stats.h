@@ -10,6 +10,7 @@
 
 #include "envoy/common/interval_set.h"
 #include "envoy/common/pure.h"
+#include "envoy/stats/symbol_table.h"
 
 #include "absl/strings/string_view.h"
 
@@ -75,6 +76,17 @@ public:
    * @return absl::string_view the prefix, or an empty string_view if none was found.
    */
   virtual absl::string_view prefixToken() const PURE;
+
+  /**
+   * Finds a substring that must be present in a stat name for the extractor to match. This
+   * is used to skip extractors without evaluating them, by searching the stat name for the
+   * substrings of all extractors at once.
+   *
+   * The storage for the substring is owned by the TagExtractor.
+   *
+   * @return absl::string_view the substring, or an empty string_view if there is none.
+   */
+  virtual absl::string_view substrToken() const PURE;
 };
 
 typedef std::unique_ptr<const TagExtractor> TagExtractorPtr;
@@ -102,19 +114,47 @@ class Metric {
 public:
   virtual ~Metric() {}
   /**
-   * Returns the full name of the Metric.
+   * Returns the full name of the Metric. Names are stored in encoded form, so this builds a new
+   * string on each call; use statName() for lookups and comparisons.
    */
-  virtual const std::string& name() const PURE;
+  virtual std::string name() const PURE;
+
+  /**
+   * Appends the full name of the Metric to a string. Unlike name(), this does not allocate when
+   * the string has room, so sinks formatting many metrics should use it with a reused string.
+   */
+  virtual void appendName(std::string& out) const PURE;
+
+  /**
+   * Returns the full name of the Metric in its encoded form.
+   */
+  virtual StatName statName() const PURE;
 
   /**
    * Returns a vector of configurable tags to identify this Metric.
    */
-  virtual const std::vector<Tag>& tags() const PURE;
+  virtual std::vector<Tag> tags() const PURE;
+
+  typedef std::function<void(absl::string_view name, absl::string_view value)> TagCb;
+
+  /**
+   * Calls a function with the name and value of each tag of the Metric, in the order of tags().
+   * @param scratch storage for decoding the tags, reused across tags and calls so that iterating
+   *        does not allocate when it has room.
+   * @param cb the function to call. The views it is passed point into scratch and are only valid
+   *        during the call.
+   */
+  virtual void iterateTags(std::string& scratch, const TagCb& cb) const PURE;
 
   /**
    * Returns the name of the Metric with the portions designated as tags removed.
    */
-  virtual const std::string& tagExtractedName() const PURE;
+  virtual std::string tagExtractedName() const PURE;
+
+  /**
+   * Appends the tag extracted name of the Metric to a string, as appendName() does for name().
+   */
+  virtual void appendTagExtractedName(std::string& out) const PURE;
 
   /**
    * Indicates whether this metric has been updated since the server was started.
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * A Symbol represents one '.'-delimited token of a stat name, e.g. "cluster" or "upstream_rq_200".
+ * Symbols are assigned by a symbol table and are only meaningful relative to that table.
+ */
+typedef uint32_t Symbol;
+typedef std::vector<Symbol> SymbolVec;
+
+/**
+ * A stat name encoded as a sequence of symbols. This is a non-owning view onto a byte array laid
+ * out as a 2-byte little-endian length followed by that many bytes of varint-encoded symbols.
+ * The bytes are owned elsewhere, typically by the stat the name belongs to. Two StatNames encoded
+ * by the same symbol table are equal if and only if the names they encode are equal, so a
+ * StatName can be hashed and compared without decoding it.
+ */
+class StatName {
+public:
+  static const uint64_t SizeBytes = 2;
+
+  StatName() : size_and_data_(nullptr) {}
+  explicit StatName(const uint8_t* size_and_data) : size_and_data_(size_and_data) {}
+
+  /**
+   * @return uint64_t the number of bytes of encoded symbols, excluding the length prefix.
+   */
+  uint64_t dataSize() const {
+    return size_and_data_[0] | (static_cast<uint64_t>(size_and_data_[1]) << 8);
+  }
+
+  /**
+   * @return uint64_t the number of bytes occupied by this StatName, including the length prefix.
+   */
+  uint64_t size() const { return dataSize() + SizeBytes; }
+
+  /**
+   * @return const uint8_t* the encoded symbols.
+   */
+  const uint8_t* data() const { return size_and_data_ + SizeBytes; }
+
+  bool operator==(const StatName& rhs) const {
+    const uint64_t sz = size();
+    return sz == rhs.size() && memcmp(size_and_data_, rhs.size_and_data_, sz) == 0;
+  }
+  bool operator!=(const StatName& rhs) const { return !(*this == rhs); }
+
+private:
+  const uint8_t* size_and_data_;
+};
+
+} // namespace Stats
+} // namespace Envoy
@@ -215,6 +215,29 @@ public:
    */
   virtual const HostsPerLocality& healthyHostsPerLocality() const PURE;
 
+  /**
+   * @return HostVectorConstSharedPtr the immutable snapshot backing hosts(). The snapshot is
+   *         replaced, never modified, when the host set is updated, so it can be shared across
+   *         threads and compared by identity to detect changes.
+   */
+  virtual HostVectorConstSharedPtr hostsPtr() const PURE;
+
+  /**
+   * @return HostVectorConstSharedPtr the immutable snapshot backing healthyHosts().
+   */
+  virtual HostVectorConstSharedPtr healthyHostsPtr() const PURE;
+
+  /**
+   * @return HostsPerLocalityConstSharedPtr the immutable snapshot backing hostsPerLocality().
+   */
+  virtual HostsPerLocalityConstSharedPtr hostsPerLocalityPtr() const PURE;
+
+  /**
+   * @return HostsPerLocalityConstSharedPtr the immutable snapshot backing
+   *         healthyHostsPerLocality().
+   */
+  virtual HostsPerLocalityConstSharedPtr healthyHostsPerLocalityPtr() const PURE;
+
   /**
    * @return weights for each locality in the host set.
    */
@@ -13,13 +13,14 @@ Event::DispatcherPtr Impl::allocateDispatcher() {
   return Event::DispatcherPtr{new Event::DispatcherImpl()};
 }
 
-Impl::Impl(std::chrono::milliseconds file_flush_interval_msec)
-    : file_flush_interval_msec_(file_flush_interval_msec) {}
+Impl::Impl(std::chrono::milliseconds file_flush_interval_msec, uint32_t file_flush_threads)
+    : file_flush_interval_msec_(file_flush_interval_msec),
+      file_flush_service_(std::make_shared<Filesystem::FlushService>(file_flush_threads)) {}
 
 Filesystem::FileSharedPtr Impl::createFile(const std::string& path, Event::Dispatcher& dispatcher,
                                            Thread::BasicLockable& lock, Stats::Store& stats_store) {
   return std::make_shared<Filesystem::FileImpl>(path, dispatcher, lock, stats_store,
-                                                file_flush_interval_msec_);
+                                                file_flush_interval_msec_, file_flush_service_);
 }
 
 bool Impl::fileExists(const std::string& path) { return Filesystem::fileExists(path); }
@@ -6,6 +6,8 @@
 #include "envoy/api/api.h"
 #include "envoy/filesystem/filesystem.h"
 
+#include "common/filesystem/filesystem_impl.h"
+
 namespace Envoy {
 namespace Api {
 
@@ -14,7 +16,7 @@ namespace Api {
  */
 class Impl : public Api::Api {
 public:
-  Impl(std::chrono::milliseconds file_flush_interval_msec);
+  Impl(std::chrono::milliseconds file_flush_interval_msec, uint32_t file_flush_threads);
 
   // Api::Api
   Event::DispatcherPtr allocateDispatcher() override;
@@ -26,6 +28,8 @@ public:
 
 private:
   std::chrono::milliseconds file_flush_interval_msec_;
+  // Shared with the files, which may outlive this object.
+  Filesystem::FlushServiceSharedPtr file_flush_service_;
 };
 
 } // namespace Api
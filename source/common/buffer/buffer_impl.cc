@@ -6,92 +6,196 @@
 #include "common/api/os_sys_calls_impl.h"
 #include "common/common/assert.h"
 
-#include "event2/buffer.h"
-
 namespace Envoy {
 namespace Buffer {
 
-// RawSlice is the same structure as evbuffer_iovec. This was put into place to avoid leaking
-// libevent into most code since we will likely replace evbuffer with our own implementation at
-// some point. However, we can avoid a bunch of copies since the structure is the same.
-static_assert(sizeof(RawSlice) == sizeof(evbuffer_iovec), "RawSlice != evbuffer_iovec");
-static_assert(offsetof(RawSlice, mem_) == offsetof(evbuffer_iovec, iov_base),
-              "RawSlice != evbuffer_iovec");
-static_assert(offsetof(RawSlice, len_) == offsetof(evbuffer_iovec, iov_len),
-              "RawSlice != evbuffer_iovec");
+void OwnedImpl::add(const void* data, uint64_t size) { addImpl(data, size); }
 
-void OwnedImpl::add(const void* data, uint64_t size) { evbuffer_add(buffer_.get(), data, size); }
+void OwnedImpl::addImpl(const void* data, uint64_t size) {
+  const char* src = static_cast<const char*>(data);
+  if (!slices_.empty()) {
+    const uint64_t copy_size = slices_.back()->append(src, size);
+    src += copy_size;
+    size -= copy_size;
+    length_ += copy_size;
+  }
+  if (size != 0) {
+    slices_.emplace_back(OwnedSlice::create(src, size));
+    length_ += size;
+  }
+}
 
 void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
-  evbuffer_add_reference(
-      buffer_.get(), fragment.data(), fragment.size(),
-      [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); }, &fragment);
+  length_ += fragment.size();
+  slices_.emplace_back(std::make_unique<UnownedSlice>(fragment));
 }
 
-void OwnedImpl::add(const std::string& data) {
-  evbuffer_add(buffer_.get(), data.c_str(), data.size());
-}
+void OwnedImpl::add(const std::string& data) { addImpl(data.data(), data.size()); }
 
 void OwnedImpl::add(const Instance& data) {
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   RawSlice slices[num_slices];
   data.getRawSlices(slices, num_slices);
   for (RawSlice& slice : slices) {
-    add(slice.mem_, slice.len_);
+    addImpl(slice.mem_, slice.len_);
   }
 }
 
 void OwnedImpl::commit(RawSlice* iovecs, uint64_t num_iovecs) {
-  int rc =
-      evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(rc == 0);
+  if (num_iovecs == 0 || slices_.empty()) {
+    return;
+  }
+
+  // Reservations are made from the end of the buffer, so scan backward from the end to find the
+  // last slice containing any content. No slice in front of it can match the iovecs.
+  ssize_t slice_index = static_cast<ssize_t>(slices_.size()) - 1;
+  while (slice_index > 0 && slices_[slice_index]->dataSize() == 0) {
+    slice_index--;
+  }
+
+  // Scan forward and match the slices against the iovecs, in order.
+  uint64_t num_slices_committed = 0;
+  while (num_slices_committed < num_iovecs &&
+         slice_index < static_cast<ssize_t>(slices_.size())) {
+    if (slices_[slice_index]->commit(iovecs[num_slices_committed])) {
+      length_ += iovecs[num_slices_committed].len_;
+      num_slices_committed++;
+    }
+    slice_index++;
+  }
+
+  ASSERT(num_slices_committed > 0);
 }
 
 void OwnedImpl::copyOut(size_t start, uint64_t size, void* data) const {
   ASSERT(start + size <= length());
 
-  evbuffer_ptr start_ptr;
-  int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
-  ASSERT(rc != -1);
-
-  ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
-  ASSERT(static_cast<uint64_t>(copied) == size);
+  uint8_t* dest = static_cast<uint8_t*>(data);
+  for (size_t i = 0; i < slices_.size() && size != 0; i++) {
+    const uint64_t data_size = slices_[i]->dataSize();
+    if (data_size <= start) {
+      start -= data_size;
+      continue;
+    }
+    const uint64_t copy_size = std::min(size, data_size - start);
+    memcpy(dest, slices_[i]->data() + start, copy_size);
+    size -= copy_size;
+    dest += copy_size;
+    start = 0;
+  }
+  ASSERT(size == 0);
 }
 
-void OwnedImpl::drain(uint64_t size) {
+void OwnedImpl::drain(uint64_t size) { drainImpl(size); }
+
+void OwnedImpl::drainImpl(uint64_t size) {
   ASSERT(size <= length());
-  int rc = evbuffer_drain(buffer_.get(), size);
-  ASSERT(rc == 0);
+  while (size != 0 && !slices_.empty()) {
+    const uint64_t slice_size = slices_.front()->dataSize();
+    if (slice_size <= size) {
+      slices_.pop_front();
+      length_ -= slice_size;
+      size -= slice_size;
+    } else {
+      slices_.front()->drain(size);
+      length_ -= size;
+      size = 0;
+    }
+  }
 }
 
 uint64_t OwnedImpl::getRawSlices(RawSlice* out, uint64_t out_size) const {
-  return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
-                       out_size);
+  uint64_t num_slices = 0;
+  for (size_t i = 0; i < slices_.size(); i++) {
+    const SlicePtr& slice = slices_[i];
+    if (slice->dataSize() == 0) {
+      continue;
+    }
+    if (num_slices < out_size) {
+      out[num_slices].mem_ = const_cast<uint8_t*>(slice->data());
+      out[num_slices].len_ = slice->dataSize();
+    }
+    // Per the definition of getRawSlices in include/envoy/buffer/buffer.h, we need to return
+    // the total number of slices needed to access all the data in the buffer, which can be
+    // larger than out_size. So we keep iterating and counting non-empty slices here, even
+    // if all the caller-supplied slices have been filled.
+    num_slices++;
+  }
+  return num_slices;
 }
 
-uint64_t OwnedImpl::length() const { return evbuffer_get_length(buffer_.get()); }
+uint64_t OwnedImpl::length() const { return length_; }
 
 void* OwnedImpl::linearize(uint32_t size) {
   ASSERT(size <= length());
-  return evbuffer_pullup(buffer_.get(), size);
+  if (slices_.empty()) {
+    return nullptr;
+  }
+  if (slices_.front()->dataSize() < size) {
+    // Gather the first size bytes into a single new slice, draining them from the slices they
+    // currently live in, and put the new slice at the front of the buffer.
+    SlicePtr new_slice = OwnedSlice::create(size);
+    RawSlice reservation = new_slice->reserve(size);
+    ASSERT(reservation.len_ == size);
+    copyOut(0, size, reservation.mem_);
+    new_slice->commit(reservation);
+    drainImpl(size);
+    length_ += size;
+    slices_.emplace_front(std::move(new_slice));
+  }
+  return slices_.front()->data();
 }
 
 void OwnedImpl::move(Instance& rhs) {
   // We do the static cast here because in practice we only have one buffer implementation right
-  // now and this is safe. Using the evbuffer move routines require having access to both evbuffers.
+  // now and this is safe. Moving whole slices requires access to the internals of both buffers.
   // This is a reasonable compromise in a high performance path where we want to maintain an
-  // abstraction in case we get rid of evbuffer later.
-  int rc = evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
-  ASSERT(rc == 0);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  // abstraction.
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  while (!other.slices_.empty()) {
+    SlicePtr& other_slice = other.slices_.front();
+    const uint64_t slice_size = other_slice->dataSize();
+    if (slice_size != 0) {
+      if (slice_size <= CopyThreshold && !slices_.empty() &&
+          slices_.back()->reservableSize() >= slice_size) {
+        // Coalesce small slices into the existing tail rather than fragmenting this buffer.
+        slices_.back()->append(other_slice->data(), slice_size);
+      } else {
+        slices_.emplace_back(std::move(other_slice));
+      }
+      length_ += slice_size;
+      other.length_ -= slice_size;
+    }
+    other.slices_.pop_front();
+  }
+  ASSERT(other.length_ == 0);
+  other.postProcess();
 }
 
 void OwnedImpl::move(Instance& rhs, uint64_t length) {
   // See move() above for why we do the static cast.
-  int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(), buffer_.get(),
-                                  length);
-  ASSERT(static_cast<uint64_t>(rc) == length);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  ASSERT(length <= other.length());
+  while (length != 0 && !other.slices_.empty()) {
+    SlicePtr& other_slice = other.slices_.front();
+    const uint64_t slice_size = other_slice->dataSize();
+    if (slice_size <= length) {
+      // The whole slice is wanted, so transfer ownership of it without copying.
+      if (slice_size != 0) {
+        slices_.emplace_back(std::move(other_slice));
+      }
+      other.slices_.pop_front();
+      length_ += slice_size;
+      other.length_ -= slice_size;
+      length -= slice_size;
+    } else {
+      // Only part of the slice is wanted, so copy that part and leave the rest behind.
+      addImpl(other_slice->data(), length);
+      other.drainImpl(length);
+      length = 0;
+    }
+  }
+  other.postProcess();
 }
 
 int OwnedImpl::read(int fd, uint64_t max_length) {
@@ -134,21 +238,114 @@ int OwnedImpl::read(int fd, uint64_t max_length) {
 }
 
 uint64_t OwnedImpl::reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) {
-  uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
-                                        reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(ret >= 1);
-  return ret;
+  if (num_iovecs == 0 || length == 0) {
+    return 0;
+  }
+
+  // Find the run of slices at the end of the buffer that have reservable space: the last slice
+  // with content, plus any empty slices after it left behind by earlier reservations.
+  size_t first_reservable_slice = slices_.size();
+  while (first_reservable_slice > 0) {
+    if (slices_[first_reservable_slice - 1]->reservableSize() == 0) {
+      break;
+    }
+    first_reservable_slice--;
+    if (slices_[first_reservable_slice]->dataSize() != 0) {
+      // There is some content in this slice, so anything in front of it is not reservable.
+      break;
+    }
+  }
+
+  // Reserve as much space as possible from each of those slices.
+  uint64_t num_slices_used = 0;
+  uint64_t bytes_remaining = length;
+  size_t slice_index = first_reservable_slice;
+  while (slice_index < slices_.size() && bytes_remaining != 0 && num_slices_used < num_iovecs) {
+    SlicePtr& slice = slices_[slice_index];
+    const uint64_t reservation_size = std::min(slice->reservableSize(), bytes_remaining);
+    if (num_slices_used + 1 == num_iovecs && reservation_size < bytes_remaining) {
+      // Only one iovec is left and this slice can't complete the reservation. Leave the iovec
+      // for a new slice allocated below.
+      break;
+    }
+    iovecs[num_slices_used] = slice->reserve(reservation_size);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+    slice_index++;
+  }
+
+  // If needed, allocate one more slice at the end to provide the remainder of the reservation.
+  if (bytes_remaining != 0) {
+    slices_.emplace_back(OwnedSlice::create(bytes_remaining));
+    iovecs[num_slices_used] = slices_.back()->reserve(bytes_remaining);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+  }
+
+  ASSERT(num_slices_used <= num_iovecs);
+  ASSERT(bytes_remaining == 0);
+  return num_slices_used;
 }
 
 ssize_t OwnedImpl::search(const void* data, uint64_t size, size_t start) const {
-  evbuffer_ptr start_ptr;
-  if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+  if (start > length_ || size > length_ - start) {
     return -1;
   }
+  if (size == 0) {
+    return start;
+  }
+
+  // Walk the slices looking for the first byte of the pattern with memchr(). On a candidate, try
+  // to match the rest of the pattern, which may continue into subsequent slices.
+  const uint8_t* pattern = static_cast<const uint8_t*>(data);
+  size_t offset = 0;
+  for (size_t slice_index = 0; slice_index < slices_.size(); slice_index++) {
+    const Slice& slice = *slices_[slice_index];
+    const uint64_t slice_size = slice.dataSize();
+    if (offset + slice_size <= start) {
+      offset += slice_size;
+      continue;
+    }
+    const uint8_t* slice_start = slice.data();
+    const uint8_t* slice_end = slice_start + slice_size;
+    const uint8_t* cursor = slice_start + (start > offset ? start - offset : 0);
+    while (cursor < slice_end) {
+      cursor = static_cast<const uint8_t*>(memchr(cursor, pattern[0], slice_end - cursor));
+      if (cursor == nullptr) {
+        break;
+      }
+      const size_t match_position = offset + (cursor - slice_start);
+      if (size > length_ - match_position) {
+        return -1;
+      }
 
-  evbuffer_ptr result_ptr =
-      evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
-  return result_ptr.pos;
+      // Compare the remainder of the pattern, crossing slice boundaries as needed.
+      const uint8_t* match_cursor = cursor;
+      const uint8_t* match_end = slice_end;
+      size_t match_slice = slice_index;
+      uint64_t matched = 0;
+      while (matched < size) {
+        if (match_cursor == match_end) {
+          match_slice++;
+          match_cursor = slices_[match_slice]->data();
+          match_end = match_cursor + slices_[match_slice]->dataSize();
+          continue;
+        }
+        const uint64_t compare_size = std::min<uint64_t>(size - matched, match_end - match_cursor);
+        if (memcmp(match_cursor, pattern + matched, compare_size) != 0) {
+          break;
+        }
+        matched += compare_size;
+        match_cursor += compare_size;
+      }
+      if (matched == size) {
+        return match_position;
+      }
+      cursor++;
+    }
+    offset += slice_size;
+  }
+  return -1;
 }
 
 int OwnedImpl::write(int fd) {
@@ -175,7 +372,7 @@ int OwnedImpl::write(int fd) {
   return static_cast<int>(rc);
 }
 
-OwnedImpl::OwnedImpl() : buffer_(evbuffer_new()) {}
+OwnedImpl::OwnedImpl() {}
 
 OwnedImpl::OwnedImpl(const std::string& data) : OwnedImpl() { add(data); }
 
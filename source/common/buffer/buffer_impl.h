@@ -1,16 +1,207 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/common/assert.h"
 #include "common/common/non_copyable.h"
-#include "common/event/libevent.h"
 
 namespace Envoy {
 namespace Buffer {
 
+/**
+ * A Slice manages a contiguous block of bytes.
+ * The block is arranged like this:
+ *                   |<- dataSize() --->|<- reservableSize() -->|
+ * +-----------------+------------------+-----------------------+
+ * | Drained         | Data             | Reservable            |
+ * | Unused space    | Usable content   | New content can be    |
+ * | that formerly   |                  | added here with       |
+ * | was in the Data |                  | reserve()/commit()    |
+ * | section         |                  | or append()           |
+ * +-----------------+------------------+-----------------------+
+ * ^                 ^                  ^                       ^
+ * |                 |                  |                       |
+ * base_             data()             base_ + reservable_     base_ + capacity_
+ */
+class Slice {
+public:
+  virtual ~Slice() {}
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  const uint8_t* data() const { return base_ + data_; }
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  uint8_t* data() { return base_ + data_; }
+
+  /**
+   * @return the size in bytes of the usable content.
+   */
+  uint64_t dataSize() const { return reservable_ - data_; }
+
+  /**
+   * Remove the first size bytes of usable content. Runs in O(1) time.
+   * @param size number of bytes to remove. If greater than dataSize(), the result is undefined.
+   */
+  void drain(uint64_t size) {
+    ASSERT(data_ + size <= reservable_);
+    data_ += size;
+    if (data_ == reservable_) {
+      // All the data in the slice has been drained. Reset the offsets so all the data can be
+      // reused.
+      data_ = 0;
+      reservable_ = 0;
+    }
+  }
+
+  /**
+   * @return the number of bytes available to be reserve()d.
+   * @note If reserve() has been called without a corresponding commit(), this method
+   *       still reports the full reservable space; a reservation is only a view onto it.
+   */
+  uint64_t reservableSize() const { return capacity_ - reservable_; }
+
+  /**
+   * Reserve `size` bytes that the caller can populate with content. The caller SHOULD then
+   * call commit() to add the newly populated content from the Reserved section to the Data
+   * section. Any other mutation of the slice (append() or another reserve()/commit()) before
+   * the commit() invalidates the reservation.
+   * @param size the number of bytes to reserve. The Slice implementation MAY reserve
+   *        fewer bytes than requested (for example, if it doesn't have enough room in the
+   *        Reservable section to fulfill the whole request).
+   * @return a RawSlice containing the address and length of the reserved space. If the slice
+   *         has no reservable space, the RawSlice is {nullptr, 0}.
+   */
+  RawSlice reserve(uint64_t size) {
+    const uint64_t reservation_size = std::min(size, reservableSize());
+    if (reservation_size == 0) {
+      return {nullptr, 0};
+    }
+    return {base_ + reservable_, static_cast<size_t>(reservation_size)};
+  }
+
+  /**
+   * Commit a Reservation that was previously obtained from a call to reserve().
+   * The Reservation's size is added to the Data section.
+   * @param reservation a reservation obtained from a previous call to reserve().
+   *        If the reservation is not from this Slice, commit() will return false.
+   *        If the caller is committing fewer bytes than provided by reserve(), it
+   *        should change the len_ field of the reservation before calling commit().
+   *        For example, if a caller reserve()s 4KB to do a nonblocking socket read,
+   *        and the read only returns two bytes, the caller should set
+   *        reservation.len_ = 2 and then call commit(reservation).
+   * @return whether the Reservation was successfully committed to the Slice.
+   */
+  bool commit(const RawSlice& reservation) {
+    if (static_cast<const uint8_t*>(reservation.mem_) != base_ + reservable_ ||
+        reservable_ + reservation.len_ > capacity_) {
+      // The reservation is not from this slice.
+      return false;
+    }
+    reservable_ += reservation.len_;
+    return true;
+  }
+
+  /**
+   * Copy as much of the supplied data as possible to the end of the slice.
+   * @param data start of the data to copy.
+   * @param size number of bytes to copy.
+   * @return number of bytes copied (may be a smaller than size, may even be zero).
+   */
+  uint64_t append(const void* data, uint64_t size) {
+    const uint64_t copy_size = std::min(size, reservableSize());
+    if (copy_size != 0) {
+      memcpy(base_ + reservable_, data, copy_size);
+      reservable_ += copy_size;
+    }
+    return copy_size;
+  }
+
+protected:
+  Slice(uint64_t data, uint64_t reservable, uint64_t capacity)
+      : data_(data), reservable_(reservable), capacity_(capacity) {}
+
+  // Start of the slice. Subclasses must set base_.
+  uint8_t* base_{nullptr};
+
+  // Offset in bytes from the start of the slice to the start of the Data section.
+  uint64_t data_;
+
+  // Offset in bytes from the start of the slice to the start of the Reservable section.
+  uint64_t reservable_;
+
+  // Total number of bytes in the slice.
+  uint64_t capacity_;
+};
+
+typedef std::unique_ptr<Slice> SlicePtr;
+
+/**
+ * A Slice that owns its storage. The storage is allocated inline, immediately after the slice
+ * header, so that creating a slice costs a single heap allocation.
+ */
+class OwnedSlice : public Slice {
+public:
+  /**
+   * Create an empty OwnedSlice.
+   * @param capacity number of bytes of space the slice should have. The actual capacity is
+   *        rounded up so that the slice header plus storage fill a whole number of pages.
+   * @return an OwnedSlice with at least the specified capacity.
+   */
+  static SlicePtr create(uint64_t capacity) {
+    const uint64_t slice_capacity = sliceSize(capacity);
+    return SlicePtr(new (slice_capacity) OwnedSlice(slice_capacity));
+  }
+
+  /**
+   * Create an OwnedSlice and initialize it with a copy of the supplied data.
+   * @param data the content to copy into the slice.
+   * @param size length of the content.
+   * @return an OwnedSlice containing a copy of the content, which may (dependent on
+   *         the internal implementation) have a nonzero amount of reservable space at the end.
+   */
+  static SlicePtr create(const void* data, uint64_t size) {
+    SlicePtr slice = create(size);
+    slice->append(data, size);
+    return slice;
+  }
+
+  // Custom delete operator to keep C++14 from using the global operator delete(void*, size_t),
+  // which would result in the compiler error:
+  // "exception cleanup for this placement new selects non-placement operator delete"
+  static void operator delete(void* address) { ::operator delete(address); }
+
+private:
+  static void* operator new(size_t object_size, size_t data_size) {
+    return ::operator new(object_size + data_size);
+  }
+
+  OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
+
+  /**
+   * Compute a slice size big enough to hold a specified amount of data.
+   * @param data_size the minimum amount of data the slice must be able to store, in bytes.
+   * @return a recommended slice size, in bytes.
+   */
+  static uint64_t sliceSize(uint64_t data_size) {
+    static constexpr uint64_t PageSize = 4096;
+    const uint64_t num_pages = (sizeof(OwnedSlice) + data_size + PageSize - 1) / PageSize;
+    return num_pages * PageSize - sizeof(OwnedSlice);
+  }
+
+  uint8_t storage_[];
+};
+
 /**
  * An implementation of BufferFragment where a releasor callback is called when the data is
  * no longer needed.
@@ -46,28 +237,165 @@ private:
   const std::function<void(const void*, size_t, const BufferFragmentImpl*)> releasor_;
 };
 
-class LibEventInstance : public Instance {
+/**
+ * A Slice that references externally owned data supplied via a BufferFragment. The fragment's
+ * done() is called when the slice is destroyed, i.e. once every byte has been drained or the
+ * owning buffer goes away.
+ */
+class UnownedSlice : public Slice {
 public:
-  // Allows access into the underlying buffer for move() optimizations.
-  virtual Event::Libevent::BufferPtr& buffer() PURE;
-  // Called after accessing the memory in buffer() directly to allow any post-processing.
-  virtual void postProcess() PURE;
+  UnownedSlice(BufferFragment& fragment)
+      : Slice(0, fragment.size(), fragment.size()), fragment_(fragment) {
+    base_ = static_cast<uint8_t*>(const_cast<void*>(fragment.data()));
+  }
+
+  ~UnownedSlice() override { fragment_.done(); }
+
+private:
+  BufferFragment& fragment_;
+};
+
+/**
+ * Queue of SlicePtr that supports efficient read and write access to both
+ * the front and the back of the queue.
+ * @note This class has similar properties to std::deque<T>. The reason for using
+ *       a custom deque implementation is that std::deque in libstdc++ heap-allocates a
+ *       chunk map on construction, even for empty buffers. SliceDeque keeps a small ring
+ *       inline and only moves to the heap once a buffer holds more than a handful of slices.
+ */
+class SliceDeque {
+public:
+  SliceDeque() : ring_(inline_ring_), capacity_(InlineRingCapacity) {}
+
+  SliceDeque(SliceDeque&& rhs) noexcept {
+    // This custom move constructor is needed so that ring_ will be updated properly.
+    std::move(rhs.inline_ring_, rhs.inline_ring_ + InlineRingCapacity, inline_ring_);
+    external_ring_ = std::move(rhs.external_ring_);
+    ring_ = (external_ring_ != nullptr) ? external_ring_.get() : inline_ring_;
+    start_ = rhs.start_;
+    size_ = rhs.size_;
+    capacity_ = rhs.capacity_;
+    rhs.ring_ = rhs.inline_ring_;
+    rhs.start_ = 0;
+    rhs.size_ = 0;
+    rhs.capacity_ = InlineRingCapacity;
+  }
+
+  SliceDeque& operator=(SliceDeque&& rhs) noexcept {
+    // This custom assignment move operator is needed so that ring_ will be updated properly.
+    std::move(rhs.inline_ring_, rhs.inline_ring_ + InlineRingCapacity, inline_ring_);
+    external_ring_ = std::move(rhs.external_ring_);
+    ring_ = (external_ring_ != nullptr) ? external_ring_.get() : inline_ring_;
+    start_ = rhs.start_;
+    size_ = rhs.size_;
+    capacity_ = rhs.capacity_;
+    rhs.ring_ = rhs.inline_ring_;
+    rhs.start_ = 0;
+    rhs.size_ = 0;
+    rhs.capacity_ = InlineRingCapacity;
+    return *this;
+  }
+
+  void emplace_back(SlicePtr&& slice) {
+    growRing();
+    size_t index = internalIndex(size_);
+    ring_[index] = std::move(slice);
+    size_++;
+  }
+
+  void emplace_front(SlicePtr&& slice) {
+    growRing();
+    start_ = (start_ == 0) ? capacity_ - 1 : start_ - 1;
+    ring_[start_] = std::move(slice);
+    size_++;
+  }
+
+  bool empty() const { return size() == 0; }
+  size_t size() const { return size_; }
+
+  SlicePtr& front() { return ring_[start_]; }
+  const SlicePtr& front() const { return ring_[start_]; }
+  SlicePtr& back() { return ring_[internalIndex(size_ - 1)]; }
+  const SlicePtr& back() const { return ring_[internalIndex(size_ - 1)]; }
+
+  SlicePtr& operator[](size_t i) { return ring_[internalIndex(i)]; }
+  const SlicePtr& operator[](size_t i) const { return ring_[internalIndex(i)]; }
+
+  void pop_front() {
+    if (size() == 0) {
+      return;
+    }
+    front() = SlicePtr();
+    size_--;
+    start_++;
+    if (start_ == capacity_) {
+      start_ = 0;
+    }
+  }
+
+  void pop_back() {
+    if (size() == 0) {
+      return;
+    }
+    back() = SlicePtr();
+    size_--;
+  }
+
+private:
+  constexpr static size_t InlineRingCapacity = 8;
+
+  size_t internalIndex(size_t index) const {
+    size_t internal_index = start_ + index;
+    if (internal_index >= capacity_) {
+      internal_index -= capacity_;
+      ASSERT(internal_index < capacity_);
+    }
+    return internal_index;
+  }
+
+  void growRing() {
+    if (size_ < capacity_) {
+      return;
+    }
+    const size_t new_capacity = capacity_ * 2;
+    auto new_ring = std::make_unique<SlicePtr[]>(new_capacity);
+    size_t src = start_;
+    size_t dst = 0;
+    for (size_t i = 0; i < size_; i++) {
+      new_ring[dst++] = std::move(ring_[src++]);
+      if (src == capacity_) {
+        src = 0;
+      }
+    }
+    external_ring_.swap(new_ring);
+    ring_ = external_ring_.get();
+    start_ = 0;
+    capacity_ = new_capacity;
+  }
+
+  SlicePtr inline_ring_[InlineRingCapacity];
+  std::unique_ptr<SlicePtr[]> external_ring_;
+  SlicePtr* ring_; // points to start of either inline or external ring.
+  size_t start_{0};
+  size_t size_{0};
+  size_t capacity_;
 };
 
 /**
- * Wraps an allocated and owned evbuffer.
+ * A buffer made of a queue of slices. Whole slices are moved between OwnedImpl instances in O(1)
+ * time, and externally owned data added via addBufferFragment() is referenced rather than copied.
  *
- * Note that due to the internals of move() accessing buffer(), OwnedImpl is not
- * compatible with non-LibEventInstance buffers.
+ * Note that due to the internals of move() accessing the slices of the source buffer directly,
+ * OwnedImpl is not compatible with buffers that do not derive from OwnedImpl.
  */
-class OwnedImpl : public LibEventInstance {
+class OwnedImpl : public Instance {
 public:
   OwnedImpl();
   OwnedImpl(const std::string& data);
   OwnedImpl(const Instance& data);
   OwnedImpl(const void* data, uint64_t size);
 
-  // LibEventInstance
+  // Buffer::Instance
   void add(const void* data, uint64_t size) override;
   void addBufferFragment(BufferFragment& fragment) override;
   void add(const std::string& data) override;
@@ -84,7 +412,12 @@ public:
   uint64_t reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) override;
   ssize_t search(const void* data, uint64_t size, size_t start) const override;
   int write(int fd) override;
-  void postProcess() override {}
+
+  /**
+   * Called on the source buffer after move() has removed data from it, to allow any
+   * post-processing (e.g. watermark checks) that would normally run on drain().
+   */
+  virtual void postProcess() {}
 
   /**
    * Construct a flattened string from a buffer.
@@ -92,10 +425,28 @@ public:
    */
   std::string toString() const;
 
-  Event::Libevent::BufferPtr& buffer() override { return buffer_; }
-
 private:
-  Event::Libevent::BufferPtr buffer_;
+  /**
+   * Append a copy of size bytes to the buffer without going through any overridden virtual
+   * methods.
+   */
+  void addImpl(const void* data, uint64_t size);
+
+  /**
+   * Remove size bytes from the front of the buffer without going through any overridden
+   * virtual methods. Used by move() on the source buffer.
+   */
+  void drainImpl(uint64_t size);
+
+  // Slices smaller than this are copied rather than moved when a buffer is moved into another
+  // buffer whose last slice has room, so that many tiny writes don't fragment the destination.
+  static constexpr uint64_t CopyThreshold = 512;
+
+  // The slices that hold the buffer's content.
+  SliceDeque slices_;
+
+  // Sum of the dataSize of all slices.
+  uint64_t length_{0};
 };
 
 } // namespace Buffer
@@ -0,0 +1,68 @@
+#include "common/buffer/ring_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Buffer {
+
+RingBuffer::RingBuffer(uint64_t capacity, uint64_t offset)
+    : capacity_(capacity), data_(new char[capacity]), read_index_(offset), write_index_(offset) {
+  ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+}
+
+bool RingBuffer::write(absl::string_view data) {
+  const uint64_t write_index = write_index_.load(std::memory_order_relaxed);
+  const uint64_t read_index = read_index_.load(std::memory_order_acquire);
+  if (data.size() > capacity_ - (write_index - read_index)) {
+    return false;
+  }
+
+  const uint64_t position = write_index & (capacity_ - 1);
+  const uint64_t first_size = std::min<uint64_t>(data.size(), capacity_ - position);
+  memcpy(data_.get() + position, data.data(), first_size);
+  memcpy(data_.get(), data.data() + first_size, data.size() - first_size);
+  write_index_.store(write_index + data.size(), std::memory_order_release);
+  return true;
+}
+
+uint64_t RingBuffer::getReadableSlices(RawSlice out[2]) {
+  return getSlices(read_index_.load(std::memory_order_relaxed),
+                   write_index_.load(std::memory_order_acquire), out);
+}
+
+uint64_t RingBuffer::getSlices(uint64_t begin, uint64_t end, RawSlice out[2]) {
+  ASSERT(begin >= readOffset() && begin <= end && end <= writeOffset());
+  const uint64_t readable = end - begin;
+  if (readable == 0) {
+    return 0;
+  }
+
+  const uint64_t position = begin & (capacity_ - 1);
+  const uint64_t first_size = std::min<uint64_t>(readable, capacity_ - position);
+  out[0].mem_ = data_.get() + position;
+  out[0].len_ = first_size;
+  if (first_size == readable) {
+    return 1;
+  }
+  out[1].mem_ = data_.get();
+  out[1].len_ = readable - first_size;
+  return 2;
+}
+
+void RingBuffer::drain(uint64_t size) {
+  ASSERT(size <= length());
+  read_index_.store(read_index_.load(std::memory_order_relaxed) + size, std::memory_order_release);
+}
+
+uint64_t RingBuffer::length() const {
+  // Load the read index first so that a concurrent drain can only make the result too large,
+  // never negative.
+  const uint64_t read_index = read_index_.load(std::memory_order_acquire);
+  return write_index_.load(std::memory_order_acquire) - read_index;
+}
+
+} // namespace Buffer
+} // namespace Envoy
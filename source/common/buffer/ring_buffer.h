@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/buffer/buffer.h"
+
+#include "common/common/non_copyable.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * A fixed size byte ring for one producer thread and one consumer thread. The producer appends
+ * whole records with write() and the consumer reads them in place with getReadableSlices() and
+ * releases them with drain(), so neither side takes a lock or copies more than once. Any number
+ * of threads may call length() and writeOffset().
+ *
+ * Bytes are addressed by offsets that count every byte ever written, so that a position in the
+ * ring stays meaningful while the ring is being drained.
+ */
+class RingBuffer : NonCopyable {
+public:
+  /**
+   * @param capacity supplies the size of the ring in bytes. Must be a power of two.
+   * @param offset supplies the offset of the first byte to be written. This lets a ring take over
+   *        from another one, keeping its offsets.
+   */
+  RingBuffer(uint64_t capacity, uint64_t offset = 0);
+
+  /**
+   * Producer only. Append data as a whole.
+   * @return bool whether there was room for all of the data. Nothing is written if not.
+   */
+  bool write(absl::string_view data);
+
+  /**
+   * Consumer only. Fetch the readable bytes, which wrap around the end of the ring in at most two
+   * slices. The slices stay valid until they are drained.
+   * @param out supplies an array of two slices to fill.
+   * @return uint64_t the number of slices filled, 0 if the ring is empty.
+   */
+  uint64_t getReadableSlices(RawSlice out[2]);
+
+  /**
+   * Consumer only. Fetch the bytes between two offsets, which must be readable.
+   * @param begin supplies the offset of the first byte, at least readOffset().
+   * @param end supplies the offset just past the last byte, at most writeOffset().
+   * @param out supplies an array of two slices to fill.
+   * @return uint64_t the number of slices filled, 0 if begin == end.
+   */
+  uint64_t getSlices(uint64_t begin, uint64_t end, RawSlice out[2]);
+
+  /**
+   * Consumer only. Release bytes returned by getReadableSlices() for reuse by the producer.
+   */
+  void drain(uint64_t size);
+
+  /**
+   * @return uint64_t the number of readable bytes.
+   */
+  uint64_t length() const;
+
+  /**
+   * Consumer only.
+   * @return uint64_t the offset of the first readable byte.
+   */
+  uint64_t readOffset() const { return read_index_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return uint64_t the offset just past the last byte written.
+   */
+  uint64_t writeOffset() const { return write_index_.load(std::memory_order_acquire); }
+
+  uint64_t capacity() const { return capacity_; }
+
+private:
+  const uint64_t capacity_;
+  std::unique_ptr<char[]> data_;
+  // Monotonically increasing byte offsets; the position in data_ is the offset modulo capacity_.
+  // write_index_ is only stored by the producer and read_index_ only by the consumer.
+  std::atomic<uint64_t> read_index_;
+  std::atomic<uint64_t> write_index_;
+};
+
+typedef std::unique_ptr<RingBuffer> RingBufferPtr;
+
+} // namespace Buffer
+} // namespace Envoy
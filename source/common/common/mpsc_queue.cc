@@ -0,0 +1,44 @@
+#include "common/common/mpsc_queue.h"
+
+namespace Envoy {
+
+void MpscQueue::push(Node& node) {
+  node.next_.store(nullptr, std::memory_order_relaxed);
+  // Between the exchange and the store the list is briefly broken at prev, which pop() reports as
+  // an empty queue.
+  Node* prev = head_.exchange(&node, std::memory_order_acq_rel);
+  prev->next_.store(&node, std::memory_order_release);
+}
+
+MpscQueue::Node* MpscQueue::pop() {
+  Node* tail = tail_;
+  Node* next = tail->next_.load(std::memory_order_acquire);
+  if (tail == &stub_) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+    tail_ = next;
+    tail = next;
+    next = next->next_.load(std::memory_order_acquire);
+  }
+
+  if (next != nullptr) {
+    tail_ = next;
+    return tail;
+  }
+
+  // tail is the last linked node. It can only be removed once another node follows it, so
+  // re-queue the stub behind it, unless a producer has already swung head_ past it.
+  if (tail != head_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  push(stub_);
+  next = tail->next_.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    tail_ = next;
+    return tail;
+  }
+  return nullptr;
+}
+
+} // namespace Envoy
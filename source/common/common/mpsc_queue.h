@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * Intrusive lock-free FIFO queue with any number of producers and a single consumer, after Dmitry
+ * Vyukov's non-intrusive MPSC node-based queue. push() is wait-free: it takes a single atomic
+ * exchange and never allocates. pop() is lock-free but not linearizable: while a producer is in
+ * the middle of push() it may report the queue as empty even though later elements are present.
+ * Producers that need the consumer to observe an element must therefore signal it after push()
+ * returns, which makes the element visible.
+ *
+ * The queue does not own its nodes; the caller must keep a node alive while it is queued.
+ */
+class MpscQueue : NonCopyable {
+public:
+  /**
+   * Base class of queued elements.
+   */
+  class Node {
+  private:
+    friend class MpscQueue;
+    std::atomic<Node*> next_{nullptr};
+  };
+
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  /**
+   * Adds a node at the back of the queue. May be called from any thread.
+   * @param node supplies the node, which must not already be queued.
+   */
+  void push(Node& node);
+
+  /**
+   * Removes the node at the front of the queue. Must only be called from the consumer thread.
+   * @return Node* the node, or nullptr if the queue is empty or the next node's push() has not
+   *         completed yet.
+   */
+  Node* pop();
+
+private:
+  // Producers append at head_, and the consumer removes from tail_. stub_ is a placeholder that
+  // keeps the list non-empty, and is re-queued whenever the consumer would otherwise remove the
+  // last node.
+  std::atomic<Node*> head_;
+  Node* tail_;
+  Node stub_;
+};
+
+} // namespace Envoy
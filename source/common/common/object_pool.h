@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * A bounded set of idle objects that are expensive to create, such as zlib streams, kept for
+ * reuse. The pool only stores objects; callers create them when acquire() comes back empty and
+ * must return them to a reusable state before release(). A pool is not thread safe and is meant
+ * to be owned by a single worker, e.g. through a thread local slot.
+ */
+template <class T> class ObjectPool : NonCopyable {
+public:
+  typedef std::unique_ptr<T> ObjectPtr;
+
+  /**
+   * @param max_size the maximum number of idle objects to keep. 0 disables pooling.
+   */
+  ObjectPool(uint32_t max_size) : max_size_(max_size) {}
+
+  /**
+   * @return an idle object, or nullptr if there is none.
+   */
+  ObjectPtr acquire() {
+    if (objects_.empty()) {
+      return nullptr;
+    }
+    ObjectPtr object = std::move(objects_.back());
+    objects_.pop_back();
+    return object;
+  }
+
+  /**
+   * Keep an object for a later acquire(), or destroy it if the pool is full.
+   * @return whether the object was kept.
+   */
+  bool release(ObjectPtr&& object) {
+    if (objects_.size() >= max_size_) {
+      object.reset();
+      return false;
+    }
+    objects_.push_back(std::move(object));
+    return true;
+  }
+
+  /**
+   * @return the number of idle objects.
+   */
+  size_t size() const { return objects_.size(); }
+
+private:
+  const uint32_t max_size_;
+  std::vector<ObjectPtr> objects_;
+};
+
+} // namespace Envoy
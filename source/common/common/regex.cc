@@ -0,0 +1,53 @@
+#include "common/common/regex.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/fmt.h"
+
+namespace Envoy {
+namespace Regex {
+
+Re2CompiledMatcher::Re2CompiledMatcher(const std::string& regex) : regex_(regex, options()) {
+  if (!regex_.ok()) {
+    throw EnvoyException(fmt::format("Invalid regex '{}': {}", regex, regex_.error()));
+  }
+}
+
+re2::RE2::Options Re2CompiledMatcher::options() {
+  re2::RE2::Options options;
+  options.set_encoding(re2::RE2::Options::EncodingLatin1);
+  options.set_log_errors(false);
+  return options;
+}
+
+bool Re2CompiledMatcher::match(absl::string_view value) const {
+  return regex_.Match(re2::StringPiece(value.data(), value.size()), 0, value.size(),
+                      re2::RE2::ANCHOR_BOTH, nullptr, 0);
+}
+
+bool Re2CompiledMatcher::search(absl::string_view value, absl::string_view* captures,
+                                uint32_t num_captures) const {
+  // RE2 reports the whole match as group 0, ahead of the capture groups.
+  const uint32_t num_groups = std::min(num_captures, numCaptureGroups());
+  std::vector<re2::StringPiece> groups(num_groups + 1);
+  if (!regex_.Match(re2::StringPiece(value.data(), value.size()), 0, value.size(),
+                    re2::RE2::UNANCHORED, groups.data(), groups.size())) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < num_captures; i++) {
+    captures[i] = i < num_groups ? absl::string_view(groups[i + 1].data(), groups[i + 1].size())
+                                 : absl::string_view();
+  }
+  return true;
+}
+
+CompiledMatcherPtr Utility::parseRegex(const std::string& regex) {
+  return CompiledMatcherPtr{new Re2CompiledMatcher(regex)};
+}
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/common/regex.h"
+
+#include "absl/strings/string_view.h"
+#include "re2/re2.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * CompiledMatcher backed by RE2. Matching takes time linear in the size of the input, uses bounded
+ * stack, and the expression is fully compiled up front. Input is matched byte by byte, as
+ * std::regex does, rather than as UTF-8.
+ */
+class Re2CompiledMatcher : public CompiledMatcher {
+public:
+  /**
+   * @param regex supplies the regular expression.
+   * @throw EnvoyException if RE2 cannot compile regex.
+   */
+  explicit Re2CompiledMatcher(const std::string& regex);
+
+  // Regex::CompiledMatcher
+  bool match(absl::string_view value) const override;
+  bool search(absl::string_view value, absl::string_view* captures,
+              uint32_t num_captures) const override;
+  uint32_t numCaptureGroups() const override { return regex_.NumberOfCapturingGroups(); }
+
+private:
+  static re2::RE2::Options options();
+
+  const re2::RE2 regex_;
+};
+
+/**
+ * Utilities for compiling regular expressions.
+ */
+class Utility {
+public:
+  /**
+   * Compiles a regular expression with RE2. RE2 does not support backtracking features such as
+   * lookaround assertions and backreferences, so expressions using them are rejected.
+   * @param regex supplies the regular expression.
+   * @return CompiledMatcherPtr the compiled expression.
+   * @throw EnvoyException if regex is invalid.
+   */
+  static CompiledMatcherPtr parseRegex(const std::string& regex);
+};
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,89 @@
+#include "common/common/substring_matcher.h"
+
+#include <algorithm>
+
+namespace Envoy {
+
+const SubstringMatcher::State SubstringMatcher::InitialState;
+
+uint32_t SubstringMatcher::add(absl::string_view pattern) {
+  ASSERT(!pattern.empty());
+  const auto it = std::find(patterns_.begin(), patterns_.end(), pattern);
+  if (it != patterns_.end()) {
+    return it - patterns_.begin();
+  }
+  patterns_.emplace_back(pattern);
+  compiled_ = false;
+  return patterns_.size() - 1;
+}
+
+void SubstringMatcher::compile() {
+  std::fill(std::begin(byte_classes_), std::end(byte_classes_), 0);
+  num_classes_ = 1;
+  for (const std::string& pattern : patterns_) {
+    for (const char c : pattern) {
+      uint16_t& byte_class = byte_classes_[static_cast<uint8_t>(c)];
+      if (byte_class == 0) {
+        byte_class = num_classes_++;
+      }
+    }
+  }
+
+  // Build the trie of patterns rooted at InitialState. While building, a transition to
+  // InitialState marks a missing edge, since no edge of the trie leads back to the root.
+  transitions_.assign(num_classes_, InitialState);
+  std::vector<std::vector<uint32_t>> outputs(1);
+  for (uint32_t id = 0; id < patterns_.size(); id++) {
+    State state = InitialState;
+    for (const char c : patterns_[id]) {
+      const size_t edge = state * num_classes_ + byte_classes_[static_cast<uint8_t>(c)];
+      if (transitions_[edge] == InitialState) {
+        transitions_[edge] = transitions_.size() / num_classes_;
+        transitions_.resize(transitions_.size() + num_classes_, InitialState);
+        outputs.emplace_back();
+      }
+      state = transitions_[edge];
+    }
+    outputs[state].push_back(id);
+  }
+
+  // Visit the states breadth first, so that the failure state of each state, i.e. the state for the
+  // longest proper suffix of its string that is also in the trie, has been completed before it.
+  // Missing edges are then replaced by the edges of the failure state, and each state inherits the
+  // outputs of its failure state.
+  const uint32_t num_states = transitions_.size() / num_classes_;
+  std::vector<State> failure(num_states, InitialState);
+  std::vector<State> queue;
+  queue.reserve(num_states);
+  for (uint32_t byte_class = 0; byte_class < num_classes_; byte_class++) {
+    if (transitions_[byte_class] != InitialState) {
+      queue.push_back(transitions_[byte_class]);
+    }
+  }
+  for (size_t head = 0; head < queue.size(); head++) {
+    const State state = queue[head];
+    const State fail = failure[state];
+    outputs[state].insert(outputs[state].end(), outputs[fail].begin(), outputs[fail].end());
+    for (uint32_t byte_class = 0; byte_class < num_classes_; byte_class++) {
+      State& next = transitions_[state * num_classes_ + byte_class];
+      const State fail_next = transitions_[fail * num_classes_ + byte_class];
+      if (next != InitialState) {
+        failure[next] = fail_next;
+        queue.push_back(next);
+      } else {
+        next = fail_next;
+      }
+    }
+  }
+
+  output_offsets_.clear();
+  outputs_.clear();
+  for (const std::vector<uint32_t>& state_outputs : outputs) {
+    output_offsets_.push_back(outputs_.size());
+    outputs_.insert(outputs_.end(), state_outputs.begin(), state_outputs.end());
+  }
+  output_offsets_.push_back(outputs_.size());
+  compiled_ = true;
+}
+
+} // namespace Envoy
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+
+/**
+ * Finds every occurrence of a fixed set of patterns in a single pass over the input, using the
+ * Aho-Corasick algorithm. Patterns are compiled into a DFA whose alphabet is reduced to the bytes
+ * that appear in the patterns, so scanning costs one table lookup per input byte regardless of the
+ * number of patterns. Once compiled, the matcher is immutable and can be shared between threads.
+ */
+class SubstringMatcher {
+public:
+  typedef uint32_t State;
+
+  /**
+   * The state to start scanning from. Scanning can be resumed from the state returned by a
+   * previous scan() to match patterns that span both inputs.
+   */
+  static const State InitialState = 0;
+
+  SubstringMatcher() { compile(); }
+
+  /**
+   * Adds a pattern. compile() must be called before the matcher is used again.
+   * @param pattern supplies the pattern, which must not be empty.
+   * @return uint32_t the id of the pattern. Ids are assigned sequentially from 0, and adding a
+   *         pattern that was already added returns its existing id.
+   */
+  uint32_t add(absl::string_view pattern);
+
+  /**
+   * Builds the DFA for the patterns added so far.
+   */
+  void compile();
+
+  /**
+   * @return uint32_t the number of distinct patterns.
+   */
+  uint32_t size() const { return patterns_.size(); }
+
+  /**
+   * Scans input, calling on_match(uint32_t id) for each occurrence of a pattern that ends in input.
+   * A pattern that occurs several times is reported once per occurrence.
+   * @param state supplies the state to resume from, InitialState for a new input.
+   * @param input supplies the bytes to scan.
+   * @param on_match supplies the callback for each occurrence.
+   * @return State the state after scanning input.
+   */
+  template <class OnMatch>
+  State scan(State state, absl::string_view input, OnMatch on_match) const {
+    ASSERT(compiled_);
+    for (const char c : input) {
+      state = transitions_[state * num_classes_ + byte_classes_[static_cast<uint8_t>(c)]];
+      for (uint32_t i = output_offsets_[state]; i < output_offsets_[state + 1]; i++) {
+        on_match(outputs_[i]);
+      }
+    }
+    return state;
+  }
+
+private:
+  std::vector<std::string> patterns_;
+  bool compiled_{};
+
+  // Maps each byte to its column in transitions_. Bytes that appear in no pattern share column 0.
+  uint16_t byte_classes_[256];
+  uint32_t num_classes_{};
+  // Row-major num_states x num_classes_ table of the next state for each state and byte class.
+  std::vector<State> transitions_;
+  // The ids of the patterns ending at state s are outputs_[output_offsets_[s]] up to
+  // outputs_[output_offsets_[s + 1]], including patterns that are suffixes of longer ones.
+  std::vector<uint32_t> output_offsets_;
+  std::vector<uint32_t> outputs_;
+};
+
+} // namespace Envoy
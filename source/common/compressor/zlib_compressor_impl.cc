@@ -33,6 +33,13 @@ void ZlibCompressorImpl::init(CompressionLevel comp_level, CompressionStrategy c
 
 uint64_t ZlibCompressorImpl::checksum() { return zstream_ptr_->adler; }
 
+void ZlibCompressorImpl::reset() {
+  ASSERT(initialized_);
+  const int result = deflateReset(zstream_ptr_.get());
+  RELEASE_ASSERT(result == Z_OK);
+  resetOutput();
+}
+
 void ZlibCompressorImpl::compress(Buffer::Instance& buffer, State state) {
   const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
   Buffer::RawSlice slices[num_slices];
@@ -88,7 +95,11 @@ void ZlibCompressorImpl::updateOutput(Buffer::Instance& output_buffer) {
   if (n_output > 0) {
     output_buffer.add(static_cast<void*>(chunk_char_ptr_.get()), n_output);
   }
-  chunk_char_ptr_.reset(new unsigned char[chunk_size_]);
+  resetOutput();
+}
+
+void ZlibCompressorImpl::resetOutput() {
+  // The output has been copied out, so the chunk can be reused.
   zstream_ptr_->avail_out = chunk_size_;
   zstream_ptr_->next_out = chunk_char_ptr_.get();
 }
@@ -72,6 +72,13 @@ public:
    */
   uint64_t checksum();
 
+  /**
+   * Return an initialized compressor to the state it was in right after init(), discarding any
+   * pending output, so that it can compress a new stream with the same parameters without
+   * allocating its zlib state again.
+   */
+  void reset();
+
   // Compressor
   void compress(Buffer::Instance& buffer, State state) override;
 
@@ -80,6 +87,8 @@ private:
   void process(Buffer::Instance& output_buffer, int64_t flush_state);
   void updateOutput(Buffer::Instance& output_buffer);
 
+  void resetOutput();
+
   const uint64_t chunk_size_;
   bool initialized_;
 
@@ -87,5 +96,7 @@ private:
   std::unique_ptr<z_stream, std::function<void(z_stream*)>> zstream_ptr_;
 };
 
+typedef std::unique_ptr<ZlibCompressorImpl> ZlibCompressorImplPtr;
+
 } // namespace Compressor
 } // namespace Envoy
@@ -31,6 +31,14 @@ void ZlibDecompressorImpl::init(int64_t window_bits) {
 
 uint64_t ZlibDecompressorImpl::checksum() { return zstream_ptr_->adler; }
 
+void ZlibDecompressorImpl::reset() {
+  ASSERT(initialized_);
+  const int result = inflateReset(zstream_ptr_.get());
+  RELEASE_ASSERT(result == Z_OK);
+  zstream_ptr_->avail_out = chunk_size_;
+  zstream_ptr_->next_out = chunk_char_ptr_.get();
+}
+
 void ZlibDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
                                       Buffer::Instance& output_buffer) {
   const uint64_t num_slices = input_buffer.getRawSlices(nullptr, 0);
@@ -44,7 +52,6 @@ void ZlibDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
       if (zstream_ptr_->avail_out == 0) {
         output_buffer.add(static_cast<void*>(chunk_char_ptr_.get()),
                           chunk_size_ - zstream_ptr_->avail_out);
-        chunk_char_ptr_.reset(new unsigned char[chunk_size_]);
         zstream_ptr_->avail_out = chunk_size_;
         zstream_ptr_->next_out = chunk_char_ptr_.get();
       }
@@ -40,6 +40,12 @@ public:
    */
   uint64_t checksum();
 
+  /**
+   * Return an initialized decompressor to the state it was in right after init(), so that it can
+   * decompress a new stream without allocating its zlib state again.
+   */
+  void reset();
+
   // Decompressor
   void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override;
 
@@ -53,5 +59,7 @@ private:
   std::unique_ptr<z_stream, std::function<void(z_stream*)>> zstream_ptr_;
 };
 
+typedef std::unique_ptr<ZlibDecompressorImpl> ZlibDecompressorImplPtr;
+
 } // namespace Decompressor
 } // namespace Envoy
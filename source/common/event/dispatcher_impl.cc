@@ -1,5 +1,11 @@
 #include "common/event/dispatcher_impl.h"
 
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#include <unistd.h>
+
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
 #include <functional>
@@ -10,7 +16,7 @@
 #include "envoy/network/listener.h"
 
 #include "common/buffer/buffer_impl.h"
-#include "common/common/lock_guard.h"
+#include "common/common/assert.h"
 #include "common/event/file_event_impl.h"
 #include "common/event/signal_impl.h"
 #include "common/event/timer_impl.h"
@@ -20,6 +26,7 @@
 #include "common/network/listener_impl.h"
 
 #include "event2/event.h"
+#include "event2/util.h"
 
 namespace Envoy {
 namespace Event {
@@ -33,12 +40,42 @@ DispatcherImpl::DispatcherImpl()
 DispatcherImpl::DispatcherImpl(Buffer::WatermarkFactoryPtr&& factory)
     : buffer_factory_(std::move(factory)), base_(event_base_new()),
       deferred_delete_timer_(createTimer([this]() -> void { clearDeferredDeleteList(); })),
-      post_timer_(createTimer([this]() -> void { runPostCallbacks(); })),
       current_to_delete_(&to_delete_1_) {
   RELEASE_ASSERT(Libevent::Global::initialized());
+  initializePostWakeup();
 }
 
-DispatcherImpl::~DispatcherImpl() {}
+DispatcherImpl::~DispatcherImpl() {
+  post_event_.reset();
+  // Callbacks that never ran are destroyed here. Destroying one may post() another, which is
+  // queued and destroyed in turn.
+  while (MpscQueue::Node* node = post_queue_.pop()) {
+    delete static_cast<PostCallback*>(node);
+  }
+  ::close(post_read_fd_);
+  if (post_write_fd_ != post_read_fd_) {
+    ::close(post_write_fd_);
+  }
+}
+
+void DispatcherImpl::initializePostWakeup() {
+#ifdef __linux__
+  post_read_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  RELEASE_ASSERT(post_read_fd_ != -1);
+  post_write_fd_ = post_read_fd_;
+#else
+  int fds[2];
+  RELEASE_ASSERT(::pipe(fds) == 0);
+  for (int fd : fds) {
+    RELEASE_ASSERT(evutil_make_socket_nonblocking(fd) == 0);
+    RELEASE_ASSERT(evutil_make_socket_closeonexec(fd) == 0);
+  }
+  post_read_fd_ = fds[0];
+  post_write_fd_ = fds[1];
+#endif
+  post_event_ = createFileEvent(post_read_fd_, [this](uint32_t) -> void { onPostWakeup(); },
+                                FileTriggerType::Level, FileReadyType::Read);
+}
 
 void DispatcherImpl::clearDeferredDeleteList() {
   ASSERT(isThreadSafe());
@@ -137,15 +174,14 @@ SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
-  bool do_post;
-  {
-    Thread::LockGuard lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(callback);
-  }
-
-  if (do_post) {
-    post_timer_->enableTimer(std::chrono::milliseconds(0));
+  post_queue_.push(*new PostCallback(std::move(callback)));
+
+  // The callback must be queued before the wakeup is signalled, see runPostCallbacks().
+  if (!post_wakeup_pending_.exchange(true)) {
+    const uint64_t value = 1;
+    const ssize_t rc = ::write(post_write_fd_, &value, sizeof(value));
+    // A full pipe already has a wakeup pending.
+    RELEASE_ASSERT(rc == sizeof(value) || errno == EAGAIN);
   }
 }
 
@@ -161,24 +197,33 @@ void DispatcherImpl::run(RunType type) {
   event_base_loop(base_.get(), type == RunType::NonBlock ? EVLOOP_NONBLOCK : 0);
 }
 
+void DispatcherImpl::onPostWakeup() {
+  // Consume the wakeup so that the level triggered event stops firing.
+  uint64_t value;
+#ifdef __linux__
+  // A single read resets the eventfd counter.
+  const ssize_t rc = ::read(post_read_fd_, &value, sizeof(value));
+  ASSERT(rc == sizeof(value));
+#else
+  // The pipe holds one value per signalled wakeup.
+  while (::read(post_read_fd_, &value, sizeof(value)) == sizeof(value)) {
+  }
+#endif
+  runPostCallbacks();
+}
+
 void DispatcherImpl::runPostCallbacks() {
-  while (true) {
-    // It is important that this declaration is inside the body of the loop so that the callback is
-    // destructed while post_lock_ is not held. If callback is declared outside the loop and reused
-    // for each iteration, the previous iteration's callback is destructed when callback is
-    // re-assigned, which happens while holding the lock. This can lead to a deadlock (via
-    // recursive mutex acquisition) if destroying the callback runs a destructor, which through some
-    // callstack calls post() on this dispatcher.
-    std::function<void()> callback;
-    {
-      Thread::LockGuard lock(post_lock_);
-      if (post_callbacks_.empty()) {
-        return;
-      }
-      callback = post_callbacks_.front();
-      post_callbacks_.pop_front();
-    }
-    callback();
+  // Clear the pending flag before draining. A post() that races with the drain has then either
+  // queued its callback before the flag was cleared, in which case the drain runs it, or it sees
+  // the cleared flag and signals another wakeup. This also covers a push() that is still in
+  // progress, which makes pop() stop early.
+  post_wakeup_pending_.exchange(false);
+
+  // Run every callback queued so far in one pass, including those posted by the callbacks
+  // themselves. Each callback is destroyed before the next one runs.
+  while (MpscQueue::Node* node = post_queue_.pop()) {
+    std::unique_ptr<PostCallback> callback(static_cast<PostCallback*>(node));
+    callback->callback_();
   }
 }
 
@@ -1,8 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
-#include <list>
 #include <vector>
 
 #include "envoy/event/deferred_deletable.h"
@@ -10,6 +10,7 @@
 #include "envoy/network/connection_handler.h"
 
 #include "common/common/logger.h"
+#include "common/common/mpsc_queue.h"
 #include "common/common/thread.h"
 #include "common/event/libevent.h"
 
@@ -57,6 +58,17 @@ public:
   Buffer::WatermarkFactory& getWatermarkFactory() override { return *buffer_factory_; }
 
 private:
+  /**
+   * A callback queued by post().
+   */
+  struct PostCallback : public MpscQueue::Node {
+    PostCallback(std::function<void()>&& callback) : callback_(std::move(callback)) {}
+
+    std::function<void()> callback_;
+  };
+
+  void initializePostWakeup();
+  void onPostWakeup();
   void runPostCallbacks();
 
   // Validate that an operation is thread safe, i.e. it's invoked on the same thread that the
@@ -70,12 +82,17 @@ private:
   Buffer::WatermarkFactoryPtr buffer_factory_;
   Libevent::BasePtr base_;
   TimerPtr deferred_delete_timer_;
-  TimerPtr post_timer_;
   std::vector<DeferredDeletablePtr> to_delete_1_;
   std::vector<DeferredDeletablePtr> to_delete_2_;
   std::vector<DeferredDeletablePtr>* current_to_delete_;
-  Thread::MutexBasicLockable post_lock_;
-  std::list<std::function<void()>> post_callbacks_ GUARDED_BY(post_lock_);
+  MpscQueue post_queue_;
+  // Set by the post() that signals post_write_fd_, and cleared by the dispatcher thread before it
+  // drains post_queue_, so that a burst of posts wakes the dispatcher once.
+  std::atomic<bool> post_wakeup_pending_{};
+  // An eventfd on Linux, for which both are the same fd, and a pipe elsewhere.
+  int post_read_fd_{-1};
+  int post_write_fd_{-1};
+  FileEventPtr post_event_;
   bool deferred_deleting_{};
 };
 
@@ -1,8 +1,11 @@
 #include "common/filesystem/filesystem_impl.h"
 
 #include <dirent.h>
+#include <limits.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <fstream>
@@ -93,12 +96,93 @@ bool illegalPath(const std::string& path) {
   }
 }
 
+FlushService::FlushService(uint32_t num_threads) {
+  ASSERT(num_threads > 0);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(new FlushThread());
+  }
+}
+
+FlushService::FlushThread& FlushService::assignThread() {
+  return *threads_[next_thread_++ % threads_.size()];
+}
+
+FlushService::FlushThread::~FlushThread() {
+  {
+    Thread::LockGuard lock(lock_);
+    ASSERT(pending_files_.empty());
+    exit_ = true;
+    pending_event_.notifyOne();
+  }
+
+  if (thread_ != nullptr) {
+    thread_->join();
+  }
+}
+
+void FlushService::FlushThread::requestFlush(FileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  if (thread_ == nullptr) {
+    thread_.reset(new Thread::Thread([this]() -> void { threadRoutine(); }));
+  }
+
+  if (std::find(pending_files_.begin(), pending_files_.end(), &file) == pending_files_.end()) {
+    pending_files_.push_back(&file);
+    pending_event_.notifyOne();
+  }
+}
+
+void FlushService::FlushThread::cancelFlush(FileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  pending_files_.remove(&file);
+  while (flushing_file_ == &file) {
+    flushed_event_.wait(lock_);
+  }
+}
+
+void FlushService::FlushThread::threadRoutine() {
+  while (true) {
+    FileImpl* file;
+
+    {
+      Thread::LockGuard lock(lock_);
+      while (pending_files_.empty() && !exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        pending_event_.wait(lock_);
+      }
+
+      if (exit_) {
+        return;
+      }
+
+      file = pending_files_.front();
+      pending_files_.pop_front();
+      flushing_file_ = file;
+    }
+
+    // Files do their own locking. A request for the same file made from here on queues it again.
+    file->flushPending();
+
+    {
+      Thread::LockGuard lock(lock_);
+      flushing_file_ = nullptr;
+      flushed_event_.notifyAll();
+    }
+  }
+}
+
+const uint64_t FileImpl::WRITER_RING_INITIAL_SIZE;
+const uint64_t FileImpl::WRITER_RING_MAX_SIZE;
+
 FileImpl::FileImpl(const std::string& path, Event::Dispatcher& dispatcher,
                    Thread::BasicLockable& lock, Stats::Store& stats_store,
-                   std::chrono::milliseconds flush_interval_msec)
-    : path_(path), file_lock_(lock), flush_timer_(dispatcher.createTimer([this]() -> void {
+                   std::chrono::milliseconds flush_interval_msec,
+                   FlushServiceSharedPtr flush_service)
+    : path_(path), file_lock_(lock), flush_service_(flush_service),
+      flush_thread_(flush_service_->assignThread()),
+      flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        flush_thread_.requestFlush(*this);
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
       os_sys_calls_(Api::OsSysCallsSingleton::get()), flush_interval_msec_(flush_interval_msec),
@@ -119,30 +203,179 @@ void FileImpl::open() {
 void FileImpl::reopen() { reopen_file_ = true; }
 
 FileImpl::~FileImpl() {
-  {
-    Thread::LockGuard lock(write_lock_);
-    flush_thread_exit_ = true;
-    flush_event_.notifyOne();
+  flush_thread_.cancelFlush(*this);
+
+  // Flush any remaining data. If file was not opened for some reason, skip flushing part.
+  if (fd_ != -1) {
+    takeFlushBuffer();
+    doWrite();
+
+    os_sys_calls_.close(fd_);
   }
+}
 
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
+namespace {
+
+/**
+ * @return uint32_t a non-zero id that is unique to the calling thread. This is cheaper than
+ *         Thread::Thread::currentThreadId(), which is a system call, and ids are never reused.
+ */
+uint32_t writerId() {
+  static std::atomic<uint32_t> next_writer_id{1};
+  static thread_local const uint32_t writer_id = next_writer_id++;
+  return writer_id;
+}
+
+} // namespace
+
+FileImpl::WriterRing* FileImpl::writerRing() {
+  const uint32_t writer_id = writerId();
+  for (WriterRing& writer_ring : writer_rings_) {
+    uint32_t owner = writer_ring.owner_.load(std::memory_order_acquire);
+    if (owner == 0 && writer_ring.owner_.compare_exchange_strong(owner, writer_id)) {
+      writer_ring.ring_ = std::make_unique<Buffer::RingBuffer>(WRITER_RING_INITIAL_SIZE);
+      writer_ring.ready_.store(true, std::memory_order_release);
+      return &writer_ring;
+    }
+    if (owner == writer_id) {
+      return &writer_ring;
+    }
+  }
+  return nullptr;
+}
+
+bool FileImpl::growRing(WriterRing& writer_ring, absl::string_view data) {
+  Buffer::RingBuffer& ring = *writer_ring.ring_;
+  const uint64_t size = ring.length() + data.size();
+  if (size > WRITER_RING_MAX_SIZE || !flush_lock_.tryLock()) {
+    return false;
   }
 
-  // Flush any remaining data. If file was not opened for some reason, skip flushing part.
-  if (fd_ != -1) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+  // The flush side only reads the ring under flush_lock_, so it can be replaced here. The new ring
+  // keeps the offsets of the old one, which marks and ring_ends_ refer to.
+  std::unique_lock<Thread::BasicLockable> flush_lock(flush_lock_, std::adopt_lock);
+  uint64_t capacity = ring.capacity() * 2;
+  while (capacity < size) {
+    capacity *= 2;
+  }
+  Buffer::RingBufferPtr new_ring =
+      std::make_unique<Buffer::RingBuffer>(capacity, ring.readOffset());
+  Buffer::RawSlice slices[2];
+  const uint64_t num_slices = ring.getReadableSlices(slices);
+  for (uint64_t i = 0; i < num_slices; i++) {
+    new_ring->write({static_cast<const char*>(slices[i].mem_), slices[i].len_});
+  }
+  new_ring->write(data);
+  writer_ring.ring_ = std::move(new_ring);
+  return true;
+}
+
+void FileImpl::takeFlushBuffer() {
+  // Marks are added under write_lock_ after the ring data they refer to, so every mark is within
+  // the ring data recorded here.
+  for (size_t i = 0; i < writer_rings_.size(); i++) {
+    WriterRing& writer_ring = writer_rings_[i];
+    if (writer_ring.owner_.load(std::memory_order_acquire) == 0) {
+      break;
     }
+    if (writer_ring.ready_.load(std::memory_order_acquire)) {
+      ring_ends_[i] = writer_ring.ring_->writeOffset();
+    }
+  }
 
-    os_sys_calls_.close(fd_);
+  const uint64_t buffer_length = about_to_write_buffer_.length();
+  for (FallbackMark mark : fallback_marks_) {
+    mark.buffer_offset_ += buffer_length;
+    about_to_write_marks_.push_back(mark);
   }
+  fallback_marks_.clear();
+  about_to_write_buffer_.move(flush_buffer_);
+  ASSERT(flush_buffer_.length() == 0);
 }
 
-void FileImpl::doWrite(Buffer::Instance& buffer) {
-  uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
-  Buffer::RawSlice slices[num_slices];
-  buffer.getRawSlices(slices, num_slices);
+void FileImpl::forEachTakenSlice(const std::function<void(const Buffer::RawSlice&)>& cb) {
+  std::array<uint64_t, MAX_WRITER_RINGS> ring_offsets{};
+  for (size_t i = 0; i < writer_rings_.size(); i++) {
+    if (ring_ends_[i] > 0) {
+      ring_offsets[i] = writer_rings_[i].ring_->readOffset();
+    }
+  }
+  auto add_ring = [this, &cb, &ring_offsets](size_t index, uint64_t end) -> void {
+    Buffer::RawSlice slices[2];
+    const uint64_t num_slices =
+        writer_rings_[index].ring_->getSlices(ring_offsets[index], end, slices);
+    for (uint64_t i = 0; i < num_slices; i++) {
+      cb(slices[i]);
+    }
+    ring_offsets[index] = end;
+  };
+
+  const uint64_t num_buffer_slices = about_to_write_buffer_.getRawSlices(nullptr, 0);
+  buffer_slices_.resize(num_buffer_slices);
+  about_to_write_buffer_.getRawSlices(buffer_slices_.data(), num_buffer_slices);
+  size_t slice_index = 0;
+  uint64_t slice_offset = 0;
+  uint64_t buffer_offset = 0;
+  auto add_buffer = [this, &cb, &slice_index, &slice_offset, &buffer_offset](uint64_t end) -> void {
+    while (buffer_offset < end) {
+      const Buffer::RawSlice& slice = buffer_slices_[slice_index];
+      const uint64_t size = std::min<uint64_t>(slice.len_ - slice_offset, end - buffer_offset);
+      if (size > 0) {
+        cb({static_cast<char*>(slice.mem_) + slice_offset, size});
+      }
+      buffer_offset += size;
+      slice_offset += size;
+      if (slice_offset == slice.len_) {
+        slice_index++;
+        slice_offset = 0;
+      }
+    }
+  };
+
+  // Ring data without a mark has no fallback writes of its thread after it, so it can go last.
+  for (const FallbackMark& mark : about_to_write_marks_) {
+    add_buffer(mark.buffer_offset_);
+    add_ring(mark.ring_index_, mark.ring_offset_);
+  }
+  add_buffer(about_to_write_buffer_.length());
+  for (size_t i = 0; i < writer_rings_.size(); i++) {
+    if (ring_ends_[i] > 0) {
+      add_ring(i, ring_ends_[i]);
+    }
+  }
+}
+
+void FileImpl::drainTaken() {
+  for (size_t i = 0; i < writer_rings_.size(); i++) {
+    if (ring_ends_[i] > 0) {
+      Buffer::RingBuffer& ring = *writer_rings_[i].ring_;
+      ring.drain(ring_ends_[i] - ring.readOffset());
+    }
+  }
+  about_to_write_buffer_.drain(about_to_write_buffer_.length());
+  about_to_write_marks_.clear();
+}
+
+void FileImpl::moveRingsToBuffer() {
+  Buffer::OwnedImpl buffer;
+  forEachTakenSlice(
+      [&buffer](const Buffer::RawSlice& slice) -> void { buffer.add(slice.mem_, slice.len_); });
+  drainTaken();
+  about_to_write_buffer_.move(buffer);
+}
+
+void FileImpl::doWrite() {
+  write_slices_.clear();
+  forEachTakenSlice(
+      [this](const Buffer::RawSlice& slice) -> void { write_slices_.push_back(slice); });
+  if (!write_slices_.empty()) {
+    writeSlices(write_slices_.data(), write_slices_.size());
+  }
+  drainTaken();
+}
+
+void FileImpl::writeSlices(const Buffer::RawSlice* slices, uint64_t num_slices) {
+  uint64_t length = 0;
 
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different FileImpl pointing to the same underlying file. This can happen either via hot
@@ -154,56 +387,56 @@ void FileImpl::doWrite(Buffer::Instance& buffer) {
   //            process lock or had multiple locks.
   {
     Thread::LockGuard lock(file_lock_);
-    for (Buffer::RawSlice& slice : slices) {
-      ssize_t rc = os_sys_calls_.write(fd_, slice.mem_, slice.len_);
-      ASSERT(rc == static_cast<ssize_t>(slice.len_));
+    while (num_slices > 0) {
+      const uint64_t num_iovecs = std::min<uint64_t>(num_slices, IOV_MAX);
+      iovec iov[num_iovecs];
+      uint64_t iov_length = 0;
+      for (uint64_t i = 0; i < num_iovecs; i++) {
+        iov[i].iov_base = slices[i].mem_;
+        iov[i].iov_len = slices[i].len_;
+        iov_length += slices[i].len_;
+      }
+
+      ssize_t rc = os_sys_calls_.writev(fd_, iov, num_iovecs);
+      ASSERT(rc == static_cast<ssize_t>(iov_length));
       stats_.write_completed_.inc();
+      length += iov_length;
+      slices += num_iovecs;
+      num_slices -= num_iovecs;
     }
   }
 
-  stats_.write_total_buffered_.sub(buffer.length());
-  buffer.drain(buffer.length());
+  stats_.write_total_buffered_.sub(length);
 }
 
-void FileImpl::flushThreadFunc() {
-
-  while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
-
-    {
-      Thread::LockGuard write_lock(write_lock_);
+void FileImpl::flushPending() {
+  std::unique_lock<Thread::BasicLockable> flush_lock;
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_) {
-        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
-      }
+  {
+    Thread::LockGuard write_lock(write_lock_);
+    flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
+    takeFlushBuffer();
+  }
 
-      if (flush_thread_exit_) {
-        return;
+  // if we failed to open file before (-1 == fd_), then simply ignore
+  if (fd_ != -1) {
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        os_sys_calls_.close(fd_);
+        open();
       }
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      ASSERT(flush_buffer_.length() > 0);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
+      doWrite();
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
     }
+  }
 
-    // if we failed to open file before (-1 == fd_), then simply ignore
-    if (fd_ != -1) {
-      try {
-        if (reopen_file_) {
-          reopen_file_ = false;
-          os_sys_calls_.close(fd_);
-          open();
-        }
-
-        doWrite(about_to_write_buffer_);
-      } catch (const EnvoyException&) {
-        stats_.reopen_failed_.inc();
-      }
-    }
+  // Without a file the writer rings would never drain, so keep their data with the rest of what
+  // could not be written.
+  if (fd_ == -1) {
+    moveRingsToBuffer();
   }
 }
 
@@ -214,41 +447,65 @@ void FileImpl::flush() {
     Thread::LockGuard write_lock(write_lock_);
 
     // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
+    // possible that flushPending() has already moved data from
     // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
     // but has not yet completed doWrite(). This would allow flush() to
     // return before the pending data has actually been written to disk.
     flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
 
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
+    takeFlushBuffer();
   }
 
-  doWrite(about_to_write_buffer_);
+  doWrite();
 }
 
 void FileImpl::write(absl::string_view data) {
+  stats_.write_buffered_.inc();
+  stats_.write_total_buffered_.add(data.length());
+
+  // Once flushing has started, writes go to the calling thread's ring without locking.
+  WriterRing* writer_ring = writerRing();
+  if (flushing_started_.load(std::memory_order_acquire)) {
+    if (writer_ring == nullptr) {
+      stats_.write_ring_bypassed_.inc();
+    } else if (writer_ring->ring_->write(data) || growRing(*writer_ring, data)) {
+      const uint64_t flush_size = writer_ring->ring_->capacity() / 4;
+      const uint64_t length = writer_ring->ring_->length();
+      if (length > flush_size && length - data.size() <= flush_size) {
+        flush_thread_.requestFlush(*this);
+      }
+      return;
+    } else {
+      stats_.write_ring_overflow_.inc();
+    }
+  }
+
   Thread::LockGuard lock(write_lock_);
 
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  if (!flushing_started_) {
+    startFlushing();
   }
 
-  stats_.write_buffered_.inc();
-  stats_.write_total_buffered_.add(data.length());
+  if (writer_ring != nullptr) {
+    // The thread's ring data written so far goes before this write.
+    const uint64_t ring_offset = writer_ring->ring_->writeOffset();
+    if (ring_offset != writer_ring->marked_offset_) {
+      fallback_marks_.push_back({static_cast<size_t>(writer_ring - writer_rings_.data()),
+                                 ring_offset, flush_buffer_.length()});
+      writer_ring->marked_offset_ = ring_offset;
+    }
+  }
   flush_buffer_.add(data.data(), data.size());
   if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+    flush_thread_.requestFlush(*this);
   }
 }
 
-void FileImpl::createFlushStructures() {
-  flush_thread_.reset(new Thread::Thread([this]() -> void { flushThreadFunc(); }));
+void FileImpl::startFlushing() {
+  // The first write is flushed right away.
+  flush_thread_.requestFlush(*this);
   flush_timer_->enableTimer(flush_interval_msec_);
+  flushing_started_.store(true, std::memory_order_release);
 }
 
 } // namespace Filesystem
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
+#include <list>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/api/os_sys_calls.h"
 #include "envoy/event/dispatcher.h"
@@ -12,6 +17,7 @@
 #include "envoy/stats/stats_macros.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/ring_buffer.h"
 #include "common/common/thread.h"
 
 namespace Envoy {
@@ -21,6 +27,8 @@ namespace Envoy {
   COUNTER(write_completed)                                                                         \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
+  COUNTER(write_ring_overflow)                                                                     \
+  COUNTER(write_ring_bypassed)                                                                     \
   GAUGE  (write_total_buffered)
 // clang-format on
 
@@ -71,17 +79,83 @@ std::string canonicalPath(const std::string& path);
  */
 bool illegalPath(const std::string& path);
 
+class FileImpl;
+
+/**
+ * Threads that write out the data buffered by FileImpl instances. The threads are shared by all
+ * files, so that the number of threads, and of thread wakeups, does not grow with the number of
+ * files. Each file is assigned to one of the threads when it is created.
+ */
+class FlushService {
+public:
+  /**
+   * @param num_threads supplies the number of flush threads. Threads are started when first used.
+   */
+  FlushService(uint32_t num_threads);
+
+  /**
+   * A single flush thread. Files ask it to flush with requestFlush(), and it flushes them one
+   * after the other in request order.
+   */
+  class FlushThread {
+  public:
+    ~FlushThread();
+
+    /**
+     * Flush a file soon. Requests for a file that is already waiting to be flushed are merged.
+     */
+    void requestFlush(FileImpl& file);
+
+    /**
+     * Forget a file's pending request, and wait for a flush of it that is in progress to finish.
+     * Must be called before the file is destroyed.
+     */
+    void cancelFlush(FileImpl& file);
+
+  private:
+    void threadRoutine();
+
+    Thread::MutexBasicLockable lock_;
+    Thread::CondVar pending_event_;
+    Thread::CondVar flushed_event_;
+    std::list<FileImpl*> pending_files_ GUARDED_BY(lock_);
+    FileImpl* flushing_file_ GUARDED_BY(lock_){};
+    bool exit_ GUARDED_BY(lock_){};
+    Thread::ThreadPtr thread_ GUARDED_BY(lock_);
+  };
+
+  /**
+   * @return FlushThread& the thread to flush a new file on. Files are spread round robin.
+   */
+  FlushThread& assignThread();
+
+private:
+  std::vector<std::unique_ptr<FlushThread>> threads_;
+  std::atomic<uint32_t> next_thread_{};
+};
+
+typedef std::shared_ptr<FlushService> FlushServiceSharedPtr;
+
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * Data is therefore buffered in memory and written out by a FlushService thread, either when
+ * enough of it has accumulated or when the flush timer fires. All pending data of a file is
+ * written with a single writev() where possible.
+ *
+ * Each writing thread (in practice each worker) gets its own ring buffer the first time it writes,
+ * so that concurrent writes do not contend on a lock. Rings start small and grow when a write does
+ * not fit, up to WRITER_RING_MAX_SIZE. The flush thread writes the rings out in place. Writes that
+ * do not fit in the writer's ring, and writes from threads beyond MAX_WRITER_RINGS, fall back to
+ * the shared flush_buffer_ under write_lock_ rather than being dropped. Such a write records how
+ * far the thread's ring had been written, and the flush side writes the ring data up to there
+ * first, so the records of a single thread stay in order and the thread can keep using its ring.
  */
 class FileImpl : public File {
 public:
   FileImpl(const std::string& path, Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
-           Stats::Store& stats_store, std::chrono::milliseconds flush_interval_msec);
+           Stats::Store& stats_store, std::chrono::milliseconds flush_interval_msec,
+           FlushServiceSharedPtr flush_service);
   ~FileImpl();
 
   // Filesystem::File
@@ -99,13 +173,57 @@ public:
   void flush() override;
 
 private:
-  void doWrite(Buffer::Instance& buffer);
-  void flushThreadFunc();
+  friend class FlushService::FlushThread;
+
+  // A ring claimed by a writing thread. Slots are claimed in order and never released; a slot is
+  // only read by the flush side once ready_ is set.
+  struct WriterRing {
+    std::atomic<uint32_t> owner_{}; // 0 while unclaimed.
+    std::atomic<bool> ready_{};
+    Buffer::RingBufferPtr ring_; // Only replaced by the owner, under flush_lock_.
+    // Ring offset of the owner's last FallbackMark. Only used by the owner.
+    uint64_t marked_offset_{};
+  };
+
+  // A write that fell back to flush_buffer_ from a thread with a ring. The thread's ring data up
+  // to ring_offset_ goes before it in the file.
+  struct FallbackMark {
+    size_t ring_index_;
+    uint64_t ring_offset_;
+    uint64_t buffer_offset_; // Where the write starts in flush_buffer_ or about_to_write_buffer_.
+  };
+
+  WriterRing* writerRing();
+  // Replace the ring with a larger one holding its data and then the given data. Fails if that
+  // would exceed WRITER_RING_MAX_SIZE or if the flush side is busy. Only called by the owner.
+  bool growRing(WriterRing& writer_ring, absl::string_view data);
+  // Record how far each writer ring has been written and move flush_buffer_, with its marks, to
+  // about_to_write_buffer_. write_lock_ and flush_lock_ must be held.
+  void takeFlushBuffer();
+  // Pass the data taken for writing, rings and about_to_write_buffer_ interleaved in file order, to
+  // the callback one slice at a time. flush_lock_ must be held.
+  void forEachTakenSlice(const std::function<void(const Buffer::RawSlice&)>& cb);
+  // Release the data taken for writing. flush_lock_ must be held.
+  void drainTaken();
+  // Copy the ring data taken for writing into about_to_write_buffer_. flush_lock_ must be held.
+  void moveRingsToBuffer();
+  // Write the data taken for writing. flush_lock_ must be held.
+  void doWrite();
+  void writeSlices(const Buffer::RawSlice* slices, uint64_t num_slices);
+  // Write out everything buffered so far, reopening the file first if asked to. Called by the
+  // flush thread.
+  void flushPending();
   void open();
-  void createFlushStructures();
+  void startFlushing();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  // Bounds on the size of each writer's ring. The flush thread is told to flush once a ring is a
+  // quarter full.
+  static const uint64_t WRITER_RING_INITIAL_SIZE = 1024 * 4;
+  static const uint64_t WRITER_RING_MAX_SIZE = 1024 * 64;
+  // Upper bound on the number of threads with their own ring.
+  static const size_t MAX_WRITER_RINGS = 64;
 
   int fd_;
   std::string path_;
@@ -127,9 +245,9 @@ private:
       write_lock_; // The lock is used when filling the flush buffer. It allows
                    // multiple threads to write to the same file at relatively
                    // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
-  Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
+  FlushServiceSharedPtr flush_service_;
+  FlushService::FlushThread& flush_thread_;
+  std::atomic<bool> flushing_started_{};
   std::atomic<bool> reopen_file_{};
   Buffer::OwnedImpl flush_buffer_
       GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It gets filled and
@@ -143,6 +261,16 @@ private:
                                             // the lock is released so that flush_buffer_ can
                                             // continue to fill. This buffer is then used for the
                                             // final write to disk.
+  std::array<WriterRing, MAX_WRITER_RINGS> writer_rings_; // Filled by their owning threads and
+                                                          // drained under flush_lock_.
+  std::vector<FallbackMark> fallback_marks_ GUARDED_BY(write_lock_); // Marks of flush_buffer_.
+  std::vector<FallbackMark> about_to_write_marks_; // Marks of about_to_write_buffer_, under
+                                                   // flush_lock_.
+  // Offset up to which each writer ring was taken for writing, under flush_lock_.
+  std::array<uint64_t, MAX_WRITER_RINGS> ring_ends_{};
+  std::vector<Buffer::RawSlice> buffer_slices_; // Slices of about_to_write_buffer_, under
+                                                // flush_lock_.
+  std::vector<Buffer::RawSlice> write_slices_;  // Slices of a single write, under flush_lock_.
   Event::TimerPtr flush_timer_;
   Api::OsSysCalls& os_sys_calls_;
   const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
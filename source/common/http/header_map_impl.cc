@@ -1,7 +1,7 @@
 #include "common/http/header_map_impl.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <list>
 #include <string>
 
 #include "common/common/assert.h"
@@ -199,6 +199,58 @@ template <> bool HeaderMapImpl::HeaderList::isPseudoHeader(const LowerCaseString
   return key.get().c_str()[0] == ':';
 }
 
+HeaderMapImpl::HeaderList::HeaderList(HeaderList&& other)
+    : entries_(std::move(other.entries_)), pseudo_headers_end_(other.pseudo_headers_end_),
+      blocks_(std::move(other.blocks_)), slots_used_in_block_(other.slots_used_in_block_),
+      free_slots_(other.free_slots_) {
+  other.entries_.clear();
+  other.pseudo_headers_end_ = 0;
+  other.slots_used_in_block_ = 0;
+  other.free_slots_ = nullptr;
+}
+
+HeaderMapImpl::HeaderList::~HeaderList() {
+  for (HeaderEntryImpl* entry : entries_) {
+    entry->~HeaderEntryImpl();
+  }
+}
+
+void HeaderMapImpl::HeaderList::erase(HeaderEntryImpl& entry) {
+  // Header counts are small, so a scan of the contiguous pointer array is cheaper than keeping a
+  // position index up to date on every insert.
+  auto i = std::find(entries_.begin(), entries_.end(), &entry);
+  ASSERT(i != entries_.end());
+  if (static_cast<size_t>(i - entries_.begin()) < pseudo_headers_end_) {
+    pseudo_headers_end_--;
+  }
+  entries_.erase(i);
+  releaseEntry(&entry);
+}
+
+void* HeaderMapImpl::HeaderList::allocateSlot() {
+  if (free_slots_ != nullptr) {
+    FreeSlot* slot = free_slots_;
+    free_slots_ = slot->next_;
+    return slot;
+  }
+
+  if (blocks_ == nullptr || slots_used_in_block_ == EntryBlock::Size) {
+    std::unique_ptr<EntryBlock> block(new EntryBlock);
+    block->next_ = std::move(blocks_);
+    blocks_ = std::move(block);
+    slots_used_in_block_ = 0;
+  }
+
+  return &blocks_->slots_[slots_used_in_block_++];
+}
+
+void HeaderMapImpl::HeaderList::releaseEntry(HeaderEntryImpl* entry) {
+  entry->~HeaderEntryImpl();
+  FreeSlot* slot = new (entry) FreeSlot();
+  slot->next_ = free_slots_;
+  free_slots_ = slot;
+}
+
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key) : key_(key) {}
 
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value)
@@ -310,7 +362,7 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
   }
 
   for (auto i = headers_.begin(), j = rhs.headers_.begin(); i != headers_.end(); ++i, ++j) {
-    if (i->key() != j->key().c_str() || i->value() != j->value().c_str()) {
+    if ((*i)->key() != (*j)->key().c_str() || (*i)->value() != (*j)->value().c_str()) {
       return false;
     }
   }
@@ -326,8 +378,7 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
     ASSERT(*ref_lookup_response.entry_ == nullptr); // This function doesn't handle append.
     maybeCreateInline(ref_lookup_response.entry_, *ref_lookup_response.key_, std::move(value));
   } else {
-    std::list<HeaderEntryImpl>::iterator i = headers_.insert(std::move(key), std::move(value));
-    i->entry_ = i;
+    headers_.insert(std::move(key), std::move(value));
   }
 }
 
@@ -416,18 +467,18 @@ void HeaderMapImpl::setReferenceKey(const LowerCaseString& key, const std::strin
 
 uint64_t HeaderMapImpl::byteSize() const {
   uint64_t byte_size = 0;
-  for (const HeaderEntryImpl& header : headers_) {
-    byte_size += header.key().size();
-    byte_size += header.value().size();
+  for (const HeaderEntryImpl* header : headers_) {
+    byte_size += header->key().size();
+    byte_size += header->value().size();
   }
 
   return byte_size;
 }
 
 const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
+  for (const HeaderEntryImpl* header : headers_) {
+    if (header->key() == key.get().c_str()) {
+      return header;
     }
   }
 
@@ -435,9 +486,9 @@ const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
 }
 
 HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) {
-  for (HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
+  for (HeaderEntryImpl* header : headers_) {
+    if (header->key() == key.get().c_str()) {
+      return header;
     }
   }
 
@@ -445,8 +496,8 @@ HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) {
 }
 
 void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (cb(header, context) == HeaderMap::Iterate::Break) {
+  for (const HeaderEntryImpl* header : headers_) {
+    if (cb(*header, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
@@ -454,7 +505,7 @@ void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
 
 void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
   for (auto it = headers_.rbegin(); it != headers_.rend(); it++) {
-    if (cb(*it, context) == HeaderMap::Iterate::Break) {
+    if (cb(**it, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
@@ -489,13 +540,8 @@ void HeaderMapImpl::remove(const LowerCaseString& key) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
   } else {
-    for (auto i = headers_.begin(); i != headers_.end();) {
-      if (i->key() == key.get().c_str()) {
-        i = headers_.erase(i);
-      } else {
-        ++i;
-      }
-    }
+    headers_.remove_if(
+        [&key](const HeaderEntryImpl& entry) { return entry.key() == key.get().c_str(); });
   }
 }
 
@@ -524,9 +570,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key);
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.insert(key);
   return **entry;
 }
 
@@ -538,9 +582,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key, std::move(value));
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.insert(key, std::move(value));
   return **entry;
 }
 
@@ -560,7 +602,7 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
 
   HeaderEntryImpl* entry = *ptr_to_entry;
   *ptr_to_entry = nullptr;
-  headers_.erase(entry->entry_);
+  headers_.erase(*entry);
 }
 
 } // namespace Http
@@ -2,9 +2,10 @@
 
 #include <array>
 #include <cstdint>
-#include <list>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "envoy/http/header_map.h"
 
@@ -96,7 +97,6 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
   };
 
   struct StaticLookupResponse {
@@ -130,55 +130,95 @@ protected:
   /**
    * List of HeaderEntryImpl that keeps the pseudo headers (key starting with ':') in the front
    * of the list (as required by nghttp2) and otherwise maintains insertion order.
+   *
+   * Entries are constructed in fixed-size blocks of slots that never move, so the address of a
+   * HeaderEntryImpl (and therefore the O(1) inline header pointers) is stable until the entry is
+   * removed. Ordering is kept in a contiguous vector of entry pointers. A typical request costs a
+   * handful of allocations instead of one per header, and iteration walks a flat array.
    */
-  class HeaderList {
+  class HeaderList : NonCopyable {
   public:
-    HeaderList() : pseudo_headers_end_(headers_.end()) {}
+    typedef std::vector<HeaderEntryImpl*>::const_iterator const_iterator;
+    typedef std::vector<HeaderEntryImpl*>::const_reverse_iterator const_reverse_iterator;
+
+    HeaderList() {}
+    // Entries stay in their blocks, so pointers to them, including the inline headers of the
+    // owning HeaderMapImpl, remain valid in the moved-to list.
+    HeaderList(HeaderList&& other);
+    ~HeaderList();
 
     template <class Key> bool isPseudoHeader(const Key& key) { return key.c_str()[0] == ':'; }
 
-    template <class Key, class... Value>
-    std::list<HeaderEntryImpl>::iterator insert(Key&& key, Value&&... value) {
+    template <class Key, class... Value> HeaderEntryImpl& insert(Key&& key, Value&&... value) {
       const bool is_pseudo_header = isPseudoHeader(key);
-      std::list<HeaderEntryImpl>::iterator i =
-          headers_.emplace(is_pseudo_header ? pseudo_headers_end_ : headers_.end(),
-                           std::forward<Key>(key), std::forward<Value>(value)...);
-      if (!is_pseudo_header && pseudo_headers_end_ == headers_.end()) {
-        pseudo_headers_end_ = i;
+      HeaderEntryImpl* entry =
+          new (allocateSlot()) HeaderEntryImpl(std::forward<Key>(key), std::forward<Value>(value)...);
+      if (entries_.empty()) {
+        entries_.reserve(EntryBlock::Size);
       }
-      return i;
-    }
-
-    std::list<HeaderEntryImpl>::iterator erase(std::list<HeaderEntryImpl>::iterator i) {
-      if (pseudo_headers_end_ == i) {
+      if (is_pseudo_header) {
+        entries_.insert(entries_.begin() + pseudo_headers_end_, entry);
         pseudo_headers_end_++;
+      } else {
+        entries_.push_back(entry);
       }
-      return headers_.erase(i);
+      return *entry;
     }
 
+    void erase(HeaderEntryImpl& entry);
+
     template <class UnaryPredicate> void remove_if(UnaryPredicate p) {
-      headers_.remove_if([&](const HeaderEntryImpl& entry) {
-        const bool to_remove = p(entry);
-        if (to_remove) {
-          if (pseudo_headers_end_ == entry.entry_) {
-            pseudo_headers_end_++;
+      size_t kept = 0;
+      size_t pseudo_headers_end = pseudo_headers_end_;
+      for (size_t i = 0; i < entries_.size(); i++) {
+        HeaderEntryImpl* entry = entries_[i];
+        if (p(*entry)) {
+          if (i < pseudo_headers_end_) {
+            pseudo_headers_end--;
           }
+          releaseEntry(entry);
+        } else {
+          entries_[kept++] = entry;
         }
-        return to_remove;
-      });
+      }
+      entries_.resize(kept);
+      pseudo_headers_end_ = pseudo_headers_end;
     }
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
-    size_t size() const { return headers_.size(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    const_reverse_iterator rbegin() const { return entries_.rbegin(); }
+    const_reverse_iterator rend() const { return entries_.rend(); }
+    size_t size() const { return entries_.size(); }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
-    std::list<HeaderEntryImpl>::iterator pseudo_headers_end_;
+    /**
+     * Uninitialized storage for a fixed number of entries. Blocks are chained together and only
+     * freed when the list is destroyed.
+     */
+    struct EntryBlock {
+      static constexpr size_t Size = 8;
+
+      typename std::aligned_storage<sizeof(HeaderEntryImpl), alignof(HeaderEntryImpl)>::type
+          slots_[Size];
+      std::unique_ptr<EntryBlock> next_;
+    };
+
+    /**
+     * A slot whose entry has been removed. The storage is reused as a link in the free list.
+     */
+    struct FreeSlot {
+      FreeSlot* next_;
+    };
+
+    void* allocateSlot();
+    void releaseEntry(HeaderEntryImpl* entry);
+
+    std::vector<HeaderEntryImpl*> entries_;
+    size_t pseudo_headers_end_{0};
+    std::unique_ptr<EntryBlock> blocks_;
+    size_t slots_used_in_block_{0};
+    FreeSlot* free_slots_{nullptr};
   };
 
   void insertByKey(HeaderString&& key, HeaderString&& value);
@@ -17,6 +17,7 @@
 #include "common/http/codec_helper.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http1/parser.h"
 
 namespace Envoy {
 namespace Http {
@@ -153,18 +154,46 @@ public:
   virtual bool supports_http_10() { return false; }
 
 protected:
-  ConnectionImpl(Network::Connection& connection, http_parser_type type);
+  ConnectionImpl(Network::Connection& connection, http_parser_type type,
+                 Http1Settings::ParserEngine parser_engine);
 
   bool resetStreamCalled() { return reset_stream_called_; }
 
   Network::Connection& connection_;
-  http_parser parser_;
+  ParserPtr parser_;
   HeaderMapPtr deferred_end_stream_headers_;
   Http::Code error_code_{Http::Code::BadRequest};
 
 private:
   enum class HeaderParsingState { Field, Value, Done };
 
+  /**
+   * Forwards parser callbacks to the connection.
+   */
+  class ParserCallbacksImpl : public ParserCallbacks {
+  public:
+    ParserCallbacksImpl(ConnectionImpl& parent) : parent_(parent) {}
+
+    // Http1::ParserCallbacks
+    void onMessageBegin() override { parent_.onMessageBeginBase(); }
+    void onUrl(const char* data, size_t length) override { parent_.onUrl(data, length); }
+    void onHeaderField(const char* data, size_t length) override {
+      parent_.onHeaderField(data, length);
+    }
+    void onHeaderValue(const char* data, size_t length) override {
+      parent_.onHeaderValue(data, length);
+    }
+    void onHeader(absl::string_view key, absl::string_view value) override {
+      parent_.onHeader(key, value);
+    }
+    int onHeadersComplete() override { return parent_.onHeadersCompleteBase(); }
+    void onBody(const char* data, size_t length) override { parent_.onBody(data, length); }
+    void onMessageComplete() override { parent_.onMessageComplete(); }
+
+  private:
+    ConnectionImpl& parent_;
+  };
+
   /**
    * Called in order to complete an in progress header decode.
    */
@@ -205,6 +234,13 @@ private:
    */
   void onHeaderValue(const char* data, size_t length);
 
+  /**
+   * Called when a complete header is received.
+   * @param key supplies the header name.
+   * @param value supplies the header value.
+   */
+  void onHeader(absl::string_view key, absl::string_view value);
+
   /**
    * Called when headers are complete. A base routine happens first then a virtual disaptch is
    * invoked.
@@ -247,9 +283,9 @@ private:
    */
   virtual void onBelowLowWatermark() PURE;
 
-  static http_parser_settings settings_;
   static const ToLowerTable& toLowerTable();
 
+  ParserCallbacksImpl parser_callbacks_{*this};
   HeaderMapImplPtr current_header_map_;
   HeaderParsingState header_parsing_state_{HeaderParsingState::Field};
   HeaderString current_header_field_;
@@ -0,0 +1,58 @@
+#include "common/http/http1/legacy_parser_impl.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+namespace {
+
+ParserCallbacks& callbacks(http_parser* parser) {
+  return *static_cast<ParserCallbacks*>(parser->data);
+}
+
+} // namespace
+
+http_parser_settings LegacyParserImpl::settings_{
+    [](http_parser* parser) -> int {
+      callbacks(parser).onMessageBegin();
+      return 0;
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      callbacks(parser).onUrl(at, length);
+      return 0;
+    },
+    nullptr, // on_status
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      callbacks(parser).onHeaderField(at, length);
+      return 0;
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      callbacks(parser).onHeaderValue(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int { return callbacks(parser).onHeadersComplete(); },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      callbacks(parser).onBody(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int {
+      callbacks(parser).onMessageComplete();
+      return 0;
+    },
+    nullptr, // on_chunk_header
+    nullptr  // on_chunk_complete
+};
+
+LegacyParserImpl::LegacyParserImpl(http_parser_type type, ParserCallbacks& callbacks)
+    : callbacks_(callbacks) {
+  http_parser_init(&parser_, type);
+  parser_.data = &callbacks_;
+}
+
+size_t LegacyParserImpl::execute(const char* data, size_t length) {
+  return http_parser_execute(&parser_, &settings_, data, length);
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
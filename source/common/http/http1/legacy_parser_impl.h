@@ -0,0 +1,50 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include <cstdint>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Parser implementation backed by http_parser.
+ */
+class LegacyParserImpl : public Parser {
+public:
+  LegacyParserImpl(http_parser_type type, ParserCallbacks& callbacks);
+
+  /**
+   * @return bool whether the connection can be reused after the current message.
+   */
+  bool shouldKeepAlive() const { return http_should_keep_alive(&parser_) != 0; }
+
+  /**
+   * @return bool whether the current message upgraded the connection.
+   */
+  bool upgrade() const { return parser_.upgrade != 0; }
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause(bool paused) override { http_parser_pause(&parser_, paused ? 1 : 0); }
+  http_errno error() const override { return HTTP_PARSER_ERRNO(&parser_); }
+  http_method method() const override { return static_cast<http_method>(parser_.method); }
+  uint16_t statusCode() const override { return parser_.status_code; }
+  uint16_t httpMajor() const override { return parser_.http_major; }
+  uint16_t httpMinor() const override { return parser_.http_minor; }
+  bool chunked() const override { return (parser_.flags & F_CHUNKED) != 0; }
+  uint64_t contentLength() const override { return parser_.content_length; }
+
+private:
+  static http_parser_settings settings_;
+
+  http_parser parser_;
+  ParserCallbacks& callbacks_;
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
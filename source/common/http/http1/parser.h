@@ -0,0 +1,121 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Callbacks invoked by a Parser. Errors are raised by throwing from within a callback.
+ */
+class ParserCallbacks {
+public:
+  virtual ~ParserCallbacks() {}
+
+  /**
+   * Called when a request/response is beginning.
+   */
+  virtual void onMessageBegin() PURE;
+
+  /**
+   * Called when URL data is received. May be called more than once per message.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onUrl(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header field data is received. May be called more than once per field.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onHeaderField(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header value data is received. May be called more than once per value.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onHeaderValue(const char* data, size_t length) PURE;
+
+  /**
+   * Called with a complete header by parsers that see the whole header at once, in place of
+   * onHeaderField() and onHeaderValue().
+   * @param key supplies the header name, as received.
+   * @param value supplies the header value, without leading whitespace.
+   */
+  virtual void onHeader(absl::string_view key, absl::string_view value) PURE;
+
+  /**
+   * Called when headers are complete.
+   * @return 0 if no error, 1 if there should be no body.
+   */
+  virtual int onHeadersComplete() PURE;
+
+  /**
+   * Called when body data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onBody(const char* data, size_t length) PURE;
+
+  /**
+   * Called when the request/response is complete.
+   */
+  virtual void onMessageComplete() PURE;
+};
+
+/**
+ * An HTTP/1 parser. Errors and message metadata use the http_parser definitions, so that all
+ * implementations fail in the same way.
+ */
+class Parser {
+public:
+  virtual ~Parser() {}
+
+  /**
+   * Parse a span of data, invoking callbacks as messages are parsed.
+   * @param data supplies the start address.
+   * @param length supplies the length. A zero length indicates the end of the stream.
+   * @return size_t the number of bytes consumed. Less than length is consumed only if the parser
+   *         is paused, fails, or the connection is upgraded.
+   */
+  virtual size_t execute(const char* data, size_t length) PURE;
+
+  /**
+   * Pause or resume the parser. A paused parser consumes no data. Callbacks may pause the parser
+   * from onHeadersComplete() and onMessageComplete(), in which case execute() returns as soon as
+   * the callback does.
+   */
+  virtual void pause(bool paused) PURE;
+
+  /**
+   * @return http_errno HPE_OK, HPE_PAUSED, or the error that stopped the parser.
+   */
+  virtual http_errno error() const PURE;
+
+  /**
+   * The following describe the current message and are valid from onHeadersComplete().
+   */
+  virtual http_method method() const PURE;
+  virtual uint16_t statusCode() const PURE;
+  virtual uint16_t httpMajor() const PURE;
+  virtual uint16_t httpMinor() const PURE;
+  virtual bool chunked() const PURE;
+  // ULLONG_MAX if there is no content-length header.
+  virtual uint64_t contentLength() const PURE;
+};
+
+typedef std::unique_ptr<Parser> ParserPtr;
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
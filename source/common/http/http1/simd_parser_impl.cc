@@ -0,0 +1,434 @@
+#include "common/http/http1/simd_parser_impl.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+namespace {
+
+struct Method {
+  absl::string_view name_;
+  http_method method_;
+};
+
+// The methods parsed by the fast path, most common first. CONNECT is left to http_parser as it
+// upgrades the connection.
+const Method METHODS[] = {{"GET", HTTP_GET},         {"POST", HTTP_POST},
+                          {"PUT", HTTP_PUT},         {"HEAD", HTTP_HEAD},
+                          {"DELETE", HTTP_DELETE},   {"OPTIONS", HTTP_OPTIONS},
+                          {"PATCH", HTTP_PATCH}};
+const size_t MAX_METHOD_LENGTH = 7;
+
+// "HTTP/1.1\r\n"
+const size_t VERSION_LENGTH = 10;
+
+/**
+ * @return whether a byte is a token character, as allowed by http_parser in header names.
+ */
+bool isToken(char c) {
+  static const std::array<bool, 256> table = []() {
+    std::array<bool, 256> table{};
+    for (uint32_t c = '0'; c <= '9'; c++) {
+      table[c] = true;
+    }
+    for (uint32_t c = 'a'; c <= 'z'; c++) {
+      table[c] = true;
+      table[c - 'a' + 'A'] = true;
+    }
+    for (const char c : absl::string_view("!#$%&'*+-.^_`|~")) {
+      table[static_cast<uint8_t>(c)] = true;
+    }
+    return table;
+  }();
+  return table[static_cast<uint8_t>(c)];
+}
+
+/**
+ * Parse a content-length value. Values that http_parser would reject, or parse with more
+ * leniency, such as those with trailing whitespace, are not parsed.
+ */
+bool parseContentLength(absl::string_view value, uint64_t& length) {
+  // Short enough not to overflow.
+  if (value.empty() || value.size() > 18) {
+    return false;
+  }
+
+  length = 0;
+  for (const char c : value) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    length = length * 10 + (c - '0');
+  }
+  return true;
+}
+
+} // namespace
+
+const char* SimdScanner::findValueEnd(const char* begin, const char* end) {
+  const char* p = begin;
+#if defined(__AVX2__)
+  {
+    const __m256i ctl = _mm256_set1_epi8(0x1f);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    for (; end - p >= 32; p += 32) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      // v <= 0x1f, as an unsigned compare.
+      const __m256i is_ctl = _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctl), ctl);
+      const __m256i stop = _mm256_or_si256(_mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), is_ctl),
+                                           _mm256_cmpeq_epi8(v, del));
+      const uint32_t mask = _mm256_movemask_epi8(stop);
+      if (mask != 0) {
+        return p + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const __m128i ctl = _mm_set1_epi8(0x1f);
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i del = _mm_set1_epi8(0x7f);
+    for (; end - p >= 16; p += 16) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i is_ctl = _mm_cmpeq_epi8(_mm_max_epu8(v, ctl), ctl);
+      const __m128i stop =
+          _mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi8(v, tab), is_ctl), _mm_cmpeq_epi8(v, del));
+      const uint32_t mask = _mm_movemask_epi8(stop);
+      if (mask != 0) {
+        return p + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+  for (; p < end; p++) {
+    const uint8_t c = *p;
+    if ((c < 0x20 && c != '\t') || c == 0x7f) {
+      return p;
+    }
+  }
+  return end;
+}
+
+const char* SimdScanner::findUrlEnd(const char* begin, const char* end) {
+  const char* p = begin;
+#if defined(__AVX2__)
+  {
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    for (; end - p >= 32; p += 32) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      // v <= 0x20 or v >= 0x7f, as unsigned compares.
+      const __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(v, space), space),
+                                           _mm256_cmpeq_epi8(_mm256_min_epu8(v, del), del));
+      const uint32_t mask = _mm256_movemask_epi8(stop);
+      if (mask != 0) {
+        return p + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7f);
+    for (; end - p >= 16; p += 16) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, space), space),
+                                        _mm_cmpeq_epi8(_mm_min_epu8(v, del), del));
+      const uint32_t mask = _mm_movemask_epi8(stop);
+      if (mask != 0) {
+        return p + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+  for (; p < end; p++) {
+    const uint8_t c = *p;
+    if (c <= 0x20 || c >= 0x7f) {
+      return p;
+    }
+  }
+  return end;
+}
+
+SimdParserImpl::SimdParserImpl(ParserCallbacks& callbacks)
+    : callbacks_(callbacks), legacy_(HTTP_REQUEST, *this) {}
+
+size_t SimdParserImpl::execute(const char* data, size_t length) {
+  if (error() != HPE_OK) {
+    return 0;
+  }
+
+  if (length == 0) {
+    switch (state_) {
+    case State::Legacy:
+      return legacy_.execute(data, length);
+    case State::HeadersDone:
+    case State::Body:
+      error_ = HPE_INVALID_EOF_STATE;
+      return 0;
+    default:
+      return 0;
+    }
+  }
+
+  const char* p = data;
+  const char* const end = data + length;
+  while (p < end) {
+    switch (state_) {
+    case State::MessageStart: {
+      // http_parser skips CR and LF between messages, but counts them towards the header size.
+      if (*p == '\r' || *p == '\n') {
+        if (++skipped_ > HTTP_MAX_HEADER_SIZE) {
+          error_ = HPE_HEADER_OVERFLOW;
+          return p - data;
+        }
+        p++;
+        break;
+      }
+
+      const char* head_end = parseHead(p, end);
+      if (head_end == nullptr) {
+        startLegacyMessage();
+        break;
+      }
+
+      legacy_message_ = false;
+      skipped_ = 0;
+      callbacks_.onMessageBegin();
+      callbacks_.onUrl(url_.data(), url_.size());
+      for (const Header& header : headers_) {
+        callbacks_.onHeader(header.key_, header.value_);
+      }
+      skip_body_ = callbacks_.onHeadersComplete() == 1;
+      state_ = State::HeadersDone;
+      // Like http_parser, leave the final LF to be consumed when parsing resumes after a pause.
+      p = head_end;
+      break;
+    }
+
+    case State::HeadersDone:
+      p++;
+      if (skip_body_ || content_length_ == 0 || content_length_ == ULLONG_MAX) {
+        completeMessage();
+      } else {
+        body_remaining_ = content_length_;
+        state_ = State::Body;
+      }
+      break;
+
+    case State::Body: {
+      const uint64_t body_length = std::min<uint64_t>(body_remaining_, end - p);
+      callbacks_.onBody(p, body_length);
+      p += body_length;
+      body_remaining_ -= body_length;
+      if (body_remaining_ == 0) {
+        completeMessage();
+      }
+      break;
+    }
+
+    case State::Legacy:
+      legacy_message_complete_ = false;
+      p += legacy_.execute(p, end - p);
+      if (!legacy_message_complete_) {
+        // legacy_ consumed everything, failed, or was paused mid message.
+        return p - data;
+      }
+
+      // onMessageComplete() paused legacy_ so that the fast path can parse the next message.
+      legacy_.pause(false);
+      state_ = nextMessageState(legacy_.shouldKeepAlive());
+      error_ = legacy_paused_ ? HPE_PAUSED : HPE_OK;
+      if (legacy_.upgrade()) {
+        return p - data;
+      }
+      break;
+
+    case State::Dead:
+      if (++skipped_ > HTTP_MAX_HEADER_SIZE) {
+        error_ = HPE_HEADER_OVERFLOW;
+        return p - data;
+      }
+      if (*p != '\r' && *p != '\n') {
+        error_ = HPE_CLOSED_CONNECTION;
+        return p - data;
+      }
+      p++;
+      break;
+    }
+
+    if (error_ != HPE_OK) {
+      return p - data;
+    }
+  }
+
+  return p - data;
+}
+
+void SimdParserImpl::pause(bool paused) {
+  if (state_ == State::Legacy) {
+    legacy_.pause(paused);
+    return;
+  }
+
+  ASSERT(error_ == HPE_OK || error_ == HPE_PAUSED);
+  error_ = paused ? HPE_PAUSED : HPE_OK;
+}
+
+const char* SimdParserImpl::parseHead(const char* begin, const char* end) {
+  // http_parser fails messages whose request line and headers, along with the CR and LF bytes
+  // preceding them, exceed HTTP_MAX_HEADER_SIZE. Leave those that come close to it to http_parser.
+  if (skipped_ >= HTTP_MAX_HEADER_SIZE) {
+    return nullptr;
+  }
+  end = begin + std::min<size_t>(end - begin, HTTP_MAX_HEADER_SIZE - skipped_ - 1);
+
+  // Request line.
+  const char* p = begin;
+  const char* space =
+      static_cast<const char*>(memchr(p, ' ', std::min<size_t>(end - p, MAX_METHOD_LENGTH + 1)));
+  if (space == nullptr) {
+    return nullptr;
+  }
+  const absl::string_view method_name(p, space - p);
+  const Method* method =
+      std::find_if(std::begin(METHODS), std::end(METHODS),
+                   [&](const Method& method) -> bool { return method.name_ == method_name; });
+  if (method == std::end(METHODS)) {
+    return nullptr;
+  }
+  method_ = method->method_;
+
+  // Only origin form URLs. http_parser accepts every visible ASCII character in a path.
+  p = space + 1;
+  if (p == end || *p != '/') {
+    return nullptr;
+  }
+  const char* url_end = SimdScanner::findUrlEnd(p, end);
+  if (url_end == end || *url_end != ' ') {
+    return nullptr;
+  }
+  url_ = absl::string_view(p, url_end - p);
+
+  p = url_end + 1;
+  if (static_cast<size_t>(end - p) < VERSION_LENGTH || memcmp(p, "HTTP/1.", 7) != 0 ||
+      (p[7] != '0' && p[7] != '1') || p[8] != '\r' || p[9] != '\n') {
+    return nullptr;
+  }
+  http_minor_ = p[7] - '0';
+  p += VERSION_LENGTH;
+
+  // Headers. Each must be on a single line ending in CRLF.
+  headers_.clear();
+  content_length_ = ULLONG_MAX;
+  bool connection_close = false;
+  bool connection_keep_alive = false;
+  while (true) {
+    if (end - p < 2) {
+      return nullptr;
+    }
+    if (p[0] == '\r') {
+      if (p[1] != '\n') {
+        return nullptr;
+      }
+      break;
+    }
+
+    const char* key = p;
+    while (p < end && isToken(*p)) {
+      p++;
+    }
+    if (p == key || p == end || *p != ':') {
+      return nullptr;
+    }
+    const absl::string_view key_view(key, p - key);
+
+    // Like http_parser, strip leading but not trailing whitespace from the value.
+    p++;
+    while (p < end && (*p == ' ' || *p == '\t')) {
+      p++;
+    }
+    const char* value = p;
+    p = SimdScanner::findValueEnd(p, end);
+    if (end - p < 2 || p[0] != '\r' || p[1] != '\n') {
+      return nullptr;
+    }
+    const absl::string_view value_view(value, p - value);
+    p += 2;
+
+    // Headers that change how http_parser frames the message or reuses the connection.
+    if (StringUtil::caseCompare(key_view, "content-length")) {
+      if (content_length_ != ULLONG_MAX || !parseContentLength(value_view, content_length_)) {
+        return nullptr;
+      }
+    } else if (StringUtil::caseCompare(key_view, "connection")) {
+      if (StringUtil::caseCompare(value_view, "close")) {
+        connection_close = true;
+      } else if (StringUtil::caseCompare(value_view, "keep-alive")) {
+        connection_keep_alive = true;
+      } else {
+        return nullptr;
+      }
+    } else if (StringUtil::caseCompare(key_view, "transfer-encoding") ||
+               StringUtil::caseCompare(key_view, "upgrade") ||
+               StringUtil::caseCompare(key_view, "proxy-connection")) {
+      return nullptr;
+    }
+
+    headers_.push_back({key_view, value_view});
+  }
+
+  keep_alive_ = http_minor_ == 1 ? !connection_close : connection_keep_alive;
+  return p + 1;
+}
+
+void SimdParserImpl::startLegacyMessage() {
+  static const std::string* line_feeds = new std::string(256, '\n');
+
+  state_ = State::Legacy;
+  legacy_message_ = true;
+  while (skipped_ > 0) {
+    const uint32_t length = std::min<uint32_t>(skipped_, line_feeds->size());
+    legacy_.execute(line_feeds->data(), length);
+    skipped_ -= length;
+  }
+}
+
+SimdParserImpl::State SimdParserImpl::nextMessageState(bool keep_alive) {
+  // Like http_parser, only refuse further messages in strict mode.
+  return keep_alive || !HTTP_PARSER_STRICT ? State::MessageStart : State::Dead;
+}
+
+void SimdParserImpl::completeMessage() {
+  state_ = nextMessageState(keep_alive_);
+  callbacks_.onMessageComplete();
+}
+
+void SimdParserImpl::onMessageComplete() {
+  callbacks_.onMessageComplete();
+  legacy_paused_ = legacy_.error() == HPE_PAUSED;
+  legacy_message_complete_ = true;
+  legacy_.pause(true);
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
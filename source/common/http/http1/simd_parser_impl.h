@@ -0,0 +1,155 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/parser.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Vectorized byte scans used by SimdParserImpl. Each uses AVX2 when compiled with it, SSE2 on
+ * x86-64, and a scalar loop otherwise.
+ */
+class SimdScanner {
+public:
+  /**
+   * @return the first byte in [begin, end) that is a control character other than HT, or DEL.
+   *         These are the bytes that may not appear in a header value. Returns end if there is
+   *         none.
+   */
+  static const char* findValueEnd(const char* begin, const char* end);
+
+  /**
+   * @return the first byte in [begin, end) that is not a visible ASCII character (0x21 to 0x7E),
+   *         or end if there is none.
+   */
+  static const char* findUrlEnd(const char* begin, const char* end);
+};
+
+/**
+ * Request parser that parses common requests from whole header blocks using vectorized scans,
+ * instead of the byte at a time state machine of http_parser. It handles requests that:
+ * - arrive with the complete request line and headers in a single execute() call.
+ * - use a common method, an origin form URL, and HTTP/1.0 or HTTP/1.1.
+ * - have no body, or a body delimited by a single content-length header.
+ * Any other request, including every malformed one, is replayed into an embedded http_parser
+ * from its first byte, and the two parsers take turns from one message to the next. Because the
+ * fast path only accepts requests that http_parser parses the same way, callbacks and errors are
+ * identical to those of LegacyParserImpl, except that the fast path delivers headers through
+ * onHeader().
+ */
+class SimdParserImpl : public Parser, private ParserCallbacks {
+public:
+  SimdParserImpl(ParserCallbacks& callbacks);
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause(bool paused) override;
+  http_errno error() const override {
+    return state_ == State::Legacy ? legacy_.error() : error_;
+  }
+  http_method method() const override { return legacy_message_ ? legacy_.method() : method_; }
+  uint16_t statusCode() const override { return 0; }
+  uint16_t httpMajor() const override { return legacy_message_ ? legacy_.httpMajor() : 1; }
+  uint16_t httpMinor() const override {
+    return legacy_message_ ? legacy_.httpMinor() : http_minor_;
+  }
+  bool chunked() const override { return legacy_message_ && legacy_.chunked(); }
+  uint64_t contentLength() const override {
+    return legacy_message_ ? legacy_.contentLength() : content_length_;
+  }
+
+private:
+  enum class State {
+    // Between messages.
+    MessageStart,
+    // The current message is being parsed by legacy_.
+    Legacy,
+    // The fast path has raised onHeadersComplete() and will next consume the final LF of the
+    // header block.
+    HeadersDone,
+    // The fast path is reading a content-length delimited body.
+    Body,
+    // A message that does not allow the connection to be reused is complete. Only CR and LF
+    // may follow, as with http_parser in strict mode.
+    Dead
+  };
+
+  struct Header {
+    absl::string_view key_;
+    absl::string_view value_;
+  };
+
+  /**
+   * Parse a request line and headers that start at begin, without raising callbacks.
+   * @return the final LF of the header block if the fast path can parse the message, otherwise
+   *         nullptr.
+   */
+  const char* parseHead(const char* begin, const char* end);
+
+  /**
+   * Hand the message starting at the next byte to legacy_, after replaying the CR and LF bytes
+   * that preceded it.
+   */
+  void startLegacyMessage();
+
+  /**
+   * @return the state following a complete message.
+   */
+  static State nextMessageState(bool keep_alive);
+
+  void completeMessage();
+
+  // Http1::ParserCallbacks, for messages parsed by legacy_.
+  void onMessageBegin() override { callbacks_.onMessageBegin(); }
+  void onUrl(const char* data, size_t length) override { callbacks_.onUrl(data, length); }
+  void onHeaderField(const char* data, size_t length) override {
+    callbacks_.onHeaderField(data, length);
+  }
+  void onHeaderValue(const char* data, size_t length) override {
+    callbacks_.onHeaderValue(data, length);
+  }
+  void onHeader(absl::string_view key, absl::string_view value) override {
+    callbacks_.onHeader(key, value);
+  }
+  int onHeadersComplete() override { return callbacks_.onHeadersComplete(); }
+  void onBody(const char* data, size_t length) override { callbacks_.onBody(data, length); }
+  void onMessageComplete() override;
+
+  ParserCallbacks& callbacks_;
+  LegacyParserImpl legacy_;
+  State state_{State::MessageStart};
+  // The error or pause state while legacy_ is not parsing.
+  http_errno error_{HPE_OK};
+  // Whether the current message is being, or was, parsed by legacy_.
+  bool legacy_message_{};
+  // Set by onMessageComplete() when legacy_ completes a message.
+  bool legacy_message_complete_{};
+  // Whether callbacks paused the parser from the onMessageComplete() of a legacy_ message.
+  bool legacy_paused_{};
+  // CR and LF bytes skipped since the last message, which http_parser counts towards the header
+  // size limit of the next one.
+  uint32_t skipped_{};
+
+  // The message being parsed by the fast path.
+  std::vector<Header> headers_;
+  absl::string_view url_;
+  http_method method_{HTTP_GET};
+  uint16_t http_minor_{1};
+  uint64_t content_length_{ULLONG_MAX};
+  bool keep_alive_{};
+  bool skip_body_{};
+  uint64_t body_remaining_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
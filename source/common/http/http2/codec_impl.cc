@@ -10,6 +10,7 @@
 #include "envoy/network/connection.h"
 
 #include "common/common/assert.h"
+#include "common/common/cleanup.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
@@ -274,22 +275,34 @@ void ConnectionImpl::StreamImpl::resetStreamWorker(StreamResetReason reason) {
 ConnectionImpl::~ConnectionImpl() { nghttp2_session_del(session_); }
 
 void ConnectionImpl::dispatch(Buffer::Instance& data) {
-  ENVOY_CONN_LOG(trace, "dispatching {} bytes", connection_, data.length());
+  const uint64_t length = data.length();
+  ENVOY_CONN_LOG(trace, "dispatching {} bytes", connection_, length);
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   Buffer::RawSlice slices[num_slices];
   data.getRawSlices(slices, num_slices);
-  for (Buffer::RawSlice& slice : slices) {
-    dispatching_ = true;
-    ssize_t rc =
-        nghttp2_session_mem_recv(session_, static_cast<const uint8_t*>(slice.mem_), slice.len_);
-    if (rc != static_cast<ssize_t>(slice.len_)) {
-      throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
-    }
+  {
+    dispatch_buffer_ = &data;
+    dispatch_undrained_ = 0;
+    // The buffer belongs to the caller, so it must not be referenced past this call, including
+    // when a protocol error is thrown part way through.
+    Cleanup clear_dispatch_buffer([this]() { dispatch_buffer_ = nullptr; });
+    for (Buffer::RawSlice& slice : slices) {
+      dispatching_ = true;
+      dispatch_slice_ = slice;
+      dispatch_cursor_ = static_cast<const uint8_t*>(slice.mem_);
+      ssize_t rc =
+          nghttp2_session_mem_recv(session_, static_cast<const uint8_t*>(slice.mem_), slice.len_);
+      if (rc != static_cast<ssize_t>(slice.len_)) {
+        throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
+      }
 
-    dispatching_ = false;
+      dispatch_undrained_ +=
+          static_cast<const uint8_t*>(slice.mem_) + slice.len_ - dispatch_cursor_;
+      dispatching_ = false;
+    }
   }
 
-  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, data.length());
+  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, length);
   data.drain(data.length());
 
   // Decoding incoming frames can generate outbound frames so flush pending.
@@ -304,7 +317,20 @@ int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
   StreamImpl* stream = getStream(stream_id);
   // If this results in buffering too much data, the watermark buffer will call
   // pendingRecvBufferHighWatermark, resulting in ++read_disable_count_
-  stream->pending_recv_data_.add(data, len);
+  const uint8_t* slice_end =
+      static_cast<const uint8_t*>(dispatch_slice_.mem_) + dispatch_slice_.len_;
+  if (dispatch_buffer_ != nullptr && len > 0 && data >= dispatch_cursor_ &&
+      data + len <= slice_end) {
+    // nghttp2 hands out DATA payloads in place, so the payload is still at the front of the
+    // buffer being dispatched once the frame headers and padding before it are drained. Moving it
+    // transfers whole slices to the stream instead of copying them.
+    dispatch_buffer_->drain(dispatch_undrained_ + (data - dispatch_cursor_));
+    stream->pending_recv_data_.move(*dispatch_buffer_, len);
+    dispatch_undrained_ = 0;
+    dispatch_cursor_ = data + len;
+  } else {
+    stream->pending_recv_data_.add(data, len);
+  }
   // Update the window to the peer unless some consumer of this stream's data has hit a flow control
   // limit and disabled reads on this stream
   if (!stream->buffers_overrun()) {
@@ -739,8 +765,8 @@ ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection,
                                            Http::ConnectionCallbacks& callbacks,
                                            Stats::Scope& stats, const Http2Settings& http2_settings)
     : ConnectionImpl(connection, stats, http2_settings), callbacks_(callbacks) {
-  nghttp2_session_client_new2(&session_, http2_callbacks_.callbacks(), base(),
-                              http2_options_.options());
+  nghttp2_session_client_new3(&session_, http2_callbacks_.callbacks(), base(),
+                              http2_options_.options(), allocator_.mem());
   sendSettings(http2_settings, true);
 }
 
@@ -783,8 +809,8 @@ ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
                                            Http::ServerConnectionCallbacks& callbacks,
                                            Stats::Scope& scope, const Http2Settings& http2_settings)
     : ConnectionImpl(connection, scope, http2_settings), callbacks_(callbacks) {
-  nghttp2_session_server_new2(&session_, http2_callbacks_.callbacks(), base(),
-                              http2_options_.options());
+  nghttp2_session_server_new3(&session_, http2_callbacks_.callbacks(), base(),
+                              http2_options_.options(), allocator_.mem());
   sendSettings(http2_settings, false);
 }
 
@@ -18,6 +18,7 @@
 #include "common/common/logger.h"
 #include "common/http/codec_helper.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http2/session_allocator.h"
 
 #include "absl/types/optional.h"
 #include "nghttp2/nghttp2.h"
@@ -241,6 +242,8 @@ protected:
   static Http2Options http2_options_;
 
   std::list<StreamImplPtr> active_streams_;
+  // Must outlive session_, which is deleted in ~ConnectionImpl().
+  SessionAllocator allocator_;
   nghttp2_session* session_{};
   CodecStats stats_;
   Network::Connection& connection_;
@@ -257,6 +260,13 @@ private:
   ssize_t onSend(const uint8_t* data, size_t length);
   int onStreamClose(int32_t stream_id, uint32_t error_code);
 
+  // The buffer being dispatched, so that DATA payloads can be moved out of it. The buffer
+  // currently starts dispatch_undrained_ bytes before dispatch_cursor_, which points into
+  // dispatch_slice_, the slice being parsed.
+  Buffer::Instance* dispatch_buffer_{};
+  Buffer::RawSlice dispatch_slice_{};
+  const uint8_t* dispatch_cursor_{};
+  uint64_t dispatch_undrained_{};
   bool dispatching_ : 1;
   bool raised_goaway_ : 1;
   bool pending_deferred_reset_ : 1;
@@ -0,0 +1,124 @@
+#include "common/http/http2/session_allocator.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+namespace {
+
+SessionAllocator& allocator(void* user_data) { return *static_cast<SessionAllocator*>(user_data); }
+
+} // namespace
+
+constexpr size_t SessionAllocator::MaxCachedBlockSize;
+constexpr uint64_t SessionAllocator::MaxCachedBytes;
+constexpr size_t SessionAllocator::MinBlockSize;
+
+SessionAllocator::SessionAllocator() {
+  static_assert(MinBlockSize << (NumSizeClasses - 1) == MaxCachedBlockSize,
+                "size classes must end at MaxCachedBlockSize");
+  mem_.mem_user_data = this;
+  mem_.malloc = [](size_t size, void* user_data) -> void* {
+    return allocator(user_data).allocate(size);
+  };
+  mem_.free = [](void* block, void* user_data) -> void { allocator(user_data).release(block); };
+  mem_.calloc = [](size_t count, size_t size, void* user_data) -> void* {
+    return allocator(user_data).allocateZeroed(count, size);
+  };
+  mem_.realloc = [](void* block, size_t size, void* user_data) -> void* {
+    return allocator(user_data).reallocate(block, size);
+  };
+}
+
+SessionAllocator::~SessionAllocator() {
+  for (FreeBlock* free_block : free_lists_) {
+    while (free_block != nullptr) {
+      FreeBlock* next = free_block->next_;
+      ::free(header(free_block));
+      free_block = next;
+    }
+  }
+}
+
+size_t SessionAllocator::sizeClass(size_t size) {
+  size_t size_class = 0;
+  while ((MinBlockSize << size_class) < size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+void* SessionAllocator::allocate(size_t size) {
+  size_t capacity = size;
+  if (size <= MaxCachedBlockSize) {
+    const size_t size_class = sizeClass(size);
+    FreeBlock* free_block = free_lists_[size_class];
+    if (free_block != nullptr) {
+      free_lists_[size_class] = free_block->next_;
+      cached_bytes_ -= MinBlockSize << size_class;
+      return free_block;
+    }
+    capacity = MinBlockSize << size_class;
+  }
+
+  void* memory = ::malloc(sizeof(BlockHeader) + capacity);
+  if (memory == nullptr) {
+    return nullptr;
+  }
+  BlockHeader* block_header = static_cast<BlockHeader*>(memory);
+  block_header->capacity_ = capacity;
+  return block_header + 1;
+}
+
+void* SessionAllocator::allocateZeroed(size_t count, size_t size) {
+  if (size != 0 && count > SIZE_MAX / size) {
+    return nullptr;
+  }
+  void* block = allocate(count * size);
+  if (block != nullptr) {
+    memset(block, 0, count * size);
+  }
+  return block;
+}
+
+void* SessionAllocator::reallocate(void* block, size_t size) {
+  if (block == nullptr) {
+    return allocate(size);
+  }
+  const size_t capacity = header(block)->capacity_;
+  if (size <= capacity) {
+    return block;
+  }
+  void* new_block = allocate(size);
+  if (new_block != nullptr) {
+    memcpy(new_block, block, capacity);
+    release(block);
+  }
+  return new_block;
+}
+
+void SessionAllocator::release(void* block) {
+  if (block == nullptr) {
+    return;
+  }
+  const size_t capacity = header(block)->capacity_;
+  if (capacity > MaxCachedBlockSize || cached_bytes_ + capacity > MaxCachedBytes) {
+    ::free(header(block));
+    return;
+  }
+  const size_t size_class = sizeClass(capacity);
+  ASSERT((MinBlockSize << size_class) == capacity);
+  FreeBlock* free_block = static_cast<FreeBlock*>(block);
+  free_block->next_ = free_lists_[size_class];
+  free_lists_[size_class] = free_block;
+  cached_bytes_ += capacity;
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "common/common/non_copyable.h"
+
+#include "nghttp2/nghttp2.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * nghttp2 allocator for a single session. nghttp2 allocates and frees many small objects per
+ * frame (frame structures, stream state, HPACK entries and output buffers). Blocks of up to
+ * MaxCachedBlockSize bytes are rounded up to a power of two and, when freed, kept on a per size
+ * free list for reuse by the same session rather than returned to the heap. At most
+ * MaxCachedBytes are kept; the rest, and larger blocks, go straight back to the heap.
+ *
+ * A session, and therefore its allocator, is only used from the thread that owns the connection,
+ * so no locking is needed.
+ */
+class SessionAllocator : NonCopyable {
+public:
+  SessionAllocator();
+  ~SessionAllocator();
+
+  /**
+   * @return the allocator to pass to nghttp2_session_client_new3()/nghttp2_session_server_new3().
+   *         It must not be used after this object is destroyed.
+   */
+  nghttp2_mem* mem() { return &mem_; }
+
+  /**
+   * @return a block of at least size bytes, or nullptr if the heap is exhausted.
+   */
+  void* allocate(size_t size);
+
+  /**
+   * @return a zeroed block of at least count * size bytes, or nullptr if the heap is exhausted.
+   */
+  void* allocateZeroed(size_t count, size_t size);
+
+  /**
+   * Resize a block, keeping its content, with the semantics of realloc().
+   * @return the resized block, or nullptr if the heap is exhausted.
+   */
+  void* reallocate(void* block, size_t size);
+
+  /**
+   * Free a block returned by this allocator. nullptr is ignored.
+   */
+  void release(void* block);
+
+  /**
+   * @return the number of bytes held on the free lists.
+   */
+  uint64_t cachedBytes() const { return cached_bytes_; }
+
+  // Blocks bigger than this are never cached. nghttp2 output buffers are 16KB.
+  static constexpr size_t MaxCachedBlockSize = 16 * 1024;
+  // Upper bound on the memory a session keeps on its free lists.
+  static constexpr uint64_t MaxCachedBytes = 256 * 1024;
+
+private:
+  // Precedes every block so that it can be returned to the right free list, and keeps the
+  // block aligned for any type.
+  struct alignas(alignof(std::max_align_t)) BlockHeader {
+    size_t capacity_;
+  };
+
+  struct FreeBlock {
+    FreeBlock* next_;
+  };
+
+  static constexpr size_t MinBlockSize = 16;
+  static constexpr size_t NumSizeClasses = 11; // 16 bytes to MaxCachedBlockSize.
+
+  static size_t sizeClass(size_t size);
+  static BlockHeader* header(void* block) { return static_cast<BlockHeader*>(block) - 1; }
+
+  nghttp2_mem mem_;
+  std::array<FreeBlock*, NumSizeClasses> free_lists_{};
+  uint64_t cached_bytes_{};
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
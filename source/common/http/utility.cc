@@ -233,6 +233,9 @@ Utility::parseHttp1Settings(const envoy::api::v2::core::Http1ProtocolOptions& co
   ret.allow_absolute_url_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, allow_absolute_url, false);
   ret.accept_http_10_ = config.accept_http_10();
   ret.default_host_for_http_10_ = config.default_host_for_http_10();
+  ret.parser_engine_ = config.parser_engine() == envoy::api::v2::core::Http1ProtocolOptions::SIMD
+                           ? Http1Settings::ParserEngine::Simd
+                           : Http1Settings::ParserEngine::HttpParser;
   return ret;
 }
 
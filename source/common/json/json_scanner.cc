@@ -0,0 +1,387 @@
+#include "common/json/json_scanner.h"
+
+#include <cstdlib>
+
+#include "envoy/json/json_object.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+
+namespace Envoy {
+namespace Json {
+namespace {
+
+bool isWhitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Numbers and true/false/null are made of these.
+bool isLiteralChar(char c) {
+  return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '+' || c == '-' ||
+         c == '.';
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isNumber(const std::string& literal) {
+  const char* p = literal.c_str();
+  if (*p == '-') {
+    p++;
+  }
+  if (*p == '0') {
+    p++;
+  } else if (isDigit(*p)) {
+    while (isDigit(*p)) {
+      p++;
+    }
+  } else {
+    return false;
+  }
+  if (*p == '.') {
+    p++;
+    if (!isDigit(*p)) {
+      return false;
+    }
+    while (isDigit(*p)) {
+      p++;
+    }
+  }
+  if (*p == 'e' || *p == 'E') {
+    p++;
+    if (*p == '+' || *p == '-') {
+      p++;
+    }
+    if (!isDigit(*p)) {
+      return false;
+    }
+    while (isDigit(*p)) {
+      p++;
+    }
+  }
+  return *p == '\0';
+}
+
+} // namespace
+
+StreamingScanner::StreamingScanner(Callbacks& callbacks, uint32_t max_depth)
+    : callbacks_(callbacks), max_depth_(max_depth) {}
+
+void StreamingScanner::scan(const Buffer::Instance& data) {
+  const uint64_t num_slices = data.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  data.getRawSlices(slices, num_slices);
+  for (const Buffer::RawSlice& slice : slices) {
+    scan(static_cast<const char*>(slice.mem_), slice.len_);
+  }
+}
+
+void StreamingScanner::scan(const char* data, uint64_t size) {
+  const char* const end = data + size;
+  const char* p = data;
+  while (p != end) {
+    switch (state_) {
+    case State::String:
+      p = scanString(p, end);
+      break;
+    case State::Literal:
+      p = scanLiteral(p, end);
+      break;
+    default:
+      p = scanStructure(p);
+      break;
+    }
+  }
+}
+
+void StreamingScanner::finish() {
+  // A number at the top level only ends with the document.
+  if (state_ == State::Literal && containers_.empty()) {
+    endLiteral();
+  }
+  if (state_ != State::Done) {
+    throwError("incomplete document");
+  }
+}
+
+const char* StreamingScanner::scanStructure(const char* p) {
+  const char c = *p;
+  if (isWhitespace(c)) {
+    return p + 1;
+  }
+
+  switch (state_) {
+  case State::Value:
+    startValue(c);
+    break;
+  case State::ArrayFirstValue:
+    if (c == ']') {
+      endContainer(c);
+    } else {
+      startValue(c);
+    }
+    break;
+  case State::ObjectFirstKey:
+    if (c == '}') {
+      endContainer(c);
+    } else if (c == '"') {
+      startString(true);
+    } else {
+      throwError("expected a key or '}'");
+    }
+    break;
+  case State::ObjectKey:
+    if (c != '"') {
+      throwError("expected a key");
+    }
+    startString(true);
+    break;
+  case State::Colon:
+    if (c != ':') {
+      throwError("expected ':'");
+    }
+    state_ = State::Value;
+    break;
+  case State::AfterValue:
+    if (c == ',') {
+      state_ = containers_.back() == '{' ? State::ObjectKey : State::Value;
+    } else if (c == '}' || c == ']') {
+      endContainer(c);
+    } else {
+      throwError("expected ',' or the end of an object or array");
+    }
+    break;
+  case State::Done:
+    throwError("unexpected data after the document");
+  default:
+    NOT_REACHED;
+  }
+  return p + 1;
+}
+
+const char* StreamingScanner::scanString(const char* p, const char* end) {
+  while (p != end) {
+    if (unicode_digits_ > 0) {
+      scanUnicodeDigit(*p++);
+      continue;
+    }
+    if (escape_) {
+      scanEscape(*p++);
+      continue;
+    }
+    if (high_surrogate_ != 0 && *p != '\\') {
+      throwError("expected a low surrogate");
+    }
+
+    // Skip to the next character that needs attention, copying only what is reported.
+    const char* next = p;
+    while (next != end && *next != '"' && *next != '\\' && static_cast<uint8_t>(*next) >= 0x20) {
+      next++;
+    }
+    if (capture_) {
+      token_.append(p, next - p);
+    }
+    p = next;
+    if (p == end) {
+      break;
+    }
+    if (*p == '"') {
+      endString();
+      return p + 1;
+    }
+    if (*p != '\\') {
+      throwError("control character in string");
+    }
+    escape_ = true;
+    p++;
+  }
+  return p;
+}
+
+void StreamingScanner::scanEscape(char c) {
+  escape_ = false;
+  if (high_surrogate_ != 0 && c != 'u') {
+    throwError("expected a low surrogate");
+  }
+
+  char unescaped;
+  switch (c) {
+  case '"':
+  case '\\':
+  case '/':
+    unescaped = c;
+    break;
+  case 'b':
+    unescaped = '\b';
+    break;
+  case 'f':
+    unescaped = '\f';
+    break;
+  case 'n':
+    unescaped = '\n';
+    break;
+  case 'r':
+    unescaped = '\r';
+    break;
+  case 't':
+    unescaped = '\t';
+    break;
+  case 'u':
+    unicode_digits_ = 4;
+    code_unit_ = 0;
+    return;
+  default:
+    throwError("invalid escape in string");
+  }
+  if (capture_) {
+    token_.push_back(unescaped);
+  }
+}
+
+void StreamingScanner::scanUnicodeDigit(char c) {
+  uint32_t digit;
+  if (isDigit(c)) {
+    digit = c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    digit = c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    digit = c - 'A' + 10;
+  } else {
+    throwError("invalid unicode escape in string");
+  }
+  code_unit_ = code_unit_ << 4 | digit;
+  if (--unicode_digits_ > 0) {
+    return;
+  }
+
+  if (high_surrogate_ != 0) {
+    if (code_unit_ < 0xDC00 || code_unit_ > 0xDFFF) {
+      throwError("expected a low surrogate");
+    }
+    appendCodePoint(0x10000 + ((high_surrogate_ - 0xD800) << 10) + (code_unit_ - 0xDC00));
+    high_surrogate_ = 0;
+  } else if (code_unit_ >= 0xD800 && code_unit_ <= 0xDBFF) {
+    high_surrogate_ = code_unit_;
+  } else if (code_unit_ >= 0xDC00 && code_unit_ <= 0xDFFF) {
+    throwError("unexpected low surrogate");
+  } else {
+    appendCodePoint(code_unit_);
+  }
+}
+
+void StreamingScanner::appendCodePoint(uint32_t code_point) {
+  if (!capture_) {
+    return;
+  }
+  // UTF-8 encode.
+  if (code_point < 0x80) {
+    token_.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    token_.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    token_.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    token_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    token_.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    token_.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    token_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+const char* StreamingScanner::scanLiteral(const char* p, const char* end) {
+  const char* next = p;
+  while (next != end && isLiteralChar(*next)) {
+    next++;
+  }
+  token_.append(p, next - p);
+  if (next != end) {
+    endLiteral();
+  }
+  return next;
+}
+
+void StreamingScanner::startValue(char c) {
+  switch (c) {
+  case '{':
+    containers_.push_back('{');
+    // Only objects that are members of reported objects are reported, up to max_depth_.
+    if (reported_depth_ + 1 == containers_.size() && containers_.size() <= max_depth_) {
+      reported_depth_++;
+    }
+    state_ = State::ObjectFirstKey;
+    break;
+  case '[':
+    containers_.push_back('[');
+    state_ = State::ArrayFirstValue;
+    break;
+  case '"':
+    startString(false);
+    break;
+  default:
+    if (!isLiteralChar(c)) {
+      throwError("expected a value");
+    }
+    token_.assign(1, c);
+    state_ = State::Literal;
+    break;
+  }
+}
+
+void StreamingScanner::startString(bool key) {
+  key_ = key;
+  capture_ = reported_depth_ > 0 && reported_depth_ == containers_.size();
+  token_.clear();
+  state_ = State::String;
+}
+
+void StreamingScanner::endString() {
+  if (key_) {
+    if (capture_) {
+      path_.resize(containers_.size());
+      path_.back() = token_;
+      callbacks_.onKey(path_);
+    }
+    state_ = State::Colon;
+  } else {
+    if (capture_) {
+      callbacks_.onString(path_, token_);
+    }
+    endValue();
+  }
+}
+
+void StreamingScanner::endLiteral() {
+  if (token_ != "true" && token_ != "false" && token_ != "null") {
+    if (!isNumber(token_)) {
+      throwError(fmt::format("invalid literal '{}'", token_));
+    }
+    if (reported_depth_ > 0 && reported_depth_ == containers_.size()) {
+      callbacks_.onNumber(path_, std::strtod(token_.c_str(), nullptr));
+    }
+  }
+  endValue();
+}
+
+void StreamingScanner::endContainer(char close) {
+  if (containers_.back() != (close == '}' ? '{' : '[')) {
+    throwError(fmt::format("unexpected '{}'", close));
+  }
+  if (reported_depth_ == containers_.size()) {
+    reported_depth_--;
+    path_.resize(reported_depth_);
+  }
+  containers_.pop_back();
+  endValue();
+}
+
+void StreamingScanner::endValue() {
+  state_ = containers_.empty() ? State::Done : State::AfterValue;
+}
+
+void StreamingScanner::throwError(const std::string& message) {
+  throw Exception(fmt::format("JSON supplied is not valid: {}", message));
+}
+
+} // namespace Json
+} // namespace Envoy
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Json {
+
+/**
+ * An incremental JSON scanner for pulling a few shallow fields out of a document as it arrives in
+ * pieces, without buffering the document or building a DOM. The whole document is validated, but
+ * only keys and scalar values reachable from the top level object through at most max_depth
+ * nested objects are reported. Everything else, including the contents of arrays, is skipped
+ * without being copied. It is not thread safe.
+ */
+class StreamingScanner {
+public:
+  /**
+   * The keys leading from the top level object to the current member, outermost first.
+   */
+  typedef std::vector<std::string> Path;
+
+  class Callbacks {
+  public:
+    virtual ~Callbacks() {}
+
+    /**
+     * Called for each key of a reported object.
+     * @param path supplies the path of the member, ending with its key.
+     */
+    virtual void onKey(const Path& path) PURE;
+
+    /**
+     * Called for each string value of a member of a reported object.
+     */
+    virtual void onString(const Path& path, const std::string& value) PURE;
+
+    /**
+     * Called for each number value of a member of a reported object.
+     */
+    virtual void onNumber(const Path& path, double value) PURE;
+  };
+
+  /**
+   * @param max_depth supplies the depth of the most deeply nested objects reported. The top level
+   *        object has depth 1.
+   */
+  StreamingScanner(Callbacks& callbacks, uint32_t max_depth);
+
+  /**
+   * Scan the next part of the document.
+   * @throw Json::Exception if the document is not valid JSON.
+   */
+  void scan(const char* data, uint64_t size);
+  void scan(const Buffer::Instance& data);
+
+  /**
+   * Signal the end of the document.
+   * @throw Json::Exception if the document is not valid JSON or is incomplete.
+   */
+  void finish();
+
+private:
+  enum class State {
+    Value,
+    ArrayFirstValue,
+    ObjectFirstKey,
+    ObjectKey,
+    Colon,
+    AfterValue,
+    String,
+    Literal,
+    Done
+  };
+
+  const char* scanStructure(const char* p);
+  const char* scanString(const char* p, const char* end);
+  const char* scanLiteral(const char* p, const char* end);
+  void scanEscape(char c);
+  void scanUnicodeDigit(char c);
+  void appendCodePoint(uint32_t code_point);
+  void startValue(char c);
+  void startString(bool key);
+  void endString();
+  void endLiteral();
+  void endContainer(char close);
+  void endValue();
+  [[noreturn]] void throwError(const std::string& message);
+
+  Callbacks& callbacks_;
+  const uint32_t max_depth_;
+  State state_{State::Value};
+  // The open containers, '{' or '[', outermost first.
+  std::vector<char> containers_;
+  // The number of outermost containers that are reported objects.
+  uint32_t reported_depth_{};
+  Path path_;
+  // The string or literal being scanned.
+  std::string token_;
+  bool key_{};
+  bool capture_{};
+  bool escape_{};
+  uint32_t unicode_digits_{};
+  uint32_t code_unit_{};
+  uint32_t high_surrogate_{};
+};
+
+} // namespace Json
+} // namespace Envoy
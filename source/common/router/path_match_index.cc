@@ -0,0 +1,170 @@
+#include "common/router/path_match_index.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/common/assert.h"
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+namespace {
+const uint32_t NO_CHILD = std::numeric_limits<uint32_t>::max();
+} // namespace
+
+PathMatchIndex::PathMatchIndex() : prefixes_(true), case_insensitive_prefixes_(false) {}
+
+void PathMatchIndex::addPrefix(absl::string_view prefix, bool case_sensitive, uint32_t position) {
+  if (case_sensitive) {
+    prefixes_.add(prefix, position);
+  } else {
+    case_insensitive_prefixes_.add(prefix, position);
+  }
+}
+
+void PathMatchIndex::addPath(absl::string_view path, bool case_sensitive, uint32_t position) {
+  if (case_sensitive) {
+    paths_[std::string(path)].push_back(position);
+  } else {
+    case_insensitive_paths_[absl::AsciiStrToLower(path)].push_back(position);
+  }
+}
+
+void PathMatchIndex::addUnindexed(uint32_t position) {
+  unindexed_.insert(std::upper_bound(unindexed_.begin(), unindexed_.end(), position), position);
+}
+
+void PathMatchIndex::candidates(absl::string_view path, std::vector<uint32_t>& positions) const {
+  positions.clear();
+  prefixes_.find(path, positions);
+  case_insensitive_prefixes_.find(path, positions);
+
+  // Exact path routes ignore the query string.
+  const absl::string_view path_only = path.substr(0, path.find('?'));
+  if (!paths_.empty()) {
+    const auto it = paths_.find(std::string(path_only));
+    if (it != paths_.end()) {
+      positions.insert(positions.end(), it->second.begin(), it->second.end());
+    }
+  }
+  if (!case_insensitive_paths_.empty()) {
+    const auto it = case_insensitive_paths_.find(absl::AsciiStrToLower(path_only));
+    if (it != case_insensitive_paths_.end()) {
+      positions.insert(positions.end(), it->second.begin(), it->second.end());
+    }
+  }
+
+  std::sort(positions.begin(), positions.end());
+  if (!unindexed_.empty()) {
+    const size_t indexed = positions.size();
+    positions.insert(positions.end(), unindexed_.begin(), unindexed_.end());
+    std::inplace_merge(positions.begin(), positions.begin() + indexed, positions.end());
+  }
+}
+
+PathMatchIndex::RadixTree::RadixTree(bool case_sensitive) : case_sensitive_(case_sensitive) {
+  newNode("");
+}
+
+char PathMatchIndex::RadixTree::fold(char c) const {
+  return case_sensitive_ ? c : absl::ascii_tolower(c);
+}
+
+uint32_t PathMatchIndex::RadixTree::newNode(absl::string_view label) {
+  RELEASE_ASSERT(nodes_.size() < NO_CHILD);
+  nodes_.emplace_back();
+  nodes_.back().label_.reserve(label.size());
+  for (char c : label) {
+    nodes_.back().label_.push_back(fold(c));
+  }
+  return nodes_.size() - 1;
+}
+
+uint32_t PathMatchIndex::RadixTree::findChild(const RadixNode& node, char c) const {
+  const auto it = std::lower_bound(
+      node.children_.begin(), node.children_.end(), c,
+      [this](uint32_t child, char first) { return nodes_[child].label_[0] < first; });
+  if (it != node.children_.end() && nodes_[*it].label_[0] == c) {
+    return *it;
+  }
+  return NO_CHILD;
+}
+
+void PathMatchIndex::RadixTree::add(absl::string_view prefix, uint32_t position) {
+  uint32_t node = 0;
+  size_t offset = 0;
+  while (offset < prefix.size()) {
+    const char c = fold(prefix[offset]);
+    uint32_t child = findChild(nodes_[node], c);
+    if (child == NO_CHILD) {
+      // No existing edge shares a first character, so the rest of the prefix becomes a new leaf.
+      child = newNode(prefix.substr(offset));
+      std::vector<uint32_t>& children = nodes_[node].children_;
+      children.insert(std::upper_bound(children.begin(), children.end(), c,
+                                       [this](char first, uint32_t other) {
+                                         return first < nodes_[other].label_[0];
+                                       }),
+                      child);
+      node = child;
+      break;
+    }
+
+    const std::string& label = nodes_[child].label_;
+    size_t common = 1;
+    while (common < label.size() && offset + common < prefix.size() &&
+           label[common] == fold(prefix[offset + common])) {
+      common++;
+    }
+
+    if (common < label.size()) {
+      // The prefix diverges from or ends inside the edge label, so split the edge at that point.
+      const std::string head = label.substr(0, common);
+      nodes_[child].label_.erase(0, common);
+      const uint32_t middle = newNode(head);
+      nodes_[middle].children_.push_back(child);
+      std::replace(nodes_[node].children_.begin(), nodes_[node].children_.end(), child, middle);
+      child = middle;
+    }
+
+    node = child;
+    offset += common;
+  }
+
+  nodes_[node].positions_.push_back(position);
+}
+
+void PathMatchIndex::RadixTree::find(absl::string_view path,
+                                     std::vector<uint32_t>& positions) const {
+  uint32_t node = 0;
+  size_t offset = 0;
+  while (true) {
+    positions.insert(positions.end(), nodes_[node].positions_.begin(),
+                     nodes_[node].positions_.end());
+    if (offset == path.size()) {
+      return;
+    }
+
+    const uint32_t child = findChild(nodes_[node], fold(path[offset]));
+    if (child == NO_CHILD) {
+      return;
+    }
+
+    const std::string& label = nodes_[child].label_;
+    if (path.size() - offset < label.size()) {
+      return;
+    }
+    for (size_t i = 1; i < label.size(); i++) {
+      if (fold(path[offset + i]) != label[i]) {
+        return;
+      }
+    }
+
+    node = child;
+    offset += label.size();
+  }
+}
+
+} // namespace Router
+} // namespace Envoy
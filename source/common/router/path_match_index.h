@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Index over the path matchers of an ordered list of routes, built once when the route
+ * configuration is loaded. For a request path it returns the positions of the routes whose path
+ * matcher may match, so that only those routes need to be evaluated. Prefix matchers are kept in
+ * radix trees and exact path matchers in hash maps. Routes with any other kind of path matcher are
+ * added as unindexed and are always returned.
+ *
+ * The index only narrows down the candidates. It does not look at headers, query parameters or
+ * runtime, so every candidate must still be evaluated in full, in the order returned, to preserve
+ * first match semantics.
+ */
+class PathMatchIndex {
+public:
+  PathMatchIndex();
+
+  /**
+   * Adds a route that matches paths starting with prefix. Like prefix routes, this considers the
+   * whole path including the query string.
+   * @param prefix supplies the prefix.
+   * @param case_sensitive supplies whether the comparison is case sensitive.
+   * @param position supplies the position of the route in the route list.
+   */
+  void addPrefix(absl::string_view prefix, bool case_sensitive, uint32_t position);
+
+  /**
+   * Adds a route that matches paths equal to path, ignoring the query string.
+   * @param path supplies the path.
+   * @param case_sensitive supplies whether the comparison is case sensitive.
+   * @param position supplies the position of the route in the route list.
+   */
+  void addPath(absl::string_view path, bool case_sensitive, uint32_t position);
+
+  /**
+   * Adds a route that the index cannot rule out, such as a regex route.
+   * @param position supplies the position of the route in the route list.
+   */
+  void addUnindexed(uint32_t position);
+
+  /**
+   * Finds the routes that may match a request path.
+   * @param path supplies the request path, including any query string.
+   * @param positions receives the positions of the candidate routes in ascending order. Any
+   *        previous contents are discarded.
+   */
+  void candidates(absl::string_view path, std::vector<uint32_t>& positions) const;
+
+private:
+  /**
+   * A radix tree node. The key of a node is the concatenation of the edge labels from the root.
+   * Children are sorted by the first character of their label, which is distinct among siblings.
+   */
+  struct RadixNode {
+    std::string label_;
+    std::vector<uint32_t> positions_;
+    std::vector<uint32_t> children_;
+  };
+
+  /**
+   * Radix tree of prefixes. Case insensitive trees store lower cased labels.
+   */
+  class RadixTree {
+  public:
+    explicit RadixTree(bool case_sensitive);
+
+    void add(absl::string_view prefix, uint32_t position);
+    void find(absl::string_view path, std::vector<uint32_t>& positions) const;
+
+  private:
+    char fold(char c) const;
+    uint32_t newNode(absl::string_view label);
+    uint32_t findChild(const RadixNode& node, char c) const;
+
+    const bool case_sensitive_;
+    // Nodes reference each other by index so that adding nodes does not invalidate them. The root
+    // is always nodes_[0] and has an empty label.
+    std::vector<RadixNode> nodes_;
+  };
+
+  RadixTree prefixes_;
+  RadixTree case_insensitive_prefixes_;
+  std::unordered_map<std::string, std::vector<uint32_t>> paths_;
+  // Keyed by the lower cased path.
+  std::unordered_map<std::string, std::vector<uint32_t>> case_insensitive_paths_;
+  std::vector<uint32_t> unindexed_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -10,12 +10,14 @@
 
 #include "common/common/lock_guard.h"
 #include "common/common/perf_annotation.h"
+#include "common/common/regex.h"
 #include "common/common/thread.h"
 #include "common/common/utility.h"
 #include "common/config/well_known_names.h"
 
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 
 namespace Envoy {
 namespace Stats {
@@ -32,7 +34,8 @@ uint64_t roundUpMultipleNaturalAlignment(uint64_t val) {
 }
 
 bool regexStartsWithDot(absl::string_view regex) {
-  return absl::StartsWith(regex, "\\.") || absl::StartsWith(regex, "(?=\\.)");
+  return absl::StartsWith(regex, "\\.") || absl::StartsWith(regex, "(?=\\.)") ||
+         absl::StartsWith(regex, "(?:\\..*?)??\\.");
 }
 
 } // namespace
@@ -75,7 +78,8 @@ std::string Utility::sanitizeStatsName(const std::string& name) {
 TagExtractorImpl::TagExtractorImpl(const std::string& name, const std::string& regex,
                                    const std::string& substr)
     : name_(name), prefix_(std::string(extractRegexPrefix(regex))), substr_(substr),
-      regex_(RegexUtil::parseRegex(regex)) {}
+      regex_(Regex::Utility::parseRegex(regex)),
+      second_token_(!prefix_.empty() && regex == absl::StrCat("^", prefix_, "\\.((.*?)\\.)")) {}
 
 std::string TagExtractorImpl::extractRegexPrefix(absl::string_view regex) {
   std::string prefix;
@@ -124,27 +128,35 @@ bool TagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>
     return false;
   }
 
-  std::smatch match;
+  if (second_token_) {
+    const bool found = extractSecondToken(stat_name, tags, remove_characters);
+    PERF_RECORD(perf, found ? "token-match" : "token-miss", name_);
+    return found;
+  }
+
   // The regex must match and contain one or more subexpressions (all after the first are ignored).
-  if (std::regex_search(stat_name, match, regex_) && match.size() > 1) {
+  absl::string_view match[2];
+  const uint32_t num_groups = regex_->numCaptureGroups();
+  if (num_groups > 0 && regex_->search(stat_name, match, 2)) {
     // remove_subexpr is the first submatch. It represents the portion of the string to be removed.
-    const auto& remove_subexpr = match[1];
+    const absl::string_view remove_subexpr = match[0];
 
     // value_subexpr is the optional second submatch. It is usually inside the first submatch
     // (remove_subexpr) to allow the expression to strip off extra characters that should be removed
     // from the string but also not necessary in the tag value ("." for example). If there is no
     // second submatch, then the value_subexpr is the same as the remove_subexpr.
-    const auto& value_subexpr = match.size() > 2 ? match[2] : remove_subexpr;
+    const absl::string_view value_subexpr = num_groups > 1 ? match[1] : remove_subexpr;
 
     tags.emplace_back();
     Tag& tag = tags.back();
     tag.name_ = name_;
-    tag.value_ = value_subexpr.str();
+    tag.value_ = std::string(value_subexpr);
 
     // Determines which characters to remove from stat_name to elide remove_subexpr.
-    std::string::size_type start = remove_subexpr.first - stat_name.begin();
-    std::string::size_type end = remove_subexpr.second - stat_name.begin();
-    remove_characters.insert(start, end);
+    if (remove_subexpr.data() != nullptr) {
+      std::string::size_type start = remove_subexpr.data() - stat_name.data();
+      remove_characters.insert(start, start + remove_subexpr.size());
+    }
     PERF_RECORD(perf, "re-match", name_);
     return true;
   }
@@ -152,6 +164,27 @@ bool TagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>
   return false;
 }
 
+bool TagExtractorImpl::extractSecondToken(const std::string& stat_name, std::vector<Tag>& tags,
+                                          IntervalSet<size_t>& remove_characters) const {
+  // The lazy (.*?) stops at the first '.' after the prefix, so the value never contains a '.'.
+  const size_t start = prefix_.size() + 1;
+  if (stat_name.size() < start || stat_name[prefix_.size()] != '.' ||
+      stat_name.compare(0, prefix_.size(), prefix_) != 0) {
+    return false;
+  }
+  const size_t end = stat_name.find('.', start);
+  if (end == std::string::npos) {
+    return false;
+  }
+
+  tags.emplace_back();
+  Tag& tag = tags.back();
+  tag.name_ = name_;
+  tag.value_.assign(stat_name, start, end - start);
+  remove_characters.insert(start, end + 1);
+  return true;
+}
+
 RawStatData* HeapRawStatDataAllocator::alloc(const std::string& name) {
   RawStatData* data = static_cast<RawStatData*>(::calloc(RawStatData::size(), 1));
   data->initialize(name);
@@ -175,14 +208,102 @@ RawStatData* HeapRawStatDataAllocator::alloc(const std::string& name) {
   }
 }
 
+MetricImpl::MetricImpl(const std::string& name, std::string&& tag_extracted_name,
+                       std::vector<Tag>&& tags) {
+  SymbolTableImpl& symbol_table = symbolTable();
+  std::vector<SymbolVec> parts;
+  parts.reserve(2 + 2 * tags.size());
+  parts.push_back(symbol_table.encode(name));
+  parts.push_back(symbol_table.encode(tag_extracted_name));
+  for (const Tag& tag : tags) {
+    parts.push_back(symbol_table.encode(tag.name_));
+    parts.push_back(symbol_table.encode(tag.value_));
+  }
+
+  uint64_t size = SymbolTableImpl::varintSize(tags.size());
+  for (const SymbolVec& part : parts) {
+    size += SymbolTableImpl::statNameSize(part);
+  }
+  storage_.reset(new uint8_t[size]);
+
+  uint8_t* dest = SymbolTableImpl::writeStatName(parts[0], storage_.get());
+  dest = SymbolTableImpl::writeStatName(parts[1], dest);
+  dest = SymbolTableImpl::writeVarint(tags.size(), dest);
+  for (size_t i = 2; i < parts.size(); i++) {
+    dest = SymbolTableImpl::writeStatName(parts[i], dest);
+  }
+  ASSERT(dest == storage_.get() + size);
+}
+
+MetricImpl::~MetricImpl() {
+  // Release every symbol taken in the constructor under a single acquisition of the table lock.
+  SymbolVec symbols = SymbolTableImpl::symbolsOf(statName());
+  SymbolVec part = SymbolTableImpl::symbolsOf(tagExtractedStatName());
+  symbols.insert(symbols.end(), part.begin(), part.end());
+  uint64_t num_tags;
+  const uint8_t* src = tagsBegin(num_tags);
+  for (uint64_t i = 0; i < 2 * num_tags; i++) {
+    const StatName tag_part(src);
+    part = SymbolTableImpl::symbolsOf(tag_part);
+    symbols.insert(symbols.end(), part.begin(), part.end());
+    src += tag_part.size();
+  }
+  symbolTable().free(symbols);
+}
+
+std::string MetricImpl::tagExtractedName() const {
+  return symbolTable().toString(tagExtractedStatName());
+}
+
+std::vector<Tag> MetricImpl::tags() const {
+  const SymbolTableImpl& symbol_table = symbolTable();
+  uint64_t num_tags;
+  const uint8_t* src = tagsBegin(num_tags);
+  std::vector<Tag> tags(num_tags);
+  for (Tag& tag : tags) {
+    const StatName tag_name(src);
+    src += tag_name.size();
+    const StatName tag_value(src);
+    src += tag_value.size();
+    tag.name_ = symbol_table.toString(tag_name);
+    tag.value_ = symbol_table.toString(tag_value);
+  }
+  return tags;
+}
+
+void MetricImpl::iterateTags(std::string& scratch, const TagCb& cb) const {
+  const SymbolTableImpl& symbol_table = symbolTable();
+  uint64_t num_tags;
+  const uint8_t* src = tagsBegin(num_tags);
+  for (uint64_t i = 0; i < num_tags; i++) {
+    const StatName tag_name(src);
+    src += tag_name.size();
+    const StatName tag_value(src);
+    src += tag_value.size();
+    scratch.clear();
+    symbol_table.appendTo(tag_name, scratch);
+    const size_t name_size = scratch.size();
+    symbol_table.appendTo(tag_value, scratch);
+    const absl::string_view decoded(scratch);
+    cb(decoded.substr(0, name_size), decoded.substr(name_size));
+  }
+}
+
+const uint8_t* MetricImpl::tagsBegin(uint64_t& num_tags) const {
+  const StatName tag_extracted_name = tagExtractedStatName();
+  const uint8_t* src = tag_extracted_name.data() + tag_extracted_name.dataSize();
+  num_tags = SymbolTableImpl::readVarint(src);
+  return src;
+}
+
 /**
  * Counter implementation that wraps a RawStatData.
  */
 class CounterImpl : public Counter, public MetricImpl {
 public:
-  CounterImpl(RawStatData& data, RawStatDataAllocator& alloc, std::string&& tag_extracted_name,
-              std::vector<Tag>&& tags)
-      : MetricImpl(data.name_, std::move(tag_extracted_name), std::move(tags)), data_(data),
+  CounterImpl(RawStatData& data, RawStatDataAllocator& alloc, const std::string& name,
+              std::string&& tag_extracted_name, std::vector<Tag>&& tags)
+      : MetricImpl(name, std::move(tag_extracted_name), std::move(tags)), data_(data),
         alloc_(alloc) {}
   ~CounterImpl() { alloc_.free(data_); }
 
@@ -209,9 +330,9 @@ private:
  */
 class GaugeImpl : public Gauge, public MetricImpl {
 public:
-  GaugeImpl(RawStatData& data, RawStatDataAllocator& alloc, std::string&& tag_extracted_name,
-            std::vector<Tag>&& tags)
-      : MetricImpl(data.name_, std::move(tag_extracted_name), std::move(tags)), data_(data),
+  GaugeImpl(RawStatData& data, RawStatDataAllocator& alloc, const std::string& name,
+            std::string&& tag_extracted_name, std::vector<Tag>&& tags)
+      : MetricImpl(name, std::move(tag_extracted_name), std::move(tags)), data_(data),
         alloc_(alloc) {}
   ~GaugeImpl() { alloc_.free(data_); }
 
@@ -268,6 +389,7 @@ TagProducerImpl::TagProducerImpl(const envoy::config::metrics::v2::StatsConfig&
       default_tags_.emplace_back(Stats::Tag{.name_ = name, .value_ = tag_specifier.fixed_value()});
     }
   }
+  substr_matcher_.compile();
 }
 
 int TagProducerImpl::addExtractorsMatching(absl::string_view name) {
@@ -283,30 +405,31 @@ int TagProducerImpl::addExtractorsMatching(absl::string_view name) {
 }
 
 void TagProducerImpl::addExtractor(TagExtractorPtr extractor) {
+  uint64_t substr_mask = 0;
+  const absl::string_view substr = extractor->substrToken();
+  if (!substr.empty()) {
+    const uint32_t id = substr_matcher_.add(substr);
+    if (id < MaxIndexedSubstrs) {
+      substr_mask = uint64_t(1) << id;
+    }
+  }
+
   const absl::string_view prefix = extractor->prefixToken();
   if (prefix.empty()) {
-    tag_extractors_without_prefix_.emplace_back(std::move(extractor));
+    tag_extractors_without_prefix_.push_back({std::move(extractor), substr_mask});
   } else {
-    tag_extractor_prefix_map_[prefix].emplace_back(std::move(extractor));
+    tag_extractor_prefix_map_[prefix].push_back({std::move(extractor), substr_mask});
   }
 }
 
-void TagProducerImpl::forEachExtractorMatching(
-    const std::string& stat_name, std::function<void(const TagExtractorPtr&)> f) const {
-  IntervalSetImpl<size_t> remove_characters;
-  for (const TagExtractorPtr& tag_extractor : tag_extractors_without_prefix_) {
-    f(tag_extractor);
-  }
-  const std::string::size_type dot = stat_name.find('.');
-  if (dot != std::string::npos) {
-    const absl::string_view token = absl::string_view(stat_name.data(), dot);
-    const auto iter = tag_extractor_prefix_map_.find(token);
-    if (iter != tag_extractor_prefix_map_.end()) {
-      for (const TagExtractorPtr& tag_extractor : iter->second) {
-        f(tag_extractor);
-      }
+uint64_t TagProducerImpl::findSubstrs(absl::string_view stat_name) const {
+  uint64_t substrs = 0;
+  substr_matcher_.scan(SubstringMatcher::InitialState, stat_name, [&substrs](uint32_t id) {
+    if (id < MaxIndexedSubstrs) {
+      substrs |= uint64_t(1) << id;
     }
-  }
+  });
+  return substrs;
 }
 
 std::string TagProducerImpl::produceTags(const std::string& metric_name,
@@ -434,7 +557,7 @@ CounterSharedPtr RawStatDataAllocator::makeCounter(const std::string& name,
   if (data == nullptr) {
     return nullptr;
   }
-  return std::make_shared<CounterImpl>(*data, *this, std::move(tag_extracted_name),
+  return std::make_shared<CounterImpl>(*data, *this, name, std::move(tag_extracted_name),
                                        std::move(tags));
 }
 
@@ -445,7 +568,8 @@ GaugeSharedPtr RawStatDataAllocator::makeGauge(const std::string& name,
   if (data == nullptr) {
     return nullptr;
   }
-  return std::make_shared<GaugeImpl>(*data, *this, std::move(tag_extracted_name), std::move(tags));
+  return std::make_shared<GaugeImpl>(*data, *this, name, std::move(tag_extracted_name),
+                                     std::move(tags));
 }
 
 } // namespace Stats
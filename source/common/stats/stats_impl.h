@@ -7,10 +7,10 @@
 #include <functional>
 #include <list>
 #include <memory>
-#include <regex>
 #include <string>
 #include <unordered_map>
 
+#include "envoy/common/regex.h"
 #include "envoy/common/time.h"
 #include "envoy/config/metrics/v2/stats.pb.h"
 #include "envoy/server/options.h"
@@ -19,10 +19,12 @@
 #include "common/common/assert.h"
 #include "common/common/hash.h"
 #include "common/common/non_copyable.h"
+#include "common/common/substring_matcher.h"
 #include "common/common/thread.h"
 #include "common/common/thread_annotations.h"
 #include "common/common/utility.h"
 #include "common/protobuf/protobuf.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
@@ -52,6 +54,7 @@ public:
   bool extractTag(const std::string& tag_extracted_name, std::vector<Tag>& tags,
                   IntervalSet<size_t>& remove_characters) const override;
   absl::string_view prefixToken() const override { return prefix_; }
+  absl::string_view substrToken() const override { return substr_; }
 
   /**
    * @param stat_name The stat name
@@ -69,10 +72,21 @@ private:
    */
   static std::string extractRegexPrefix(absl::string_view regex);
 
+  /**
+   * Extracts the tag of a regex of the form ^prefix\.((.*?)\.) without evaluating the regex. The
+   * tag value is the second '.' separated token of stat_name, which is removed along with its
+   * trailing '.'.
+   */
+  bool extractSecondToken(const std::string& stat_name, std::vector<Tag>& tags,
+                          IntervalSet<size_t>& remove_characters) const;
+
   const std::string name_;
   const std::string prefix_;
   const std::string substr_;
-  const std::regex regex_;
+  const Regex::CompiledMatcherPtr regex_;
+  // True if the regex is ^prefix\.((.*?)\.), the form used to tag the second token of scoped
+  // stats such as cluster.<cluster_name>.
+  const bool second_token_;
 };
 
 /**
@@ -128,6 +142,14 @@ private:
   std::unordered_set<std::string>
   addDefaultExtractors(const envoy::config::metrics::v2::StatsConfig& config);
 
+  /**
+   * Finds which of the extractor substrings occur in stat_name, in a single pass.
+   * @param stat_name absl::string_view the stat name.
+   * @return uint64_t the bitwise or of the substr_mask_ of every extractor whose substring
+   *         occurs in stat_name.
+   */
+  uint64_t findSubstrs(absl::string_view stat_name) const;
+
   /**
    * Iterates over every tag extractor that might possibly match stat_name, calling
    * callback f for each one. This is broken out this way to reduce code redundancy
@@ -136,22 +158,54 @@ private:
    *   1. Finding the first '.' separated token in stat_name.
    *   2. Collecting the TagExtractors whose regexes have that same prefix "^prefix\\."
    *   3. Collecting also the TagExtractors whose regexes don't start with any prefix.
-   * In the future, we may also do substring searches in some cases.
+   *   4. Dropping the TagExtractors whose substring does not occur in stat_name.
    * See DefaultTagRegexTester::produceTagsReverse in test/common/stats/stats_impl_test.cc.
    *
    * @param stat_name const std::string& the stat name.
-   * @param f std::function<void(const TagExtractorPtr&)> function to call for each extractor.
+   * @param f function to call with the const TagExtractorPtr& of each extractor.
    */
-  void forEachExtractorMatching(const std::string& stat_name,
-                                std::function<void(const TagExtractorPtr&)> f) const;
+  template <class Callback>
+  void forEachExtractorMatching(const std::string& stat_name, Callback f) const {
+    const uint64_t substrs = findSubstrs(stat_name);
+    auto visit = [substrs, &f](const std::vector<IndexedTagExtractor>& extractors) {
+      for (const IndexedTagExtractor& extractor : extractors) {
+        if ((extractor.substr_mask_ & ~substrs) == 0) {
+          f(extractor.extractor_);
+        }
+      }
+    };
+    visit(tag_extractors_without_prefix_);
+    const std::string::size_type dot = stat_name.find('.');
+    if (dot != std::string::npos) {
+      const absl::string_view token = absl::string_view(stat_name.data(), dot);
+      const auto iter = tag_extractor_prefix_map_.find(token);
+      if (iter != tag_extractor_prefix_map_.end()) {
+        visit(iter->second);
+      }
+    }
+  }
 
-  std::vector<TagExtractorPtr> tag_extractors_without_prefix_;
+  // Substrings beyond this many are not indexed, and are only checked by their extractor.
+  static const uint32_t MaxIndexedSubstrs = 64;
+
+  struct IndexedTagExtractor {
+    TagExtractorPtr extractor_;
+    // The bit assigned to the extractor's substring by substr_matcher_, or 0 if the
+    // extractor has no indexed substring.
+    uint64_t substr_mask_;
+  };
+
+  std::vector<IndexedTagExtractor> tag_extractors_without_prefix_;
 
   // Maps a prefix word extracted out of a regex to a vector of TagExtractors. Note that
   // the storage for the prefix string is owned by the TagExtractor, which, depending on
   // implementation, may need make a copy of the prefix.
-  std::unordered_map<absl::string_view, std::vector<TagExtractorPtr>, StringViewHash>
+  std::unordered_map<absl::string_view, std::vector<IndexedTagExtractor>, StringViewHash>
       tag_extractor_prefix_map_;
+
+  // Finds the substrings of all extractors. Pattern ids are used as bit positions in
+  // substr_mask_.
+  SubstringMatcher substr_matcher_;
   std::vector<Tag> default_tags_;
 };
 
@@ -284,12 +338,18 @@ private:
  */
 class MetricImpl : public virtual Metric {
 public:
-  MetricImpl(const std::string& name, std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : name_(name), tag_extracted_name_(std::move(tag_extracted_name)), tags_(std::move(tags)) {}
-
-  const std::string& name() const override { return name_; }
-  const std::string& tagExtractedName() const override { return tag_extracted_name_; }
-  const std::vector<Tag>& tags() const override { return tags_; }
+  MetricImpl(const std::string& name, std::string&& tag_extracted_name, std::vector<Tag>&& tags);
+  ~MetricImpl();
+
+  std::string name() const override { return symbolTable().toString(statName()); }
+  void appendName(std::string& out) const override { symbolTable().appendTo(statName(), out); }
+  StatName statName() const override { return StatName(storage_.get()); }
+  std::string tagExtractedName() const override;
+  void appendTagExtractedName(std::string& out) const override {
+    symbolTable().appendTo(tagExtractedStatName(), out);
+  }
+  std::vector<Tag> tags() const override;
+  void iterateTags(std::string& scratch, const TagCb& cb) const override;
 
 protected:
   /**
@@ -300,9 +360,15 @@ protected:
   };
 
 private:
-  const std::string name_;
-  const std::string tag_extracted_name_;
-  const std::vector<Tag> tags_;
+  static SymbolTableImpl& symbolTable() { return SymbolTableSingleton::get(); }
+  StatName tagExtractedStatName() const { return StatName(storage_.get() + statName().size()); }
+  const uint8_t* tagsBegin(uint64_t& num_tags) const;
+
+  // The name, tag extracted name and tags, encoded with the process-wide symbol table and packed
+  // into a single allocation as:
+  //   [name][tag extracted name][number of tags][tag name][tag value]...[tag name][tag value]
+  // The names and tag parts are StatNames and the number of tags is a varint.
+  std::unique_ptr<uint8_t[]> storage_;
 };
 
 /**
@@ -0,0 +1,284 @@
+#include "common/stats/symbol_table_impl.h"
+
+#include <limits>
+#include <string>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Stats {
+
+SymbolTableImpl::SymbolTableImpl() {}
+
+SymbolTableImpl::~SymbolTableImpl() {
+  for (std::atomic<DecodeDirectory*>& entry : decode_root_) {
+    DecodeDirectory* directory = entry.load(std::memory_order_relaxed);
+    if (directory == nullptr) {
+      continue;
+    }
+    for (std::atomic<DecodeBlock*>& block : directory->blocks_) {
+      delete block.load(std::memory_order_relaxed);
+    }
+    delete directory;
+  }
+}
+
+SymbolVec SymbolTableImpl::encode(absl::string_view name) {
+  SymbolVec symbols;
+  if (name.empty()) {
+    return symbols;
+  }
+
+  Thread::LockGuard lock(lock_);
+  for (absl::string_view token : absl::StrSplit(name, '.')) {
+    auto result = encode_map_.emplace(std::string(token), SharedSymbol{0, 1});
+    if (result.second) {
+      Symbol& symbol = result.first->second.symbol_;
+      if (!free_symbols_.empty()) {
+        symbol = free_symbols_.top();
+        free_symbols_.pop();
+      } else {
+        // Only reached with every symbol below next_symbol_ in use, so running out would take
+        // more distinct live tokens than fit in memory.
+        ASSERT(next_symbol_ <= std::numeric_limits<Symbol>::max());
+        symbol = next_symbol_++;
+      }
+      addToken(symbol, result.first->first);
+    } else {
+      ++result.first->second.ref_count_;
+    }
+    symbols.push_back(result.first->second.symbol_);
+  }
+  return symbols;
+}
+
+bool SymbolTableImpl::encodeExisting(absl::string_view name, SymbolVec& symbols) const {
+  symbols.clear();
+  if (name.empty()) {
+    return true;
+  }
+
+  Thread::LockGuard lock(lock_);
+  for (absl::string_view token : absl::StrSplit(name, '.')) {
+    auto it = encode_map_.find(std::string(token));
+    if (it == encode_map_.end()) {
+      return false;
+    }
+    symbols.push_back(it->second.symbol_);
+  }
+  return true;
+}
+
+std::string SymbolTableImpl::toString(StatName stat_name) const {
+  std::string name;
+  appendTo(stat_name, name);
+  return name;
+}
+
+void SymbolTableImpl::appendTo(StatName stat_name, std::string& out) const {
+  const uint8_t* src = stat_name.data();
+  const uint8_t* end = src + stat_name.dataSize();
+  bool first = true;
+  while (src < end) {
+    if (!first) {
+      out.push_back('.');
+    }
+    first = false;
+    out.append(token(readVarint(src)));
+  }
+  ASSERT(src == end);
+}
+
+std::string SymbolTableImpl::decode(const SymbolVec& symbols) const {
+  std::string name;
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    if (i > 0) {
+      name.push_back('.');
+    }
+    name.append(token(symbols[i]));
+  }
+  return name;
+}
+
+void SymbolTableImpl::free(const SymbolVec& symbols) {
+  Thread::LockGuard lock(lock_);
+  for (Symbol symbol : symbols) {
+    auto it = encode_map_.find(token(symbol));
+    ASSERT(it != encode_map_.end());
+    ASSERT(it->second.ref_count_ > 0);
+    if (--it->second.ref_count_ == 0) {
+      removeToken(symbol);
+      encode_map_.erase(it);
+      free_symbols_.push(symbol);
+    }
+  }
+}
+
+uint64_t SymbolTableImpl::numSymbols() const {
+  Thread::LockGuard lock(lock_);
+  return encode_map_.size();
+}
+
+uint64_t SymbolTableImpl::serial(Symbol symbol) const {
+  const DecodeSlot* decode_slot = slot(symbol);
+  return decode_slot == nullptr ? 0 : decode_slot->serial_.load(std::memory_order_acquire);
+}
+
+SymbolTableImpl::DecodeSlot* SymbolTableImpl::slot(Symbol symbol) const {
+  DecodeDirectory* directory =
+      decode_root_[symbol >> (DecodeDirectoryBits + DecodeBlockBits)].load(
+          std::memory_order_acquire);
+  if (directory == nullptr) {
+    return nullptr;
+  }
+  DecodeBlock* block =
+      directory->blocks_[(symbol >> DecodeBlockBits) & ((1 << DecodeDirectoryBits) - 1)].load(
+          std::memory_order_acquire);
+  if (block == nullptr) {
+    return nullptr;
+  }
+  return &block->slots_[symbol & ((1 << DecodeBlockBits) - 1)];
+}
+
+const std::string& SymbolTableImpl::token(Symbol symbol) const {
+  const DecodeSlot* decode_slot = slot(symbol);
+  ASSERT(decode_slot != nullptr);
+  const std::string* token = decode_slot->token_.load(std::memory_order_acquire);
+  ASSERT(token != nullptr);
+  return *token;
+}
+
+void SymbolTableImpl::addToken(Symbol symbol, const std::string& token) {
+  std::atomic<DecodeDirectory*>& root_entry =
+      decode_root_[symbol >> (DecodeDirectoryBits + DecodeBlockBits)];
+  DecodeDirectory* directory = root_entry.load(std::memory_order_relaxed);
+  if (directory == nullptr) {
+    directory = new DecodeDirectory();
+    root_entry.store(directory, std::memory_order_release);
+  }
+  std::atomic<DecodeBlock*>& directory_entry =
+      directory->blocks_[(symbol >> DecodeBlockBits) & ((1 << DecodeDirectoryBits) - 1)];
+  DecodeBlock* block = directory_entry.load(std::memory_order_relaxed);
+  if (block == nullptr) {
+    block = new DecodeBlock();
+    directory_entry.store(block, std::memory_order_release);
+  }
+  DecodeSlot& decode_slot = block->slots_[symbol & ((1 << DecodeBlockBits) - 1)];
+  decode_slot.token_.store(&token, std::memory_order_release);
+  decode_slot.serial_.store(next_serial_++, std::memory_order_release);
+}
+
+void SymbolTableImpl::removeToken(Symbol symbol) {
+  // The slot stays allocated for serial(); see the comment on the decode table.
+  DecodeSlot& decode_slot = *slot(symbol);
+  decode_slot.serial_.store(0, std::memory_order_release);
+  decode_slot.token_.store(nullptr, std::memory_order_relaxed);
+}
+
+uint64_t SymbolTableImpl::statNameSize(const SymbolVec& symbols) {
+  uint64_t size = StatName::SizeBytes;
+  for (Symbol symbol : symbols) {
+    size += varintSize(symbol);
+  }
+  return size;
+}
+
+uint8_t* SymbolTableImpl::writeStatName(const SymbolVec& symbols, uint8_t* dest) {
+  const uint64_t data_size = statNameSize(symbols) - StatName::SizeBytes;
+  RELEASE_ASSERT(data_size < (1 << 16));
+  *dest++ = data_size & 0xff;
+  *dest++ = data_size >> 8;
+  for (Symbol symbol : symbols) {
+    dest = writeVarint(symbol, dest);
+  }
+  return dest;
+}
+
+SymbolVec SymbolTableImpl::symbolsOf(StatName stat_name) {
+  SymbolVec symbols;
+  const uint8_t* src = stat_name.data();
+  const uint8_t* end = src + stat_name.dataSize();
+  while (src < end) {
+    symbols.push_back(readVarint(src));
+  }
+  ASSERT(src == end);
+  return symbols;
+}
+
+uint8_t* SymbolTableImpl::writeVarint(uint64_t value, uint8_t* dest) {
+  // Seven bits per byte, least significant first, with the high bit set on all but the last byte.
+  while (value >= 0x80) {
+    *dest++ = (value & 0x7f) | 0x80;
+    value >>= 7;
+  }
+  *dest++ = value;
+  return dest;
+}
+
+uint64_t SymbolTableImpl::varintSize(uint64_t value) {
+  uint64_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+uint64_t SymbolTableImpl::readVarint(const uint8_t*& src) {
+  uint64_t value = 0;
+  uint32_t shift = 0;
+  uint8_t byte;
+  do {
+    byte = *src++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return value;
+}
+
+StatNameStorage::StatNameStorage(const SymbolVec& symbols)
+    : bytes_(new uint8_t[SymbolTableImpl::statNameSize(symbols)]) {
+  SymbolTableImpl::writeStatName(symbols, bytes_.get());
+}
+
+bool SymbolCache::encode(absl::string_view name, StatName& stat_name) {
+  encoding_symbols_.clear();
+  if (!name.empty()) {
+    for (absl::string_view token : absl::StrSplit(name, '.')) {
+      token_.assign(token.data(), token.size());
+      auto it = symbols_.find(token_);
+      if (it == symbols_.end() || symbol_table_.serial(it->second.symbol_) != it->second.serial_) {
+        return false;
+      }
+      encoding_symbols_.push_back(it->second.symbol_);
+    }
+  }
+
+  encoding_.resize(SymbolTableImpl::statNameSize(encoding_symbols_));
+  SymbolTableImpl::writeStatName(encoding_symbols_, encoding_.data());
+  stat_name = StatName(encoding_.data());
+  return true;
+}
+
+void SymbolCache::remember(absl::string_view name, StatName stat_name) {
+  if (name.empty()) {
+    return;
+  }
+
+  const SymbolVec symbols = SymbolTableImpl::symbolsOf(stat_name);
+  auto symbol = symbols.begin();
+  for (absl::string_view token : absl::StrSplit(name, '.')) {
+    ASSERT(symbol != symbols.end());
+    // The caller holds a reference to the symbol, so its current serial is the one it was
+    // encoded with.
+    symbols_[std::string(token)] = {*symbol, symbol_table_.serial(*symbol)};
+    ++symbol;
+  }
+  ASSERT(symbol == symbols.end());
+}
+
+} // namespace Stats
+} // namespace Envoy
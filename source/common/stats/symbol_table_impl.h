@@ -0,0 +1,271 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/stats/symbol_table.h"
+
+#include "common/common/hash.h"
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+#include "common/singleton/threadsafe_singleton.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Hash functor so that StatName can be used as the key of unordered containers.
+ */
+struct StatNameHash {
+  size_t operator()(const StatName& stat_name) const {
+    return HashUtil::xxHash64(
+        absl::string_view(reinterpret_cast<const char*>(stat_name.data()), stat_name.dataSize()));
+  }
+};
+
+template <class Value> using StatNameHashMap = std::unordered_map<StatName, Value, StatNameHash>;
+
+/**
+ * Interns the '.'-delimited tokens of stat names, so that each distinct token is stored once per
+ * process no matter how many stats include it. Names are encoded as StatNames, sequences of
+ * varint-encoded symbols, which for typical names take a few bytes per token instead of one byte
+ * per character.
+ *
+ * Each symbol is reference counted by the number of encoded names using it, and its token is
+ * dropped once that count reaches zero. The symbol is then handed out again to a later token,
+ * lowest free symbol first so that encodings stay short, which bounds the number of symbols by
+ * the peak number of distinct tokens in use. Every assignment of a symbol to a token gets a
+ * serial that is never reused, so that SymbolCache can detect, without taking the table lock,
+ * symbols that have been reused since it cached them.
+ *
+ * Decoding does not take the lock either, so that metrics can report their names from any thread
+ * without contending with each other. The lock is only taken to add and free symbols.
+ */
+class SymbolTableImpl : NonCopyable {
+public:
+  SymbolTableImpl();
+  ~SymbolTableImpl();
+
+  /**
+   * Encodes a stat name, adding any tokens not yet in the table. The caller owns a reference to
+   * every returned symbol and must release them with free().
+   * @param name the stat name to encode.
+   * @return SymbolVec the symbols of each token of the name, in order.
+   */
+  SymbolVec encode(absl::string_view name);
+
+  /**
+   * Encodes a stat name using only tokens that are already in the table. No references are taken,
+   * so the symbols are only meaningful while something else holds a reference to them.
+   * @param name the stat name to encode.
+   * @param symbols receives the symbols of each token of the name, in order.
+   * @return bool false if any token of the name is not in the table.
+   */
+  bool encodeExisting(absl::string_view name, SymbolVec& symbols) const;
+
+  /**
+   * Decodes a vector of symbols back into a '.'-delimited stat name. This does not take the lock.
+   * @param symbols the symbols to decode, each of which must still be referenced.
+   * @return std::string the stat name.
+   */
+  std::string decode(const SymbolVec& symbols) const;
+
+  /**
+   * @return std::string the stat name encoded by stat_name.
+   */
+  std::string toString(StatName stat_name) const;
+
+  /**
+   * Appends the stat name encoded by stat_name to a string. This does not take the lock, and does
+   * not allocate if the string has room, so callers formatting many names can reuse one string.
+   * @param stat_name the encoded name, whose symbols must still be referenced.
+   * @param out the string to append to.
+   */
+  void appendTo(StatName stat_name, std::string& out) const;
+
+  /**
+   * Releases one reference to each symbol, as obtained from encode().
+   * @param symbols the symbols to release.
+   */
+  void free(const SymbolVec& symbols);
+  void free(StatName stat_name) { free(symbolsOf(stat_name)); }
+
+  /**
+   * @return uint64_t the number of distinct tokens currently interned.
+   */
+  uint64_t numSymbols() const;
+
+  /**
+   * Returns the serial of the current assignment of a symbol to a token. A symbol that has been
+   * released and handed out again has a different serial. This does not take the lock, and can be
+   * called for any symbol, whether or not it is referenced.
+   * @param symbol the symbol.
+   * @return uint64_t the serial, or 0 if the symbol is not currently assigned.
+   */
+  uint64_t serial(Symbol symbol) const;
+
+  /**
+   * @return uint64_t the number of bytes needed to store symbols as a StatName.
+   */
+  static uint64_t statNameSize(const SymbolVec& symbols);
+
+  /**
+   * Writes symbols to a buffer as a StatName.
+   * @param symbols the symbols to write.
+   * @param dest the buffer to write to, which must have room for statNameSize(symbols) bytes.
+   * @return uint8_t* the first byte after the written StatName.
+   */
+  static uint8_t* writeStatName(const SymbolVec& symbols, uint8_t* dest);
+
+  /**
+   * @return SymbolVec the symbols encoded by a StatName.
+   */
+  static SymbolVec symbolsOf(StatName stat_name);
+
+  /**
+   * Varint helpers for appending and reading symbols and other small integers.
+   */
+  static uint8_t* writeVarint(uint64_t value, uint8_t* dest);
+  static uint64_t varintSize(uint64_t value);
+  static uint64_t readVarint(const uint8_t*& src);
+
+private:
+  struct SharedSymbol {
+    Symbol symbol_;
+    uint32_t ref_count_;
+  };
+
+  typedef std::unordered_map<std::string, SharedSymbol> EncodeMap;
+
+  // Tokens are found by symbol through a three level table: an inline root of directories, each
+  // pointing at blocks of slots, both allocated as the symbols they cover are first handed out.
+  // A slot points at the key of the symbol's encode_map_ entry, which is node based so the key
+  // does not move, and holds the serial of the assignment, for as long as the symbol is
+  // referenced. Slots only change under the lock. Directories and blocks are never freed, so
+  // serial() can read the slot of any symbol that has been handed out, and decode() only reads
+  // the tokens of symbols its caller holds a reference to, which can't be cleared or reassigned
+  // until that reference is released. The table only grows to cover next_symbol_, which is
+  // bounded by the peak number of tokens in use since symbols are reused.
+  static const uint32_t DecodeBlockBits = 10;
+  static const uint32_t DecodeDirectoryBits = 10;
+  static const uint32_t DecodeRootBits =
+      std::numeric_limits<Symbol>::digits - DecodeDirectoryBits - DecodeBlockBits;
+
+  struct DecodeSlot {
+    std::atomic<const std::string*> token_{};
+    std::atomic<uint64_t> serial_{};
+  };
+
+  struct DecodeBlock {
+    DecodeSlot slots_[1 << DecodeBlockBits];
+  };
+
+  struct DecodeDirectory {
+    std::atomic<DecodeBlock*> blocks_[1 << DecodeDirectoryBits]{};
+  };
+
+  DecodeSlot* slot(Symbol symbol) const;
+  const std::string& token(Symbol symbol) const;
+  void addToken(Symbol symbol, const std::string& token) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void removeToken(Symbol symbol) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  mutable Thread::MutexBasicLockable lock_;
+  EncodeMap encode_map_ GUARDED_BY(lock_);
+  // Released symbols, lowest first.
+  std::priority_queue<Symbol, std::vector<Symbol>, std::greater<Symbol>>
+      free_symbols_ GUARDED_BY(lock_);
+  uint64_t next_symbol_ GUARDED_BY(lock_) = 0;
+  uint64_t next_serial_ GUARDED_BY(lock_) = 1;
+  std::atomic<DecodeDirectory*> decode_root_[1 << DecodeRootBits]{};
+};
+
+/**
+ * The symbol table shared by every stat in the process.
+ */
+typedef ThreadSafeSingleton<SymbolTableImpl> SymbolTableSingleton;
+
+/**
+ * Owns the bytes of a StatName. No symbol references are held; the owner is responsible for
+ * keeping the symbols alive while the StatName is in use, or for freeing them.
+ */
+class StatNameStorage : NonCopyable {
+public:
+  explicit StatNameStorage(const SymbolVec& symbols);
+
+  StatName statName() const { return StatName(bytes_.get()); }
+
+private:
+  std::unique_ptr<uint8_t[]> bytes_;
+};
+
+/**
+ * A per-thread cache of token to symbol mappings, which encodes stat names without locking the
+ * symbol table. Mappings are learned from names that have already been encoded by the table, via
+ * remember(). A mapping goes stale once its token is released from the table, after which the
+ * symbol may be handed out to another token. Each mapping records the serial of the symbol's
+ * assignment, and encode() treats a mapping whose serial no longer matches the table as missing,
+ * so the caller falls back to the table, after which remember() refreshes the mapping.
+ *
+ * The symbol could be released and reused right after the check, so an encoding is only
+ * meaningful when compared with names whose symbols the owner of the cache keeps referenced, as
+ * the per-thread stat caches do. Those names keep their symbols assigned, so one of them can
+ * only match the encoding if it was built from the same assignment that the check observed.
+ *
+ * This class is not thread safe. It is intended to be owned by a single thread.
+ */
+class SymbolCache {
+public:
+  explicit SymbolCache(const SymbolTableImpl& symbol_table) : symbol_table_(symbol_table) {}
+
+  /**
+   * Encodes a stat name using cached mappings.
+   * @param name the stat name to encode.
+   * @param stat_name receives the encoded name, which is valid until the next call to encode().
+   * @return bool false if some token of the name is not cached.
+   */
+  bool encode(absl::string_view name, StatName& stat_name);
+
+  /**
+   * Caches the mappings used to encode a stat name.
+   * @param name the stat name.
+   * @param stat_name the encoding of name, with its symbols referenced by the caller.
+   */
+  void remember(absl::string_view name, StatName stat_name);
+
+  /**
+   * Drops all cached mappings, including stale ones, which are otherwise only replaced when their
+   * token is remembered again.
+   */
+  void clear() { symbols_.clear(); }
+
+  /**
+   * @return uint64_t the number of cached mappings.
+   */
+  uint64_t size() const { return symbols_.size(); }
+
+private:
+  struct CachedSymbol {
+    Symbol symbol_;
+    uint64_t serial_;
+  };
+
+  const SymbolTableImpl& symbol_table_;
+  std::unordered_map<std::string, CachedSymbol> symbols_;
+  // Scratch space reused across calls so that encode() does not allocate in the steady state.
+  std::string token_;
+  SymbolVec encoding_symbols_;
+  std::vector<uint8_t> encoding_;
+};
+
+} // namespace Stats
+} // namespace Envoy
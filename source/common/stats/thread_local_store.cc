@@ -12,6 +12,26 @@
 namespace Envoy {
 namespace Stats {
 
+namespace {
+
+/**
+ * Looks up a stat by name in a central cache map. The store lock must be held, which keeps the
+ * stats in the map, and so the symbols of their names, alive.
+ */
+template <class StatPtr>
+StatPtr findCentral(const std::string& name, const StatNameHashMap<StatPtr>& central_cache_map) {
+  // If any token of the name is not in the symbol table, no stat with the name can exist.
+  SymbolVec symbols;
+  if (!SymbolTableSingleton::get().encodeExisting(name, symbols)) {
+    return nullptr;
+  }
+  const StatNameStorage stat_name(symbols);
+  auto it = central_cache_map.find(stat_name.statName());
+  return it == central_cache_map.end() ? nullptr : it->second;
+}
+
+} // namespace
+
 ThreadLocalStoreImpl::ThreadLocalStoreImpl(StatDataAllocator& alloc)
     : alloc_(alloc), default_scope_(createScope("")),
       tag_producer_(std::make_unique<TagProducerImpl>()),
@@ -26,7 +46,7 @@ ThreadLocalStoreImpl::~ThreadLocalStoreImpl() {
 std::vector<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
   // Handle de-dup due to overlapping scopes.
   std::vector<CounterSharedPtr> ret;
-  std::unordered_set<std::string> names;
+  std::unordered_set<StatName, StatNameHash> names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
     for (auto& counter : scope->central_cache_.counters_) {
@@ -49,7 +69,7 @@ ScopePtr ThreadLocalStoreImpl::createScope(const std::string& name) {
 std::vector<GaugeSharedPtr> ThreadLocalStoreImpl::gauges() const {
   // Handle de-dup due to overlapping scopes.
   std::vector<GaugeSharedPtr> ret;
-  std::unordered_set<std::string> names;
+  std::unordered_set<StatName, StatNameHash> names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
     for (auto& gauge : scope->central_cache_.gauges_) {
@@ -65,7 +85,6 @@ std::vector<GaugeSharedPtr> ThreadLocalStoreImpl::gauges() const {
 std::vector<ParentHistogramSharedPtr> ThreadLocalStoreImpl::histograms() const {
   // Handle de-dup due to overlapping scopes.
   std::vector<ParentHistogramSharedPtr> ret;
-  std::unordered_set<std::string> names;
   Thread::LockGuard lock(lock_);
   // TODO(ramaraochavali): As histograms don't share storage, there is a chance of duplicate names
   // here. We need to create global storage for histograms similar to how we have a central storage
@@ -150,8 +169,13 @@ void ThreadLocalStoreImpl::clearScopeFromCaches(uint64_t scope_id) {
   // at the same time.
   if (!shutting_down_) {
     // Perform a cache flush on all threads.
-    tls_->runOnAllThreads(
-        [this, scope_id]() -> void { tls_->getTyped<TlsCache>().scope_cache_.erase(scope_id); });
+    tls_->runOnAllThreads([this, scope_id]() -> void {
+      TlsCache& tls_cache = tls_->getTyped<TlsCache>();
+      tls_cache.scope_cache_.erase(scope_id);
+      // The scope's stats may have been the last users of some tokens. Drop all cached symbols so
+      // that stale mappings for released tokens do not accumulate; they are relearned on demand.
+      tls_cache.symbols_.clear();
+    });
   }
 }
 
@@ -161,19 +185,22 @@ ThreadLocalStoreImpl::ScopeImpl::~ScopeImpl() { parent_.releaseScopeCrossThread(
 
 template <class StatType>
 StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
-    const std::string& name,
-    std::unordered_map<std::string, std::shared_ptr<StatType>>& central_cache_map,
-    MakeStatFn<StatType> make_stat, std::shared_ptr<StatType>* tls_ref) {
+    const std::string& name, StatNameHashMap<std::shared_ptr<StatType>>& central_cache_map,
+    MakeStatFn<StatType> make_stat, TlsCache* tls_cache,
+    StatNameHashMap<std::shared_ptr<StatType>>* tls_cache_map) {
 
   // If we have a valid cache entry, return it.
-  if (tls_ref && *tls_ref) {
-    return **tls_ref;
+  if (tls_cache_map) {
+    std::shared_ptr<StatType>* tls_ref = tls_cache->find(name, *tls_cache_map);
+    if (tls_ref) {
+      return **tls_ref;
+    }
   }
 
-  // We must now look in the central store so we must be locked. We grab a reference to the
-  // central store location. It might contain nothing. In this case, we allocate a new stat.
+  // We must now look in the central store so we must be locked. It might not contain the stat. In
+  // this case, we allocate a new stat and key the central store by the stat's encoded name.
   Thread::LockGuard lock(parent_.lock_);
-  std::shared_ptr<StatType>& central_ref = central_cache_map[name];
+  std::shared_ptr<StatType> central_ref = findCentral(name, central_cache_map);
   if (!central_ref) {
     std::vector<Tag> tags;
     std::string tag_extracted_name = parent_.getTagsForName(name, tags);
@@ -185,12 +212,13 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
           make_stat(parent_.heap_allocator_, name, std::move(tag_extracted_name), std::move(tags));
       ASSERT(stat != nullptr);
     }
+    central_cache_map.emplace(stat->statName(), stat);
     central_ref = stat;
   }
 
   // If we have a TLS location to store or allocation into, do it.
-  if (tls_ref) {
-    *tls_ref = central_ref;
+  if (tls_cache_map) {
+    tls_cache->insert(name, *tls_cache_map, central_ref);
   }
 
   // Finally we return the reference.
@@ -201,13 +229,13 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
   // Determine the final name based on the prefix and the passed name.
   std::string final_name = prefix_ + name;
 
-  // We now try to acquire a *reference* to the TLS cache shared pointer. This might remain null
-  // if we don't have TLS initialized currently. The de-referenced pointer might be null if there
-  // is no cache entry.
-  CounterSharedPtr* tls_ref = nullptr;
+  // We now try to acquire the TLS cache and this scope's counter map within it. These remain null
+  // if we don't have TLS initialized currently. The map might not contain the counter yet.
+  TlsCache* tls_cache = nullptr;
+  StatNameHashMap<CounterSharedPtr>* tls_cache_map = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref =
-        &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].counters_[final_name];
+    tls_cache = &parent_.tls_->getTyped<TlsCache>();
+    tls_cache_map = &tls_cache->scope_cache_[this->scope_id_].counters_;
   }
 
   return safeMakeStat<Counter>(
@@ -216,7 +244,7 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
          std::vector<Tag>&& tags) -> CounterSharedPtr {
         return allocator.makeCounter(name, std::move(tag_extracted_name), std::move(tags));
       },
-      tls_ref);
+      tls_cache, tls_cache_map);
 }
 
 void ThreadLocalStoreImpl::ScopeImpl::deliverHistogramToSinks(const Histogram& histogram,
@@ -239,9 +267,11 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
   std::string final_name = prefix_ + name;
-  GaugeSharedPtr* tls_ref = nullptr;
+  TlsCache* tls_cache = nullptr;
+  StatNameHashMap<GaugeSharedPtr>* tls_cache_map = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].gauges_[final_name];
+    tls_cache = &parent_.tls_->getTyped<TlsCache>();
+    tls_cache_map = &tls_cache->scope_cache_[this->scope_id_].gauges_;
   }
 
   return safeMakeStat<Gauge>(
@@ -250,64 +280,65 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
          std::vector<Tag>&& tags) -> GaugeSharedPtr {
         return allocator.makeGauge(name, std::move(tag_extracted_name), std::move(tags));
       },
-      tls_ref);
+      tls_cache, tls_cache_map);
 }
 
 Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
   std::string final_name = prefix_ + name;
-  ParentHistogramSharedPtr* tls_ref = nullptr;
+  TlsCache* tls_cache = nullptr;
+  StatNameHashMap<ParentHistogramSharedPtr>* tls_cache_map = nullptr;
 
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>()
-                   .scope_cache_[this->scope_id_]
-                   .parent_histograms_[final_name];
-  }
-
-  if (tls_ref && *tls_ref) {
-    return **tls_ref;
+    tls_cache = &parent_.tls_->getTyped<TlsCache>();
+    tls_cache_map = &tls_cache->scope_cache_[this->scope_id_].parent_histograms_;
+    ParentHistogramSharedPtr* tls_ref = tls_cache->find(final_name, *tls_cache_map);
+    if (tls_ref) {
+      return **tls_ref;
+    }
   }
 
   Thread::LockGuard lock(parent_.lock_);
-  ParentHistogramImplSharedPtr& central_ref = central_cache_.histograms_[final_name];
+  ParentHistogramImplSharedPtr central_ref = findCentral(final_name, central_cache_.histograms_);
   if (!central_ref) {
     std::vector<Tag> tags;
     std::string tag_extracted_name = parent_.getTagsForName(final_name, tags);
     central_ref.reset(new ParentHistogramImpl(final_name, parent_, *this,
                                               std::move(tag_extracted_name), std::move(tags)));
+    central_cache_.histograms_.emplace(central_ref->statName(), central_ref);
   }
 
-  if (tls_ref) {
-    *tls_ref = central_ref;
+  if (tls_cache_map) {
+    tls_cache->insert<ParentHistogram>(final_name, *tls_cache_map, central_ref);
   }
   return *central_ref;
 }
 
-Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(const std::string& name,
+Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(StatName name,
                                                          ParentHistogramImpl& parent) {
   // See comments in counter() which explains the logic here.
 
   // Here prefix will not be considered because, by the time ParentHistogram calls this method
-  // during recordValue, the prefix is already attached to the name.
-  TlsHistogramSharedPtr* tls_ref = nullptr;
+  // during recordValue, the prefix is already attached to the name. The name is already encoded
+  // too, so no symbol lookups are needed.
+  StatNameHashMap<TlsHistogramSharedPtr>* tls_cache_map = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].histograms_[name];
-  }
-
-  if (tls_ref && *tls_ref) {
-    return **tls_ref;
+    tls_cache_map = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].histograms_;
+    auto it = tls_cache_map->find(name);
+    if (it != tls_cache_map->end()) {
+      return *it->second;
+    }
   }
 
-  std::vector<Tag> tags;
-  std::string tag_extracted_name = parent_.getTagsForName(name, tags);
+  // The parent already has the tags extracted from this name.
   TlsHistogramSharedPtr hist_tls_ptr = std::make_shared<ThreadLocalHistogramImpl>(
-      name, std::move(tag_extracted_name), std::move(tags));
+      parent.name(), parent.tagExtractedName(), parent.tags());
 
   parent.addTlsHistogram(hist_tls_ptr);
 
-  if (tls_ref) {
-    *tls_ref = hist_tls_ptr;
+  if (tls_cache_map) {
+    tls_cache_map->emplace(hist_tls_ptr->statName(), hist_tls_ptr);
   }
   return *hist_tls_ptr;
 }
@@ -352,7 +383,7 @@ ParentHistogramImpl::~ParentHistogramImpl() {
 }
 
 void ParentHistogramImpl::recordValue(uint64_t value) {
-  Histogram& tls_histogram = tls_scope_.tlsHistogram(name(), *this);
+  Histogram& tls_histogram = tls_scope_.tlsHistogram(statName(), *this);
   tls_histogram.recordValue(value);
   parent_.deliverHistogramToSinks(*this, value);
 }
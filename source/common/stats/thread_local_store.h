@@ -11,6 +11,7 @@
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/stats/stats_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 namespace Envoy {
 namespace Stats {
@@ -107,9 +108,9 @@ public:
   // TODO(ramaraochavali): Allow direct TLS access for the advanced consumers.
   /**
    * @return a ThreadLocalHistogram within the scope's namespace.
-   * @param name name of the histogram with scope prefix attached.
+   * @param name encoded name of the histogram with scope prefix attached.
    */
-  virtual Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) PURE;
+  virtual Histogram& tlsHistogram(StatName name, ParentHistogramImpl& parent) PURE;
 };
 
 /**
@@ -136,6 +137,10 @@ public:
  *   reference the old scope which may be about to be cache flushed.
  * - Since it's possible to have overlapping scopes, we de-dup stats when counters() or gauges() is
  *   called since these are very uncommon operations.
+ * - Stat names are encoded with the process-wide symbol table, and both the central and per
+ *   thread caches are keyed by the encoded name owned by the cached stat itself, so a name is
+ *   never copied into a cache. Each thread encodes lookup names with its own SymbolCache, which
+ *   keeps the fast path lockless; only a cache miss consults the symbol table.
  * - Though this implementation is designed to work with a fixed shared memory space, it will fall
  *   back to heap allocated stats if needed. NOTE: In this case, overlapping scopes will not share
  *   the same backing store. This is to keep things simple, it could be done in the future if
@@ -196,17 +201,19 @@ public:
   Source& source() override { return source_; }
 
 private:
+  struct TlsCache;
+
   struct TlsCacheEntry {
-    std::unordered_map<std::string, CounterSharedPtr> counters_;
-    std::unordered_map<std::string, GaugeSharedPtr> gauges_;
-    std::unordered_map<std::string, TlsHistogramSharedPtr> histograms_;
-    std::unordered_map<std::string, ParentHistogramSharedPtr> parent_histograms_;
+    StatNameHashMap<CounterSharedPtr> counters_;
+    StatNameHashMap<GaugeSharedPtr> gauges_;
+    StatNameHashMap<TlsHistogramSharedPtr> histograms_;
+    StatNameHashMap<ParentHistogramSharedPtr> parent_histograms_;
   };
 
   struct CentralCacheEntry {
-    std::unordered_map<std::string, CounterSharedPtr> counters_;
-    std::unordered_map<std::string, GaugeSharedPtr> gauges_;
-    std::unordered_map<std::string, ParentHistogramImplSharedPtr> histograms_;
+    StatNameHashMap<CounterSharedPtr> counters_;
+    StatNameHashMap<GaugeSharedPtr> gauges_;
+    StatNameHashMap<ParentHistogramImplSharedPtr> histograms_;
   };
 
   struct ScopeImpl : public TlsScope {
@@ -223,7 +230,7 @@ private:
     void deliverHistogramToSinks(const Histogram& histogram, uint64_t value) override;
     Gauge& gauge(const std::string& name) override;
     Histogram& histogram(const std::string& name) override;
-    Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) override;
+    Histogram& tlsHistogram(StatName name, ParentHistogramImpl& parent) override;
 
     template <class StatType>
     using MakeStatFn =
@@ -239,14 +246,15 @@ private:
      * @param name the full name of the stat (not tag extracted).
      * @param central_cache_map a map from name to the desired object in the central cache.
      * @param make_stat a function to generate the stat object, called if it's not in cache.
-     * @param tls_ref possibly null reference to a cache entry for this stat, which will be
-     *     used if non-empty, or filled in if empty (and non-null).
+     * @param tls_cache possibly null TLS cache, used to encode name for tls_cache_map.
+     * @param tls_cache_map possibly null map from name to the desired object in the TLS cache,
+     *     which will be used if it contains the stat, or filled in if not (and non-null).
      */
     template <class StatType>
-    StatType&
-    safeMakeStat(const std::string& name,
-                 std::unordered_map<std::string, std::shared_ptr<StatType>>& central_cache_map,
-                 MakeStatFn<StatType> make_stat, std::shared_ptr<StatType>* tls_ref);
+    StatType& safeMakeStat(const std::string& name,
+                           StatNameHashMap<std::shared_ptr<StatType>>& central_cache_map,
+                           MakeStatFn<StatType> make_stat, TlsCache* tls_cache,
+                           StatNameHashMap<std::shared_ptr<StatType>>* tls_cache_map);
 
     static std::atomic<uint64_t> next_scope_id_;
 
@@ -265,6 +273,38 @@ private:
     // store. See the overview for more information. This complexity is required for lockless
     // operation in the fast path.
     std::unordered_map<uint64_t, TlsCacheEntry> scope_cache_;
+
+    // Encodes lookup names for the entries of scope_cache_ without locking the symbol table.
+    SymbolCache symbols_{SymbolTableSingleton::get()};
+
+    /**
+     * Looks up a stat by name in one of the maps of a TlsCacheEntry.
+     * @return the stat, or nullptr if it is not cached.
+     */
+    template <class StatType>
+    std::shared_ptr<StatType>* find(const std::string& name,
+                                    StatNameHashMap<std::shared_ptr<StatType>>& map) {
+      StatName stat_name;
+      if (!symbols_.encode(name, stat_name)) {
+        return nullptr;
+      }
+      auto it = map.find(stat_name);
+      return it == map.end() ? nullptr : &it->second;
+    }
+
+    /**
+     * Adds a stat to one of the maps of a TlsCacheEntry, keyed by the stat's own encoded name.
+     */
+    template <class StatType>
+    void insert(const std::string& name, StatNameHashMap<std::shared_ptr<StatType>>& map,
+                const std::shared_ptr<StatType>& stat) {
+      const StatName stat_name = stat->statName();
+      symbols_.remember(name, stat_name);
+      // An existing entry for the name must be replaced along with its key, which points into the
+      // stat being replaced.
+      map.erase(stat_name);
+      map.emplace(stat_name, stat);
+    }
   };
 
   std::string getTagsForName(const std::string& name, std::vector<Tag>& tags) const;
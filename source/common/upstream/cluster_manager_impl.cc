@@ -556,21 +556,21 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(const Cluster& cluster, ui
                                                       const HostVector& hosts_removed) {
   const auto& host_set = cluster.prioritySet().hostSetsPerPriority()[priority];
 
-  // TODO(htuch): Can we skip these copies by exporting out const shared_ptr from HostSet?
-  HostVectorConstSharedPtr hosts_copy(new HostVector(host_set->hosts()));
-  HostVectorConstSharedPtr healthy_hosts_copy(new HostVector(host_set->healthyHosts()));
-  HostsPerLocalityConstSharedPtr hosts_per_locality_copy = host_set->hostsPerLocality().clone();
-  HostsPerLocalityConstSharedPtr healthy_hosts_per_locality_copy =
-      host_set->healthyHostsPerLocality().clone();
+  // The host lists are immutable snapshots, so all workers share them with the main thread. Only
+  // the delta is copied, once, regardless of the number of workers.
+  HostVectorConstSharedPtr hosts_added_copy(new HostVector(hosts_added));
+  HostVectorConstSharedPtr hosts_removed_copy(new HostVector(hosts_removed));
 
   tls_->runOnAllThreads([
-    this, name = cluster.info()->name(), priority, hosts_copy, healthy_hosts_copy,
-    hosts_per_locality_copy, healthy_hosts_per_locality_copy,
-    locality_weights = host_set->localityWeights(), hosts_added, hosts_removed
+    this, name = cluster.info()->name(), priority, hosts = host_set->hostsPtr(),
+    healthy_hosts = host_set->healthyHostsPtr(),
+    hosts_per_locality = host_set->hostsPerLocalityPtr(),
+    healthy_hosts_per_locality = host_set->healthyHostsPerLocalityPtr(),
+    locality_weights = host_set->localityWeights(), hosts_added_copy, hosts_removed_copy
   ]() {
     ThreadLocalClusterManagerImpl::updateClusterMembership(
-        name, priority, hosts_copy, healthy_hosts_copy, hosts_per_locality_copy,
-        healthy_hosts_per_locality_copy, locality_weights, hosts_added, hosts_removed, *tls_);
+        name, priority, hosts, healthy_hosts, hosts_per_locality, healthy_hosts_per_locality,
+        locality_weights, *hosts_added_copy, *hosts_removed_copy, *tls_);
   });
 }
 
@@ -414,11 +414,10 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
     : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
                                 common_config),
       seed_(random_.random()) {
-  // We fully recompute the schedulers for a given host set here on membership change, which is
-  // consistent with what other LB implementations do (e.g. thread aware).
-  // The downside of a full recompute is that time complexity is O(n * log n),
-  // so we will need to do better at delta tracking to scale (see
-  // https://github.com/envoyproxy/envoy/issues/2874).
+  // Schedulers are brought in line with the new host lists on membership change. Host lists that
+  // are unchanged (by identity) are skipped, and the others are diffed against the existing
+  // schedule, so only added hosts are inserted. See
+  // https://github.com/envoyproxy/envoy/issues/2874.
   priority_set.addMemberUpdateCb(
       [this](uint32_t priority, const HostVector&, const HostVector&) { refresh(priority); });
 }
@@ -430,45 +429,120 @@ void EdfLoadBalancerBase::initialize() {
 }
 
 void EdfLoadBalancerBase::refresh(uint32_t priority) {
-  const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
-    // Nuke existing scheduler if it exists.
-    auto& scheduler = scheduler_[source] = Scheduler{};
+  const auto update_hosts_source = [this](HostsSource source, const HostVector& hosts) {
+    auto scheduler_it = scheduler_.find(source);
+    if (scheduler_it == scheduler_.end()) {
+      scheduler_it = scheduler_.emplace(source, Scheduler{}).first;
+    }
     refreshHostSource(source);
+    updateScheduler(scheduler_it->second, hosts);
+  };
+
+  if (snapshots_.size() <= priority) {
+    snapshots_.resize(priority + 1);
+  }
+  PrioritySnapshot& snapshot = snapshots_[priority];
+
+  // Populate EdfSchedulers for each valid HostsSource value for the host set at this priority.
+  const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
+  HostVectorConstSharedPtr hosts = host_set->hostsPtr();
+  if (hosts != snapshot.hosts_) {
+    update_hosts_source(HostsSource(priority, HostsSource::SourceType::AllHosts),
+                        host_set->hosts());
+    snapshot.hosts_ = std::move(hosts);
+  }
+  HostVectorConstSharedPtr healthy_hosts = host_set->healthyHostsPtr();
+  if (healthy_hosts != snapshot.healthy_hosts_) {
+    update_hosts_source(HostsSource(priority, HostsSource::SourceType::HealthyHosts),
+                        host_set->healthyHosts());
+    snapshot.healthy_hosts_ = std::move(healthy_hosts);
+  }
+  HostsPerLocalityConstSharedPtr healthy_hosts_per_locality =
+      host_set->healthyHostsPerLocalityPtr();
+  if (healthy_hosts_per_locality != snapshot.healthy_hosts_per_locality_) {
+    for (uint32_t locality_index = 0;
+         locality_index < host_set->healthyHostsPerLocality().get().size(); ++locality_index) {
+      update_hosts_source(
+          HostsSource(priority, HostsSource::SourceType::LocalityHealthyHosts, locality_index),
+          host_set->healthyHostsPerLocality().get()[locality_index]);
+    }
+    snapshot.healthy_hosts_per_locality_ = std::move(healthy_hosts_per_locality);
+  }
+}
 
-    // Populate scheduler with host list.
-    // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
-    // weighted 1. This is because currently we don't refresh host sets if only weights change.
-    // We should probably change this to refresh at all times. See the comment in
-    // BaseDynamicClusterImpl::updateDynamicHostList about this.
-    for (const auto& host : hosts) {
-      // We use a fixed weight here. While the weight may change without
-      // notification, this will only be stale until this host is next picked,
-      // at which point it is reinserted into the EdfScheduler with its new
-      // weight in chooseHost().
-      scheduler.edf_.add(hostWeight(*host), host);
+void EdfLoadBalancerBase::buildScheduler(Scheduler& scheduler, const HostVector& hosts) {
+  // Nuke existing scheduler if it exists.
+  scheduler = Scheduler{};
+
+  // Populate scheduler with host list.
+  // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
+  // weighted 1. This is because currently we don't refresh host sets if only weights change.
+  // We should probably change this to refresh at all times. See the comment in
+  // BaseDynamicClusterImpl::updateDynamicHostList about this.
+  scheduler.entries_.reserve(hosts.size());
+  for (const auto& host : hosts) {
+    // We use a fixed weight here. While the weight may change without
+    // notification, this will only be stale until this host is next picked,
+    // at which point it is reinserted into the EdfScheduler with its new
+    // weight in chooseHost().
+    auto entry = std::make_shared<Scheduler::Entry>(host, scheduler.generation_);
+    if (scheduler.entries_.emplace(host.get(), entry).second) {
+      scheduler.edf_.add(hostWeight(*host), entry);
     }
+  }
 
-    // Cycle through hosts to achieve the intended offset behavior.
-    // TODO(htuch): Consider how we can avoid biasing towards earlier hosts in the schedule across
-    // refreshes for the weighted case.
-    if (!hosts.empty()) {
-      for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
-        auto host = scheduler.edf_.pick();
-        scheduler.edf_.add(hostWeight(*host), host);
+  // Cycle through hosts to achieve the intended offset behavior.
+  // TODO(htuch): Consider how we can avoid biasing towards earlier hosts in the schedule across
+  // refreshes for the weighted case.
+  if (!hosts.empty()) {
+    for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
+      auto entry = scheduler.edf_.pick();
+      scheduler.edf_.add(hostWeight(*entry->host_), entry);
+    }
+  }
+}
+
+void EdfLoadBalancerBase::updateScheduler(Scheduler& scheduler, const HostVector& hosts) {
+  // Mark the hosts that are already scheduled and collect the ones that are not.
+  const uint64_t generation = ++scheduler.generation_;
+  HostVector hosts_added;
+  uint64_t hosts_kept = 0;
+  for (const auto& host : hosts) {
+    auto entry_it = scheduler.entries_.find(host.get());
+    if (entry_it == scheduler.entries_.end()) {
+      hosts_added.push_back(host);
+    } else if (entry_it->second->generation_ != generation) {
+      entry_it->second->generation_ = generation;
+      ++hosts_kept;
+    }
+  }
+
+  const uint64_t hosts_removed = scheduler.entries_.size() - hosts_kept;
+  // If nothing from the old schedule survives, or dropped entries would come to outnumber live
+  // ones, start over. This also keeps the unweighted case, where edf_ is never popped, from
+  // accumulating dropped entries.
+  if (hosts_kept == 0 || scheduler.dropped_entries_ + hosts_removed > hosts.size()) {
+    buildScheduler(scheduler, hosts);
+    return;
+  }
+
+  if (hosts_removed > 0) {
+    for (auto entry_it = scheduler.entries_.begin(); entry_it != scheduler.entries_.end();) {
+      if (entry_it->second->generation_ != generation) {
+        entry_it = scheduler.entries_.erase(entry_it);
+      } else {
+        ++entry_it;
       }
     }
-  };
+    scheduler.dropped_entries_ += hosts_removed;
+  }
 
-  // Populate EdfSchedulers for each valid HostsSource value for the host set at this priority.
-  const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
-  add_hosts_source(HostsSource(priority, HostsSource::SourceType::AllHosts), host_set->hosts());
-  add_hosts_source(HostsSource(priority, HostsSource::SourceType::HealthyHosts),
-                   host_set->healthyHosts());
-  for (uint32_t locality_index = 0;
-       locality_index < host_set->healthyHostsPerLocality().get().size(); ++locality_index) {
-    add_hosts_source(
-        HostsSource(priority, HostsSource::SourceType::LocalityHealthyHosts, locality_index),
-        host_set->healthyHostsPerLocality().get()[locality_index]);
+  // New hosts are scheduled relative to the current time, so they join the next round of picks.
+  for (const auto& host : hosts_added) {
+    auto entry = std::make_shared<Scheduler::Entry>(host, generation);
+    if (scheduler.entries_.emplace(host.get(), entry).second) {
+      scheduler.edf_.add(hostWeight(*host), entry);
+    }
   }
 }
 
@@ -488,11 +562,12 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHost(LoadBalancerContext*) {
   // the same but not 1 (like 42), we will use the EDF schedule not the unweighted pick. This is
   // not optimal. If this is fixed, remove the note in the arch overview docs for the LR LB.
   if (stats_.max_host_weight_.value() != 1) {
-    auto host = scheduler.edf_.pick();
-    if (host != nullptr) {
-      scheduler.edf_.add(hostWeight(*host), host);
+    auto entry = scheduler.edf_.pick();
+    if (entry == nullptr) {
+      return nullptr;
     }
-    return host;
+    scheduler.edf_.add(hostWeight(*entry->host_), entry);
+    return entry->host_;
   } else {
     const HostVector& hosts_to_use = hostSourceToHosts(hosts_source);
     if (hosts_to_use.size() == 0) {
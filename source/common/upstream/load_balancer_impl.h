@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <queue>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/api/v2/cds.pb.h"
@@ -232,8 +233,32 @@ public:
 
 protected:
   struct Scheduler {
+    // A host's place in the schedule. The EdfScheduler only holds weak references, so dropping the
+    // entry from entries_ lazily removes the host from the schedule.
+    struct Entry {
+      Entry(const HostSharedPtr& host, uint64_t generation)
+          : host_(host), generation_(generation) {}
+
+      const HostSharedPtr host_;
+      // Last synchronization in which the host was present in the host list.
+      uint64_t generation_;
+    };
+
     // EdfScheduler for weighted LB.
-    EdfScheduler<const Host> edf_;
+    EdfScheduler<Entry> edf_;
+    // Live schedule entries, keyed by host.
+    std::unordered_map<const Host*, std::shared_ptr<Entry>> entries_;
+    uint64_t generation_{};
+    // Number of entries dropped since the schedule was last built from scratch. These linger in
+    // edf_ until they are popped.
+    uint64_t dropped_entries_{};
+  };
+
+  // Host list snapshots that the schedulers of a priority were last synchronized with.
+  struct PrioritySnapshot {
+    HostVectorConstSharedPtr hosts_;
+    HostVectorConstSharedPtr healthy_hosts_;
+    HostsPerLocalityConstSharedPtr healthy_hosts_per_locality_;
   };
 
   void initialize();
@@ -247,6 +272,8 @@ protected:
 
 private:
   void refresh(uint32_t priority);
+  void buildScheduler(Scheduler& scheduler, const HostVector& hosts);
+  void updateScheduler(Scheduler& scheduler, const HostVector& hosts);
   virtual void refreshHostSource(const HostsSource& source) PURE;
   virtual double hostWeight(const Host& host) PURE;
   virtual HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
@@ -254,6 +281,8 @@ private:
 
   // Scheduler for each valid HostsSource.
   std::unordered_map<HostsSource, Scheduler, HostsSourceHash> scheduler_;
+  // Indexed by priority.
+  std::vector<PrioritySnapshot> snapshots_;
 };
 
 /**
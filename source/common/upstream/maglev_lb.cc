@@ -103,5 +103,46 @@ uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
   return (entry.offset_ + (entry.skip_ * entry.next_)) % table_size_;
 }
 
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+MaglevLoadBalancer::createLoadBalancer(const HostSet& host_set) {
+  // Note that we only compute global panic on host set refresh. Given that the runtime setting
+  // will rarely change, this is a reasonable compromise to avoid creating extra LBs when we only
+  // need to create one per priority level.
+  const bool global_panic = isGlobalPanic(host_set);
+  const bool has_locality =
+      host_set.localityWeights() != nullptr && !host_set.localityWeights()->empty();
+  TableCacheEntry inputs;
+  if (!has_locality) {
+    inputs.hosts_ = global_panic ? host_set.hostsPtr() : host_set.healthyHostsPtr();
+  } else {
+    inputs.hosts_per_locality_ =
+        global_panic ? host_set.hostsPerLocalityPtr() : host_set.healthyHostsPerLocalityPtr();
+    inputs.locality_weights_ = host_set.localityWeights();
+  }
+
+  // Every host contributes to the table's fill order, so a table can't be patched when its hosts
+  // change. It is only rebuilt when the inputs change though, e.g. a health change while in panic
+  // mode leaves the table alone.
+  if (tables_.size() <= host_set.priority()) {
+    tables_.resize(host_set.priority() + 1);
+  }
+  TableCacheEntry& cached = tables_[host_set.priority()];
+  if (cached.table_ != nullptr && cached.hosts_ == inputs.hosts_ &&
+      cached.hosts_per_locality_ == inputs.hosts_per_locality_ &&
+      cached.locality_weights_ == inputs.locality_weights_) {
+    return cached.table_;
+  }
+
+  if (!has_locality) {
+    inputs.table_ = std::make_shared<MaglevTable>(HostsPerLocalityImpl(*inputs.hosts_, false),
+                                                  nullptr, table_size_);
+  } else {
+    inputs.table_ = std::make_shared<MaglevTable>(*inputs.hosts_per_locality_,
+                                                  inputs.locality_weights_, table_size_);
+  }
+  cached = std::move(inputs);
+  return cached.table_;
+}
+
 } // namespace Upstream
 } // namespace Envoy
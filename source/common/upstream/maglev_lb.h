@@ -57,33 +57,21 @@ public:
         table_size_(table_size) {}
 
 private:
+  // The inputs a table was built from. Host lists are immutable snapshots, so a table can be
+  // reused for as long as its inputs are the same objects.
+  struct TableCacheEntry {
+    HostVectorConstSharedPtr hosts_;
+    HostsPerLocalityConstSharedPtr hosts_per_locality_;
+    LocalityWeightsConstSharedPtr locality_weights_;
+    HashingLoadBalancerSharedPtr table_;
+  };
+
   // ThreadAwareLoadBalancerBase
-  HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) override {
-    // Note that we only compute global panic on host set refresh. Given that the runtime setting
-    // will rarely change, this is a reasonable compromise to avoid creating extra LBs when we only
-    // need to create one per priority level.
-    const bool has_locality =
-        host_set.localityWeights() != nullptr && !host_set.localityWeights()->empty();
-    if (isGlobalPanic(host_set)) {
-      if (!has_locality) {
-        return std::make_shared<MaglevTable>(HostsPerLocalityImpl(host_set.hosts(), false), nullptr,
-                                             table_size_);
-      } else {
-        return std::make_shared<MaglevTable>(host_set.hostsPerLocality(),
-                                             host_set.localityWeights(), table_size_);
-      }
-    } else {
-      if (!has_locality) {
-        return std::make_shared<MaglevTable>(HostsPerLocalityImpl(host_set.healthyHosts(), false),
-                                             nullptr, table_size_);
-      } else {
-        return std::make_shared<MaglevTable>(host_set.healthyHostsPerLocality(),
-                                             host_set.localityWeights(), table_size_);
-      }
-    }
-  }
+  HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) override;
 
   const uint64_t table_size_;
+  // Last table built for each priority.
+  std::vector<TableCacheEntry> tables_;
 };
 
 } // namespace Upstream
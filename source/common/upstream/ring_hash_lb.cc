@@ -1,7 +1,12 @@
 #include "common/upstream/ring_hash_lb.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
+#include <numeric>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "common/common/assert.h"
@@ -12,6 +17,41 @@
 namespace Envoy {
 namespace Upstream {
 
+namespace {
+
+/**
+ * Calls cb(k) for every position k of an Eytzinger laid out array of the given size (positions 1
+ * through size), in sorted order. This is an in-order walk of the implicit tree.
+ */
+template <class Callback> void forEachInOrder(size_t size, Callback cb) {
+  if (size == 0) {
+    return;
+  }
+  size_t k = 1;
+  while (2 * k <= size) {
+    k = 2 * k;
+  }
+  while (k != 0) {
+    cb(k);
+    if (2 * k + 1 <= size) {
+      // Next is the leftmost node of the right subtree.
+      k = 2 * k + 1;
+      while (2 * k <= size) {
+        k = 2 * k;
+      }
+    } else {
+      // Next is the first ancestor this node is in the left subtree of. Going past the root ends
+      // the walk.
+      while ((k & 1) != 0) {
+        k >>= 1;
+      }
+      k >>= 1;
+    }
+  }
+}
+
+} // namespace
+
 RingHashLoadBalancer::RingHashLoadBalancer(
     PrioritySet& priority_set, ClusterStats& stats, Runtime::Loader& runtime,
     Runtime::RandomGenerator& random,
@@ -20,80 +60,134 @@ RingHashLoadBalancer::RingHashLoadBalancer(
     : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
       config_(config) {}
 
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+RingHashLoadBalancer::createLoadBalancer(const HostSet& host_set) {
+  // Note that we only compute global panic on host set refresh. Given that the runtime setting
+  // will rarely change, this is a reasonable compromise to avoid creating extra LBs when we only
+  // need to create one per priority level.
+  HostVectorConstSharedPtr hosts =
+      isGlobalPanic(host_set) ? host_set.hostsPtr() : host_set.healthyHostsPtr();
+
+  if (rings_.size() <= host_set.priority()) {
+    rings_.resize(host_set.priority() + 1);
+  }
+  RingSharedPtr& ring = rings_[host_set.priority()];
+  // The host lists are immutable snapshots, so an unchanged list keeps its ring.
+  if (ring == nullptr || ring->hosts_ != hosts) {
+    ring = std::make_shared<Ring>(config_, std::move(hosts), ring.get());
+  }
+  return ring;
+}
+
 HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h) const {
-  if (ring_.empty()) {
+  const size_t ring_size = size();
+  if (ring_size == 0) {
     return nullptr;
   }
 
-  // Ported from https://github.com/RJ/ketama/blob/master/libketama/ketama.c (ketama_get_server)
-  // I've generally kept the variable names to make the code easier to compare.
-  // NOTE: The algorithm depends on using signed integers for lowp, midp, and highp. Do not
-  //       change them!
-  int64_t lowp = 0;
-  int64_t highp = ring_.size();
-  while (true) {
-    int64_t midp = (lowp + highp) / 2;
-
-    if (midp == static_cast<int64_t>(ring_.size())) {
-      return ring_[0].host_;
-    }
-
-    uint64_t midval = ring_[midp].hash_;
-    uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
-
-    if (h <= midval && h > midval1) {
-      return ring_[midp].host_;
-    }
-
-    if (midval < h) {
-      lowp = midp + 1;
-    } else {
-      highp = midp - 1;
-    }
-
-    if (lowp > highp) {
-      return ring_[0].host_;
-    }
+  // Like ketama_get_server() in https://github.com/RJ/ketama/blob/master/libketama/ketama.c, pick
+  // the first entry whose hash is >= h, wrapping around to the first entry of the ring if there is
+  // none. Walking down the tree goes right past entries < h and left otherwise, so the answer is
+  // the last node where the walk went left. The branch is data independent, which lets the
+  // compiler turn it into a conditional move.
+  size_t k = 1;
+  while (k <= ring_size) {
+    k = 2 * k + (hashes_[k] < h);
   }
+  // Drop the trailing right turns and the final left turn to get back to that node. k is 0 when
+  // the walk never went left, i.e. every hash is < h.
+  k >>= __builtin_ffsll(static_cast<long long>(~k));
+  return (*hosts_)[k == 0 ? first_host_index_ : host_indexes_[k]];
 }
 
 RingHashLoadBalancer::Ring::Ring(
     const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& config,
-    const HostVector& hosts) {
+    HostVectorConstSharedPtr hosts, const Ring* previous)
+    : hosts_(std::move(hosts)) {
   ENVOY_LOG(trace, "ring hash: building ring");
-  if (hosts.empty()) {
+  if (hosts_->empty()) {
     return;
   }
 
   // Currently we specify the minimum size of the ring, and determine the replication factor
   // based on the number of hosts. It's possible we might want to support more sophisticated
   // configuration in the future.
-  // NOTE: Currently we keep a ring for healthy hosts and unhealthy hosts, and this is done per
-  //       thread. This is the simplest implementation, but it's expensive from a memory
-  //       standpoint and duplicates the regeneration computation. In the future we might want
-  //       to generate the rings centrally and then just RCU them out to each thread. This is
-  //       sufficient for getting started.
+  // NOTE: Rings are built on the main thread and shared with all workers, see
+  //       ThreadAwareLoadBalancerBase.
   const uint64_t min_ring_size =
       config ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.value(), minimum_ring_size, 1024) : 1024;
 
-  uint64_t hashes_per_host = 1;
-  if (hosts.size() < min_ring_size) {
-    hashes_per_host = min_ring_size / hosts.size();
-    if ((min_ring_size % hosts.size()) != 0) {
-      hashes_per_host++;
+  hashes_per_host_ = 1;
+  if (hosts_->size() < min_ring_size) {
+    hashes_per_host_ = min_ring_size / hosts_->size();
+    if ((min_ring_size % hosts_->size()) != 0) {
+      hashes_per_host_++;
     }
   }
 
-  ENVOY_LOG(info, "ring hash: min_ring_size={} hashes_per_host={}", min_ring_size, hashes_per_host);
-  ring_.reserve(hosts.size() * hashes_per_host);
+  ENVOY_LOG(info, "ring hash: min_ring_size={} hashes_per_host={}", min_ring_size,
+            hashes_per_host_);
+  RELEASE_ASSERT(hosts_->size() <= std::numeric_limits<uint32_t>::max());
+  std::vector<RingEntry> ring;
+  ring.reserve(hosts_->size() * hashes_per_host_);
+
+  // If the previous ring used the same number of hashes per host, entries for hosts that are still
+  // present are identical and carried over with their host index remapped, and only the hosts that
+  // were added need hashing. Hosts listed more than once get one set of entries per listing, which
+  // the carried over entries can't account for, so that case is built from scratch.
+  std::vector<uint32_t> indexes_to_hash;
+  bool carried_over = false;
+  if (previous != nullptr && previous->hashes_per_host_ == hashes_per_host_) {
+    std::unordered_map<const Host*, uint32_t> current_hosts;
+    current_hosts.reserve(hosts_->size());
+    for (uint32_t i = 0; i < hosts_->size(); i++) {
+      current_hosts.emplace((*hosts_)[i].get(), i);
+    }
+
+    // New index of each previous host, or hosts_->size() if it was removed.
+    const uint32_t removed = hosts_->size();
+    std::vector<uint32_t> new_indexes(previous->hosts_->size(), removed);
+    std::unordered_set<const Host*> previous_hosts;
+    previous_hosts.reserve(previous->hosts_->size());
+    for (uint32_t i = 0; i < previous->hosts_->size(); i++) {
+      const Host* host = (*previous->hosts_)[i].get();
+      previous_hosts.insert(host);
+      const auto it = current_hosts.find(host);
+      if (it != current_hosts.end()) {
+        new_indexes[i] = it->second;
+      }
+    }
+
+    if (current_hosts.size() == hosts_->size() &&
+        previous_hosts.size() == previous->hosts_->size()) {
+      for (const RingEntry& entry : previous->sortedEntries()) {
+        const uint32_t new_index = new_indexes[entry.host_index_];
+        if (new_index != removed) {
+          ring.push_back({entry.hash_, new_index});
+        }
+      }
+      for (uint32_t i = 0; i < hosts_->size(); i++) {
+        if (previous_hosts.count((*hosts_)[i].get()) == 0) {
+          indexes_to_hash.push_back(i);
+        }
+      }
+      carried_over = true;
+    }
+  }
+  if (!carried_over) {
+    indexes_to_hash.resize(hosts_->size());
+    std::iota(indexes_to_hash.begin(), indexes_to_hash.end(), 0);
+  }
 
   const bool use_std_hash =
       config ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.value().deprecated_v1(), use_std_hash, true)
              : true;
 
+  std::vector<RingEntry> new_entries;
+  new_entries.reserve(indexes_to_hash.size() * hashes_per_host_);
   char hash_key_buffer[196];
-  for (const auto& host : hosts) {
-    const std::string& address_string = host->address()->asString();
+  for (const uint32_t host_index : indexes_to_hash) {
+    const std::string& address_string = (*hosts_)[host_index]->address()->asString();
     uint64_t offset_start = address_string.size();
 
     // Currently, we support both IP and UDS addresses. The UDS max path length is ~108 on all Unix
@@ -107,7 +201,7 @@ RingHashLoadBalancer::Ring::Ring(
                    sizeof(hash_key_buffer));
     memcpy(hash_key_buffer, address_string.c_str(), offset_start);
     hash_key_buffer[offset_start++] = '_';
-    for (uint64_t i = 0; i < hashes_per_host; i++) {
+    for (uint64_t i = 0; i < hashes_per_host_; i++) {
       const uint64_t total_hash_key_len =
           offset_start +
           StringUtil::itoa(hash_key_buffer + offset_start, StringUtil::MIN_ITOA_OUT_LEN, i);
@@ -118,20 +212,48 @@ RingHashLoadBalancer::Ring::Ring(
       const uint64_t hash = use_std_hash ? std::hash<std::string>()(std::string(hash_key))
                                          : HashUtil::xxHash64(hash_key);
       ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
-      ring_.push_back({hash, host});
+      new_entries.push_back({hash, host_index});
     }
   }
 
-  std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
+  const auto entry_less = [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
     return lhs.hash_ < rhs.hash_;
-  });
+  };
+  std::sort(new_entries.begin(), new_entries.end(), entry_less);
+  if (ring.empty()) {
+    ring = std::move(new_entries);
+  } else if (!new_entries.empty()) {
+    // Both halves are sorted, so a linear merge keeps the ring sorted.
+    const size_t carried_over_size = ring.size();
+    ring.insert(ring.end(), new_entries.begin(), new_entries.end());
+    std::inplace_merge(ring.begin(), ring.begin() + carried_over_size, ring.end(), entry_less);
+  }
 
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
-    for (auto entry : ring_) {
-      ENVOY_LOG(trace, "ring hash: host={} hash={}", entry.host_->address()->asString(),
-                entry.hash_);
+    for (const RingEntry& entry : ring) {
+      ENVOY_LOG(trace, "ring hash: host={} hash={}",
+                (*hosts_)[entry.host_index_]->address()->asString(), entry.hash_);
     }
   }
+
+  hashes_.resize(ring.size() + 1);
+  host_indexes_.resize(ring.size() + 1);
+  size_t i = 0;
+  forEachInOrder(ring.size(), [this, &ring, &i](size_t k) {
+    hashes_[k] = ring[i].hash_;
+    host_indexes_[k] = ring[i].host_index_;
+    i++;
+  });
+  first_host_index_ = ring[0].host_index_;
+}
+
+std::vector<RingHashLoadBalancer::RingEntry> RingHashLoadBalancer::Ring::sortedEntries() const {
+  std::vector<RingEntry> entries;
+  entries.reserve(size());
+  forEachInOrder(size(), [this, &entries](size_t k) {
+    entries.push_back({hashes_[k], host_indexes_[k]});
+  });
+  return entries;
 }
 
 } // namespace Upstream
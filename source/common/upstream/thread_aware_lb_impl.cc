@@ -11,23 +11,34 @@ void ThreadAwareLoadBalancerBase::initialize() {
   // complicated initialization as the load balancer would need its own initialized callback. I
   // think the synchronous/asynchronous split is probably the best option.
   priority_set_.addMemberUpdateCb(
-      [this](uint32_t, const HostVector&, const HostVector&) -> void { refresh(); });
+      [this](uint32_t priority, const HostVector&, const HostVector&) -> void {
+        refresh(priority);
+      });
 
-  refresh();
+  refresh({});
 }
 
-void ThreadAwareLoadBalancerBase::refresh() {
-  auto per_priority_state_vector = std::make_shared<std::vector<PerPriorityStatePtr>>(
+void ThreadAwareLoadBalancerBase::refresh(absl::optional<uint32_t> priority) {
+  auto per_priority_state_vector = std::make_shared<std::vector<PerPriorityStateSharedPtr>>(
       priority_set_.hostSetsPerPriority().size());
   auto per_priority_load = std::make_shared<std::vector<uint32_t>>(per_priority_load_);
 
   for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
-    const uint32_t priority = host_set->priority();
-    (*per_priority_state_vector)[priority].reset(new PerPriorityState);
-    const auto& per_priority_state = (*per_priority_state_vector)[priority];
+    const uint32_t i = host_set->priority();
+    // Note that global panic is only recomputed along with the load balancer of a priority. Given
+    // that the runtime setting will rarely change, this is a reasonable compromise to avoid
+    // rebuilding load balancers for priorities whose hosts did not change.
+    if (priority && priority.value() != i && current_per_priority_state_ != nullptr &&
+        i < current_per_priority_state_->size()) {
+      (*per_priority_state_vector)[i] = (*current_per_priority_state_)[i];
+      continue;
+    }
+    auto per_priority_state = std::make_shared<PerPriorityState>();
     per_priority_state->current_lb_ = createLoadBalancer(*host_set);
     per_priority_state->global_panic_ = isGlobalPanic(*host_set);
+    (*per_priority_state_vector)[i] = std::move(per_priority_state);
   }
+  current_per_priority_state_ = per_priority_state_vector;
 
   {
     std::unique_lock<std::shared_timed_mutex> lock(factory_->mutex_);
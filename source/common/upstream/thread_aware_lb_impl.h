@@ -40,7 +40,8 @@ private:
     std::shared_ptr<HashingLoadBalancer> current_lb_;
     bool global_panic_{};
   };
-  typedef std::unique_ptr<PerPriorityState> PerPriorityStatePtr;
+  // Shared so that the state of priorities that did not change carries over between refreshes.
+  typedef std::shared_ptr<const PerPriorityState> PerPriorityStateSharedPtr;
 
   struct LoadBalancerImpl : public LoadBalancer {
     LoadBalancerImpl(ClusterStats& stats, Runtime::RandomGenerator& random)
@@ -51,7 +52,7 @@ private:
 
     ClusterStats& stats_;
     Runtime::RandomGenerator& random_;
-    std::shared_ptr<std::vector<PerPriorityStatePtr>> per_priority_state_;
+    std::shared_ptr<std::vector<PerPriorityStateSharedPtr>> per_priority_state_;
     std::shared_ptr<std::vector<uint32_t>> per_priority_load_;
   };
 
@@ -68,15 +69,19 @@ private:
     // TOOD(mattklein123): Added GUARDED_BY(mutex_) to to the following variables. OSX clang
     // seems to not like them with shared mutexes so we need to ifdef them out on OSX. I don't
     // have time to do this right now.
-    std::shared_ptr<std::vector<PerPriorityStatePtr>> per_priority_state_;
+    std::shared_ptr<std::vector<PerPriorityStateSharedPtr>> per_priority_state_;
     // This is split out of PerPriorityState so LoadBalancerBase::ChoosePriorirty can be reused.
     std::shared_ptr<std::vector<uint32_t>> per_priority_load_;
   };
 
   virtual HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) PURE;
-  void refresh();
+  // Rebuilds the state for the given priority, or for all priorities if none is given. Priorities
+  // that already have state and are not being rebuilt share it with the previous refresh.
+  void refresh(absl::optional<uint32_t> priority);
 
   std::shared_ptr<LoadBalancerFactoryImpl> factory_;
+  // Last state handed to factory_. Only accessed from the main thread.
+  std::shared_ptr<std::vector<PerPriorityStateSharedPtr>> current_per_priority_state_;
 };
 
 } // namespace Upstream
@@ -571,12 +571,12 @@ void ClusterImplBase::reloadHealthyHosts() {
   }
 
   for (auto& host_set : prioritySet().hostSetsPerPriority()) {
-    // TODO(htuch): Can we skip these copies by exporting out const shared_ptr from HostSet?
-    HostVectorConstSharedPtr hosts_copy(new HostVector(host_set->hosts()));
-    HostsPerLocalityConstSharedPtr hosts_per_locality_copy = host_set->hostsPerLocality().clone();
-    host_set->updateHosts(
-        hosts_copy, createHealthyHostList(host_set->hosts()), hosts_per_locality_copy,
-        createHealthyHostLists(host_set->hostsPerLocality()), host_set->localityWeights(), {}, {});
+    // Membership is unchanged, so the existing host snapshots are passed through as is. This also
+    // lets load balancers tell by identity that only the healthy host lists need refreshing.
+    host_set->updateHosts(host_set->hostsPtr(), createHealthyHostList(host_set->hosts()),
+                          host_set->hostsPerLocalityPtr(),
+                          createHealthyHostLists(host_set->hostsPerLocality()),
+                          host_set->localityWeights(), {}, {});
   }
 }
 
@@ -0,0 +1,311 @@
+#include "extensions/filters/common/ext_authz/check_cache.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+namespace {
+
+// The decisions cached per worker if max_entries is not set.
+constexpr uint32_t DefaultMaxEntries = 1000;
+
+const std::string HeaderAttributePrefix = "request.http.headers.";
+
+// Values are length prefixed, so that the values of adjacent attributes can't run into each
+// other.
+void appendValue(const std::string& value, std::string& key) {
+  key.append(std::to_string(value.size()));
+  key.push_back(':');
+  key.append(value);
+}
+
+std::string peerAddress(const envoy::service::auth::v2alpha::AttributeContext::Peer& peer,
+                        bool with_port) {
+  const auto& address = peer.address();
+  if (address.has_pipe()) {
+    return address.pipe().path();
+  }
+  if (!with_port) {
+    return address.socket_address().address();
+  }
+  return fmt::format("{}:{}", address.socket_address().address(),
+                     address.socket_address().port_value());
+}
+
+} // namespace
+
+CheckKeyBuilder::CheckKeyBuilder(
+    const Protobuf::RepeatedPtrField<ProtobufTypes::String>& attributes) {
+  for (const auto& attribute : attributes) {
+    appenders_.push_back(createAppender(attribute));
+  }
+}
+
+CheckKeyBuilder::AttributeAppender CheckKeyBuilder::createAppender(const std::string& attribute) {
+  typedef envoy::service::auth::v2alpha::AttributeContext AttributeContext;
+
+  if (absl::StartsWith(attribute, HeaderAttributePrefix)) {
+    const std::string header =
+        absl::AsciiStrToLower(attribute.substr(HeaderAttributePrefix.size()));
+    return [header](const AttributeContext& attributes, std::string& key) {
+      const auto& headers = attributes.request().http().headers();
+      const auto it = headers.find(header);
+      if (it == headers.end()) {
+        // Tell a missing header from an empty one.
+        key.push_back('-');
+      } else {
+        appendValue(it->second, key);
+      }
+    };
+  }
+
+  static const std::unordered_map<std::string,
+                                  std::function<std::string(const AttributeContext&)>>
+      getters = {
+          {"source.address",
+           [](const AttributeContext& a) { return peerAddress(a.source(), true); }},
+          {"source.ip", [](const AttributeContext& a) { return peerAddress(a.source(), false); }},
+          {"source.principal", [](const AttributeContext& a) { return a.source().principal(); }},
+          {"source.service", [](const AttributeContext& a) { return a.source().service(); }},
+          {"destination.address",
+           [](const AttributeContext& a) { return peerAddress(a.destination(), true); }},
+          {"destination.ip",
+           [](const AttributeContext& a) { return peerAddress(a.destination(), false); }},
+          {"destination.principal",
+           [](const AttributeContext& a) { return a.destination().principal(); }},
+          {"destination.service",
+           [](const AttributeContext& a) { return a.destination().service(); }},
+          {"request.http.method",
+           [](const AttributeContext& a) { return a.request().http().method(); }},
+          {"request.http.path",
+           [](const AttributeContext& a) { return a.request().http().path(); }},
+          {"request.http.host",
+           [](const AttributeContext& a) { return a.request().http().host(); }},
+          {"request.http.scheme",
+           [](const AttributeContext& a) { return a.request().http().scheme(); }},
+          {"request.http.protocol",
+           [](const AttributeContext& a) { return a.request().http().protocol(); }},
+      };
+
+  const auto it = getters.find(attribute);
+  if (it == getters.end()) {
+    throw EnvoyException(fmt::format("ext_authz: unsupported check cache key attribute '{}'",
+                                     attribute));
+  }
+  const auto& getter = it->second;
+  return [&getter](const AttributeContext& attributes, std::string& key) {
+    appendValue(getter(attributes), key);
+  };
+}
+
+std::string
+CheckKeyBuilder::build(const envoy::service::auth::v2alpha::CheckRequest& request) const {
+  std::string key;
+  for (const auto& appender : appenders_) {
+    appender(request.attributes(), key);
+  }
+  return key;
+}
+
+PendingCheck::PendingCheck(CheckCache& parent, const std::string& key, ClientPtr&& client)
+    : parent_(parent), key_(key), client_(std::move(client)) {}
+
+void PendingCheck::check(const envoy::service::auth::v2alpha::CheckRequest& request,
+                         Tracing::Span& parent_span) {
+  client_->check(*this, request, parent_span);
+}
+
+void PendingCheck::cancel() {
+  if (!complete_) {
+    complete_ = true;
+    client_->cancel();
+  }
+}
+
+void PendingCheck::removeWaiter(RequestCallbacks& callbacks) {
+  waiters_.remove(&callbacks);
+  if (waiters_.empty() && !complete_) {
+    cancel();
+    parent_.removePending(key_);
+  }
+}
+
+void PendingCheck::onComplete(CheckStatus status) {
+  complete_ = true;
+  // A decision is only reused if the authorization service made one.
+  if (status != CheckStatus::Error && cache_ttl_.count() > 0) {
+    parent_.insert(key_, status, cache_ttl_);
+  }
+  parent_.removePending(key_);
+
+  // A waiter may cause other waiters to go away, so take them one at a time.
+  while (!waiters_.empty()) {
+    RequestCallbacks* waiter = waiters_.front();
+    waiters_.pop_front();
+    waiter->onComplete(status);
+  }
+}
+
+CheckCache::CheckCache(Event::Dispatcher& dispatcher, MonotonicTimeSource& time_source,
+                       CheckCacheStats& stats, uint32_t max_entries,
+                       absl::optional<std::chrono::milliseconds> max_ttl)
+    : dispatcher_(dispatcher), time_source_(time_source), stats_(stats),
+      max_entries_(max_entries), max_ttl_(max_ttl) {}
+
+CheckCache::~CheckCache() {
+  for (auto& pending_check : pending_checks_) {
+    pending_check.second->cancel();
+  }
+}
+
+absl::optional<CheckStatus> CheckCache::lookup(const std::string& key) {
+  auto it = decision_index_.find(key);
+  if (it == decision_index_.end()) {
+    stats_.cache_miss_.inc();
+    return absl::nullopt;
+  }
+
+  if (it->second->second.expiry_ <= time_source_.currentTime()) {
+    decisions_.erase(it->second);
+    decision_index_.erase(it);
+    stats_.cache_miss_.inc();
+    return absl::nullopt;
+  }
+
+  stats_.cache_hit_.inc();
+  decisions_.splice(decisions_.begin(), decisions_, it->second);
+  return it->second->second.status_;
+}
+
+void CheckCache::insert(const std::string& key, CheckStatus status,
+                        std::chrono::milliseconds ttl) {
+  if (max_ttl_) {
+    ttl = std::min(ttl, max_ttl_.value());
+  }
+  if (ttl.count() <= 0 || max_entries_ == 0) {
+    return;
+  }
+
+  const Decision decision{status, time_source_.currentTime() + ttl};
+  auto it = decision_index_.find(key);
+  if (it != decision_index_.end()) {
+    it->second->second = decision;
+    decisions_.splice(decisions_.begin(), decisions_, it->second);
+    return;
+  }
+
+  if (decisions_.size() >= max_entries_) {
+    decision_index_.erase(decisions_.back().first);
+    decisions_.pop_back();
+    stats_.cache_evicted_.inc();
+  }
+  decisions_.emplace_front(key, decision);
+  decision_index_.emplace(key, decisions_.begin());
+}
+
+PendingCheck* CheckCache::findPending(const std::string& key) {
+  auto it = pending_checks_.find(key);
+  return it == pending_checks_.end() ? nullptr : it->second.get();
+}
+
+PendingCheck& CheckCache::addPending(const std::string& key, ClientPtr&& client) {
+  ASSERT(pending_checks_.count(key) == 0);
+  PendingCheckPtr pending_check = std::make_unique<PendingCheck>(*this, key, std::move(client));
+  PendingCheck& ret = *pending_check;
+  pending_checks_.emplace(key, std::move(pending_check));
+  return ret;
+}
+
+void CheckCache::removePending(const std::string& key) {
+  auto it = pending_checks_.find(key);
+  ASSERT(it != pending_checks_.end());
+  dispatcher_.deferredDelete(std::move(it->second));
+  pending_checks_.erase(it);
+}
+
+CheckCacheConfig::CheckCacheConfig(
+    const envoy::config::filter::ext_authz::v2alpha::CheckCache& config,
+    ThreadLocal::SlotAllocator& tls, Stats::Scope& scope, const std::string& stats_prefix,
+    MonotonicTimeSource& time_source)
+    : key_builder_(config.key_attributes()), stats_(generateStats(stats_prefix, scope)),
+      tls_(tls.allocateSlot()) {
+  const uint32_t max_entries =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, DefaultMaxEntries);
+  absl::optional<std::chrono::milliseconds> max_ttl;
+  if (config.has_max_ttl()) {
+    max_ttl = std::chrono::milliseconds(DurationUtil::durationToMilliseconds(config.max_ttl()));
+  }
+  tls_->set([this, &time_source, max_entries,
+             max_ttl](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<CheckCache>(dispatcher, time_source, stats_, max_entries, max_ttl);
+  });
+}
+
+CheckCacheStats CheckCacheConfig::generateStats(const std::string& prefix, Stats::Scope& scope) {
+  return {ALL_CHECK_CACHE_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+}
+
+CachingClientImpl::CachingClientImpl(CheckCacheConfigSharedPtr config,
+                                     ClientFactory client_factory)
+    : config_(config), client_factory_(client_factory) {}
+
+CachingClientImpl::~CachingClientImpl() { ASSERT(!callbacks_); }
+
+void CachingClientImpl::cancel() {
+  ASSERT(callbacks_ != nullptr);
+  pending_check_->removeWaiter(*this);
+  pending_check_ = nullptr;
+  callbacks_ = nullptr;
+}
+
+void CachingClientImpl::check(RequestCallbacks& callbacks,
+                              const envoy::service::auth::v2alpha::CheckRequest& request,
+                              Tracing::Span& parent_span) {
+  ASSERT(callbacks_ == nullptr);
+  CheckCache& cache = config_->cache();
+  const std::string key = config_->keyBuilder().build(request);
+
+  const absl::optional<CheckStatus> status = cache.lookup(key);
+  if (status) {
+    callbacks.onComplete(status.value());
+    return;
+  }
+
+  callbacks_ = &callbacks;
+  pending_check_ = cache.findPending(key);
+  if (pending_check_ != nullptr) {
+    config_->stats().coalesced_.inc();
+    pending_check_->addWaiter(*this);
+    return;
+  }
+
+  pending_check_ = &cache.addPending(key, client_factory_());
+  pending_check_->addWaiter(*this);
+  // The decision may come back inline.
+  pending_check_->check(request, parent_span);
+}
+
+void CachingClientImpl::onComplete(CheckStatus status) {
+  RequestCallbacks* callbacks = callbacks_;
+  pending_check_ = nullptr;
+  callbacks_ = nullptr;
+  callbacks->onComplete(status);
+}
+
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
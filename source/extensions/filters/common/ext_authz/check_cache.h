@@ -0,0 +1,231 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/config/filter/ext_authz/v2alpha/check_cache.pb.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/filters/common/ext_authz/ext_authz.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+
+/**
+ * All check cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_CHECK_CACHE_STATS(COUNTER)                                                             \
+  COUNTER(cache_hit)                                                                               \
+  COUNTER(cache_miss)                                                                              \
+  COUNTER(cache_evicted)                                                                           \
+  COUNTER(coalesced)
+// clang-format on
+
+/**
+ * Struct definition for all check cache stats. @see stats_macros.h
+ */
+struct CheckCacheStats {
+  ALL_CHECK_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Builds the key that identifies check requests with the same decision from the configured
+ * attributes of a check request.
+ */
+class CheckKeyBuilder {
+public:
+  /**
+   * @param attributes supplies the names of the key attributes.
+   * @throw EnvoyException if an attribute is not supported.
+   */
+  CheckKeyBuilder(const Protobuf::RepeatedPtrField<ProtobufTypes::String>& attributes);
+
+  std::string build(const envoy::service::auth::v2alpha::CheckRequest& request) const;
+
+private:
+  // Appends the value of an attribute to a key.
+  typedef std::function<void(const envoy::service::auth::v2alpha::AttributeContext& attributes,
+                             std::string& key)>
+      AttributeAppender;
+
+  static AttributeAppender createAppender(const std::string& attribute);
+
+  std::vector<AttributeAppender> appenders_;
+};
+
+/**
+ * Creates the clients that send check requests to the authorization service.
+ */
+typedef std::function<ClientPtr()> ClientFactory;
+
+class CheckCache;
+
+/**
+ * A check request sent to the authorization service on behalf of all the identical check
+ * requests waiting for its decision.
+ */
+class PendingCheck : public RequestCallbacks, public Event::DeferredDeletable {
+public:
+  PendingCheck(CheckCache& parent, const std::string& key, ClientPtr&& client);
+
+  void check(const envoy::service::auth::v2alpha::CheckRequest& request,
+             Tracing::Span& parent_span);
+
+  /**
+   * Cancel the check request if it is still outstanding.
+   */
+  void cancel();
+
+  void addWaiter(RequestCallbacks& callbacks) { waiters_.push_back(&callbacks); }
+
+  /**
+   * Stop waiting for the decision. The check request is canceled once nobody waits for it.
+   */
+  void removeWaiter(RequestCallbacks& callbacks);
+
+  // ExtAuthz::RequestCallbacks
+  void onCacheTtl(std::chrono::milliseconds ttl) override { cache_ttl_ = ttl; }
+  void onComplete(CheckStatus status) override;
+
+private:
+  CheckCache& parent_;
+  const std::string key_;
+  ClientPtr client_;
+  std::list<RequestCallbacks*> waiters_;
+  std::chrono::milliseconds cache_ttl_{};
+  bool complete_{};
+};
+
+typedef std::unique_ptr<PendingCheck> PendingCheckPtr;
+
+/**
+ * The cached decisions and the pending check requests of one filter config on one worker. It is
+ * not thread safe.
+ */
+class CheckCache : public ThreadLocal::ThreadLocalObject {
+public:
+  CheckCache(Event::Dispatcher& dispatcher, MonotonicTimeSource& time_source,
+             CheckCacheStats& stats, uint32_t max_entries,
+             absl::optional<std::chrono::milliseconds> max_ttl);
+  ~CheckCache();
+
+  /**
+   * @return the cached decision for a key, if there is one that has not expired.
+   */
+  absl::optional<CheckStatus> lookup(const std::string& key);
+
+  /**
+   * Cache a decision for the shorter of ttl and the configured maximum TTL, evicting the least
+   * recently used decision if the cache is full.
+   */
+  void insert(const std::string& key, CheckStatus status, std::chrono::milliseconds ttl);
+
+  /**
+   * @return the pending check request for a key, or nullptr if there is none.
+   */
+  PendingCheck* findPending(const std::string& key);
+
+  /**
+   * Start tracking a check request sent with client, so that identical check requests can wait
+   * for its decision.
+   */
+  PendingCheck& addPending(const std::string& key, ClientPtr&& client);
+
+  /**
+   * Stop tracking a completed or canceled check request. It is destroyed once the current event
+   * is done, since it may still be on the stack.
+   */
+  void removePending(const std::string& key);
+
+  CheckCacheStats& stats() { return stats_; }
+  size_t size() const { return decisions_.size(); }
+
+private:
+  struct Decision {
+    CheckStatus status_;
+    MonotonicTime expiry_;
+  };
+  typedef std::list<std::pair<std::string, Decision>> DecisionList;
+
+  Event::Dispatcher& dispatcher_;
+  MonotonicTimeSource& time_source_;
+  CheckCacheStats& stats_;
+  const uint32_t max_entries_;
+  const absl::optional<std::chrono::milliseconds> max_ttl_;
+  // Decisions from the most to the least recently used.
+  DecisionList decisions_;
+  std::unordered_map<std::string, DecisionList::iterator> decision_index_;
+  std::unordered_map<std::string, PendingCheckPtr> pending_checks_;
+};
+
+/**
+ * The check cache configuration of a filter config, with the per worker caches.
+ */
+class CheckCacheConfig {
+public:
+  CheckCacheConfig(const envoy::config::filter::ext_authz::v2alpha::CheckCache& config,
+                   ThreadLocal::SlotAllocator& tls, Stats::Scope& scope,
+                   const std::string& stats_prefix, MonotonicTimeSource& time_source);
+
+  const CheckKeyBuilder& keyBuilder() const { return key_builder_; }
+  CheckCache& cache() { return tls_->getTyped<CheckCache>(); }
+  CheckCacheStats& stats() { return stats_; }
+
+private:
+  static CheckCacheStats generateStats(const std::string& prefix, Stats::Scope& scope);
+
+  const CheckKeyBuilder key_builder_;
+  CheckCacheStats stats_;
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<CheckCacheConfig> CheckCacheConfigSharedPtr;
+
+/**
+ * A client that answers check requests from the decision cache when it can, and otherwise
+ * waits for an identical pending check request or sends one with a client from the factory.
+ */
+class CachingClientImpl : public Client, public RequestCallbacks {
+public:
+  CachingClientImpl(CheckCacheConfigSharedPtr config, ClientFactory client_factory);
+  ~CachingClientImpl();
+
+  // ExtAuthz::Client
+  void cancel() override;
+  void check(RequestCallbacks& callbacks,
+             const envoy::service::auth::v2alpha::CheckRequest& request,
+             Tracing::Span& parent_span) override;
+
+  // ExtAuthz::RequestCallbacks
+  void onComplete(CheckStatus status) override;
+
+private:
+  CheckCacheConfigSharedPtr config_;
+  ClientFactory client_factory_;
+  PendingCheck* pending_check_{};
+  RequestCallbacks* callbacks_{};
+};
+
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
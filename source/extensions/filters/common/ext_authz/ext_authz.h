@@ -34,6 +34,13 @@ class RequestCallbacks {
 public:
   virtual ~RequestCallbacks() {}
 
+  /**
+   * Called right before onComplete() if the authorization service allows its decision to be
+   * reused for identical requests, with how long for. Only callers that cache decisions need to
+   * handle it.
+   */
+  virtual void onCacheTtl(std::chrono::milliseconds) {}
+
   /**
    * Called when a check request is complete. The resulting status is supplied.
    */
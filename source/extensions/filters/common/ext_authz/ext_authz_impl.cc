@@ -14,6 +14,7 @@
 #include "common/http/utility.h"
 #include "common/network/utility.h"
 #include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -56,6 +57,10 @@ void GrpcClientImpl::onSuccess(
     span.setTag(Constants::get().TraceStatus, Constants::get().TraceOk);
   }
 
+  if (response->has_cache_ttl()) {
+    callbacks_->onCacheTtl(
+        std::chrono::milliseconds(DurationUtil::durationToMilliseconds(response->cache_ttl())));
+  }
   callbacks_->onComplete(status);
   callbacks_ = nullptr;
 }
@@ -1,14 +1,13 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include "envoy/http/filter.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/stats.h"
 
-#include "common/json/json_loader.h"
-
 #include "extensions/filters/http/dynamo/dynamo_request_parser.h"
 
 namespace Envoy {
@@ -21,6 +20,7 @@ namespace Dynamo {
  * It captures RPS/latencies:
  *  1) Per table per response code (and group of response codes, e.g., 2xx/3xx/etc)
  *  2) Per operation per response code (and group of response codes, e.g., 2xx/3xx/etc)
+ * Request and response bodies are parsed as they stream through, they are not buffered.
  */
 class DynamoFilter : public Http::StreamFilter {
 public:
@@ -52,15 +52,16 @@ public:
   }
 
 private:
-  void onDecodeComplete(const Buffer::Instance& data);
-  void onEncodeComplete(const Buffer::Instance& data);
-  std::string buildBody(const Buffer::Instance* buffered, const Buffer::Instance& last);
+  void parseRequestBody(const Buffer::Instance& data);
+  void parseResponseBody(const Buffer::Instance& data);
+  void onDecodeComplete();
+  void onEncodeComplete();
   void chargeBasicStats(uint64_t status);
   void chargeStatsPerEntity(const std::string& entity, const std::string& entity_type,
                             uint64_t status);
-  void chargeFailureSpecificStats(const Json::Object& json_body);
-  void chargeUnProcessedKeysStats(const Json::Object& json_body);
-  void chargeTablePartitionIdStats(const Json::Object& json_body);
+  void chargeFailureSpecificStats(const ResponseBodyParser& response);
+  void chargeUnProcessedKeysStats(const ResponseBodyParser& response);
+  void chargeTablePartitionIdStats(const ResponseBodyParser& response);
 
   Runtime::Loader& runtime_;
   std::string stat_prefix_;
@@ -72,6 +73,11 @@ private:
   std::string error_type_{};
   MonotonicTime start_decode_;
   Http::HeaderMap* response_headers_;
+  // Created with the first body data, and reset once the body is invalid.
+  std::unique_ptr<RequestBodyParser> request_parser_;
+  std::unique_ptr<ResponseBodyParser> response_parser_;
+  bool request_body_invalid_{};
+  bool response_body_invalid_{};
   Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
   Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
 };
@@ -66,51 +66,13 @@ std::string RequestParser::parseOperation(const Http::HeaderMap& headerMap) {
   return operation;
 }
 
-RequestParser::TableDescriptor RequestParser::parseTable(const std::string& operation,
-                                                         const Json::Object& json_data) {
-  TableDescriptor table{"", true};
-
-  // Simple operations on a single table, have "TableName" explicitly specified.
-  if (find(SINGLE_TABLE_OPERATIONS.begin(), SINGLE_TABLE_OPERATIONS.end(), operation) !=
-      SINGLE_TABLE_OPERATIONS.end()) {
-    table.table_name = json_data.getString("TableName", "");
-  } else if (find(BATCH_OPERATIONS.begin(), BATCH_OPERATIONS.end(), operation) !=
-             BATCH_OPERATIONS.end()) {
-    Json::ObjectSharedPtr tables = json_data.getObject("RequestItems", true);
-    tables->iterate([&table](const std::string& key, const Json::Object&) {
-      if (table.table_name.empty()) {
-        table.table_name = key;
-      } else {
-        if (table.table_name != key) {
-          table.table_name = "";
-          table.is_single_table = false;
-          return false;
-        }
-      }
-      return true;
-    });
-  }
-
-  return table;
-}
-std::vector<std::string> RequestParser::parseBatchUnProcessedKeys(const Json::Object& json_data) {
-  std::vector<std::string> unprocessed_tables;
-  Json::ObjectSharedPtr tables = json_data.getObject("UnprocessedKeys", true);
-  tables->iterate([&unprocessed_tables](const std::string& key, const Json::Object&) {
-    unprocessed_tables.emplace_back(key);
-    return true;
-  });
-
-  return unprocessed_tables;
-}
-std::string RequestParser::parseErrorType(const Json::Object& json_data) {
-  std::string error_type = json_data.getString("__type", "");
-  if (error_type.empty()) {
+std::string RequestParser::parseErrorType(const std::string& type) {
+  if (type.empty()) {
     return "";
   }
 
   for (const std::string& supported_error_type : SUPPORTED_ERROR_TYPES) {
-    if (StringUtil::endsWith(error_type, supported_error_type)) {
+    if (StringUtil::endsWith(type, supported_error_type)) {
       return supported_error_type;
     }
   }
@@ -118,29 +80,72 @@ std::string RequestParser::parseErrorType(const Json::Object& json_data) {
   return "";
 }
 
+bool RequestParser::isSingleTableOperation(const std::string& operation) {
+  return find(SINGLE_TABLE_OPERATIONS.begin(), SINGLE_TABLE_OPERATIONS.end(), operation) !=
+         SINGLE_TABLE_OPERATIONS.end();
+}
+
 bool RequestParser::isBatchOperation(const std::string& operation) {
   return find(BATCH_OPERATIONS.begin(), BATCH_OPERATIONS.end(), operation) !=
          BATCH_OPERATIONS.end();
 }
 
-std::vector<RequestParser::PartitionDescriptor>
-RequestParser::parsePartitions(const Json::Object& json_data) {
-  std::vector<RequestParser::PartitionDescriptor> partition_descriptors;
+// The interesting parts of a request are at most two objects deep:
+// {"RequestItems": {"table": ...}}.
+RequestBodyParser::RequestBodyParser(const std::string& operation)
+    : single_table_operation_(RequestParser::isSingleTableOperation(operation)),
+      batch_operation_(RequestParser::isBatchOperation(operation)), scanner_(*this, 2) {}
+
+void RequestBodyParser::onKey(const Json::StreamingScanner::Path& path) {
+  // Batch operations name their tables with the keys of "RequestItems".
+  if (!batch_operation_ || path.size() != 2 || path[0] != "RequestItems" ||
+      !table_.is_single_table) {
+    return;
+  }
+
+  if (table_.table_name.empty()) {
+    table_.table_name = path[1];
+  } else if (table_.table_name != path[1]) {
+    table_.table_name = "";
+    table_.is_single_table = false;
+  }
+}
+
+void RequestBodyParser::onString(const Json::StreamingScanner::Path& path,
+                                 const std::string& value) {
+  // Simple operations on a single table, have "TableName" explicitly specified.
+  if (single_table_operation_ && path.size() == 1 && path[0] == "TableName") {
+    table_.table_name = value;
+  }
+}
+
+// The interesting parts of a response are at most three objects deep:
+// {"ConsumedCapacity": {"Partitions": {"partition": capacity}}}.
+ResponseBodyParser::ResponseBodyParser() : scanner_(*this, 3) {}
+
+void ResponseBodyParser::onKey(const Json::StreamingScanner::Path& path) {
+  // The unprocessed keys block contains a list of tables and keys for that table that did not
+  // complete apart of the batch operation. Only the table names are kept.
+  if (path.size() == 2 && path[0] == "UnprocessedKeys") {
+    unprocessed_tables_.emplace_back(path[1]);
+  }
+}
+
+void ResponseBodyParser::onString(const Json::StreamingScanner::Path& path,
+                                  const std::string& value) {
+  if (path.size() == 1 && path[0] == "__type") {
+    type_ = value;
+  }
+}
 
-  Json::ObjectSharedPtr partitions =
-      json_data.getObject("ConsumedCapacity", true)->getObject("Partitions", true);
-  partitions->iterate([&partition_descriptors, &partitions](const std::string& key,
-                                                            const Json::Object&) {
+void ResponseBodyParser::onNumber(const Json::StreamingScanner::Path& path, double value) {
+  if (path.size() == 3 && path[0] == "ConsumedCapacity" && path[1] == "Partitions") {
     // For a given partition id, the amount of capacity used is returned in the body as a double.
-    // A stat will be created to track the capacity consumed for the operation, table and partition.
-    // Stats counter only increments by whole numbers, capacity is round up to the nearest integer
-    // to account for this.
-    uint64_t capacity_integer = static_cast<uint64_t>(std::ceil(partitions->getDouble(key, 0.0)));
-    partition_descriptors.emplace_back(key, capacity_integer);
-    return true;
-  });
-
-  return partition_descriptors;
+    // A stat will be created to track the capacity consumed for the operation, table and
+    // partition. Stats counter only increments by whole numbers, capacity is round up to the
+    // nearest integer to account for this.
+    partitions_.emplace_back(path[2], static_cast<uint64_t>(std::ceil(value)));
+  }
 }
 
 } // namespace Dynamo
@@ -4,9 +4,10 @@
 #include <string>
 #include <vector>
 
+#include "envoy/buffer/buffer.h"
 #include "envoy/http/header_map.h"
 
-#include "common/json/json_loader.h"
+#include "common/json/json_scanner.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -41,56 +42,25 @@ public:
   static std::string parseOperation(const Http::HeaderMap& headerMap);
 
   /**
-   * Parse table name out of data, based on the operation.
-   * @return empty string as TableDescriptor.table_name if table name cannot be parsed out of valid
-   *json data
-   * or if operation is not in the list of operations that we support.
-   *
-   * For simple operations on single table, e.g., GetItem, PutItem, Query etc @return table
-   * name in TableDescriptor.table_name.
-   *
-   * For batch operations, e.g. BatchGetItem/BatchWriteItem, @return table name in
-   *TableDescriptor.table_name if it's only one
-   * table used in all operations, @return empty string in TableDescriptor.table_name and
-   *TableDescriptor.is_single_table=false in case of multiple.
-   *
-   * @throw Json::Exception if data is not in valid Json format.
-   */
-  static TableDescriptor parseTable(const std::string& operation, const Json::Object& json_data);
-
-  /**
-   * Parse error details which might be provided for a given response code.
+   * Map the __type of an error response to the error it is.
    * @return empty string if cannot get error details.
    * For the full list of errors, see
    * http://docs.aws.amazon.com/amazondynamodb/latest/APIReference/CommonErrors.html
    * Operation specific errors, for example, error section of
    * http://docs.aws.amazon.com/amazondynamodb/latest/APIReference/API_UpdateItem.html
-   *
-   * @throw Json::Exception if data is not in valid Json format.
    */
-  static std::string parseErrorType(const Json::Object& json_data);
+  static std::string parseErrorType(const std::string& type);
 
   /**
-   * Parse unprocessed keys for batch operation results.
-   * @return empty set if there are no unprocessed keys or a set of table names that did not get
-   * processed in the batch operation.
+   * @return true if the operation is in the set of supported SINGLE_TABLE_OPERATIONS
    */
-  static std::vector<std::string> parseBatchUnProcessedKeys(const Json::Object& json_data);
+  static bool isSingleTableOperation(const std::string& operation);
 
   /**
    * @return true if the operation is in the set of supported BATCH_OPERATIONS
    */
   static bool isBatchOperation(const std::string& operation);
 
-  /**
-   * Parse the Partition ids and the consumed capacity from the body.
-   * @return empty set if there is no partition data or a set of partition data containing
-   * the partition id as a string and the capacity consumed as an integer.
-   *
-   * @throw Json::Exception if data is not in valid Json format.
-   */
-  static std::vector<PartitionDescriptor> parsePartitions(const Json::Object& json_data);
-
 private:
   static const Http::LowerCaseString X_AMZ_TARGET;
   static const std::vector<std::string> SINGLE_TABLE_OPERATIONS;
@@ -102,6 +72,103 @@ private:
   RequestParser() {}
 };
 
+/**
+ * Parses the table(s) of a request out of its body as the body arrives, without buffering it or
+ * building the JSON document.
+ */
+class RequestBodyParser : public Json::StreamingScanner::Callbacks {
+public:
+  RequestBodyParser(const std::string& operation);
+
+  /**
+   * Parse the next part of the body.
+   * @throw Json::Exception if data is not in valid Json format.
+   */
+  void parse(const Buffer::Instance& data) { scanner_.scan(data); }
+
+  /**
+   * Signal the end of the body.
+   * @throw Json::Exception if the body is not in valid Json format.
+   */
+  void finish() { scanner_.finish(); }
+
+  /**
+   * @return empty string as TableDescriptor.table_name if table name cannot be parsed out of
+   * the body or if operation is not in the list of operations that we support.
+   *
+   * For simple operations on single table, e.g., GetItem, PutItem, Query etc @return table
+   * name in TableDescriptor.table_name.
+   *
+   * For batch operations, e.g. BatchGetItem/BatchWriteItem, @return table name in
+   * TableDescriptor.table_name if it's only one table used in all operations, @return empty
+   * string in TableDescriptor.table_name and TableDescriptor.is_single_table=false in case of
+   * multiple.
+   */
+  const RequestParser::TableDescriptor& table() const { return table_; }
+
+  // Json::StreamingScanner::Callbacks
+  void onKey(const Json::StreamingScanner::Path& path) override;
+  void onString(const Json::StreamingScanner::Path& path, const std::string& value) override;
+  void onNumber(const Json::StreamingScanner::Path&, double) override {}
+
+private:
+  const bool single_table_operation_;
+  const bool batch_operation_;
+  RequestParser::TableDescriptor table_{"", true};
+  Json::StreamingScanner scanner_;
+};
+
+/**
+ * Parses the error type, the unprocessed keys of batch operations and the partition capacity out
+ * of a response body as the body arrives, without buffering it or building the JSON document.
+ */
+class ResponseBodyParser : public Json::StreamingScanner::Callbacks {
+public:
+  ResponseBodyParser();
+
+  /**
+   * Parse the next part of the body.
+   * @throw Json::Exception if data is not in valid Json format.
+   */
+  void parse(const Buffer::Instance& data) { scanner_.scan(data); }
+
+  /**
+   * Signal the end of the body.
+   * @throw Json::Exception if the body is not in valid Json format.
+   */
+  void finish() { scanner_.finish(); }
+
+  /**
+   * @return the error details of the response, @see RequestParser::parseErrorType().
+   */
+  std::string errorType() const { return RequestParser::parseErrorType(type_); }
+
+  /**
+   * @return empty set if there are no unprocessed keys or a set of table names that did not get
+   * processed in the batch operation.
+   */
+  const std::vector<std::string>& unprocessedTables() const { return unprocessed_tables_; }
+
+  /**
+   * @return empty set if there is no partition data or a set of partition data containing
+   * the partition id as a string and the capacity consumed as an integer.
+   */
+  const std::vector<RequestParser::PartitionDescriptor>& partitions() const {
+    return partitions_;
+  }
+
+  // Json::StreamingScanner::Callbacks
+  void onKey(const Json::StreamingScanner::Path& path) override;
+  void onString(const Json::StreamingScanner::Path& path, const std::string& value) override;
+  void onNumber(const Json::StreamingScanner::Path& path, double value) override;
+
+private:
+  std::string type_;
+  std::vector<std::string> unprocessed_tables_;
+  std::vector<RequestParser::PartitionDescriptor> partitions_;
+  Json::StreamingScanner scanner_;
+};
+
 } // namespace Dynamo
 } // namespace HttpFilters
 } // namespace Extensions
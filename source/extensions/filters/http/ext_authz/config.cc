@@ -6,8 +6,10 @@
 #include "envoy/config/filter/http/ext_authz/v2alpha/ext_authz.pb.validate.h"
 #include "envoy/registry/registry.h"
 
+#include "common/common/utility.h"
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/common/ext_authz/check_cache.h"
 #include "extensions/filters/common/ext_authz/ext_authz_impl.h"
 #include "extensions/filters/http/ext_authz/ext_authz.h"
 
@@ -18,19 +20,38 @@ namespace ExtAuthz {
 
 Http::FilterFactoryCb ExtAuthzFilterConfig::createFilterFactoryFromProtoTyped(
     const envoy::config::filter::http::ext_authz::v2alpha::ExtAuthz& proto_config,
-    const std::string&, Server::Configuration::FactoryContext& context) {
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
   auto filter_config =
       std::make_shared<FilterConfig>(proto_config, context.localInfo(), context.scope(),
                                      context.runtime(), context.clusterManager());
   const uint32_t timeout_ms = PROTOBUF_GET_MS_OR_DEFAULT(proto_config.grpc_service(), timeout, 200);
 
-  return [ grpc_service = proto_config.grpc_service(), &context, filter_config,
-           timeout_ms ](Http::FilterChainFactoryCallbacks & callbacks) {
+  Filters::Common::ExtAuthz::ClientFactory client_factory =
+      [ grpc_service = proto_config.grpc_service(), &context,
+        timeout_ms ]()->Filters::Common::ExtAuthz::ClientPtr {
     auto async_client_factory =
         context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
             grpc_service, context.scope(), true);
-    auto client = std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
+    return std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
         async_client_factory->create(), std::chrono::milliseconds(timeout_ms));
+  };
+
+  Filters::Common::ExtAuthz::CheckCacheConfigSharedPtr check_cache_config;
+  if (proto_config.has_check_cache()) {
+    check_cache_config = std::make_shared<Filters::Common::ExtAuthz::CheckCacheConfig>(
+        proto_config.check_cache(), context.threadLocal(), context.scope(),
+        stats_prefix + "ext_authz.", ProdMonotonicTimeSource::instance_);
+  }
+
+  return [filter_config, client_factory,
+          check_cache_config](Http::FilterChainFactoryCallbacks& callbacks) {
+    Filters::Common::ExtAuthz::ClientPtr client;
+    if (check_cache_config) {
+      client = std::make_unique<Filters::Common::ExtAuthz::CachingClientImpl>(check_cache_config,
+                                                                              client_factory);
+    } else {
+      client = client_factory();
+    }
     callbacks.addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr{
         std::make_shared<Filter>(filter_config, std::move(client))});
   };
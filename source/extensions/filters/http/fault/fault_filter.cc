@@ -31,6 +31,8 @@ const std::string FaultFilter::ABORT_PERCENT_KEY = "fault.http.abort.abort_perce
 const std::string FaultFilter::DELAY_DURATION_KEY = "fault.http.delay.fixed_duration_ms";
 const std::string FaultFilter::ABORT_HTTP_STATUS_KEY = "fault.http.abort.http_status";
 
+const uint64_t DownstreamClusterKeyTable::MAX_DOWNSTREAM_CLUSTERS = 1024;
+
 FaultSettings::FaultSettings(const envoy::config::filter::http::fault::v2::HTTPFault& fault) {
 
   if (fault.has_abort()) {
@@ -44,7 +46,7 @@ FaultSettings::FaultSettings(const envoy::config::filter::http::fault::v2::HTTPF
     fixed_duration_ms_ = PROTOBUF_GET_MS_OR_DEFAULT(delay, fixed_delay, 0);
   }
 
-  for (const Http::HeaderUtility::HeaderData& header_map : fault.headers()) {
+  for (const auto& header_map : fault.headers()) {
     fault_filter_headers_.push_back(header_map);
   }
 
@@ -57,9 +59,44 @@ FaultSettings::FaultSettings(const envoy::config::filter::http::fault::v2::HTTPF
 
 FaultFilterConfig::FaultFilterConfig(const envoy::config::filter::http::fault::v2::HTTPFault& fault,
                                      Runtime::Loader& runtime, const std::string& stats_prefix,
-                                     Stats::Scope& scope)
+                                     Stats::Scope& scope, ThreadLocal::SlotAllocator& tls)
     : settings_(fault), runtime_(runtime), stats_(generateStats(stats_prefix, scope)),
-      stats_prefix_(stats_prefix), scope_(scope) {}
+      stats_prefix_(stats_prefix), scope_(scope), tls_(tls.allocateSlot()) {
+  tls_->set([stats_prefix](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<DownstreamClusterKeyTable>(stats_prefix);
+  });
+}
+
+DownstreamClusterKeys::DownstreamClusterKeys(absl::string_view cluster)
+    : cluster_(cluster),
+      delay_percent_key_(fmt::format("fault.http.{}.delay.fixed_delay_percent", cluster_)),
+      abort_percent_key_(fmt::format("fault.http.{}.abort.abort_percent", cluster_)),
+      delay_duration_key_(fmt::format("fault.http.{}.delay.fixed_duration_ms", cluster_)),
+      abort_http_status_key_(fmt::format("fault.http.{}.abort.http_status", cluster_)) {}
+
+std::string DownstreamClusterKeys::statName(const std::string& stats_prefix,
+                                            absl::string_view cluster, absl::string_view name) {
+  return fmt::format("{}fault.{}.{}", stats_prefix, cluster, name);
+}
+
+const DownstreamClusterKeys* DownstreamClusterKeyTable::find(absl::string_view cluster) {
+  auto it = keys_.find(cluster);
+  if (it != keys_.end()) {
+    return it->second.get();
+  }
+  if (keys_.size() >= MAX_DOWNSTREAM_CLUSTERS) {
+    return nullptr;
+  }
+
+  std::unique_ptr<DownstreamClusterKeys> keys(new DownstreamClusterKeys(cluster));
+  keys->delays_injected_stat_ =
+      DownstreamClusterKeys::statName(stats_prefix_, cluster, "delays_injected");
+  keys->aborts_injected_stat_ =
+      DownstreamClusterKeys::statName(stats_prefix_, cluster, "aborts_injected");
+  const DownstreamClusterKeys* ret = keys.get();
+  keys_.emplace(ret->cluster_, std::move(keys));
+  return ret;
+}
 
 FaultFilter::FaultFilter(FaultFilterConfigSharedPtr config) : config_(config) {}
 
@@ -99,16 +136,13 @@ Http::FilterHeadersStatus FaultFilter::decodeHeaders(Http::HeaderMap& headers, b
   }
 
   if (headers.EnvoyDownstreamServiceCluster()) {
-    downstream_cluster_ = headers.EnvoyDownstreamServiceCluster()->value().c_str();
-
-    downstream_cluster_delay_percent_key_ =
-        fmt::format("fault.http.{}.delay.fixed_delay_percent", downstream_cluster_);
-    downstream_cluster_abort_percent_key_ =
-        fmt::format("fault.http.{}.abort.abort_percent", downstream_cluster_);
-    downstream_cluster_delay_duration_key_ =
-        fmt::format("fault.http.{}.delay.fixed_duration_ms", downstream_cluster_);
-    downstream_cluster_abort_http_status_key_ =
-        fmt::format("fault.http.{}.abort.http_status", downstream_cluster_);
+    const absl::string_view cluster =
+        headers.EnvoyDownstreamServiceCluster()->value().getStringView();
+    downstream_cluster_keys_ = config_->downstreamClusterKeys(cluster);
+    if (downstream_cluster_keys_ == nullptr) {
+      unshared_downstream_cluster_keys_.emplace(cluster);
+      downstream_cluster_keys_ = &unshared_downstream_cluster_keys_.value();
+    }
   }
 
   absl::optional<uint64_t> duration_ms = delayDuration();
@@ -132,9 +166,9 @@ bool FaultFilter::isDelayEnabled() {
   bool enabled = config_->runtime().snapshot().featureEnabled(DELAY_PERCENT_KEY,
                                                               fault_settings_->delayPercent());
 
-  if (!downstream_cluster_delay_percent_key_.empty()) {
-    enabled |= config_->runtime().snapshot().featureEnabled(downstream_cluster_delay_percent_key_,
-                                                            fault_settings_->delayPercent());
+  if (downstream_cluster_keys_) {
+    enabled |= config_->runtime().snapshot().featureEnabled(
+        downstream_cluster_keys_->delay_percent_key_, fault_settings_->delayPercent());
   }
 
   return enabled;
@@ -144,9 +178,9 @@ bool FaultFilter::isAbortEnabled() {
   bool enabled = config_->runtime().snapshot().featureEnabled(ABORT_PERCENT_KEY,
                                                               fault_settings_->abortPercent());
 
-  if (!downstream_cluster_abort_percent_key_.empty()) {
-    enabled |= config_->runtime().snapshot().featureEnabled(downstream_cluster_abort_percent_key_,
-                                                            fault_settings_->abortPercent());
+  if (downstream_cluster_keys_) {
+    enabled |= config_->runtime().snapshot().featureEnabled(
+        downstream_cluster_keys_->abort_percent_key_, fault_settings_->abortPercent());
   }
 
   return enabled;
@@ -161,9 +195,9 @@ absl::optional<uint64_t> FaultFilter::delayDuration() {
 
   uint64_t duration = config_->runtime().snapshot().getInteger(DELAY_DURATION_KEY,
                                                                fault_settings_->delayDuration());
-  if (!downstream_cluster_delay_duration_key_.empty()) {
-    duration =
-        config_->runtime().snapshot().getInteger(downstream_cluster_delay_duration_key_, duration);
+  if (downstream_cluster_keys_) {
+    duration = config_->runtime().snapshot().getInteger(
+        downstream_cluster_keys_->delay_duration_key_, duration);
   }
 
   // Delay only if the duration is >0ms
@@ -179,9 +213,9 @@ uint64_t FaultFilter::abortHttpStatus() {
   uint64_t http_status =
       config_->runtime().snapshot().getInteger(ABORT_HTTP_STATUS_KEY, fault_settings_->abortCode());
 
-  if (!downstream_cluster_abort_http_status_key_.empty()) {
+  if (downstream_cluster_keys_) {
     http_status = config_->runtime().snapshot().getInteger(
-        downstream_cluster_abort_http_status_key_, http_status);
+        downstream_cluster_keys_->abort_http_status_key_, http_status);
   }
 
   return http_status;
@@ -189,11 +223,8 @@ uint64_t FaultFilter::abortHttpStatus() {
 
 void FaultFilter::recordDelaysInjectedStats() {
   // Downstream specific stats.
-  if (!downstream_cluster_.empty()) {
-    const std::string stats_counter =
-        fmt::format("{}fault.{}.delays_injected", config_->statsPrefix(), downstream_cluster_);
-
-    config_->scope().counter(stats_counter).inc();
+  if (downstream_cluster_keys_ && !downstream_cluster_keys_->cluster_.empty()) {
+    incDownstreamClusterCounter(downstream_cluster_keys_->delays_injected_stat_, "delays_injected");
   }
 
   // General stats.
@@ -202,17 +233,26 @@ void FaultFilter::recordDelaysInjectedStats() {
 
 void FaultFilter::recordAbortsInjectedStats() {
   // Downstream specific stats.
-  if (!downstream_cluster_.empty()) {
-    const std::string stats_counter =
-        fmt::format("{}fault.{}.aborts_injected", config_->statsPrefix(), downstream_cluster_);
-
-    config_->scope().counter(stats_counter).inc();
+  if (downstream_cluster_keys_ && !downstream_cluster_keys_->cluster_.empty()) {
+    incDownstreamClusterCounter(downstream_cluster_keys_->aborts_injected_stat_, "aborts_injected");
   }
 
   // General stats.
   config_->stats().aborts_injected_.inc();
 }
 
+void FaultFilter::incDownstreamClusterCounter(const std::string& stat_name,
+                                              absl::string_view name) {
+  if (!stat_name.empty()) {
+    config_->scope().counter(stat_name).inc();
+  } else {
+    config_->scope()
+        .counter(DownstreamClusterKeys::statName(config_->statsPrefix(),
+                                                 downstream_cluster_keys_->cluster_, name))
+        .inc();
+  }
+}
+
 Http::FilterDataStatus FaultFilter::decodeData(Buffer::Instance&, bool) {
   if (delay_timer_ == nullptr) {
     return Http::FilterDataStatus::Continue;
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -11,9 +12,14 @@
 #include "envoy/http/filter.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 
+#include "common/common/utility.h"
 #include "common/http/header_utility.h"
 
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -62,13 +68,62 @@ private:
   std::unordered_set<std::string> downstream_nodes_{}; // Inject failures for specific downstream
 };
 
+/**
+ * Runtime keys and stat names used to fault requests from a single downstream cluster.
+ */
+struct DownstreamClusterKeys {
+  explicit DownstreamClusterKeys(absl::string_view cluster);
+
+  /**
+   * @return std::string the name of a per downstream cluster fault counter.
+   */
+  static std::string statName(const std::string& stats_prefix, absl::string_view cluster,
+                              absl::string_view name);
+
+  const std::string cluster_;
+  const std::string delay_percent_key_;
+  const std::string abort_percent_key_;
+  const std::string delay_duration_key_;
+  const std::string abort_http_status_key_;
+  // Only set for keys kept in a DownstreamClusterKeyTable. Otherwise the names are built when a
+  // fault is injected.
+  std::string delays_injected_stat_;
+  std::string aborts_injected_stat_;
+};
+
+typedef std::unique_ptr<const DownstreamClusterKeys> DownstreamClusterKeysConstPtr;
+
+/**
+ * A per worker table of downstream cluster keys, so that they are built once for each cluster a
+ * worker sees. It holds at most MAX_DOWNSTREAM_CLUSTERS clusters and never removes them.
+ */
+class DownstreamClusterKeyTable : public ThreadLocal::ThreadLocalObject {
+public:
+  DownstreamClusterKeyTable(const std::string& stats_prefix) : stats_prefix_(stats_prefix) {}
+
+  /**
+   * @param cluster supplies the value of the downstream service cluster header.
+   * @return const DownstreamClusterKeys* the keys for the cluster, or nullptr if the cluster has
+   *         not been seen before and the table is full.
+   */
+  const DownstreamClusterKeys* find(absl::string_view cluster);
+
+  const static uint64_t MAX_DOWNSTREAM_CLUSTERS;
+
+private:
+  const std::string stats_prefix_;
+  // Keyed by views of the cluster_ member of each entry.
+  std::unordered_map<absl::string_view, DownstreamClusterKeysConstPtr, StringViewHash> keys_;
+};
+
 /**
  * Configuration for the fault filter.
  */
 class FaultFilterConfig {
 public:
   FaultFilterConfig(const envoy::config::filter::http::fault::v2::HTTPFault& fault,
-                    Runtime::Loader& runtime, const std::string& stats_prefix, Stats::Scope& scope);
+                    Runtime::Loader& runtime, const std::string& stats_prefix, Stats::Scope& scope,
+                    ThreadLocal::SlotAllocator& tls);
 
   Runtime::Loader& runtime() { return runtime_; }
   FaultFilterStats& stats() { return stats_; }
@@ -76,6 +131,14 @@ public:
   Stats::Scope& scope() { return scope_; }
   const FaultSettings* settings() { return &settings_; }
 
+  /**
+   * Find the runtime keys and stat names for a downstream cluster in this worker's table.
+   * @see DownstreamClusterKeyTable::find().
+   */
+  const DownstreamClusterKeys* downstreamClusterKeys(absl::string_view cluster) {
+    return tls_->getTyped<DownstreamClusterKeyTable>().find(cluster);
+  }
+
 private:
   static FaultFilterStats generateStats(const std::string& prefix, Stats::Scope& scope);
 
@@ -84,6 +147,7 @@ private:
   FaultFilterStats stats_;
   const std::string stats_prefix_;
   Stats::Scope& scope_;
+  ThreadLocal::SlotPtr tls_;
 };
 
 typedef std::shared_ptr<FaultFilterConfig> FaultFilterConfigSharedPtr;
@@ -108,6 +172,7 @@ public:
 private:
   void recordAbortsInjectedStats();
   void recordDelaysInjectedStats();
+  void incDownstreamClusterCounter(const std::string& stat_name, absl::string_view name);
   void resetTimerState();
   void postDelayInjection();
   void abortWithHTTPStatus();
@@ -122,14 +187,11 @@ private:
   FaultFilterConfigSharedPtr config_;
   Http::StreamDecoderFilterCallbacks* callbacks_{};
   Event::TimerPtr delay_timer_;
-  std::string downstream_cluster_{};
+  const DownstreamClusterKeys* downstream_cluster_keys_{};
+  // Keys built for this request only, when the worker's table is full.
+  absl::optional<DownstreamClusterKeys> unshared_downstream_cluster_keys_;
   const FaultSettings* fault_settings_;
 
-  std::string downstream_cluster_delay_percent_key_{};
-  std::string downstream_cluster_abort_percent_key_{};
-  std::string downstream_cluster_delay_duration_key_{};
-  std::string downstream_cluster_abort_http_status_key_{};
-
   const static std::string DELAY_PERCENT_KEY;
   const static std::string ABORT_PERCENT_KEY;
   const static std::string DELAY_DURATION_KEY;
@@ -8,6 +8,7 @@
 #include "common/common/utility.h"
 #include "common/filesystem/filesystem_impl.h"
 #include "common/grpc/common.h"
+#include "common/http/codes.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
 #include "common/protobuf/protobuf.h"
@@ -72,10 +73,18 @@ private:
   std::unique_ptr<TranscoderInputStream> response_stream_;
 };
 
+JsonTranscoderStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+  const std::string final_prefix = prefix + "grpc_json_transcoder.";
+  return {ALL_GRPC_JSON_TRANSCODER_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
+                                         POOL_GAUGE_PREFIX(scope, final_prefix))};
+}
+
 } // namespace
 
 JsonTranscoderConfig::JsonTranscoderConfig(
-    const envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder& proto_config) {
+    const envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder& proto_config,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : stats_(generateStats(stats_prefix, scope)) {
   FileDescriptorSet descriptor_set;
 
   switch (proto_config.descriptor_set_case()) {
@@ -249,6 +258,7 @@ Http::FilterHeadersStatus JsonTranscoderFilter::decodeHeaders(Http::HeaderMap& h
 
     Buffer::OwnedImpl data;
     readToBuffer(*transcoder_->RequestOutput(), data);
+    updateRequestBytesInFlight(data.length() > 0);
 
     if (data.length() > 0) {
       decoder_callbacks_->addDecodedData(data, true);
@@ -271,6 +281,7 @@ Http::FilterDataStatus JsonTranscoderFilter::decodeData(Buffer::Instance& data,
   }
 
   readToBuffer(*transcoder_->RequestOutput(), data);
+  const bool within_limit = updateRequestBytesInFlight(data.length() > 0);
 
   const auto& request_status = transcoder_->RequestStatus();
 
@@ -282,6 +293,19 @@ Http::FilterDataStatus JsonTranscoderFilter::decodeData(Buffer::Instance& data,
 
     return Http::FilterDataStatus::StopIterationNoBuffer;
   }
+
+  if (!within_limit) {
+    // The transcoder cannot produce anything until it has the rest of the message, so pausing the
+    // downstream would not help. Reject the request like a buffering filter would.
+    ENVOY_LOG(debug, "Transcoding request error: message exceeds the buffer limit");
+    error_ = true;
+    config_.stats().request_too_large_.inc();
+    decoder_callbacks_->sendLocalReply(Http::Code::PayloadTooLarge,
+                                       Http::CodeUtility::toString(Http::Code::PayloadTooLarge),
+                                       nullptr);
+
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
   return Http::FilterDataStatus::Continue;
 }
 
@@ -296,6 +320,7 @@ Http::FilterTrailersStatus JsonTranscoderFilter::decodeTrailers(Http::HeaderMap&
 
   Buffer::OwnedImpl data;
   readToBuffer(*transcoder_->RequestOutput(), data);
+  updateRequestBytesInFlight(data.length() > 0);
 
   if (data.length()) {
     decoder_callbacks_->addDecodedData(data, true);
@@ -348,6 +373,16 @@ Http::FilterDataStatus JsonTranscoderFilter::encodeData(Buffer::Instance& data,
 
   readToBuffer(*transcoder_->ResponseOutput(), data);
 
+  if (!updateResponseBytesInFlight(data.length() > 0)) {
+    // As for requests, the transcoder needs the rest of the message to make progress.
+    ENVOY_LOG(debug, "Transcoding response error: message exceeds the buffer limit");
+    error_ = true;
+    config_.stats().response_too_large_.inc();
+    encoder_callbacks_->resetStream();
+
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+
   if (!method_->server_streaming() && !end_stream) {
     // Buffer until the response is complete.
     return Http::FilterDataStatus::StopIterationAndBuffer;
@@ -366,6 +401,7 @@ Http::FilterTrailersStatus JsonTranscoderFilter::encodeTrailers(Http::HeaderMap&
 
   Buffer::OwnedImpl data;
   readToBuffer(*transcoder_->ResponseOutput(), data);
+  updateResponseBytesInFlight(data.length() > 0);
 
   if (data.length()) {
     encoder_callbacks_->addEncodedData(data, true);
@@ -400,7 +436,11 @@ void JsonTranscoderFilter::setEncoderFilterCallbacks(
   encoder_callbacks_ = &callbacks;
 }
 
-// TODO(lizan): Incorporate watermarks to bound buffer sizes
+void JsonTranscoderFilter::onDestroy() {
+  setBytesInFlight(0, request_bytes_in_flight_, config_.stats().request_bytes_in_flight_);
+  setBytesInFlight(0, response_bytes_in_flight_, config_.stats().response_bytes_in_flight_);
+}
+
 bool JsonTranscoderFilter::readToBuffer(Protobuf::io::ZeroCopyInputStream& stream,
                                         Buffer::Instance& data) {
   const void* out;
@@ -415,6 +455,38 @@ bool JsonTranscoderFilter::readToBuffer(Protobuf::io::ZeroCopyInputStream& strea
   return false;
 }
 
+void JsonTranscoderFilter::setBytesInFlight(uint64_t bytes, uint64_t& bytes_in_flight,
+                                            Stats::Gauge& gauge) {
+  if (bytes > bytes_in_flight) {
+    gauge.add(bytes - bytes_in_flight);
+  } else {
+    gauge.sub(bytes_in_flight - bytes);
+  }
+  bytes_in_flight = bytes;
+}
+
+bool JsonTranscoderFilter::updateRequestBytesInFlight(bool transcoded) {
+  if (transcoded) {
+    request_in_.markTranscoded();
+  }
+  setBytesInFlight(request_in_.bytesInFlight(), request_bytes_in_flight_,
+                   config_.stats().request_bytes_in_flight_);
+
+  const uint32_t limit = decoder_callbacks_->decoderBufferLimit();
+  return limit == 0 || request_bytes_in_flight_ <= limit;
+}
+
+bool JsonTranscoderFilter::updateResponseBytesInFlight(bool transcoded) {
+  if (transcoded) {
+    response_in_.markTranscoded();
+  }
+  setBytesInFlight(response_in_.bytesInFlight(), response_bytes_in_flight_,
+                   config_.stats().response_bytes_in_flight_);
+
+  const uint32_t limit = encoder_callbacks_->encoderBufferLimit();
+  return limit == 0 || response_bytes_in_flight_ <= limit;
+}
+
 } // namespace GrpcJsonTranscoder
 } // namespace HttpFilters
 } // namespace Extensions
@@ -5,6 +5,7 @@
 #include "envoy/http/filter.h"
 #include "envoy/http/header_map.h"
 #include "envoy/json/json_object.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "common/common/logger.h"
 #include "common/protobuf/protobuf.h"
@@ -21,6 +22,24 @@ namespace Extensions {
 namespace HttpFilters {
 namespace GrpcJsonTranscoder {
 
+/**
+ * All stats for the gRPC JSON transcoder filter. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_GRPC_JSON_TRANSCODER_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(request_too_large)                                                                       \
+  COUNTER(response_too_large)                                                                      \
+  GAUGE  (request_bytes_in_flight)                                                                 \
+  GAUGE  (response_bytes_in_flight)
+// clang-format on
+
+/**
+ * Struct definition for all gRPC JSON transcoder stats. @see stats_macros.h
+ */
+struct JsonTranscoderStats {
+  ALL_GRPC_JSON_TRANSCODER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * VariableBinding specifies a value for a single field in the request message.
  * When transcoding HTTP/REST/JSON to gRPC/proto the request message is
@@ -48,7 +67,8 @@ public:
    * and construct a path matcher for HTTP path bindings.
    */
   JsonTranscoderConfig(
-      const envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder& proto_config);
+      const envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder& proto_config,
+      const std::string& stats_prefix, Stats::Scope& scope);
 
   /**
    * Create an instance of Transcoder interface based on incoming request
@@ -72,6 +92,8 @@ public:
    */
   bool matchIncomingRequestInfo() const;
 
+  JsonTranscoderStats& stats() { return stats_; }
+
 private:
   /**
    * Convert method descriptor to RequestInfo that needed for transcoding library
@@ -86,12 +108,15 @@ private:
   Protobuf::util::JsonPrintOptions print_options_;
 
   bool match_incoming_request_route_{false};
+  JsonTranscoderStats stats_;
 };
 
 typedef std::shared_ptr<JsonTranscoderConfig> JsonTranscoderConfigSharedPtr;
 
 /**
- * The filter instance for gRPC JSON transcoder.
+ * The filter instance for gRPC JSON transcoder. Request and response bodies are transcoded as they
+ * arrive. Only the part of a message that the transcoder cannot convert yet is held, and it counts
+ * against the buffer limit of the stream.
  */
 class JsonTranscoderFilter : public Http::StreamFilter, public Logger::Loggable<Logger::Id::http2> {
 public:
@@ -113,10 +138,13 @@ public:
   void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override;
 
   // Http::StreamFilterBase
-  void onDestroy() override {}
+  void onDestroy() override;
 
 private:
   bool readToBuffer(Protobuf::io::ZeroCopyInputStream& stream, Buffer::Instance& data);
+  void setBytesInFlight(uint64_t bytes, uint64_t& bytes_in_flight, Stats::Gauge& gauge);
+  bool updateRequestBytesInFlight(bool transcoded);
+  bool updateResponseBytesInFlight(bool transcoded);
 
   JsonTranscoderConfig& config_;
   std::unique_ptr<google::grpc::transcoding::Transcoder> transcoder_;
@@ -126,6 +154,8 @@ private:
   Http::StreamEncoderFilterCallbacks* encoder_callbacks_{nullptr};
   const Protobuf::MethodDescriptor* method_{nullptr};
   Http::HeaderMap* response_headers_{nullptr};
+  uint64_t request_bytes_in_flight_{0};
+  uint64_t response_bytes_in_flight_{0};
 
   bool error_{false};
 };
@@ -5,6 +5,10 @@ namespace Extensions {
 namespace HttpFilters {
 namespace GrpcJsonTranscoder {
 
+uint64_t TranscoderInputStreamImpl::bytesInFlight() const {
+  return ByteCount() + BytesAvailable() - transcoded_;
+}
+
 int64_t TranscoderInputStreamImpl::BytesAvailable() const { return buffer_->length() - position_; }
 
 bool TranscoderInputStreamImpl::Finished() const { return finished_; }
@@ -12,9 +12,24 @@ namespace GrpcJsonTranscoder {
 class TranscoderInputStreamImpl : public Buffer::ZeroCopyInputStreamImpl,
                                   public google::grpc::transcoding::TranscoderInputStream {
 public:
+  /**
+   * @return the number of bytes moved into the stream that are not marked as transcoded, whether
+   *         they are still in the stream or have already been read by the transcoder.
+   */
+  uint64_t bytesInFlight() const;
+
+  /**
+   * Mark all bytes read from the stream so far as transcoded. Called once the transcoder has
+   * produced output for them.
+   */
+  void markTranscoded() { transcoded_ = ByteCount(); }
+
   // TranscoderInputStream
   virtual int64_t BytesAvailable() const override;
   virtual bool Finished() const override;
+
+private:
+  uint64_t transcoded_{0};
 };
 
 } // namespace GrpcJsonTranscoder
@@ -1,6 +1,7 @@
 #include "extensions/filters/http/gzip/gzip_filter.h"
 
 #include "common/common/macros.h"
+#include "common/protobuf/utility.h"
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
@@ -21,6 +22,9 @@ const uint64_t DefaultWindowBits = 12;
 // Minimum length of an upstream response that allows compression.
 const uint64_t MinimumContentLength = 30;
 
+// Default number of idle compressors kept by each worker.
+const uint32_t DefaultCompressorPoolSize = 16;
+
 // When summed to window bits, this sets a gzip header and trailer around the compressed data.
 const uint64_t GzipHeaderValue = 16;
 
@@ -35,20 +39,55 @@ const std::vector<std::string>& defaultContentEncoding() {
                           "application/xhtml+xml"});
 }
 
+// Runtime key overriding the configured minimum content length. Built once, since it is looked
+// up for every response with a content length.
+const std::string& minimumContentLengthRuntimeKey() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "gzip.min_content_length");
+}
+
 } // namespace
 
 GzipFilterConfig::GzipFilterConfig(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
                                    const std::string& stats_prefix, Stats::Scope& scope,
-                                   Runtime::Loader& runtime)
+                                   Runtime::Loader& runtime, ThreadLocal::SlotAllocator& tls)
     : compression_level_(compressionLevelEnum(gzip.compression_level())),
       compression_strategy_(compressionStrategyEnum(gzip.compression_strategy())),
       content_length_(contentLengthUint(gzip.content_length().value())),
       memory_level_(memoryLevelUint(gzip.memory_level().value())),
       window_bits_(windowBitsUint(gzip.window_bits().value())),
+      compressor_pool_size_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, compressor_pool_size, DefaultCompressorPoolSize)),
       content_type_values_(contentTypeSet(gzip.content_type())),
       disable_on_etag_header_(gzip.disable_on_etag_header()),
       remove_accept_encoding_header_(gzip.remove_accept_encoding_header()),
-      stats_(generateStats(stats_prefix + "gzip.", scope)), runtime_(runtime) {}
+      stats_(generateStats(stats_prefix + "gzip.", scope)), runtime_(runtime),
+      tls_(tls.allocateSlot()) {
+  const uint32_t pool_size = compressor_pool_size_;
+  tls_->set([pool_size](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalCompressorPool>(pool_size);
+  });
+}
+
+Compressor::ZlibCompressorImplPtr GzipFilterConfig::acquireCompressor() {
+  Compressor::ZlibCompressorImplPtr compressor =
+      tls_->getTyped<ThreadLocalCompressorPool>().pool_.acquire();
+  if (compressor) {
+    stats_.compressor_pool_hit_.inc();
+    return compressor;
+  }
+
+  stats_.compressor_pool_miss_.inc();
+  compressor = std::make_unique<Compressor::ZlibCompressorImpl>();
+  compressor->init(compression_level_, compression_strategy_, window_bits_, memory_level_);
+  return compressor;
+}
+
+void GzipFilterConfig::releaseCompressor(Compressor::ZlibCompressorImplPtr&& compressor) {
+  compressor->reset();
+  if (!tls_->getTyped<ThreadLocalCompressorPool>().pool_.release(std::move(compressor))) {
+    stats_.compressor_pool_overflow_.inc();
+  }
+}
 
 Compressor::ZlibCompressorImpl::CompressionLevel GzipFilterConfig::compressionLevelEnum(
     envoy::config::filter::http::gzip::v2::Gzip_CompressionLevel_Enum compression_level) {
@@ -101,7 +140,9 @@ uint64_t GzipFilterConfig::windowBitsUint(Protobuf::uint32 window_bits) {
 }
 
 GzipFilter::GzipFilter(const GzipFilterConfigSharedPtr& config)
-    : skip_compression_{true}, compressed_data_(), compressor_(), config_(config) {}
+    : skip_compression_{true}, compressed_data_(), config_(config) {}
+
+void GzipFilter::onDestroy() { releaseCompressor(); }
 
 Http::FilterHeadersStatus GzipFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
   if (config_->runtime().snapshot().featureEnabled("gzip.filter_enabled", 100) &&
@@ -125,8 +166,7 @@ Http::FilterHeadersStatus GzipFilter::encodeHeaders(Http::HeaderMap& headers, bo
     insertVaryHeader(headers);
     headers.removeContentLength();
     headers.insertContentEncoding().value(Http::Headers::get().ContentEncodingValues.Gzip);
-    compressor_.init(config_->compressionLevel(), config_->compressionStrategy(),
-                     config_->windowBits(), config_->memoryLevel());
+    compressor_ = config_->acquireCompressor();
     config_->stats().compressed_.inc();
   } else if (!skip_compression_) {
     skip_compression_ = true;
@@ -138,12 +178,21 @@ Http::FilterHeadersStatus GzipFilter::encodeHeaders(Http::HeaderMap& headers, bo
 Http::FilterDataStatus GzipFilter::encodeData(Buffer::Instance& data, bool end_stream) {
   if (!skip_compression_) {
     config_->stats().total_uncompressed_bytes_.add(data.length());
-    compressor_.compress(data, end_stream ? Compressor::State::Finish : Compressor::State::Flush);
+    compressor_->compress(data, end_stream ? Compressor::State::Finish : Compressor::State::Flush);
     config_->stats().total_compressed_bytes_.add(data.length());
+    if (end_stream) {
+      releaseCompressor();
+    }
   }
   return Http::FilterDataStatus::Continue;
 }
 
+void GzipFilter::releaseCompressor() {
+  if (compressor_) {
+    config_->releaseCompressor(std::move(compressor_));
+  }
+}
+
 bool GzipFilter::hasCacheControlNoTransform(Http::HeaderMap& headers) const {
   const Http::HeaderEntry* cache_control = headers.CacheControl();
   if (cache_control) {
@@ -230,7 +279,8 @@ bool GzipFilter::isMinimumContentLength(Http::HeaderMap& headers) const {
     uint64_t length;
     const bool is_minimum_content_length =
         StringUtil::atoul(content_length->value().c_str(), length) &&
-        length >= config_->minimumLength();
+        length >= config_->runtime().snapshot().getInteger(minimumContentLengthRuntimeKey(),
+                                                           config_->minimumLength());
     if (!is_minimum_content_length) {
       config_->stats().content_length_too_small_.inc();
     }
@@ -6,8 +6,10 @@
 #include "envoy/json/json_object.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/object_pool.h"
 #include "common/compressor/zlib_compressor_impl.h"
 #include "common/http/header_map_impl.h"
 #include "common/json/config_schemas.h"
@@ -42,6 +44,9 @@ namespace Gzip {
   COUNTER(total_compressed_bytes)  \
   COUNTER(content_length_too_small)\
   COUNTER(not_compressed_etag)     \
+  COUNTER(compressor_pool_hit)     \
+  COUNTER(compressor_pool_miss)    \
+  COUNTER(compressor_pool_overflow)\
 // clang-format on
 
 /**
@@ -58,8 +63,20 @@ class GzipFilterConfig {
 
 public:
   GzipFilterConfig(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
-                   const std::string& stats_prefix,
-                   Stats::Scope& scope, Runtime::Loader& runtime);
+                   const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
+                   ThreadLocal::SlotAllocator& tls);
+
+  /**
+   * @return a compressor initialized with this configuration. An idle compressor is taken from
+   *         the worker's pool when there is one.
+   */
+  Compressor::ZlibCompressorImplPtr acquireCompressor();
+
+  /**
+   * Return a compressor obtained from acquireCompressor() to the worker's pool, or destroy it if
+   * the pool is full. The compressor may be in the middle of a stream.
+   */
+  void releaseCompressor(Compressor::ZlibCompressorImplPtr&& compressor);
 
   Compressor::ZlibCompressorImpl::CompressionLevel compressionLevel() const {
     return compression_level_;
@@ -76,8 +93,18 @@ public:
   uint64_t memoryLevel() const { return memory_level_; }
   uint64_t minimumLength() const { return content_length_; }
   uint64_t windowBits() const { return window_bits_; }
+  uint32_t compressorPoolSize() const { return compressor_pool_size_; }
 
 private:
+  /**
+   * Idle compressors of a worker.
+   */
+  struct ThreadLocalCompressorPool : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalCompressorPool(uint32_t max_size) : pool_(max_size) {}
+
+    ObjectPool<Compressor::ZlibCompressorImpl> pool_;
+  };
+
   static Compressor::ZlibCompressorImpl::CompressionLevel compressionLevelEnum(
       envoy::config::filter::http::gzip::v2::Gzip_CompressionLevel_Enum compression_level);
   static Compressor::ZlibCompressorImpl::CompressionStrategy compressionStrategyEnum(
@@ -99,12 +126,14 @@ private:
   int32_t content_length_;
   int32_t memory_level_;
   int32_t window_bits_;
+  uint32_t compressor_pool_size_;
 
   StringUtil::CaseUnorderedSet content_type_values_;
   bool disable_on_etag_header_;
   bool remove_accept_encoding_header_;
   GzipStats stats_;
   Runtime::Loader& runtime_;
+  ThreadLocal::SlotPtr tls_;
 };
 typedef std::shared_ptr<GzipFilterConfig> GzipFilterConfigSharedPtr;
 
@@ -116,7 +145,7 @@ public:
   GzipFilter(const GzipFilterConfigSharedPtr& config);
 
   // Http::StreamFilterBase
-  void onDestroy() override{};
+  void onDestroy() override;
 
   // Http::StreamDecoderFilter
   Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
@@ -157,10 +186,11 @@ private:
 
   void sanitizeEtagHeader(Http::HeaderMap& headers);
   void insertVaryHeader(Http::HeaderMap& headers);
+  void releaseCompressor();
 
   bool skip_compression_;
   Buffer::OwnedImpl compressed_data_;
-  Compressor::ZlibCompressorImpl compressor_;
+  Compressor::ZlibCompressorImplPtr compressor_;
   GzipFilterConfigSharedPtr config_;
 
   Http::StreamDecoderFilterCallbacks* decoder_callbacks_{nullptr};
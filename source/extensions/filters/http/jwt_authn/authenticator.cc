@@ -8,6 +8,7 @@
 #include "common/http/message_impl.h"
 #include "common/http/utility.h"
 
+#include "absl/types/optional.h"
 #include "jwt_verify_lib/jwt.h"
 #include "jwt_verify_lib/verify.h"
 
@@ -41,7 +42,7 @@ private:
   void onSuccess(Http::MessagePtr&& response) override;
   void onFailure(Http::AsyncClient::FailureReason) override;
 
-  // Verify with a specific public key.
+  // Verify with a specific public key, or take the cached result if it is still valid.
   void verifyKey();
 
   // Handle the public key fetch done event.
@@ -58,8 +59,12 @@ private:
 
   // The token data
   JwtLocationConstPtr token_;
-  // The JWT object.
-  ::google::jwt_verify::Jwt jwt_;
+  // The key of the token in the token cache.
+  std::string token_key_;
+  // The JWT object, shared with the token cache.
+  std::shared_ptr<const ::google::jwt_verify::Jwt> jwt_;
+  // The cached verification result of the token, if any.
+  absl::optional<TokenCache::Entry> cached_;
   // The JWKS data object
   JwksCache::JwksData* jwks_data_{};
 
@@ -102,35 +107,54 @@ void AuthenticatorImpl::verify(Http::HeaderMap& headers, Authenticator::Callback
   // Only process the first token for now.
   token_.swap(tokens[0]);
 
-  const Status status = jwt_.parseFromString(token_->token());
-  if (status != Status::Ok) {
-    doneWithStatus(status);
-    return;
+  const auto unix_timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                                  std::chrono::system_clock::now().time_since_epoch())
+                                  .count();
+
+  // A token seen before is taken parsed from the token cache. Its signature still has to be
+  // verified again if the Jwks of its issuer changed since.
+  cached_.reset();
+  TokenCache& token_cache = config_->getCache().getTokenCache();
+  if (token_cache.enabled()) {
+    token_key_ = TokenCache::digest(token_->token());
+    const TokenCache::Entry* entry = token_cache.lookup(token_key_, unix_timestamp);
+    if (entry != nullptr) {
+      cached_ = *entry;
+    }
+  }
+
+  if (cached_) {
+    jwt_ = cached_->jwt_;
+  } else {
+    auto jwt = std::make_shared<::google::jwt_verify::Jwt>();
+    const Status status = jwt->parseFromString(token_->token());
+    if (status != Status::Ok) {
+      doneWithStatus(status);
+      return;
+    }
+    jwt_ = std::move(jwt);
   }
 
   // Check if token is extracted from the location specified by the issuer.
-  if (!token_->isIssuerSpecified(jwt_.iss_)) {
-    ENVOY_LOG(debug, "Jwt for issuer {} is not extracted from the specified locations", jwt_.iss_);
+  if (!token_->isIssuerSpecified(jwt_->iss_)) {
+    ENVOY_LOG(debug, "Jwt for issuer {} is not extracted from the specified locations", jwt_->iss_);
     doneWithStatus(Status::JwtUnknownIssuer);
     return;
   }
 
   // Check "exp" claim.
-  const auto unix_timestamp = std::chrono::duration_cast<std::chrono::seconds>(
-                                  std::chrono::system_clock::now().time_since_epoch())
-                                  .count();
-  if (jwt_.exp_ < unix_timestamp) {
+  if (jwt_->exp_ < unix_timestamp) {
     doneWithStatus(Status::JwtExpired);
     return;
   }
 
   // Check the issuer is configured or not.
-  jwks_data_ = config_->getCache().getJwksCache().findByIssuer(jwt_.iss_);
+  jwks_data_ = config_->getCache().getJwksCache().findByIssuer(jwt_->iss_);
   // isIssuerSpecified() check already make sure the issuer is in the cache.
   ASSERT(jwks_data_ != nullptr);
 
   // Check if audience is allowed
-  if (!jwks_data_->areAudiencesAllowed(jwt_.audiences_)) {
+  if (!jwks_data_->areAudiencesAllowed(jwt_->audiences_)) {
     doneWithStatus(Status::JwtAudienceNotAllowed);
     return;
   }
@@ -212,7 +236,22 @@ void AuthenticatorImpl::onFetchRemoteJwksDone(const std::string& jwks_str) {
 
 // Verify with a specific public key.
 void AuthenticatorImpl::verifyKey() {
-  const Status status = ::google::jwt_verify::verifyJwt(jwt_, *jwks_data_->getJwksObj());
+  TokenCache& token_cache = config_->getCache().getTokenCache();
+  const uint64_t jwks_generation = jwks_data_->getJwksGeneration();
+  Status status;
+  if (cached_ && cached_->jwks_generation_ == jwks_generation) {
+    config_->stats().token_cache_hit_.inc();
+    status = cached_->status_;
+  } else {
+    status = ::google::jwt_verify::verifyJwt(*jwt_, *jwks_data_->getJwksObj());
+    if (token_cache.enabled()) {
+      config_->stats().token_cache_miss_.inc();
+      if (token_cache.insert(token_key_, {jwt_, status, jwks_generation})) {
+        config_->stats().token_cache_evicted_.inc();
+      }
+    }
+  }
+
   if (status != Status::Ok) {
     doneWithStatus(status);
     return;
@@ -222,7 +261,7 @@ void AuthenticatorImpl::verifyKey() {
   const auto& provider = jwks_data_->getJwtProvider();
   if (!provider.forward_payload_header().empty()) {
     headers_->addCopy(Http::LowerCaseString(provider.forward_payload_header()),
-                      jwt_.payload_str_base64url_);
+                      jwt_->payload_str_base64url_);
   }
 
   if (!provider.forward()) {
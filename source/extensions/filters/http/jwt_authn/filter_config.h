@@ -5,9 +5,11 @@
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/logger.h"
+#include "common/protobuf/utility.h"
 
 #include "extensions/filters/http/jwt_authn/extractor.h"
 #include "extensions/filters/http/jwt_authn/jwks_cache.h"
+#include "extensions/filters/http/jwt_authn/token_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -16,8 +18,7 @@ namespace JwtAuthn {
 
 /**
  * Making cache as a thread local object, its read/write operations don't need to be protected.
- * Now it only has jwks_cache, but in the future, it will have token cache: to cache the tokens
- * with their verification results.
+ * It has jwks_cache, and token_cache to cache the tokens with their verification results.
  */
 class ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
 public:
@@ -25,14 +26,24 @@ public:
   ThreadLocalCache(
       const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config) {
     jwks_cache_ = JwksCache::create(config);
+    token_cache_ = std::make_unique<TokenCache>(
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, token_cache_size, DefaultTokenCacheSize));
   }
 
   // Get the JwksCache object.
   JwksCache& getJwksCache() { return *jwks_cache_; }
 
+  // Get the TokenCache object.
+  TokenCache& getTokenCache() { return *token_cache_; }
+
 private:
+  // The default maximum number of cached tokens per thread.
+  static constexpr uint32_t DefaultTokenCacheSize = 1000;
+
   // The JwksCache object.
   JwksCachePtr jwks_cache_;
+  // The TokenCache object.
+  TokenCachePtr token_cache_;
 };
 
 /**
@@ -42,7 +53,10 @@ private:
 // clang-format off
 #define ALL_JWT_AUTHN_FILTER_STATS(COUNTER)                                                        \
   COUNTER(allowed)                                                                                 \
-  COUNTER(denied)
+  COUNTER(denied)                                                                                  \
+  COUNTER(token_cache_hit)                                                                         \
+  COUNTER(token_cache_miss)                                                                        \
+  COUNTER(token_cache_evicted)
 // clang-format on
 
 /**
@@ -54,6 +54,8 @@ public:
 
   bool isExpired() const override { return std::chrono::steady_clock::now() >= expiration_time_; }
 
+  uint64_t getJwksGeneration() const override { return jwks_generation_; }
+
   Status setRemoteJwks(const std::string& jwks_str) override {
     return setKey(jwks_str, getRemoteJwksExpirationTime());
   }
@@ -79,6 +81,7 @@ private:
     }
     jwks_obj_ = std::move(jwks_obj);
     expiration_time_ = expire;
+    jwks_generation_++;
     return Status::Ok;
   }
 
@@ -90,6 +93,8 @@ private:
   ::google::jwt_verify::JwksPtr jwks_obj_;
   // The pubkey expiration time.
   std::chrono::steady_clock::time_point expiration_time_;
+  // Incremented whenever jwks_obj_ is set.
+  uint64_t jwks_generation_{};
 };
 
 class JwksCacheImpl : public JwksCache {
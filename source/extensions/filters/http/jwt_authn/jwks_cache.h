@@ -54,6 +54,10 @@ public:
     // Return true if jwks object is expired.
     virtual bool isExpired() const PURE;
 
+    // Get the generation of the Jwks object. It changes whenever a new Jwks object is set, so
+    // results verified with an older one can be told apart.
+    virtual uint64_t getJwksGeneration() const PURE;
+
     // Set a remote Jwks string.
     virtual ::google::jwt_verify::Status setRemoteJwks(const std::string& jwks_str) PURE;
   };
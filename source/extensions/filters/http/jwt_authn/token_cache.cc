@@ -0,0 +1,59 @@
+#include "extensions/filters/http/jwt_authn/token_cache.h"
+
+#include "openssl/sha.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+std::string TokenCache::digest(const std::string& token) {
+  std::string key(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(reinterpret_cast<const uint8_t*>(token.data()), token.size(),
+         reinterpret_cast<uint8_t*>(&key[0]));
+  return key;
+}
+
+const TokenCache::Entry* TokenCache::lookup(const std::string& key, int64_t now) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+
+  if (it->second->second.jwt_->exp_ < now) {
+    entries_.erase(it->second);
+    index_.erase(it);
+    return nullptr;
+  }
+
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return &it->second->second;
+}
+
+bool TokenCache::insert(const std::string& key, Entry&& entry) {
+  if (max_size_ == 0) {
+    return false;
+  }
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    it->second->second = std::move(entry);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return false;
+  }
+
+  bool evicted = false;
+  if (entries_.size() >= max_size_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+    evicted = true;
+  }
+  entries_.emplace_front(key, std::move(entry));
+  index_.emplace(key, entries_.begin());
+  return evicted;
+}
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
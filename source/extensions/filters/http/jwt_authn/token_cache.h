@@ -0,0 +1,78 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "common/common/non_copyable.h"
+
+#include "jwt_verify_lib/jwt.h"
+#include "jwt_verify_lib/status.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+/**
+ * A size bounded LRU cache of verified tokens, keyed by the SHA-256 digest of the token string.
+ * An entry keeps the parsed token and its verification result, so a token presented again is
+ * neither parsed nor verified again. Entries expire at the "exp" claim of their token, and record
+ * the generation of the issuer's Jwks they were verified with, so callers can ignore entries
+ * verified with keys that have since been rotated. It is not thread safe; each worker owns one
+ * through ThreadLocalCache.
+ */
+class TokenCache : NonCopyable {
+public:
+  struct Entry {
+    // The parsed token.
+    std::shared_ptr<const ::google::jwt_verify::Jwt> jwt_;
+    // The result of verifying the token signature.
+    ::google::jwt_verify::Status status_;
+    // The generation of the issuer's Jwks the token was verified with.
+    uint64_t jwks_generation_;
+  };
+
+  /**
+   * @param max_size the maximum number of entries. 0 disables the cache.
+   */
+  TokenCache(uint32_t max_size) : max_size_(max_size) {}
+
+  /**
+   * @return the key of a token in the cache.
+   */
+  static std::string digest(const std::string& token);
+
+  /**
+   * Find an entry and make it the most recently used one. An expired entry is removed.
+   * @param key supplies the key from digest().
+   * @param now supplies the current time in seconds since the epoch.
+   * @return the entry, or nullptr if there is none. It is valid until the next insert().
+   */
+  const Entry* lookup(const std::string& key, int64_t now);
+
+  /**
+   * Add or replace an entry, evicting the least recently used entry if the cache is full.
+   * @return whether an entry was evicted.
+   */
+  bool insert(const std::string& key, Entry&& entry);
+
+  bool enabled() const { return max_size_ > 0; }
+  size_t size() const { return entries_.size(); }
+
+private:
+  typedef std::list<std::pair<std::string, Entry>> EntryList;
+
+  const uint32_t max_size_;
+  // Entries from the most to the least recently used.
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+};
+
+typedef std::unique_ptr<TokenCache> TokenCachePtr;
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
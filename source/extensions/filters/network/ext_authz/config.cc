@@ -7,12 +7,16 @@
 #include "envoy/network/connection.h"
 #include "envoy/registry/registry.h"
 
+#include "common/common/utility.h"
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/common/ext_authz/check_cache.h"
 #include "extensions/filters/common/ext_authz/ext_authz.h"
 #include "extensions/filters/common/ext_authz/ext_authz_impl.h"
 #include "extensions/filters/network/ext_authz/ext_authz.h"
 
+#include "fmt/format.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -24,16 +28,33 @@ Network::FilterFactoryCb ExtAuthzConfigFactory::createFilterFactoryFromProtoType
   ConfigSharedPtr ext_authz_config(new Config(proto_config, context.scope()));
   const uint32_t timeout_ms = PROTOBUF_GET_MS_OR_DEFAULT(proto_config.grpc_service(), timeout, 200);
 
-  return [ grpc_service = proto_config.grpc_service(), &context, ext_authz_config,
-           timeout_ms ](Network::FilterManager & filter_manager)
-      ->void {
-
+  Filters::Common::ExtAuthz::ClientFactory client_factory =
+      [ grpc_service = proto_config.grpc_service(), &context,
+        timeout_ms ]()->Filters::Common::ExtAuthz::ClientPtr {
     auto async_client_factory =
         context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
             grpc_service, context.scope(), true);
-
-    auto client = std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
+    return std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
         async_client_factory->create(), std::chrono::milliseconds(timeout_ms));
+  };
+
+  Filters::Common::ExtAuthz::CheckCacheConfigSharedPtr check_cache_config;
+  if (proto_config.has_check_cache()) {
+    check_cache_config = std::make_shared<Filters::Common::ExtAuthz::CheckCacheConfig>(
+        proto_config.check_cache(), context.threadLocal(), context.scope(),
+        fmt::format("ext_authz.{}.", proto_config.stat_prefix()),
+        ProdMonotonicTimeSource::instance_);
+  }
+
+  return [ext_authz_config, client_factory,
+          check_cache_config](Network::FilterManager& filter_manager) -> void {
+    Filters::Common::ExtAuthz::ClientPtr client;
+    if (check_cache_config) {
+      client = std::make_unique<Filters::Common::ExtAuthz::CachingClientImpl>(check_cache_config,
+                                                                              client_factory);
+    } else {
+      client = client_factory();
+    }
     filter_manager.addReadFilter(Network::ReadFilterSharedPtr{
         std::make_shared<Filter>(ext_authz_config, std::move(client))});
   };
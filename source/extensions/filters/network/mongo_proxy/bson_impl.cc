@@ -1,9 +1,12 @@
 #include "extensions/filters/network/mongo_proxy/bson_impl.h"
 
 #include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/byte_order.h"
 #include "common/common/fmt.h"
@@ -390,101 +393,93 @@ void DocumentImpl::fromBuffer(Buffer::Instance& data) {
     uint8_t element_type = BufferHelper::removeByte(data);
     std::string key = BufferHelper::removeCString(data);
     ENVOY_LOG(trace, "BSON element type: {:#x} key: {}", element_type, key);
-    switch (static_cast<Field::Type>(element_type)) {
-    case Field::Type::DOUBLE: {
-      double value = BufferHelper::removeDouble(data);
-      ENVOY_LOG(trace, "BSON double: {}", value);
-      addDouble(key, value);
-      break;
-    }
+    fields_.emplace_back(createField(element_type, key, data));
+  }
+}
 
-    case Field::Type::STRING: {
-      std::string value = BufferHelper::removeString(data);
-      ENVOY_LOG(trace, "BSON string: {}", value);
-      addString(key, std::move(value));
-      break;
-    }
+FieldPtr DocumentImpl::createField(uint8_t element_type, const std::string& key,
+                                   Buffer::Instance& data) {
+  switch (static_cast<Field::Type>(element_type)) {
+  case Field::Type::DOUBLE: {
+    double value = BufferHelper::removeDouble(data);
+    ENVOY_LOG(trace, "BSON double: {}", value);
+    return FieldPtr{new FieldImpl(key, value)};
+  }
 
-    case Field::Type::DOCUMENT: {
-      ENVOY_LOG(trace, "BSON document");
-      addDocument(key, DocumentImpl::create(data));
-      break;
-    }
+  case Field::Type::STRING: {
+    std::string value = BufferHelper::removeString(data);
+    ENVOY_LOG(trace, "BSON string: {}", value);
+    return FieldPtr{new FieldImpl(Field::Type::STRING, key, std::move(value))};
+  }
 
-    case Field::Type::ARRAY: {
-      ENVOY_LOG(trace, "BSON array");
-      addArray(key, DocumentImpl::create(data));
-      break;
-    }
+  case Field::Type::DOCUMENT: {
+    ENVOY_LOG(trace, "BSON document");
+    return FieldPtr{new FieldImpl(Field::Type::DOCUMENT, key, DocumentImpl::create(data))};
+  }
 
-    case Field::Type::BINARY: {
-      std::string value = BufferHelper::removeBinary(data);
-      ENVOY_LOG(trace, "BSON binary: {}", value);
-      addBinary(key, std::move(value));
-      break;
-    }
+  case Field::Type::ARRAY: {
+    ENVOY_LOG(trace, "BSON array");
+    return FieldPtr{new FieldImpl(Field::Type::ARRAY, key, DocumentImpl::create(data))};
+  }
 
-    case Field::Type::OBJECT_ID: {
-      Field::ObjectId value;
-      BufferHelper::removeBytes(data, &value[0], value.size());
-      addObjectId(key, std::move(value));
-      break;
-    }
+  case Field::Type::BINARY: {
+    std::string value = BufferHelper::removeBinary(data);
+    ENVOY_LOG(trace, "BSON binary: {}", value);
+    return FieldPtr{new FieldImpl(Field::Type::BINARY, key, std::move(value))};
+  }
 
-    case Field::Type::BOOLEAN: {
-      bool value = BufferHelper::removeByte(data) != 0;
-      ENVOY_LOG(trace, "BSON boolean: {}", value);
-      addBoolean(key, value);
-      break;
-    }
+  case Field::Type::OBJECT_ID: {
+    Field::ObjectId value;
+    BufferHelper::removeBytes(data, &value[0], value.size());
+    return FieldPtr{new FieldImpl(key, std::move(value))};
+  }
 
-    case Field::Type::DATETIME: {
-      int64_t value = BufferHelper::removeInt64(data);
-      ENVOY_LOG(trace, "BSON datetime: {}", value);
-      addDatetime(key, value);
-      break;
-    }
+  case Field::Type::BOOLEAN: {
+    bool value = BufferHelper::removeByte(data) != 0;
+    ENVOY_LOG(trace, "BSON boolean: {}", value);
+    return FieldPtr{new FieldImpl(key, value)};
+  }
 
-    case Field::Type::NULL_VALUE: {
-      ENVOY_LOG(trace, "BSON null value");
-      addNull(key);
-      break;
-    }
+  case Field::Type::DATETIME: {
+    int64_t value = BufferHelper::removeInt64(data);
+    ENVOY_LOG(trace, "BSON datetime: {}", value);
+    return FieldPtr{new FieldImpl(Field::Type::DATETIME, key, value)};
+  }
 
-    case Field::Type::REGEX: {
-      Field::Regex value;
-      value.pattern_ = BufferHelper::removeCString(data);
-      value.options_ = BufferHelper::removeCString(data);
-      ENVOY_LOG(trace, "BSON regex pattern: {} options: {}", value.pattern_, value.options_);
-      addRegex(key, std::move(value));
-      break;
-    }
+  case Field::Type::NULL_VALUE: {
+    ENVOY_LOG(trace, "BSON null value");
+    return FieldPtr{new FieldImpl(key)};
+  }
 
-    case Field::Type::INT32: {
-      int32_t value = BufferHelper::removeInt32(data);
-      ENVOY_LOG(trace, "BSON int32: {}", value);
-      addInt32(key, value);
-      break;
-    }
+  case Field::Type::REGEX: {
+    Field::Regex value;
+    value.pattern_ = BufferHelper::removeCString(data);
+    value.options_ = BufferHelper::removeCString(data);
+    ENVOY_LOG(trace, "BSON regex pattern: {} options: {}", value.pattern_, value.options_);
+    return FieldPtr{new FieldImpl(key, std::move(value))};
+  }
 
-    case Field::Type::TIMESTAMP: {
-      int64_t value = BufferHelper::removeInt64(data);
-      ENVOY_LOG(trace, "BSON timestamp: {}", value);
-      addTimestamp(key, value);
-      break;
-    }
+  case Field::Type::INT32: {
+    int32_t value = BufferHelper::removeInt32(data);
+    ENVOY_LOG(trace, "BSON int32: {}", value);
+    return FieldPtr{new FieldImpl(key, value)};
+  }
 
-    case Field::Type::INT64: {
-      int64_t value = BufferHelper::removeInt64(data);
-      ENVOY_LOG(trace, "BSON int64: {}", value);
-      addInt64(key, value);
-      break;
-    }
+  case Field::Type::TIMESTAMP: {
+    int64_t value = BufferHelper::removeInt64(data);
+    ENVOY_LOG(trace, "BSON timestamp: {}", value);
+    return FieldPtr{new FieldImpl(Field::Type::TIMESTAMP, key, value)};
+  }
 
-    default:
-      throw EnvoyException(
-          fmt::format("invalid BSON element type: {:#x} key: {}", element_type, key));
-    }
+  case Field::Type::INT64: {
+    int64_t value = BufferHelper::removeInt64(data);
+    ENVOY_LOG(trace, "BSON int64: {}", value);
+    return FieldPtr{new FieldImpl(Field::Type::INT64, key, value)};
+  }
+
+  default:
+    throw EnvoyException(
+        fmt::format("invalid BSON element type: {:#x} key: {}", element_type, key));
   }
 }
 
@@ -562,6 +557,239 @@ const Field* DocumentImpl::find(const std::string& name, Field::Type type) const
   return nullptr;
 }
 
+namespace {
+
+int32_t readInt32(const char* data) {
+  int32_t value;
+  std::memcpy(&value, data, sizeof(int32_t));
+  return le32toh(value);
+}
+
+/**
+ * @return the size of the encoded value of a field, which starts at data and can't span more than
+ *         remaining bytes.
+ */
+uint32_t encodedValueSize(uint8_t element_type, const char* data, uint32_t remaining) {
+  int64_t size;
+  switch (static_cast<Field::Type>(element_type)) {
+  case Field::Type::DOUBLE:
+  case Field::Type::DATETIME:
+  case Field::Type::TIMESTAMP:
+  case Field::Type::INT64: {
+    size = sizeof(int64_t);
+    break;
+  }
+
+  case Field::Type::STRING:
+  case Field::Type::DOCUMENT:
+  case Field::Type::ARRAY:
+  case Field::Type::BINARY: {
+    if (remaining < sizeof(int32_t)) {
+      throw EnvoyException("invalid buffer size");
+    }
+
+    // Strings include their terminating null byte, documents their own length, and binary data is
+    // followed by a subtype byte.
+    const int32_t length = readInt32(data);
+    if (element_type == static_cast<uint8_t>(Field::Type::STRING)) {
+      size = sizeof(int32_t) + static_cast<int64_t>(length);
+    } else if (element_type == static_cast<uint8_t>(Field::Type::BINARY)) {
+      size = sizeof(int32_t) + 1 + static_cast<int64_t>(length);
+    } else {
+      size = length;
+    }
+
+    if (length < 0 || size < static_cast<int64_t>(sizeof(int32_t) + 1) || size > remaining) {
+      throw EnvoyException("invalid buffer size");
+    }
+    if (element_type != static_cast<uint8_t>(Field::Type::BINARY) && data[size - 1] != '\0') {
+      throw EnvoyException("invalid document");
+    }
+    break;
+  }
+
+  case Field::Type::OBJECT_ID: {
+    size = sizeof(Field::ObjectId);
+    break;
+  }
+
+  case Field::Type::BOOLEAN: {
+    size = 1;
+    break;
+  }
+
+  case Field::Type::NULL_VALUE: {
+    size = 0;
+    break;
+  }
+
+  case Field::Type::REGEX: {
+    // Pattern and options, both null terminated.
+    const char* pattern_end = static_cast<const char*>(std::memchr(data, '\0', remaining));
+    const char* options_end =
+        pattern_end == nullptr
+            ? nullptr
+            : static_cast<const char*>(std::memchr(pattern_end + 1, '\0',
+                                                   remaining - (pattern_end + 1 - data)));
+    if (options_end == nullptr) {
+      throw EnvoyException("invalid CString");
+    }
+    size = options_end + 1 - data;
+    break;
+  }
+
+  case Field::Type::INT32: {
+    size = sizeof(int32_t);
+    break;
+  }
+
+  default:
+    throw EnvoyException(fmt::format("invalid BSON element type: {:#x}", element_type));
+  }
+
+  if (size > remaining) {
+    throw EnvoyException("invalid buffer size");
+  }
+
+  return size;
+}
+
+/**
+ * Check the element headers and value sizes of an encoded document, whose length and terminator
+ * have already been checked, and of the documents embedded in it.
+ */
+void validateEncodedDocument(const char* document, uint32_t size) {
+  // Embedded documents are walked in place rather than recursively, so that deeply nested input
+  // can't exhaust the stack. This holds the terminator position of each document being walked.
+  std::vector<uint32_t> ends{size - 1};
+  uint32_t position = sizeof(int32_t);
+  while (!ends.empty()) {
+    const uint32_t end = ends.back();
+    if (position == end) {
+      ends.pop_back();
+      position++;
+      continue;
+    }
+
+    const uint8_t element_type = document[position++];
+    const char* key_end =
+        static_cast<const char*>(std::memchr(document + position, '\0', end - position));
+    if (key_end == nullptr) {
+      throw EnvoyException("invalid CString");
+    }
+
+    position = key_end + 1 - document;
+    const uint32_t value_size = encodedValueSize(element_type, document + position, end - position);
+    if (element_type == static_cast<uint8_t>(Field::Type::DOCUMENT) ||
+        element_type == static_cast<uint8_t>(Field::Type::ARRAY)) {
+      ends.push_back(position + value_size - 1);
+      position += sizeof(int32_t);
+    } else {
+      position += value_size;
+    }
+  }
+}
+
+} // namespace
+
+DocumentSharedPtr LazyDocumentImpl::create(Buffer::Instance& data) {
+  const int32_t size = BufferHelper::peekInt32(data);
+  if (size < static_cast<int32_t>(sizeof(int32_t) + 1) ||
+      static_cast<uint64_t>(size) > data.length()) {
+    throw EnvoyException("invalid BSON message length");
+  }
+
+  std::shared_ptr<std::string> encoded = std::make_shared<std::string>(size, '\0');
+  data.copyOut(0, size, &(*encoded)[0]);
+  data.drain(size);
+  if (encoded->back() != '\0') {
+    throw EnvoyException("invalid document");
+  }
+
+  validateEncodedDocument(encoded->data(), size);
+  return DocumentSharedPtr{new LazyDocumentImpl(std::move(encoded), 0, size)};
+}
+
+int32_t LazyDocumentImpl::byteSize() const { return data_ ? size_ : document_->byteSize(); }
+
+void LazyDocumentImpl::encode(Buffer::Instance& output) const {
+  if (data_) {
+    output.add(data_->data() + offset_, size_);
+  } else {
+    document_->encode(output);
+  }
+}
+
+const Field* LazyDocumentImpl::find(const std::string& name) const {
+  return document_ ? document_->find(name) : findEncoded(name, nullptr);
+}
+
+const Field* LazyDocumentImpl::find(const std::string& name, Field::Type type) const {
+  return document_ ? document_->find(name, type) : findEncoded(name, &type);
+}
+
+const Document& LazyDocumentImpl::document() const {
+  if (!document_) {
+    Buffer::OwnedImpl encoded(data_->data() + offset_, size_);
+    document_ = DocumentImpl::create(encoded);
+  }
+
+  return *document_;
+}
+
+Document& LazyDocumentImpl::mutableDocument() {
+  document();
+
+  // The encoded bytes no longer describe the document. Fields already returned by find() stay
+  // valid.
+  data_.reset();
+  return *document_;
+}
+
+const Field* LazyDocumentImpl::findEncoded(const std::string& name,
+                                           const Field::Type* type) const {
+  // Walk the element headers, skipping over the values of the fields that don't match. The last
+  // byte is the document terminator.
+  const char* document = data_->data() + offset_;
+  const uint32_t end = size_ - 1;
+  uint32_t position = sizeof(int32_t);
+  while (position < end) {
+    const uint8_t element_type = document[position++];
+    const char* key = document + position;
+    const char* key_end = static_cast<const char*>(std::memchr(key, '\0', end - position));
+    if (key_end == nullptr) {
+      throw EnvoyException("invalid CString");
+    }
+
+    const uint32_t key_size = key_end - key;
+    position += key_size + 1;
+    const uint32_t value_size = encodedValueSize(element_type, document + position, end - position);
+    if ((type == nullptr || static_cast<uint8_t>(*type) == element_type) &&
+        key_size == name.size() && std::memcmp(key, name.data(), key_size) == 0) {
+      auto it = found_fields_.find(position);
+      if (it == found_fields_.end()) {
+        FieldPtr field;
+        if (element_type == static_cast<uint8_t>(Field::Type::DOCUMENT) ||
+            element_type == static_cast<uint8_t>(Field::Type::ARRAY)) {
+          field.reset(new FieldImpl(
+              static_cast<Field::Type>(element_type), name,
+              DocumentSharedPtr{new LazyDocumentImpl(data_, offset_ + position, value_size)}));
+        } else {
+          Buffer::OwnedImpl value(document + position, value_size);
+          field = DocumentImpl::createField(element_type, name, value);
+        }
+        it = found_fields_.emplace(position, std::move(field)).first;
+      }
+
+      return it->second.get();
+    }
+
+    position += value_size;
+  }
+
+  return nullptr;
+}
+
 } // namespace Bson
 } // namespace MongoProxy
 } // namespace NetworkFilters
@@ -3,6 +3,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/exception.h"
@@ -257,6 +258,16 @@ public:
   std::string toString() const override;
   const std::list<FieldPtr>& values() const override { return fields_; }
 
+  /**
+   * Decode a field value from a buffer.
+   * @param element_type supplies the BSON element type of the field.
+   * @param key supplies the field key.
+   * @param data supplies the buffer, positioned at the start of the value.
+   * @return FieldPtr the decoded field. Embedded documents and arrays are fully decoded.
+   */
+  static FieldPtr createField(uint8_t element_type, const std::string& key,
+                              Buffer::Instance& data);
+
 private:
   DocumentImpl() {}
 
@@ -265,6 +276,114 @@ private:
   std::list<FieldPtr> fields_;
 };
 
+/**
+ * A document that keeps its encoded bytes and only decodes what is accessed. find() decodes just
+ * the field it returns, embedded documents are themselves lazy views over the same bytes, and
+ * byteSize() and encode() use the encoded bytes directly. values(), toString(), operator==() and
+ * the add*() functions decode the whole document.
+ */
+class LazyDocumentImpl : public Document, public std::enable_shared_from_this<LazyDocumentImpl> {
+public:
+  /**
+   * Copy an encoded document out of a buffer and drain it. The element headers and value sizes of
+   * the document and of the documents embedded in it are validated, so that malformed documents
+   * are rejected here rather than when they are accessed.
+   */
+  static DocumentSharedPtr create(Buffer::Instance& data);
+
+  // Mongo::Document
+  DocumentSharedPtr addDouble(const std::string& key, double value) override {
+    mutableDocument().addDouble(key, value);
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addString(const std::string& key, std::string&& value) override {
+    mutableDocument().addString(key, std::move(value));
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addDocument(const std::string& key, DocumentSharedPtr value) override {
+    mutableDocument().addDocument(key, value);
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addArray(const std::string& key, DocumentSharedPtr value) override {
+    mutableDocument().addArray(key, value);
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addBinary(const std::string& key, std::string&& value) override {
+    mutableDocument().addBinary(key, std::move(value));
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addObjectId(const std::string& key, Field::ObjectId&& value) override {
+    mutableDocument().addObjectId(key, std::move(value));
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addBoolean(const std::string& key, bool value) override {
+    mutableDocument().addBoolean(key, value);
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addDatetime(const std::string& key, int64_t value) override {
+    mutableDocument().addDatetime(key, value);
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addNull(const std::string& key) override {
+    mutableDocument().addNull(key);
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addRegex(const std::string& key, Field::Regex&& value) override {
+    mutableDocument().addRegex(key, std::move(value));
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addInt32(const std::string& key, int32_t value) override {
+    mutableDocument().addInt32(key, value);
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addTimestamp(const std::string& key, int64_t value) override {
+    mutableDocument().addTimestamp(key, value);
+    return shared_from_this();
+  }
+
+  DocumentSharedPtr addInt64(const std::string& key, int64_t value) override {
+    mutableDocument().addInt64(key, value);
+    return shared_from_this();
+  }
+
+  bool operator==(const Document& rhs) const override { return document() == rhs; }
+  int32_t byteSize() const override;
+  void encode(Buffer::Instance& output) const override;
+  const Field* find(const std::string& name) const override;
+  const Field* find(const std::string& name, Field::Type type) const override;
+  std::string toString() const override { return document().toString(); }
+  const std::list<FieldPtr>& values() const override { return document().values(); }
+
+private:
+  LazyDocumentImpl(std::shared_ptr<const std::string> data, uint32_t offset, uint32_t size)
+      : data_(std::move(data)), offset_(offset), size_(size) {}
+
+  const Document& document() const;
+  Document& mutableDocument();
+  const Field* findEncoded(const std::string& name, const Field::Type* type) const;
+
+  // The encoded document is at [offset_, offset_ + size_) of data_, which is shared with the
+  // documents embedded in it. data_ is released once the document is modified.
+  std::shared_ptr<const std::string> data_;
+  const uint32_t offset_;
+  const uint32_t size_;
+  // The whole decoded document, once something needs it.
+  mutable DocumentSharedPtr document_;
+  // Fields decoded by find() before the whole document was decoded, by offset.
+  mutable std::unordered_map<uint32_t, FieldPtr> found_fields_;
+};
+
 } // namespace Bson
 } // namespace MongoProxy
 } // namespace NetworkFilters
@@ -68,7 +68,7 @@ void InsertMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& da
   flags_ = Bson::BufferHelper::removeInt32(data);
   full_collection_name_ = Bson::BufferHelper::removeCString(data);
   while (data.length() - (original_buffer_length - message_length) > 0) {
-    documents_.emplace_back(Bson::DocumentImpl::create(data));
+    documents_.emplace_back(Bson::LazyDocumentImpl::create(data));
   }
 
   ENVOY_LOG(trace, "{}", toString(true));
@@ -142,10 +142,10 @@ void QueryMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& dat
   full_collection_name_ = Bson::BufferHelper::removeCString(data);
   number_to_skip_ = Bson::BufferHelper::removeInt32(data);
   number_to_return_ = Bson::BufferHelper::removeInt32(data);
-  query_ = Bson::DocumentImpl::create(data);
+  query_ = Bson::LazyDocumentImpl::create(data);
 
   if (data.length() - (original_buffer_length - message_length) > 0) {
-    return_fields_selector_ = Bson::DocumentImpl::create(data);
+    return_fields_selector_ = Bson::LazyDocumentImpl::create(data);
   }
 
   ENVOY_LOG(trace, "{}", toString(true));
@@ -190,7 +190,7 @@ void ReplyMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data) {
   starting_from_ = Bson::BufferHelper::removeInt32(data);
   number_returned_ = Bson::BufferHelper::removeInt32(data);
   for (int32_t i = 0; i < number_returned_; i++) {
-    documents_.emplace_back(Bson::DocumentImpl::create(data));
+    documents_.emplace_back(Bson::LazyDocumentImpl::create(data));
   }
 
   ENVOY_LOG(trace, "{}", toString(true));
@@ -232,14 +232,14 @@ void CommandMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& d
 
   database_ = Bson::BufferHelper::removeCString(data);
   command_name_ = Bson::BufferHelper::removeCString(data);
-  metadata_ = Bson::DocumentImpl::create(data);
-  command_args_ = Bson::DocumentImpl::create(data);
+  metadata_ = Bson::LazyDocumentImpl::create(data);
+  command_args_ = Bson::LazyDocumentImpl::create(data);
 
   // There may be additional docs.
   // message_length is mongo message length. original_data_length contains
   // mongo message and possibly first few bytes of next message.
   while (data.length() - (original_data_length - message_length) > 0) {
-    input_docs_.emplace_back(Bson::DocumentImpl::create(data));
+    input_docs_.emplace_back(Bson::LazyDocumentImpl::create(data));
   }
 
   ENVOY_LOG(trace, "{}", toString(true));
@@ -292,14 +292,14 @@ void CommandReplyMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instan
   const uint64_t original_data_length = data.length();
   ASSERT(data.length() >= message_length); // See comment below about relationship.
 
-  metadata_ = Bson::DocumentImpl::create(data);
-  command_reply_ = Bson::DocumentImpl::create(data);
+  metadata_ = Bson::LazyDocumentImpl::create(data);
+  command_reply_ = Bson::LazyDocumentImpl::create(data);
 
   // There may be additional docs.
   // message_length is mongo message length. original_data_length contains
   // mongo message and possibly first few bytes of next message.
   while (data.length() - (original_data_length - message_length) > 0) {
-    output_docs_.emplace_back(Bson::DocumentImpl::create(data));
+    output_docs_.emplace_back(Bson::LazyDocumentImpl::create(data));
   }
 
   ENVOY_LOG(trace, "{}", toString(true));
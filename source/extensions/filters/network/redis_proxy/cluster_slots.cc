@@ -0,0 +1,129 @@
+#include "extensions/filters/network/redis_proxy/cluster_slots.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/network/utility.h"
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+namespace {
+
+/**
+ * CRC16-CCITT (XMODEM), which Redis Cluster uses to hash keys to slots.
+ */
+uint16_t crc16(absl::string_view data) {
+  static const std::array<uint16_t, 256> table = []() {
+    std::array<uint16_t, 256> table;
+    for (uint32_t i = 0; i < table.size(); i++) {
+      uint16_t crc = i << 8;
+      for (uint32_t bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+      }
+      table[i] = crc;
+    }
+    return table;
+  }();
+
+  uint16_t crc = 0;
+  for (const char c : data) {
+    crc = (crc << 8) ^ table[((crc >> 8) ^ static_cast<uint8_t>(c)) & 0xff];
+  }
+  return crc;
+}
+
+} // namespace
+
+uint16_t SlotMap::keySlot(absl::string_view key) {
+  const size_t open = key.find('{');
+  if (open != absl::string_view::npos) {
+    const size_t close = key.find('}', open + 1);
+    if (close != absl::string_view::npos && close != open + 1) {
+      key = key.substr(open + 1, close - open - 1);
+    }
+  }
+  return crc16(key) & (SLOT_COUNT - 1);
+}
+
+SlotMapConstSharedPtr SlotMap::create(const RespValue& response) {
+  if (response.type() != RespType::Array) {
+    return nullptr;
+  }
+
+  // Each entry is [start slot, end slot, primary, replicas...], where a node is [ip, port, ...].
+  std::shared_ptr<SlotMap> slot_map = std::make_shared<SlotMap>();
+  std::unordered_map<std::string, uint16_t> primary_indexes;
+  for (const RespValue& entry : response.asArray()) {
+    if (entry.type() != RespType::Array || entry.asArray().size() < 3) {
+      return nullptr;
+    }
+    const RespValue& start = entry.asArray()[0];
+    const RespValue& end = entry.asArray()[1];
+    const RespValue& primary = entry.asArray()[2];
+    if (start.type() != RespType::Integer || end.type() != RespType::Integer ||
+        start.asInteger() < 0 || end.asInteger() < start.asInteger() ||
+        end.asInteger() >= SLOT_COUNT || primary.type() != RespType::Array ||
+        primary.asArray().size() < 2 || primary.asArray()[0].type() != RespType::BulkString ||
+        primary.asArray()[1].type() != RespType::Integer ||
+        primary.asArray()[1].asInteger() <= 0 || primary.asArray()[1].asInteger() > 65535) {
+      return nullptr;
+    }
+
+    std::string address;
+    try {
+      const uint16_t port = primary.asArray()[1].asInteger();
+      address =
+          Network::Utility::parseInternetAddress(primary.asArray()[0].asString(), port)->asString();
+    } catch (const EnvoyException&) {
+      return nullptr;
+    }
+
+    const auto index = primary_indexes.emplace(address, slot_map->primaries_.size() + 1);
+    if (index.second) {
+      slot_map->primaries_.push_back(address);
+    }
+    std::fill(slot_map->slots_.begin() + start.asInteger(),
+              slot_map->slots_.begin() + end.asInteger() + 1, index.first->second);
+  }
+
+  return slot_map;
+}
+
+absl::optional<Redirection> SlotMap::parseRedirection(const RespValue& value) {
+  if (value.type() != RespType::Error) {
+    return absl::nullopt;
+  }
+
+  // "MOVED <slot> <ip>:<port>" or "ASK <slot> <ip>:<port>".
+  const std::vector<absl::string_view> parts = absl::StrSplit(value.asString(), ' ');
+  uint32_t slot;
+  if (parts.size() != 3 || (parts[0] != "MOVED" && parts[0] != "ASK") ||
+      !absl::SimpleAtoi(parts[1], &slot) || slot >= SLOT_COUNT) {
+    return absl::nullopt;
+  }
+
+  try {
+    return Redirection{parts[0] == "ASK", static_cast<uint16_t>(slot),
+                       Network::Utility::parseInternetAddressAndPort(std::string(parts[2]))
+                           ->asString()};
+  } catch (const EnvoyException&) {
+    return absl::nullopt;
+  }
+}
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "extensions/filters/network/redis_proxy/codec.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+/**
+ * A MOVED or ASK redirection returned by a Redis Cluster node.
+ * See https://redis.io/topics/cluster-spec#redirection-and-resharding.
+ */
+struct Redirection {
+  // True for ASK, which only applies to the next request, false for MOVED.
+  bool ask_;
+  uint16_t slot_;
+  // Address of the node to redirect to, formatted as by Network::Address::Instance::asString().
+  std::string address_;
+};
+
+/**
+ * An immutable map of the Redis Cluster hash slots to the primary node serving each one, built
+ * from a CLUSTER SLOTS response. See https://redis.io/commands/cluster-slots.
+ */
+class SlotMap {
+public:
+  static const uint32_t SLOT_COUNT = 16384;
+
+  /**
+   * @return the hash slot of a key. If the key contains a hash tag (a non empty substring between
+   *         the first '{' and the following '}'), only the hash tag is hashed.
+   */
+  static uint16_t keySlot(absl::string_view key);
+
+  /**
+   * Build a slot map from a CLUSTER SLOTS response.
+   * @param response supplies the response.
+   * @return std::shared_ptr<const SlotMap> the slot map, or nullptr if the response is malformed.
+   */
+  static std::shared_ptr<const SlotMap> create(const RespValue& response);
+
+  /**
+   * Parse a MOVED or ASK error.
+   * @param value supplies a response.
+   * @return the redirection if the response is a MOVED or ASK error, otherwise empty.
+   */
+  static absl::optional<Redirection> parseRedirection(const RespValue& value);
+
+  /**
+   * @return the address of the primary serving a slot, formatted as by
+   *         Network::Address::Instance::asString(), or nullptr if no node serves the slot.
+   */
+  const std::string* primary(uint16_t slot) const {
+    const uint16_t index = slots_[slot];
+    return index == 0 ? nullptr : &primaries_[index - 1];
+  }
+
+private:
+  std::vector<std::string> primaries_;
+  // For each slot, 1 + the index of its primary in primaries_, or 0 if no node serves it.
+  std::array<uint16_t, SLOT_COUNT> slots_{};
+};
+
+typedef std::shared_ptr<const SlotMap> SlotMapConstSharedPtr;
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
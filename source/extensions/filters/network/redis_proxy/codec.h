@@ -24,8 +24,14 @@ enum class RespType { Null, SimpleString, BulkString, Integer, Error, Array };
 class RespValue {
 public:
   RespValue() : type_(RespType::Null) {}
+  RespValue(const RespValue& other);
   ~RespValue() { cleanup(); }
 
+  /**
+   * Deep copy another RESP value.
+   */
+  RespValue& operator=(const RespValue& other);
+
   /**
    * Convert a RESP value to a string for debugging purposes.
    */
@@ -121,6 +127,14 @@ public:
    * @param out supplies the buffer to encode to.
    */
   virtual void encode(const RespValue& value, Buffer::Instance& out) PURE;
+
+  /**
+   * Encode a RESP value that is no longer needed to a buffer. Unlike encode(const RespValue&), the
+   * encoder may hand large strings over to the buffer instead of copying them.
+   * @param value supplies the value to encode, which is consumed.
+   * @param out supplies the buffer to encode to.
+   */
+  virtual void encode(RespValuePtr&& value, Buffer::Instance& out) PURE;
 };
 
 typedef std::unique_ptr<Encoder> EncoderPtr;
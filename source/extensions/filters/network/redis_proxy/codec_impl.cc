@@ -13,6 +13,59 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace RedisProxy {
 
+namespace {
+
+/**
+ * A buffer fragment that owns the string it references. It lets the encoder hand a bulk string
+ * that is no longer needed to the output buffer without copying it, and deletes itself once the
+ * buffer has drained it.
+ */
+class StringFragment : public Buffer::BufferFragment {
+public:
+  StringFragment(std::string&& string) : string_(std::move(string)) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return string_.data(); }
+  size_t size() const override { return string_.size(); }
+  void done() override { delete this; }
+
+private:
+  const std::string string_;
+};
+
+} // namespace
+
+RespValue::RespValue(const RespValue& other) : type_(RespType::Null) { *this = other; }
+
+RespValue& RespValue::operator=(const RespValue& other) {
+  if (&other == this) {
+    return *this;
+  }
+
+  type(other.type());
+  switch (type_) {
+  case RespType::Array: {
+    array_ = other.array_;
+    break;
+  }
+  case RespType::SimpleString:
+  case RespType::BulkString:
+  case RespType::Error: {
+    string_ = other.string_;
+    break;
+  }
+  case RespType::Integer: {
+    integer_ = other.integer_;
+    break;
+  }
+  case RespType::Null: {
+    break;
+  }
+  }
+
+  return *this;
+}
+
 std::string RespValue::toString() const {
   switch (type_) {
   case RespType::Array: {
@@ -362,28 +415,71 @@ void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
   }
 }
 
-void EncoderImpl::encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out) {
+void EncoderImpl::encode(RespValuePtr&& value, Buffer::Instance& out) {
+  encodeOwned(*value, out);
+  value.reset();
+}
+
+void EncoderImpl::encodeOwned(RespValue& value, Buffer::Instance& out) {
+  switch (value.type()) {
+  case RespType::Array: {
+    encodeArrayHeader(value.asArray().size(), out);
+    for (RespValue& element : value.asArray()) {
+      encodeOwned(element, out);
+    }
+    break;
+  }
+  case RespType::BulkString: {
+    std::string& string = value.asString();
+    if (string.size() < MIN_MOVED_BULK_STRING_SIZE) {
+      encodeBulkString(string, out);
+    } else {
+      encodeBulkStringHeader(string.size(), out);
+      out.addBufferFragment(*new StringFragment(std::move(string)));
+      out.add("\r\n", 2);
+    }
+    break;
+  }
+  case RespType::SimpleString:
+  case RespType::Error:
+  case RespType::Null:
+  case RespType::Integer: {
+    encode(value, out);
+    break;
+  }
+  }
+}
+
+void EncoderImpl::encodeArrayHeader(uint64_t size, Buffer::Instance& out) {
   char buffer[32];
   char* current = buffer;
   *current++ = '*';
-  current += StringUtil::itoa(current, 31, array.size());
+  current += StringUtil::itoa(current, 31, size);
   *current++ = '\r';
   *current++ = '\n';
   out.add(buffer, current - buffer);
+}
+
+void EncoderImpl::encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out) {
+  encodeArrayHeader(array.size(), out);
 
   for (const RespValue& value : array) {
     encode(value, out);
   }
 }
 
-void EncoderImpl::encodeBulkString(const std::string& string, Buffer::Instance& out) {
+void EncoderImpl::encodeBulkStringHeader(uint64_t size, Buffer::Instance& out) {
   char buffer[32];
   char* current = buffer;
   *current++ = '$';
-  current += StringUtil::itoa(current, 31, string.size());
+  current += StringUtil::itoa(current, 31, size);
   *current++ = '\r';
   *current++ = '\n';
   out.add(buffer, current - buffer);
+}
+
+void EncoderImpl::encodeBulkString(const std::string& string, Buffer::Instance& out) {
+  encodeBulkStringHeader(string.size(), out);
   out.add(string);
   out.add("\r\n", 2);
 }
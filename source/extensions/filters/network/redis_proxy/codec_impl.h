@@ -18,6 +18,8 @@ namespace RedisProxy {
  * Decoder implementation of https://redis.io/topics/protocol
  *
  * This implementation buffers when needed and will always consume all bytes passed for decoding.
+ * Bulk string bodies are copied out of the input: its slices are owned by the buffer and released
+ * when it is drained, and a body can span several of them.
  */
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::redis> {
 public:
@@ -82,10 +84,18 @@ class EncoderImpl : public Encoder {
 public:
   // RedisProxy::Encoder
   void encode(const RespValue& value, Buffer::Instance& out) override;
+  void encode(RespValuePtr&& value, Buffer::Instance& out) override;
+
+  // Bulk strings at least this long are moved into the output buffer by encode(RespValuePtr&&)
+  // rather than copied. Below this, a copy is cheaper than allocating a buffer fragment.
+  static const uint64_t MIN_MOVED_BULK_STRING_SIZE = 16 * 1024;
 
 private:
+  void encodeArrayHeader(uint64_t size, Buffer::Instance& out);
   void encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out);
+  void encodeBulkStringHeader(uint64_t size, Buffer::Instance& out);
   void encodeBulkString(const std::string& string, Buffer::Instance& out);
+  void encodeOwned(RespValue& value, Buffer::Instance& out);
   void encodeError(const std::string& string, Buffer::Instance& out);
   void encodeInteger(int64_t integer, Buffer::Instance& out);
   void encodeSimpleString(const std::string& string, Buffer::Instance& out);
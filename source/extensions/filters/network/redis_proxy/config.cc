@@ -31,7 +31,8 @@ Network::FilterFactoryCb RedisProxyFilterConfigFactory::createFilterFactoryFromP
                                           context.drainDecision(), context.runtime()));
   ConnPool::InstancePtr conn_pool(new ConnPool::InstanceImpl(
       filter_config->cluster_name_, context.clusterManager(),
-      ConnPool::ClientFactoryImpl::instance_, context.threadLocal(), proto_config.settings()));
+      ConnPool::ClientFactoryImpl::instance_, context.threadLocal(), context.dispatcher(),
+      proto_config.settings()));
   std::shared_ptr<CommandSplitter::Instance> splitter(new CommandSplitter::InstanceImpl(
       std::move(conn_pool), context.scope(), filter_config->stat_prefix_));
   return [splitter, filter_config](Network::FilterManager& filter_manager) -> void {
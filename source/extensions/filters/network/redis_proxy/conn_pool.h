@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -94,6 +95,29 @@ public:
    * passive healthcheck operations.
    */
   virtual bool disableOutlierEvents() const PURE;
+
+  /**
+   * @return bool whether requests are batched per connection and flushed as a single write. When
+   *         false, each request is written as soon as it is made and the limits below are unused.
+   */
+  virtual bool enableBatching() const PURE;
+
+  /**
+   * @return uint32_t the number of buffered bytes at which a batch is flushed, or 0 for no limit.
+   */
+  virtual uint32_t maxBufferSizeBeforeFlush() const PURE;
+
+  /**
+   * @return uint32_t the number of buffered requests at which a batch is flushed, or 0 for no
+   *         limit.
+   */
+  virtual uint32_t maxRequestsBeforeFlush() const PURE;
+
+  /**
+   * @return std::chrono::milliseconds how long after its first request a batch is flushed. 0
+   *         flushes on the next dispatcher loop iteration.
+   */
+  virtual std::chrono::milliseconds bufferFlushTimeout() const PURE;
 };
 
 /**
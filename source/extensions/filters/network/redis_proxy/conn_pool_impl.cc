@@ -13,9 +13,43 @@ namespace NetworkFilters {
 namespace RedisProxy {
 namespace ConnPool {
 
+namespace {
+
+RespValue* makeCommand(const std::vector<std::string>& args) {
+  std::vector<RespValue> values(args.size());
+  for (uint64_t i = 0; i < args.size(); i++) {
+    values[i].type(RespType::BulkString);
+    values[i].asString() = args[i];
+  }
+  RespValue* command = new RespValue();
+  command->type(RespType::Array);
+  command->asArray().swap(values);
+  return command;
+}
+
+const RespValue& askingRequest() {
+  static const RespValue* request = makeCommand({"ASKING"});
+  return *request;
+}
+
+const RespValue& clusterSlotsRequest() {
+  static const RespValue* request = makeCommand({"CLUSTER", "SLOTS"});
+  return *request;
+}
+
+} // namespace
+
 ConfigImpl::ConfigImpl(
     const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings& config)
-    : op_timeout_(PROTOBUF_GET_MS_REQUIRED(config, op_timeout)) {}
+    : op_timeout_(PROTOBUF_GET_MS_REQUIRED(config, op_timeout)),
+      enable_batching_(config.has_batch_settings()),
+      max_buffer_size_before_flush_(config.batch_settings().max_buffer_size_before_flush()),
+      max_requests_before_flush_(config.batch_settings().max_requests_before_flush()),
+      buffer_flush_timeout_(
+          PROTOBUF_GET_MS_OR_DEFAULT(config.batch_settings(), buffer_flush_timeout, 0)),
+      redis_cluster_(config.has_redis_cluster()),
+      slot_refresh_interval_(
+          PROTOBUF_GET_MS_OR_DEFAULT(config.redis_cluster(), slot_refresh_interval, 5000)) {}
 
 ClientPtr ClientImpl::create(Upstream::HostConstSharedPtr host, Event::Dispatcher& dispatcher,
                              EncoderPtr&& encoder, DecoderFactory& decoder_factory,
@@ -33,14 +67,19 @@ ClientPtr ClientImpl::create(Upstream::HostConstSharedPtr host, Event::Dispatche
 
 ClientImpl::ClientImpl(Upstream::HostConstSharedPtr host, Event::Dispatcher& dispatcher,
                        EncoderPtr&& encoder, DecoderFactory& decoder_factory, const Config& config)
-    : host_(host), encoder_(std::move(encoder)), decoder_(decoder_factory.create(*this)),
-      config_(config),
+    : host_(host), dispatcher_(dispatcher), encoder_(std::move(encoder)),
+      decoder_(decoder_factory.create(*this)), config_(config),
       connect_or_op_timer_(dispatcher.createTimer([this]() -> void { onConnectOrOpTimeout(); })) {
   host->cluster().stats().upstream_cx_total_.inc();
   host->stats().cx_total_.inc();
   host->cluster().stats().upstream_cx_active_.inc();
   host->stats().cx_active_.inc();
   connect_or_op_timer_->enableTimer(host->cluster().connectTimeout());
+
+  if (config_.enableBatching()) {
+    batch_stats_.reset(new BatchStats{ALL_REDIS_BATCH_STATS(
+        POOL_HISTOGRAM_PREFIX(host->cluster().statsScope(), "redis."))});
+  }
 }
 
 ClientImpl::~ClientImpl() {
@@ -57,7 +96,25 @@ PoolRequest* ClientImpl::makeRequest(const RespValue& request, PoolCallbacks& ca
 
   pending_requests_.emplace_back(*this, callbacks);
   encoder_->encode(request, encoder_buffer_);
-  connection_->write(encoder_buffer_, false);
+  if (!config_.enableBatching()) {
+    connection_->write(encoder_buffer_, false);
+  } else {
+    // Requests made while the batch is open are appended to it. The batch is written when one of
+    // the limits is reached or when the flush timer fires, whichever comes first.
+    if (flush_timer_ == nullptr) {
+      flush_timer_ = dispatcher_.createTimer([this]() -> void { flushBatch(); });
+    }
+    batched_requests_++;
+    if ((config_.maxBufferSizeBeforeFlush() > 0 &&
+         encoder_buffer_.length() >= config_.maxBufferSizeBeforeFlush()) ||
+        (config_.maxRequestsBeforeFlush() > 0 &&
+         batched_requests_ >= config_.maxRequestsBeforeFlush())) {
+      flush_timer_->disableTimer();
+      flushBatch();
+    } else if (batched_requests_ == 1) {
+      flush_timer_->enableTimer(config_.bufferFlushTimeout());
+    }
+  }
 
   // Only boost the op timeout if:
   // - We are not already connected. Otherwise, we are governed by the connect timeout and the timer
@@ -72,6 +129,13 @@ PoolRequest* ClientImpl::makeRequest(const RespValue& request, PoolCallbacks& ca
   return &pending_requests_.back();
 }
 
+void ClientImpl::flushBatch() {
+  batch_stats_->upstream_batch_bytes_.recordValue(encoder_buffer_.length());
+  batch_stats_->upstream_batch_requests_.recordValue(batched_requests_);
+  batched_requests_ = 0;
+  connection_->write(encoder_buffer_, false);
+}
+
 void ClientImpl::onConnectOrOpTimeout() {
   putOutlierEvent(Upstream::Outlier::Result::TIMEOUT);
   if (connected_) {
@@ -127,6 +191,12 @@ void ClientImpl::onEvent(Network::ConnectionEvent event) {
     }
 
     connect_or_op_timer_->disableTimer();
+    if (flush_timer_ != nullptr) {
+      // Any unwritten batch belongs to requests that were just failed.
+      flush_timer_->disableTimer();
+      encoder_buffer_.drain(encoder_buffer_.length());
+      batched_requests_ = 0;
+    }
   } else if (event == Network::ConnectionEvent::Connected) {
     connected_ = true;
     ASSERT(!pending_requests_.empty());
@@ -190,13 +260,25 @@ ClientPtr ClientFactoryImpl::create(Upstream::HostConstSharedPtr host,
 
 InstanceImpl::InstanceImpl(
     const std::string& cluster_name, Upstream::ClusterManager& cm, ClientFactory& client_factory,
-    ThreadLocal::SlotAllocator& tls,
+    ThreadLocal::SlotAllocator& tls, Event::Dispatcher& dispatcher,
     const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings& config)
-    : cm_(cm), client_factory_(client_factory), tls_(tls.allocateSlot()), config_(config) {
+    : cluster_name_(cluster_name), cm_(cm), client_factory_(client_factory),
+      tls_(tls.allocateSlot()), config_(config) {
   tls_->set([this, cluster_name](
                 Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<ThreadLocalPool>(*this, dispatcher, cluster_name);
+    ThreadLocalPoolSharedPtr pool =
+        std::make_shared<ThreadLocalPool>(*this, dispatcher, cluster_name);
+    if (config_.redisCluster()) {
+      Thread::LockGuard lock(pool_handles_lock_);
+      pool_handles_.push_back({dispatcher, pool});
+      pool->slot_map_ = latest_slot_map_;
+    }
+    return pool;
   });
+
+  if (config_.redisCluster()) {
+    slot_refresher_.reset(new SlotRefresher(*this, dispatcher));
+  }
 }
 
 PoolRequest* InstanceImpl::makeRequest(const std::string& hash_key, const RespValue& value,
@@ -213,10 +295,20 @@ InstanceImpl::ThreadLocalPool::ThreadLocalPool(InstanceImpl& parent, Event::Disp
   //                     safely clean things up and fail requests.
   ASSERT(!cluster_->info()->addedViaApi());
   local_host_set_member_update_cb_handle_ = cluster_->prioritySet().addMemberUpdateCb(
-      [this](uint32_t, const std::vector<Upstream::HostSharedPtr>&,
+      [this](uint32_t, const std::vector<Upstream::HostSharedPtr>& hosts_added,
              const std::vector<Upstream::HostSharedPtr>& hosts_removed) -> void {
+        onHostsAdded(hosts_added);
         onHostsRemoved(hosts_removed);
       });
+
+  for (const auto& host_set : cluster_->prioritySet().hostSetsPerPriority()) {
+    onHostsAdded(host_set->hosts());
+  }
+
+  if (parent_.config_.redisCluster()) {
+    redis_cluster_stats_.reset(new RedisClusterStats{
+        ALL_REDIS_CLUSTER_STATS(POOL_COUNTER_PREFIX(cluster_->info()->statsScope(), "redis."))});
+  }
 }
 
 InstanceImpl::ThreadLocalPool::~ThreadLocalPool() {
@@ -226,6 +318,18 @@ InstanceImpl::ThreadLocalPool::~ThreadLocalPool() {
   }
 }
 
+void InstanceImpl::ThreadLocalPool::onHostsAdded(
+    const std::vector<Upstream::HostSharedPtr>& hosts_added) {
+  if (!parent_.config_.redisCluster()) {
+    return;
+  }
+
+  // Slot maps and redirections name nodes by address.
+  for (const auto& host : hosts_added) {
+    host_address_map_[host->address()->asString()] = host;
+  }
+}
+
 void InstanceImpl::ThreadLocalPool::onHostsRemoved(
     const std::vector<Upstream::HostSharedPtr>& hosts_removed) {
   for (const auto& host : hosts_removed) {
@@ -235,18 +339,31 @@ void InstanceImpl::ThreadLocalPool::onHostsRemoved(
       // we just close the connection. This will fail any pending requests.
       it->second->redis_client_->close();
     }
+
+    auto address_it = host_address_map_.find(host->address()->asString());
+    if (address_it != host_address_map_.end() && address_it->second == host) {
+      host_address_map_.erase(address_it);
+    }
   }
 }
 
-PoolRequest* InstanceImpl::ThreadLocalPool::makeRequest(const std::string& hash_key,
-                                                        const RespValue& request,
-                                                        PoolCallbacks& callbacks) {
-  LbContextImpl lb_context(hash_key);
-  Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(&lb_context);
-  if (!host) {
-    return nullptr;
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::chooseHost(const std::string& hash_key) {
+  if (slot_map_ != nullptr) {
+    const std::string* primary = slot_map_->primary(SlotMap::keySlot(hash_key));
+    if (primary != nullptr) {
+      auto it = host_address_map_.find(*primary);
+      if (it != host_address_map_.end()) {
+        return it->second;
+      }
+    }
   }
 
+  LbContextImpl lb_context(hash_key);
+  return cluster_->loadBalancer().chooseHost(&lb_context);
+}
+
+Client& InstanceImpl::ThreadLocalPool::client(const Upstream::HostConstSharedPtr& host) {
   ThreadLocalActiveClientPtr& client = client_map_[host];
   if (!client) {
     client.reset(new ThreadLocalActiveClient(*this));
@@ -255,7 +372,56 @@ PoolRequest* InstanceImpl::ThreadLocalPool::makeRequest(const std::string& hash_
     client->redis_client_->addConnectionCallbacks(*client);
   }
 
-  return client->redis_client_->makeRequest(request, callbacks);
+  return *client->redis_client_;
+}
+
+PoolRequest* InstanceImpl::ThreadLocalPool::makeRequest(const std::string& hash_key,
+                                                        const RespValue& request,
+                                                        PoolCallbacks& callbacks) {
+  Upstream::HostConstSharedPtr host = chooseHost(hash_key);
+  if (!host) {
+    return nullptr;
+  }
+
+  if (!parent_.config_.redisCluster()) {
+    return client(host).makeRequest(request, callbacks);
+  }
+
+  RedirectingRequestPtr redirecting_request(new RedirectingRequest(*this, request, callbacks));
+  redirecting_request->handle_ = client(host).makeRequest(request, *redirecting_request);
+  if (redirecting_request->handle_ == nullptr) {
+    return nullptr;
+  }
+
+  redirecting_request->moveIntoList(std::move(redirecting_request), redirecting_requests_);
+  return redirecting_requests_.front().get();
+}
+
+bool InstanceImpl::ThreadLocalPool::redirect(RedirectingRequest& request,
+                                             const Redirection& redirection) {
+  auto it = host_address_map_.find(redirection.address_);
+  if (it == host_address_map_.end()) {
+    return false;
+  }
+
+  Client& target = client(it->second);
+  if (redirection.ask_) {
+    // ASK only applies to the next request, which has to be preceded by ASKING.
+    target.makeRequest(askingRequest(), asking_callbacks_);
+  }
+
+  request.handle_ = target.makeRequest(request.request_, request);
+  if (request.handle_ == nullptr) {
+    return false;
+  }
+
+  if (redirection.ask_) {
+    redis_cluster_stats_->upstream_ask_.inc();
+  } else {
+    redis_cluster_stats_->upstream_moved_.inc();
+  }
+  request.redirected_ = true;
+  return true;
 }
 
 void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent event) {
@@ -268,6 +434,111 @@ void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent eve
   }
 }
 
+InstanceImpl::RedirectingRequest::RedirectingRequest(ThreadLocalPool& parent,
+                                                     const RespValue& request,
+                                                     PoolCallbacks& callbacks)
+    : parent_(parent), request_(request), callbacks_(callbacks) {}
+
+void InstanceImpl::RedirectingRequest::cancel() {
+  handle_->cancel();
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.redirecting_requests_));
+}
+
+void InstanceImpl::RedirectingRequest::onResponse(RespValuePtr&& value) {
+  handle_ = nullptr;
+  if (!redirected_) {
+    const absl::optional<Redirection> redirection = SlotMap::parseRedirection(*value);
+    if (redirection.has_value() && parent_.redirect(*this, redirection.value())) {
+      return;
+    }
+  }
+
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.redirecting_requests_));
+  callbacks_.onResponse(std::move(value));
+}
+
+void InstanceImpl::RedirectingRequest::onFailure() {
+  handle_ = nullptr;
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.redirecting_requests_));
+  callbacks_.onFailure();
+}
+
+InstanceImpl::SlotRefresher::SlotRefresher(InstanceImpl& parent, Event::Dispatcher& dispatcher)
+    : parent_(parent), dispatcher_(dispatcher),
+      refresh_timer_(dispatcher.createTimer([this]() -> void { refresh(); })) {
+  refresh_timer_->enableTimer(std::chrono::milliseconds(0));
+}
+
+InstanceImpl::SlotRefresher::~SlotRefresher() {
+  if (current_request_ != nullptr) {
+    current_request_->cancel();
+  }
+  if (client_ != nullptr) {
+    client_->close();
+  }
+}
+
+void InstanceImpl::SlotRefresher::refresh() {
+  if (client_ == nullptr) {
+    Upstream::ThreadLocalCluster* cluster = parent_.cm_.get(parent_.cluster_name_);
+    std::vector<Upstream::HostSharedPtr> hosts;
+    for (const auto& host_set : cluster->prioritySet().hostSetsPerPriority()) {
+      hosts.insert(hosts.end(), host_set->hosts().begin(), host_set->hosts().end());
+    }
+    if (hosts.empty()) {
+      refresh_timer_->enableTimer(parent_.config_.slotRefreshInterval());
+      return;
+    }
+
+    // Ask a different node each time so that a single unhealthy node can't stall discovery.
+    client_ = parent_.client_factory_.create(hosts[next_host_++ % hosts.size()], dispatcher_,
+                                             parent_.config_);
+    client_->addConnectionCallbacks(*this);
+  }
+
+  current_request_ = client_->makeRequest(clusterSlotsRequest(), *this);
+  if (current_request_ == nullptr) {
+    refresh_timer_->enableTimer(parent_.config_.slotRefreshInterval());
+  }
+}
+
+void InstanceImpl::SlotRefresher::onResponse(RespValuePtr&& value) {
+  current_request_ = nullptr;
+  SlotMapConstSharedPtr slot_map = SlotMap::create(*value);
+  if (slot_map != nullptr) {
+    Thread::LockGuard lock(parent_.pool_handles_lock_);
+    parent_.latest_slot_map_ = slot_map;
+    for (const ThreadLocalPoolHandle& handle : parent_.pool_handles_) {
+      // The pool and this InstanceImpl may be destroyed before the post runs, so only the handle
+      // and the slot map are captured.
+      std::weak_ptr<ThreadLocalPool> weak_pool = handle.pool_;
+      handle.dispatcher_.post([weak_pool, slot_map]() -> void {
+        ThreadLocalPoolSharedPtr pool = weak_pool.lock();
+        if (pool != nullptr) {
+          pool->slot_map_ = slot_map;
+        }
+      });
+    }
+  } else {
+    ENVOY_LOG(debug, "redis: invalid CLUSTER SLOTS response: '{}'", value->toString());
+  }
+
+  refresh_timer_->enableTimer(parent_.config_.slotRefreshInterval());
+}
+
+void InstanceImpl::SlotRefresher::onFailure() {
+  current_request_ = nullptr;
+  refresh_timer_->enableTimer(parent_.config_.slotRefreshInterval());
+}
+
+void InstanceImpl::SlotRefresher::onEvent(Network::ConnectionEvent event) {
+  if (event == Network::ConnectionEvent::RemoteClose ||
+      event == Network::ConnectionEvent::LocalClose) {
+    // The next refresh connects to the next node.
+    dispatcher_.deferredDelete(std::move(client_));
+  }
+}
+
 } // namespace ConnPool
 } // namespace RedisProxy
 } // namespace NetworkFilters
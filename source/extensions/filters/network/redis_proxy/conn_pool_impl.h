@@ -9,13 +9,19 @@
 #include <vector>
 
 #include "envoy/config/filter/network/redis_proxy/v2/redis_proxy.pb.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/linked_object.h"
+#include "common/common/lock_guard.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
 #include "common/network/filter_impl.h"
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/network/redis_proxy/cluster_slots.h"
 #include "extensions/filters/network/redis_proxy/codec_impl.h"
 #include "extensions/filters/network/redis_proxy/conn_pool.h"
 
@@ -35,9 +41,55 @@ public:
 
   bool disableOutlierEvents() const override { return false; }
   std::chrono::milliseconds opTimeout() const override { return op_timeout_; }
+  bool enableBatching() const override { return enable_batching_; }
+  uint32_t maxBufferSizeBeforeFlush() const override { return max_buffer_size_before_flush_; }
+  uint32_t maxRequestsBeforeFlush() const override { return max_requests_before_flush_; }
+  std::chrono::milliseconds bufferFlushTimeout() const override { return buffer_flush_timeout_; }
+
+  // Whether the upstream cluster is a Redis Cluster, and how often its slot map is refreshed.
+  bool redisCluster() const { return redis_cluster_; }
+  std::chrono::milliseconds slotRefreshInterval() const { return slot_refresh_interval_; }
 
 private:
   const std::chrono::milliseconds op_timeout_;
+  const bool enable_batching_;
+  const uint32_t max_buffer_size_before_flush_;
+  const uint32_t max_requests_before_flush_;
+  const std::chrono::milliseconds buffer_flush_timeout_;
+  const bool redis_cluster_;
+  const std::chrono::milliseconds slot_refresh_interval_;
+};
+
+/**
+ * All redis connection pool batching stats, in the upstream cluster's scope. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_REDIS_BATCH_STATS(HISTOGRAM)                                                           \
+  HISTOGRAM(upstream_batch_bytes)                                                                  \
+  HISTOGRAM(upstream_batch_requests)
+// clang-format on
+
+/**
+ * Struct definition for all redis connection pool batching stats. @see stats_macros.h
+ */
+struct BatchStats {
+  ALL_REDIS_BATCH_STATS(GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * All Redis Cluster redirection stats, in the upstream cluster's scope. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_REDIS_CLUSTER_STATS(COUNTER)                                                           \
+  COUNTER(upstream_ask)                                                                            \
+  COUNTER(upstream_moved)
+// clang-format on
+
+/**
+ * Struct definition for all Redis Cluster redirection stats. @see stats_macros.h
+ */
+struct RedisClusterStats {
+  ALL_REDIS_CLUSTER_STATS(GENERATE_COUNTER_STRUCT)
 };
 
 class ClientImpl : public Client, public DecoderCallbacks, public Network::ConnectionCallbacks {
@@ -84,6 +136,7 @@ private:
              DecoderFactory& decoder_factory, const Config& config);
   void onConnectOrOpTimeout();
   void onData(Buffer::Instance& data);
+  void flushBatch();
   void putOutlierEvent(Upstream::Outlier::Result result);
 
   // RedisProxy::DecoderCallbacks
@@ -95,6 +148,7 @@ private:
   void onBelowWriteBufferLowWatermark() override {}
 
   Upstream::HostConstSharedPtr host_;
+  Event::Dispatcher& dispatcher_;
   Network::ClientConnectionPtr connection_;
   EncoderPtr encoder_;
   Buffer::OwnedImpl encoder_buffer_;
@@ -103,6 +157,11 @@ private:
   std::list<PendingRequest> pending_requests_;
   Event::TimerPtr connect_or_op_timer_;
   bool connected_{};
+  // Only set when batching is enabled. The flush timer is created with the first batch.
+  Event::TimerPtr flush_timer_;
+  std::unique_ptr<BatchStats> batch_stats_;
+  // Number of requests encoded into encoder_buffer_ but not yet written.
+  uint32_t batched_requests_{};
 };
 
 class ClientFactoryImpl : public ClientFactory {
@@ -121,7 +180,7 @@ class InstanceImpl : public Instance {
 public:
   InstanceImpl(
       const std::string& cluster_name, Upstream::ClusterManager& cm, ClientFactory& client_factory,
-      ThreadLocal::SlotAllocator& tls,
+      ThreadLocal::SlotAllocator& tls, Event::Dispatcher& dispatcher,
       const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings& config);
 
   // RedisProxy::ConnPool::Instance
@@ -146,12 +205,53 @@ private:
 
   typedef std::unique_ptr<ThreadLocalActiveClient> ThreadLocalActiveClientPtr;
 
+  /**
+   * A request to a Redis Cluster node. It keeps a copy of the request so that it can be sent again
+   * to another node if the first one answers with a MOVED or ASK redirection.
+   */
+  struct RedirectingRequest : public PoolRequest,
+                              public PoolCallbacks,
+                              public Event::DeferredDeletable,
+                              public LinkedObject<RedirectingRequest> {
+    RedirectingRequest(ThreadLocalPool& parent, const RespValue& request,
+                       PoolCallbacks& callbacks);
+
+    // RedisProxy::ConnPool::PoolRequest
+    void cancel() override;
+
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&& value) override;
+    void onFailure() override;
+
+    ThreadLocalPool& parent_;
+    const RespValue request_;
+    PoolCallbacks& callbacks_;
+    PoolRequest* handle_{};
+    bool redirected_{};
+  };
+
+  typedef std::unique_ptr<RedirectingRequest> RedirectingRequestPtr;
+
+  /**
+   * Callbacks for the ASKING requests that precede a request redirected with ASK. Their "OK"
+   * responses are dropped.
+   */
+  struct AskingCallbacks : public PoolCallbacks {
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&&) override {}
+    void onFailure() override {}
+  };
+
   struct ThreadLocalPool : public ThreadLocal::ThreadLocalObject {
     ThreadLocalPool(InstanceImpl& parent, Event::Dispatcher& dispatcher,
                     const std::string& cluster_name);
     ~ThreadLocalPool();
     PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                              PoolCallbacks& callbacks);
+    Upstream::HostConstSharedPtr chooseHost(const std::string& hash_key);
+    Client& client(const Upstream::HostConstSharedPtr& host);
+    bool redirect(RedirectingRequest& request, const Redirection& redirection);
+    void onHostsAdded(const std::vector<Upstream::HostSharedPtr>& hosts_added);
     void onHostsRemoved(const std::vector<Upstream::HostSharedPtr>& hosts_removed);
 
     InstanceImpl& parent_;
@@ -159,6 +259,51 @@ private:
     Upstream::ThreadLocalCluster* cluster_;
     std::unordered_map<Upstream::HostConstSharedPtr, ThreadLocalActiveClientPtr> client_map_;
     Envoy::Common::CallbackHandle* local_host_set_member_update_cb_handle_;
+    // Only used for Redis Cluster upstreams. The slot map is published by the SlotRefresher.
+    SlotMapConstSharedPtr slot_map_;
+    std::unordered_map<std::string, Upstream::HostConstSharedPtr> host_address_map_;
+    std::list<RedirectingRequestPtr> redirecting_requests_;
+    AskingCallbacks asking_callbacks_;
+    std::unique_ptr<RedisClusterStats> redis_cluster_stats_;
+  };
+
+  typedef std::shared_ptr<ThreadLocalPool> ThreadLocalPoolSharedPtr;
+
+  /**
+   * A worker's pool, as seen by the SlotRefresher on the main thread. The pool is only
+   * dereferenced on its own dispatcher, and only if it still exists there.
+   */
+  struct ThreadLocalPoolHandle {
+    Event::Dispatcher& dispatcher_;
+    std::weak_ptr<ThreadLocalPool> pool_;
+  };
+
+  /**
+   * Periodically fetches the slot map of a Redis Cluster upstream with CLUSTER SLOTS on the main
+   * thread, cycling through the hosts of the cluster, and publishes it to all workers.
+   */
+  struct SlotRefresher : public PoolCallbacks,
+                         public Network::ConnectionCallbacks,
+                         Logger::Loggable<Logger::Id::redis> {
+    SlotRefresher(InstanceImpl& parent, Event::Dispatcher& dispatcher);
+    ~SlotRefresher();
+    void refresh();
+
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&& value) override;
+    void onFailure() override;
+
+    // Network::ConnectionCallbacks
+    void onEvent(Network::ConnectionEvent event) override;
+    void onAboveWriteBufferHighWatermark() override {}
+    void onBelowWriteBufferLowWatermark() override {}
+
+    InstanceImpl& parent_;
+    Event::Dispatcher& dispatcher_;
+    Event::TimerPtr refresh_timer_;
+    ClientPtr client_;
+    PoolRequest* current_request_{};
+    uint64_t next_host_{};
   };
 
   struct LbContextImpl : public Upstream::LoadBalancerContext {
@@ -173,10 +318,17 @@ private:
     const absl::optional<uint64_t> hash_key_;
   };
 
+  const std::string cluster_name_;
   Upstream::ClusterManager& cm_;
   ClientFactory& client_factory_;
   ThreadLocal::SlotPtr tls_;
   ConfigImpl config_;
+  std::unique_ptr<SlotRefresher> slot_refresher_;
+  // Only used for Redis Cluster upstreams. The pools register themselves as they are created on
+  // each thread, and pick up the latest slot map when they do.
+  Thread::MutexBasicLockable pool_handles_lock_;
+  std::vector<ThreadLocalPoolHandle> pool_handles_ GUARDED_BY(pool_handles_lock_);
+  SlotMapConstSharedPtr latest_slot_map_ GUARDED_BY(pool_handles_lock_);
 };
 
 } // namespace ConnPool
@@ -261,6 +261,24 @@ bool BinaryProtocolImpl::readBinary(Buffer::Instance& buffer, std::string& value
   return readString(buffer, value);
 }
 
+bool BinaryProtocolImpl::skipString(Buffer::Instance& buffer) {
+  if (buffer.length() < 4) {
+    return false;
+  }
+
+  int32_t str_len = BufferHelper::peekI32(buffer);
+  if (str_len < 0) {
+    throw EnvoyException(fmt::format("negative binary protocol string/binary length {}", str_len));
+  }
+
+  if (buffer.length() < static_cast<uint64_t>(str_len) + 4) {
+    return false;
+  }
+
+  buffer.drain(static_cast<uint64_t>(str_len) + 4);
+  return true;
+}
+
 bool LaxBinaryProtocolImpl::readMessageBegin(Buffer::Instance& buffer, std::string& name,
                                              MessageType& msg_type, int32_t& seq_id) {
   // Minimum message length:
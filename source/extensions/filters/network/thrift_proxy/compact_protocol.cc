@@ -419,6 +419,29 @@ bool CompactProtocolImpl::readBinary(Buffer::Instance& buffer, std::string& valu
   return readString(buffer, value);
 }
 
+bool CompactProtocolImpl::skipString(Buffer::Instance& buffer) {
+  if (buffer.length() < 1) {
+    return false;
+  }
+
+  int len_size;
+  int32_t str_len = BufferHelper::peekZigZagI32(buffer, 0, len_size);
+  if (len_size < 0) {
+    return false;
+  }
+
+  if (str_len < 0) {
+    throw EnvoyException(fmt::format("negative compact protocol string/binary length {}", str_len));
+  }
+
+  if (buffer.length() < static_cast<uint64_t>(str_len + len_size)) {
+    return false;
+  }
+
+  buffer.drain(str_len + len_size);
+  return true;
+}
+
 } // namespace ThriftProxy
 } // namespace NetworkFilters
 } // namespace Extensions
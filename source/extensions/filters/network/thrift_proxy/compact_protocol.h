@@ -48,6 +48,7 @@ public:
   bool readDouble(Buffer::Instance& buffer, double& value) override;
   bool readString(Buffer::Instance& buffer, std::string& value) override;
   bool readBinary(Buffer::Instance& buffer, std::string& value) override;
+  bool skipString(Buffer::Instance& buffer) override;
 
   static bool isMagic(uint16_t word) { return (word & MagicMask) == Magic; }
 
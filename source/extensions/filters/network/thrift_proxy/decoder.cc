@@ -69,6 +69,11 @@ ProtocolState DecoderStateMachine::fieldBegin(Buffer::Instance& buffer) {
     return ProtocolState::StructEnd;
   }
 
+  if (passthrough_ && frame_size_.has_value() && stack_.size() == 1) {
+    // First field of the message's outermost struct: the rest of the frame is not decoded.
+    return ProtocolState::PassthroughData;
+  }
+
   stack_.emplace_back(Frame(ProtocolState::FieldEnd, field_type));
 
   return ProtocolState::FieldValue;
@@ -208,6 +213,24 @@ ProtocolState DecoderStateMachine::setEnd(Buffer::Instance& buffer) {
   return popReturnState();
 }
 
+// PassthroughData -> MessageEnd
+ProtocolState DecoderStateMachine::passthroughData(Buffer::Instance& buffer) {
+  ASSERT(frame_size_.has_value());
+  if (consumed_ > frame_size_.value()) {
+    throw EnvoyException(
+        fmt::format("thrift message header exceeds frame size {}", frame_size_.value()));
+  }
+
+  uint64_t remaining = frame_size_.value() - consumed_;
+  if (buffer.length() < remaining) {
+    buffer.drain(buffer.length());
+    return ProtocolState::WaitForData;
+  }
+
+  buffer.drain(remaining);
+  return ProtocolState::MessageEnd;
+}
+
 ProtocolState DecoderStateMachine::handleValue(Buffer::Instance& buffer, FieldType elem_type,
                                                ProtocolState return_state) {
   switch (elem_type) {
@@ -253,6 +276,13 @@ ProtocolState DecoderStateMachine::handleValue(Buffer::Instance& buffer, FieldTy
     break;
   }
   case FieldType::String: {
+    if (passthrough_) {
+      if (!proto_.skipString(buffer)) {
+        return ProtocolState::WaitForData;
+      }
+      break;
+    }
+
     std::string value;
     if (!proto_.readString(buffer, value)) {
       return ProtocolState::WaitForData;
@@ -312,6 +342,8 @@ ProtocolState DecoderStateMachine::handleState(Buffer::Instance& buffer) {
     return setValue(buffer);
   case ProtocolState::SetEnd:
     return setEnd(buffer);
+  case ProtocolState::PassthroughData:
+    return passthroughData(buffer);
   case ProtocolState::MessageEnd:
     return messageEnd(buffer);
   default:
@@ -328,7 +360,9 @@ ProtocolState DecoderStateMachine::popReturnState() {
 
 ProtocolState DecoderStateMachine::run(Buffer::Instance& buffer) {
   while (state_ != ProtocolState::Done) {
+    const uint64_t available = buffer.length();
     ProtocolState s = handleState(buffer);
+    consumed_ += available - buffer.length();
     if (s == ProtocolState::WaitForData) {
       return s;
     }
@@ -340,8 +374,11 @@ ProtocolState DecoderStateMachine::run(Buffer::Instance& buffer) {
 }
 
 Decoder::Decoder(TransportPtr&& transport, ProtocolPtr&& protocol)
+    : Decoder(std::move(transport), std::move(protocol), false) {}
+
+Decoder::Decoder(TransportPtr&& transport, ProtocolPtr&& protocol, bool passthrough)
     : transport_(std::move(transport)), protocol_(std::move(protocol)), state_machine_{},
-      frame_started_(false) {}
+      frame_started_(false), passthrough_(passthrough) {}
 
 void Decoder::onData(Buffer::Instance& data) {
   ENVOY_LOG(debug, "thrift: {} bytes available", data.length());
@@ -356,7 +393,8 @@ void Decoder::onData(Buffer::Instance& data) {
       ENVOY_LOG(debug, "thrift: {} transport started", transport_->name());
 
       frame_started_ = true;
-      state_machine_ = std::make_unique<DecoderStateMachine>(*protocol_);
+      state_machine_ = std::make_unique<DecoderStateMachine>(
+          *protocol_, passthrough_, passthrough_ ? transport_->frameSize() : absl::nullopt);
     }
 
     ASSERT(state_machine_ != nullptr);
@@ -33,6 +33,7 @@ namespace ThriftProxy {
   FUNCTION(SetBegin)                                                                               \
   FUNCTION(SetValue)                                                                               \
   FUNCTION(SetEnd)                                                                                 \
+  FUNCTION(PassthroughData)                                                                        \
   FUNCTION(Done)
 
 /**
@@ -61,7 +62,21 @@ private:
  */
 class DecoderStateMachine {
 public:
-  DecoderStateMachine(Protocol& proto) : proto_(proto), state_(ProtocolState::MessageBegin) {}
+  DecoderStateMachine(Protocol& proto) : DecoderStateMachine(proto, false, absl::nullopt) {}
+
+  /**
+   * In passthrough mode, the state machine decodes the message header and the first field of the
+   * message's outermost struct, then skips the remainder of the message body. If frame_size is
+   * known, the remaining bytes are drained without being decoded. Otherwise the message must be
+   * walked to find its end, but string and binary values are skipped without being copied.
+   *
+   * @param proto the Protocol used to decode the message
+   * @param passthrough true to enable passthrough mode
+   * @param frame_size the size of the message as reported by the Transport, if known
+   */
+  DecoderStateMachine(Protocol& proto, bool passthrough, absl::optional<uint32_t> frame_size)
+      : proto_(proto), state_(ProtocolState::MessageBegin), passthrough_(passthrough),
+        frame_size_(frame_size) {}
 
   /**
    * Consumes as much data from the configured Buffer as possible and executes the decoding state
@@ -133,6 +148,7 @@ private:
   ProtocolState setBegin(Buffer::Instance& buffer);
   ProtocolState setValue(Buffer::Instance& buffer);
   ProtocolState setEnd(Buffer::Instance& buffer);
+  ProtocolState passthroughData(Buffer::Instance& buffer);
 
   // handleValue represents the generic Value state from the state machine documentation. It
   // returns either ProtocolState::WaitForData if more data is required or the next state. For
@@ -152,6 +168,10 @@ private:
   Protocol& proto_;
   ProtocolState state_;
   std::vector<Frame> stack_;
+  const bool passthrough_;
+  const absl::optional<uint32_t> frame_size_;
+  // Number of message bytes consumed so far.
+  uint64_t consumed_{0};
 };
 
 typedef std::unique_ptr<DecoderStateMachine> DecoderStateMachinePtr;
@@ -163,6 +183,12 @@ class Decoder : public Logger::Loggable<Logger::Id::thrift> {
 public:
   Decoder(TransportPtr&& transport, ProtocolPtr&& protocol);
 
+  /**
+   * @param passthrough if true, messages are decoded in passthrough mode: only the message header
+   *        and the first field of each message are decoded (see DecoderStateMachine).
+   */
+  Decoder(TransportPtr&& transport, ProtocolPtr&& protocol, bool passthrough);
+
   /**
    * Drains data from the given buffer while executing a DecoderStateMachine over the data. A new
    * DecoderStateMachine is instantiated for each message.
@@ -180,6 +206,7 @@ private:
   ProtocolPtr protocol_;
   DecoderStateMachinePtr state_machine_;
   bool frame_started_;
+  const bool passthrough_;
 };
 
 typedef std::unique_ptr<Decoder> DecoderPtr;
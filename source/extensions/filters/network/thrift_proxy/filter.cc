@@ -46,8 +46,10 @@ Network::FilterStatus Filter::onData(Buffer::Instance& data, bool) {
   }
 
   if (req_decoder_ == nullptr) {
+    // The filter only needs the message header, so the message body is passed through.
     req_decoder_ = std::make_unique<Decoder>(std::make_unique<AutoTransportImpl>(req_callbacks_),
-                                             std::make_unique<AutoProtocolImpl>(req_callbacks_));
+                                             std::make_unique<AutoProtocolImpl>(req_callbacks_),
+                                             true);
   }
 
   ENVOY_LOG(trace, "thrift: read {} bytes", data.length());
@@ -88,8 +90,11 @@ Network::FilterStatus Filter::onWrite(Buffer::Instance& data, bool) {
   }
 
   if (resp_decoder_ == nullptr) {
+    // The filter only needs the message header and the first reply field (see
+    // chargeUpstreamResponseField), so the remainder of the message body is passed through.
     resp_decoder_ = std::make_unique<Decoder>(std::make_unique<AutoTransportImpl>(resp_callbacks_),
-                                              std::make_unique<AutoProtocolImpl>(resp_callbacks_));
+                                              std::make_unique<AutoProtocolImpl>(resp_callbacks_),
+                                              true);
   }
 
   ENVOY_LOG(trace, "thrift wrote {} bytes", data.length());
@@ -272,6 +277,8 @@ void Filter::ResponseCallbacks::messageStart(const absl::string_view name, Messa
                                              int32_t seq_id) {
   ENVOY_LOG(debug, "thrift response: started {} message {}: {}",
             parent_.resp_decoder_->protocol().name(), name, seq_id);
+  // In passthrough mode, the end of the outermost struct is not decoded.
+  depth_ = 0;
   parent_.chargeUpstreamResponseStart(msg_type, seq_id);
 }
 
@@ -339,6 +339,15 @@ public:
    * @throw EnvoyException if the data is not a valid set footer
    */
   virtual bool readBinary(Buffer::Instance& buffer, std::string& value) PURE;
+
+  /**
+   * Skips a string or binary value without copying it out of the buffer. If successful, the value
+   * is removed from the buffer.
+   * @param buffer the buffer to read from
+   * @return true if a value successfully skipped, false if more data is required
+   * @throw EnvoyException if the data is not a valid string or binary value
+   */
+  virtual bool skipString(Buffer::Instance& buffer) PURE;
 };
 
 typedef std::unique_ptr<Protocol> ProtocolPtr;
@@ -425,6 +434,7 @@ public:
   bool readBinary(Buffer::Instance& buffer, std::string& value) override {
     return protocol_->readBinary(buffer, value);
   }
+  bool skipString(Buffer::Instance& buffer) override { return protocol_->skipString(buffer); }
 
   /*
    * Explicitly set the protocol. Public to simplify testing.
@@ -31,7 +31,8 @@ bool FramedTransportImpl::decodeFrameStart(Buffer::Instance& buffer) {
     throw EnvoyException(fmt::format("invalid thrift framed transport frame size {}", size));
   }
 
-  onFrameStart(absl::optional<uint32_t>(static_cast<uint32_t>(size)));
+  frame_size_ = static_cast<uint32_t>(size);
+  onFrameStart(frame_size_);
 
   buffer.drain(4);
   return true;
@@ -88,6 +88,14 @@ public:
    * @throws EnvoyException if the data is not valid for this transport.
    */
   virtual bool decodeFrameEnd(Buffer::Instance& buffer) PURE;
+
+  /*
+   * frameSize returns the size of the current frame's message, as decoded by the most recent
+   * successful call to decodeFrameStart.
+   *
+   * @return absl::optional<uint32_t> the message size, if the transport encodes it.
+   */
+  virtual absl::optional<uint32_t> frameSize() const PURE;
 };
 
 typedef std::unique_ptr<Transport> TransportPtr;
@@ -118,8 +126,12 @@ public:
   const std::string& name() const override { return TransportNames::get().FRAMED; }
   bool decodeFrameStart(Buffer::Instance& buffer) override;
   bool decodeFrameEnd(Buffer::Instance& buffer) override;
+  absl::optional<uint32_t> frameSize() const override { return frame_size_; }
 
   static const int32_t MaxFrameSize = 0xFA0000;
+
+private:
+  absl::optional<uint32_t> frame_size_{};
 };
 
 /**
@@ -140,6 +152,7 @@ public:
     onFrameComplete();
     return true;
   }
+  absl::optional<uint32_t> frameSize() const override { return absl::nullopt; }
 };
 
 /**
@@ -156,6 +169,9 @@ public:
   const std::string& name() const override { return name_; }
   bool decodeFrameStart(Buffer::Instance& buffer) override;
   bool decodeFrameEnd(Buffer::Instance& buffer) override;
+  absl::optional<uint32_t> frameSize() const override {
+    return transport_ == nullptr ? absl::nullopt : transport_->frameSize();
+  }
 
 private:
   void setTransport(TransportPtr&& transport) {
@@ -51,6 +51,12 @@ private:
       // Allow the main HC infra to control timeout.
       return parent_.timeout_ * 2;
     }
+    bool enableBatching() const override { return false; }
+    uint32_t maxBufferSizeBeforeFlush() const override { return 0; }
+    uint32_t maxRequestsBeforeFlush() const override { return 0; }
+    std::chrono::milliseconds bufferFlushTimeout() const override {
+      return std::chrono::milliseconds(0);
+    }
 
     // Extensions::NetworkFilters::RedisProxy::ConnPool::PoolCallbacks
     void onResponse(Extensions::NetworkFilters::RedisProxy::RespValuePtr&& value) override;
@@ -9,7 +9,6 @@
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/common/assert.h"
-#include "common/common/fmt.h"
 #include "common/common/utility.h"
 #include "common/config/utility.h"
 
@@ -51,47 +50,55 @@ void UdpStatsdSink::flush(Stats::Source& source) {
   Writer& writer = tls_->getTyped<Writer>();
   for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
     if (counter->used()) {
-      uint64_t delta = counter->latch();
-      writer.write(fmt::format("{}.{}:{}|c{}", prefix_, getName(*counter), delta,
-                               buildTagStr(counter->tags())));
+      buildMessage(*counter, counter->latch(), "c", writer);
+      writer.write(writer.message_);
     }
   }
 
   for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
     if (gauge->used()) {
-      writer.write(fmt::format("{}.{}:{}|g{}", prefix_, getName(*gauge), gauge->value(),
-                               buildTagStr(gauge->tags())));
+      buildMessage(*gauge, gauge->value(), "g", writer);
+      writer.write(writer.message_);
     }
   }
 }
 
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
   // For statsd histograms are all timers.
-  const std::string message(fmt::format("{}.{}:{}|ms{}", prefix_, getName(histogram),
-                                        std::chrono::milliseconds(value).count(),
-                                        buildTagStr(histogram.tags())));
-  tls_->getTyped<Writer>().write(message);
+  Writer& writer = tls_->getTyped<Writer>();
+  buildMessage(histogram, std::chrono::milliseconds(value).count(), "ms", writer);
+  writer.write(writer.message_);
 }
 
-const std::string UdpStatsdSink::getName(const Stats::Metric& metric) {
+void UdpStatsdSink::buildMessage(const Stats::Metric& metric, uint64_t value,
+                                 absl::string_view type, Writer& writer) {
+  // Produces something like "envoy.{}:{}|c|#{}:{},{}:{}" in the writer's reused buffer, since this
+  // runs for every stat on each flush and for every histogram sample.
+  std::string& message = writer.message_;
+  message.assign(prefix_);
+  message.push_back('.');
   if (use_tag_) {
-    return metric.tagExtractedName();
+    metric.appendTagExtractedName(message);
   } else {
-    return metric.name();
+    metric.appendName(message);
   }
-}
+  message.push_back(':');
+  char value_buffer[StringUtil::MIN_ITOA_OUT_LEN];
+  message.append(value_buffer, StringUtil::itoa(value_buffer, sizeof(value_buffer), value));
+  message.push_back('|');
+  message.append(type.data(), type.size());
 
-const std::string UdpStatsdSink::buildTagStr(const std::vector<Stats::Tag>& tags) {
-  if (!use_tag_ || tags.empty()) {
-    return "";
-  }
-
-  std::vector<std::string> tag_strings;
-  tag_strings.reserve(tags.size());
-  for (const Stats::Tag& tag : tags) {
-    tag_strings.emplace_back(tag.name_ + ":" + tag.value_);
+  if (use_tag_) {
+    bool first = true;
+    metric.iterateTags(writer.tag_, [&message, &first](absl::string_view name,
+                                                       absl::string_view value) -> void {
+      message.append(first ? "|#" : ",");
+      first = false;
+      message.append(name.data(), name.size());
+      message.push_back(':');
+      message.append(value.data(), value.size());
+    });
   }
-  return "|#" + StringUtil::join(tag_strings, ",");
 }
 
 TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
@@ -114,13 +121,13 @@ void TcpStatsdSink::flush(Stats::Source& source) {
   tls_sink.beginFlush(true);
   for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
     if (counter->used()) {
-      tls_sink.flushCounter(counter->name(), counter->latch());
+      tls_sink.flushCounter(*counter, counter->latch());
     }
   }
 
   for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
     if (gauge->used()) {
-      tls_sink.flushGauge(gauge->name(), gauge->value());
+      tls_sink.flushGauge(*gauge, gauge->value());
     }
   }
   tls_sink.endFlush(true);
@@ -146,11 +153,14 @@ void TcpStatsdSink::TlsSink::beginFlush(bool expect_empty_buffer) {
   current_slice_mem_ = reinterpret_cast<char*>(current_buffer_slice_.mem_);
 }
 
-void TcpStatsdSink::TlsSink::commonFlush(const std::string& name, uint64_t value, char stat_type) {
+void TcpStatsdSink::TlsSink::commonFlush(const Stats::Metric& metric, uint64_t value,
+                                         char stat_type) {
   ASSERT(current_slice_mem_ != nullptr);
+  name_.clear();
+  metric.appendName(name_);
   // 36 > 1 ("." after prefix) + 1 (":" after name) + 4 (postfix chars, e.g., "|ms\n") + 30 for
   // number (bigger than it will ever be)
-  const uint32_t max_size = name.size() + parent_.getPrefix().size() + 36;
+  const uint32_t max_size = name_.size() + parent_.getPrefix().size() + 36;
   if (current_buffer_slice_.len_ - usedBuffer() < max_size) {
     endFlush(false);
     beginFlush(false);
@@ -163,8 +173,8 @@ void TcpStatsdSink::TlsSink::commonFlush(const std::string& name, uint64_t value
   memcpy(current_slice_mem_, parent_.getPrefix().c_str(), parent_.getPrefix().size());
   current_slice_mem_ += parent_.getPrefix().size();
   *current_slice_mem_++ = '.';
-  memcpy(current_slice_mem_, name.c_str(), name.size());
-  current_slice_mem_ += name.size();
+  memcpy(current_slice_mem_, name_.c_str(), name_.size());
+  current_slice_mem_ += name_.size();
   *current_slice_mem_++ = ':';
   current_slice_mem_ += StringUtil::itoa(current_slice_mem_, 30, value);
   *current_slice_mem_++ = '|';
@@ -174,12 +184,12 @@ void TcpStatsdSink::TlsSink::commonFlush(const std::string& name, uint64_t value
   ASSERT(static_cast<uint64_t>(current_slice_mem_ - snapped_current) < max_size);
 }
 
-void TcpStatsdSink::TlsSink::flushCounter(const std::string& name, uint64_t delta) {
-  commonFlush(name, delta, 'c');
+void TcpStatsdSink::TlsSink::flushCounter(const Stats::Metric& metric, uint64_t delta) {
+  commonFlush(metric, delta, 'c');
 }
 
-void TcpStatsdSink::TlsSink::flushGauge(const std::string& name, uint64_t value) {
-  commonFlush(name, value, 'g');
+void TcpStatsdSink::TlsSink::flushGauge(const Stats::Metric& metric, uint64_t value) {
+  commonFlush(metric, value, 'g');
 }
 
 void TcpStatsdSink::TlsSink::endFlush(bool do_write) {
@@ -199,13 +209,20 @@ void TcpStatsdSink::TlsSink::onEvent(Network::ConnectionEvent event) {
   }
 }
 
-void TcpStatsdSink::TlsSink::onTimespanComplete(const std::string& name,
+void TcpStatsdSink::TlsSink::onTimespanComplete(const Stats::Metric& metric,
                                                 std::chrono::milliseconds ms) {
-  // Ultimately it would be nice to perf optimize this path also, but it's not very frequent. It's
-  // also currently not possible that this interleaves with any counter/gauge flushing.
+  // It's currently not possible that this interleaves with any counter/gauge flushing, so name_
+  // is free to hold the whole line.
   ASSERT(current_slice_mem_ == nullptr);
-  Buffer::OwnedImpl buffer(
-      fmt::format("{}.{}:{}|ms\n", parent_.getPrefix().c_str(), name, ms.count()));
+  name_.assign(parent_.getPrefix());
+  name_.push_back('.');
+  metric.appendName(name_);
+  name_.push_back(':');
+  char value_buffer[StringUtil::MIN_ITOA_OUT_LEN];
+  name_.append(value_buffer, StringUtil::itoa(value_buffer, sizeof(value_buffer), ms.count()));
+  name_.append("|ms\n");
+  Buffer::OwnedImpl buffer;
+  buffer.add(name_);
   write(buffer);
 }
 
@@ -31,6 +31,11 @@ public:
   // Called in unit test to validate address.
   int getFdForTests() const { return fd_; };
 
+  // Scratch space for formatting messages on the writer's thread, reused so that formatting does
+  // not allocate once the strings have grown to fit.
+  std::string message_;
+  std::string tag_;
+
 private:
   int fd_;
 };
@@ -61,8 +66,8 @@ public:
   const std::string& getPrefix() { return prefix_; }
 
 private:
-  const std::string getName(const Stats::Metric& metric);
-  const std::string buildTagStr(const std::vector<Stats::Tag>& tags);
+  void buildMessage(const Stats::Metric& metric, uint64_t value, absl::string_view type,
+                    Writer& writer);
 
   ThreadLocal::SlotPtr tls_;
   Network::Address::InstanceConstSharedPtr server_address_;
@@ -84,8 +89,7 @@ public:
   void flush(Stats::Source& source) override;
   void onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) override {
     // For statsd histograms are all timers.
-    tls_->getTyped<TlsSink>().onTimespanComplete(histogram.name(),
-                                                 std::chrono::milliseconds(value));
+    tls_->getTyped<TlsSink>().onTimespanComplete(histogram, std::chrono::milliseconds(value));
   }
 
   const std::string& getPrefix() { return prefix_; }
@@ -97,11 +101,11 @@ private:
 
     void beginFlush(bool expect_empty_buffer);
     void checkSize();
-    void commonFlush(const std::string& name, uint64_t value, char stat_type);
-    void flushCounter(const std::string& name, uint64_t delta);
-    void flushGauge(const std::string& name, uint64_t value);
+    void commonFlush(const Stats::Metric& metric, uint64_t value, char stat_type);
+    void flushCounter(const Stats::Metric& metric, uint64_t delta);
+    void flushGauge(const Stats::Metric& metric, uint64_t value);
     void endFlush(bool do_write);
-    void onTimespanComplete(const std::string& name, std::chrono::milliseconds ms);
+    void onTimespanComplete(const Stats::Metric& metric, std::chrono::milliseconds ms);
     uint64_t usedBuffer();
     void write(Buffer::Instance& buffer);
 
@@ -116,6 +120,8 @@ private:
     Buffer::OwnedImpl buffer_;
     Buffer::RawSlice current_buffer_slice_;
     char* current_slice_mem_{};
+    // Reused for metric names so that flushing does not allocate once it has grown to fit.
+    std::string name_;
   };
 
   // Somewhat arbitrary 16MiB limit for buffered stats.
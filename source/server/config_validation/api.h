@@ -14,7 +14,7 @@ namespace Api {
  */
 class ValidationImpl : public Impl {
 public:
-  ValidationImpl(std::chrono::milliseconds file_flush_interval_msec);
+  ValidationImpl(std::chrono::milliseconds file_flush_interval_msec, uint32_t file_flush_threads);
 
   Event::DispatcherPtr allocateDispatcher() override;
 };
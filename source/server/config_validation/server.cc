@@ -38,7 +38,7 @@ ValidationInstance::ValidationInstance(Options& options,
                                        Thread::BasicLockable& access_log_lock,
                                        ComponentFactory& component_factory)
     : options_(options), stats_store_(store),
-      api_(new Api::ValidationImpl(options.fileFlushIntervalMsec())),
+      api_(new Api::ValidationImpl(options.fileFlushIntervalMsec(), options.fileFlushThreads())),
       dispatcher_(api_->allocateDispatcher()), singleton_manager_(new Singleton::ManagerImpl()),
       access_log_manager_(*api_, *dispatcher_, access_log_lock, store),
       listener_manager_(*this, *this, *this, ProdSystemTimeSource::instance_) {
@@ -84,6 +84,9 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   TCLAP::ValueArg<uint32_t> file_flush_interval_msec("", "file-flush-interval-msec",
                                                      "Interval for log flushing in msec", false,
                                                      10000, "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> file_flush_threads("", "file-flush-threads",
+                                               "Number of threads for log flushing", false, 1,
+                                               "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> drain_time_s("", "drain-time-s", "Hot restart drain time in seconds",
                                          false, 600, "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> parent_shutdown_time_s("", "parent-shutdown-time-s",
@@ -136,6 +139,9 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   check_numeric_arg(max_stats.getValue() > 100 * 1000 * 1000, max_stats.getValue(),
                     "error: the 'max-stats' value specified ({}) is more than the maximum value "
                     "of 100M");
+  check_numeric_arg(file_flush_threads.getValue() == 0, file_flush_threads.getValue(),
+                    "error: the 'file-flush-threads' value specified ({}) is less than the "
+                    "minimum value of 1");
   // TODO(jmarantz): should we also multiply these to bound the total amount of memory?
 
   hot_restart_disabled_ = disable_hot_restart.getValue();
@@ -185,6 +191,7 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   service_node_ = service_node.getValue();
   service_zone_ = service_zone.getValue();
   file_flush_interval_msec_ = std::chrono::milliseconds(file_flush_interval_msec.getValue());
+  file_flush_threads_ = file_flush_threads.getValue();
   drain_time_ = std::chrono::seconds(drain_time_s.getValue());
   parent_shutdown_time_ = std::chrono::seconds(parent_shutdown_time_s.getValue());
   max_stats_ = max_stats.getValue();
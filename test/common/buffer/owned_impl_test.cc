@@ -76,39 +76,168 @@ TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   EXPECT_TRUE(release_callback_called_);
 }
 
+TEST_F(OwnedImplTest, AddBufferFragmentMovedWithoutCopy) {
+  char input[] = "hello world";
+  BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
+    release_callback_called_ = true;
+  });
+  Buffer::OwnedImpl buffer1;
+  buffer1.addBufferFragment(frag);
+
+  // Moving the whole fragment transfers the reference rather than copying the data.
+  Buffer::OwnedImpl buffer2;
+  buffer2.move(buffer1);
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ(11, buffer2.length());
+  RawSlice slice;
+  EXPECT_EQ(1, buffer2.getRawSlices(&slice, 1));
+  EXPECT_EQ(input, slice.mem_);
+  EXPECT_FALSE(release_callback_called_);
+
+  buffer2.drain(11);
+  EXPECT_TRUE(release_callback_called_);
+}
+
+TEST_F(OwnedImplTest, MoveLarge) {
+  const std::string large(16384, 'a');
+  Buffer::OwnedImpl buffer1(large);
+  RawSlice slice1;
+  EXPECT_EQ(1, buffer1.getRawSlices(&slice1, 1));
+
+  // Large slices are handed over as-is.
+  Buffer::OwnedImpl buffer2("b");
+  buffer2.move(buffer1);
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ(16385, buffer2.length());
+  RawSlice slices2[2];
+  EXPECT_EQ(2, buffer2.getRawSlices(slices2, 2));
+  EXPECT_EQ(slice1.mem_, slices2[1].mem_);
+  EXPECT_EQ("b" + large, buffer2.toString());
+}
+
+TEST_F(OwnedImplTest, MoveSmallCoalesces) {
+  Buffer::OwnedImpl buffer1("hello ");
+  Buffer::OwnedImpl buffer2("world");
+  buffer1.move(buffer2);
+  EXPECT_EQ(0, buffer2.length());
+  EXPECT_EQ(1, buffer1.getRawSlices(nullptr, 0));
+  EXPECT_EQ("hello world", buffer1.toString());
+}
+
+TEST_F(OwnedImplTest, MovePartial) {
+  const std::string large(8192, 'a');
+  Buffer::OwnedImpl buffer1("0123456789");
+  buffer1.add(large);
+  Buffer::OwnedImpl buffer2;
+
+  buffer2.move(buffer1, 4);
+  EXPECT_EQ("0123", buffer2.toString());
+  EXPECT_EQ("456789" + large, buffer1.toString());
+
+  buffer2.move(buffer1, buffer1.length());
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ("0123456789" + large, buffer2.toString());
+}
+
+TEST_F(OwnedImplTest, ReserveCommit) {
+  Buffer::OwnedImpl buffer;
+  RawSlice iovecs[2];
+
+  // A reservation that is not committed doesn't change the buffer.
+  EXPECT_EQ(1, buffer.reserve(100, iovecs, 2));
+  EXPECT_EQ(100, iovecs[0].len_);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ(0, buffer.getRawSlices(nullptr, 0));
+
+  // Commit less than was reserved.
+  memcpy(iovecs[0].mem_, "abcd", 4);
+  iovecs[0].len_ = 4;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ("abcd", buffer.toString());
+
+  // A second reservation continues in the same slice.
+  EXPECT_EQ(1, buffer.reserve(10, iovecs, 2));
+  EXPECT_EQ(static_cast<char*>(buffer.linearize(4)) + 4, iovecs[0].mem_);
+  memcpy(iovecs[0].mem_, "efgh", 4);
+  iovecs[0].len_ = 4;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ("abcdefgh", buffer.toString());
+  EXPECT_EQ(1, buffer.getRawSlices(nullptr, 0));
+
+  // A reservation bigger than the remaining space in the last slice spans two slices, unless
+  // only one iovec is supplied.
+  EXPECT_EQ(2, buffer.reserve(16384, iovecs, 2));
+  EXPECT_EQ(16384, iovecs[0].len_ + iovecs[1].len_);
+  EXPECT_EQ(1, buffer.reserve(16384, iovecs, 1));
+  EXPECT_EQ(16384, iovecs[0].len_);
+  EXPECT_EQ(8, buffer.length());
+}
+
+TEST_F(OwnedImplTest, Linearize) {
+  Buffer::OwnedImpl buffer("abc");
+  const std::string large(8192, 'd');
+  buffer.add(large);
+  buffer.add(large);
+  EXPECT_LT(1, buffer.getRawSlices(nullptr, 0));
+
+  EXPECT_EQ("abc", std::string(static_cast<const char*>(buffer.linearize(3)), 3));
+  void* data = buffer.linearize(10000);
+  EXPECT_EQ("abc" + std::string(9997, 'd'), std::string(static_cast<const char*>(data), 10000));
+  EXPECT_EQ(2 * large.size() + 3, buffer.length());
+  EXPECT_EQ("abc" + large + large, buffer.toString());
+}
+
+TEST_F(OwnedImplTest, Search) {
+  char first[] = "hello wo";
+  char second[] = "rld";
+  BufferFragmentImpl frag1(first, 8, nullptr);
+  BufferFragmentImpl frag2(second, 3, nullptr);
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag1);
+  buffer.addBufferFragment(frag2);
+
+  EXPECT_EQ(0, buffer.search("hello", 5, 0));
+  EXPECT_EQ(-1, buffer.search("hello", 5, 1));
+  // Match spanning two slices.
+  EXPECT_EQ(6, buffer.search("world", 5, 0));
+  EXPECT_EQ(7, buffer.search("o", 1, 5));
+  EXPECT_EQ(-1, buffer.search("worlds", 6, 0));
+  EXPECT_EQ(-1, buffer.search("d", 1, 11));
+}
+
 TEST_F(OwnedImplTest, Write) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   Buffer::OwnedImpl buffer;
   buffer.add("example");
-  EXPECT_CALL(os_sys_calls, writev(_, _, _)).WillOnce(Return(7));
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _)).WillOnce(Return(7));
   int rc = buffer.write(-1);
   EXPECT_EQ(7, rc);
   EXPECT_EQ(0, buffer.length());
 
   buffer.add("example");
-  EXPECT_CALL(os_sys_calls, writev(_, _, _)).WillOnce(Return(6));
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _)).WillOnce(Return(6));
   rc = buffer.write(-1);
   EXPECT_EQ(6, rc);
   EXPECT_EQ(1, buffer.length());
 
-  EXPECT_CALL(os_sys_calls, writev(_, _, _)).WillOnce(Return(0));
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _)).WillOnce(Return(0));
   rc = buffer.write(-1);
   EXPECT_EQ(0, rc);
   EXPECT_EQ(1, buffer.length());
 
-  EXPECT_CALL(os_sys_calls, writev(_, _, _)).WillOnce(Return(-1));
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _)).WillOnce(Return(-1));
   rc = buffer.write(-1);
   EXPECT_EQ(-1, rc);
   EXPECT_EQ(1, buffer.length());
 
-  EXPECT_CALL(os_sys_calls, writev(_, _, _)).WillOnce(Return(1));
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _)).WillOnce(Return(1));
   rc = buffer.write(-1);
   EXPECT_EQ(1, rc);
   EXPECT_EQ(0, buffer.length());
 
-  EXPECT_CALL(os_sys_calls, writev(_, _, _)).Times(0);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _)).Times(0);
   rc = buffer.write(-1);
   EXPECT_EQ(0, rc);
   EXPECT_EQ(0, buffer.length());
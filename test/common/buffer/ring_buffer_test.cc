@@ -0,0 +1,107 @@
+#include <string>
+#include <thread>
+
+#include "common/buffer/ring_buffer.h"
+#include "common/common/thread.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+std::string readAll(RingBuffer& ring) {
+  RawSlice slices[2];
+  const uint64_t num_slices = ring.getReadableSlices(slices);
+  std::string data;
+  for (uint64_t i = 0; i < num_slices; i++) {
+    data.append(static_cast<const char*>(slices[i].mem_), slices[i].len_);
+  }
+  ring.drain(data.size());
+  return data;
+}
+
+TEST(RingBufferTest, WriteAndRead) {
+  RingBuffer ring(16);
+  EXPECT_EQ(16, ring.capacity());
+  EXPECT_EQ("", readAll(ring));
+
+  EXPECT_TRUE(ring.write("hello"));
+  EXPECT_TRUE(ring.write(" world"));
+  EXPECT_EQ(11, ring.length());
+  EXPECT_EQ("hello world", readAll(ring));
+  EXPECT_EQ(0, ring.length());
+}
+
+TEST(RingBufferTest, RejectsWhatDoesNotFit) {
+  RingBuffer ring(8);
+  EXPECT_FALSE(ring.write("123456789"));
+  EXPECT_TRUE(ring.write("12345"));
+  EXPECT_FALSE(ring.write("6789"));
+  EXPECT_TRUE(ring.write("678"));
+  EXPECT_EQ(8, ring.length());
+  EXPECT_EQ("12345678", readAll(ring));
+}
+
+TEST(RingBufferTest, Wraparound) {
+  RingBuffer ring(8);
+  EXPECT_TRUE(ring.write("123456"));
+  EXPECT_EQ("123456", readAll(ring));
+
+  EXPECT_TRUE(ring.write("abcde"));
+  RawSlice slices[2];
+  ASSERT_EQ(2, ring.getReadableSlices(slices));
+  EXPECT_EQ("ab", std::string(static_cast<const char*>(slices[0].mem_), slices[0].len_));
+  EXPECT_EQ("cde", std::string(static_cast<const char*>(slices[1].mem_), slices[1].len_));
+
+  // A partial drain leaves the rest readable.
+  ring.drain(3);
+  EXPECT_EQ("de", readAll(ring));
+}
+
+TEST(RingBufferTest, Offsets) {
+  RingBuffer ring(8, 100);
+  EXPECT_EQ(100, ring.readOffset());
+  EXPECT_EQ(100, ring.writeOffset());
+  EXPECT_TRUE(ring.write("12345678"));
+  EXPECT_EQ("12345678", readAll(ring));
+  EXPECT_EQ(108, ring.readOffset());
+
+  EXPECT_TRUE(ring.write("abcde"));
+  EXPECT_EQ(113, ring.writeOffset());
+  RawSlice slices[2];
+  EXPECT_EQ(0, ring.getSlices(109, 109, slices));
+  ASSERT_EQ(1, ring.getSlices(109, 112, slices));
+  EXPECT_EQ("bcd", std::string(static_cast<const char*>(slices[0].mem_), slices[0].len_));
+  ASSERT_EQ(2, ring.getSlices(110, 113, slices));
+  EXPECT_EQ("cd", std::string(static_cast<const char*>(slices[0].mem_), slices[0].len_));
+  EXPECT_EQ("e", std::string(static_cast<const char*>(slices[1].mem_), slices[1].len_));
+}
+
+TEST(RingBufferTest, ProducerAndConsumerThreads) {
+  RingBuffer ring(256);
+  const uint32_t records = 10000;
+  Thread::Thread producer([&ring, records]() {
+    for (uint32_t i = 0; i < records; i++) {
+      const std::string record = std::to_string(i) + "\n";
+      while (!ring.write(record)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::string expected;
+  for (uint32_t i = 0; i < records; i++) {
+    expected += std::to_string(i) + "\n";
+  }
+  std::string received;
+  while (received.size() < expected.size()) {
+    received += readAll(ring);
+  }
+  producer.join();
+  EXPECT_EQ(expected, received);
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
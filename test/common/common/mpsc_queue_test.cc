@@ -0,0 +1,87 @@
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "common/common/mpsc_queue.h"
+#include "common/common/thread.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+struct TestNode : public MpscQueue::Node {
+  TestNode(uint32_t producer, uint32_t sequence) : producer_(producer), sequence_(sequence) {}
+
+  const uint32_t producer_;
+  const uint32_t sequence_;
+};
+
+TEST(MpscQueueTest, Empty) {
+  MpscQueue queue;
+  EXPECT_EQ(nullptr, queue.pop());
+  EXPECT_EQ(nullptr, queue.pop());
+}
+
+TEST(MpscQueueTest, Fifo) {
+  MpscQueue queue;
+  TestNode nodes[]{{0, 0}, {0, 1}, {0, 2}};
+
+  queue.push(nodes[0]);
+  EXPECT_EQ(&nodes[0], queue.pop());
+  EXPECT_EQ(nullptr, queue.pop());
+
+  queue.push(nodes[1]);
+  queue.push(nodes[2]);
+  EXPECT_EQ(&nodes[1], queue.pop());
+  // Nodes can be pushed again once they have been popped.
+  queue.push(nodes[0]);
+  EXPECT_EQ(&nodes[2], queue.pop());
+  EXPECT_EQ(&nodes[0], queue.pop());
+  EXPECT_EQ(nullptr, queue.pop());
+}
+
+// Producers push concurrently with the consumer. Every node must be popped exactly once, and the
+// nodes of each producer in the order it pushed them.
+TEST(MpscQueueTest, ConcurrentProducers) {
+  const uint32_t num_producers = 4;
+  const uint32_t num_nodes = 20000;
+  MpscQueue queue;
+  std::vector<std::unique_ptr<TestNode>> nodes;
+  for (uint32_t producer = 0; producer < num_producers; producer++) {
+    for (uint32_t sequence = 0; sequence < num_nodes; sequence++) {
+      nodes.emplace_back(new TestNode(producer, sequence));
+    }
+  }
+
+  std::atomic<bool> start{false};
+  std::vector<std::unique_ptr<Thread::Thread>> threads;
+  for (uint32_t producer = 0; producer < num_producers; producer++) {
+    threads.emplace_back(new Thread::Thread([&queue, &nodes, &start, producer, num_nodes]() {
+      while (!start) {
+      }
+      for (uint32_t sequence = 0; sequence < num_nodes; sequence++) {
+        queue.push(*nodes[producer * num_nodes + sequence]);
+      }
+    }));
+  }
+
+  start = true;
+  std::vector<uint32_t> next_sequence(num_producers, 0);
+  uint32_t popped = 0;
+  while (popped < num_producers * num_nodes) {
+    const TestNode* node = static_cast<const TestNode*>(queue.pop());
+    if (node == nullptr) {
+      continue;
+    }
+    EXPECT_EQ(next_sequence[node->producer_], node->sequence_);
+    next_sequence[node->producer_] = node->sequence_ + 1;
+    popped++;
+  }
+  EXPECT_EQ(nullptr, queue.pop());
+
+  for (auto& thread : threads) {
+    thread->join();
+  }
+}
+
+} // namespace Envoy
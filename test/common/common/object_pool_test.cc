@@ -0,0 +1,44 @@
+#include <memory>
+
+#include "common/common/object_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+TEST(ObjectPoolTest, AcquireAndRelease) {
+  ObjectPool<int> pool(2);
+  EXPECT_EQ(nullptr, pool.acquire());
+
+  std::unique_ptr<int> object(new int(1));
+  int* address = object.get();
+  EXPECT_TRUE(pool.release(std::move(object)));
+  EXPECT_EQ(1, pool.size());
+
+  object = pool.acquire();
+  EXPECT_EQ(address, object.get());
+  EXPECT_EQ(0, pool.size());
+  EXPECT_EQ(nullptr, pool.acquire());
+}
+
+TEST(ObjectPoolTest, Bounded) {
+  ObjectPool<int> pool(2);
+  EXPECT_TRUE(pool.release(std::unique_ptr<int>(new int(1))));
+  EXPECT_TRUE(pool.release(std::unique_ptr<int>(new int(2))));
+  std::unique_ptr<int> object(new int(3));
+  EXPECT_FALSE(pool.release(std::move(object)));
+  EXPECT_EQ(nullptr, object);
+  EXPECT_EQ(2, pool.size());
+
+  // The most recently released object is reused first.
+  EXPECT_EQ(2, *pool.acquire());
+  EXPECT_EQ(1, *pool.acquire());
+}
+
+TEST(ObjectPoolTest, Disabled) {
+  ObjectPool<int> pool(0);
+  EXPECT_FALSE(pool.release(std::unique_ptr<int>(new int(1))));
+  EXPECT_EQ(nullptr, pool.acquire());
+}
+
+} // namespace Envoy
@@ -0,0 +1,65 @@
+#include "envoy/common/exception.h"
+
+#include "common/common/regex.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Regex {
+
+TEST(RegexUtility, MatchIsAnchored) {
+  CompiledMatcherPtr matcher = Utility::parseRegex("/api/v[0-9]+/.*");
+  EXPECT_TRUE(matcher->match("/api/v1/users"));
+  EXPECT_TRUE(matcher->match("/api/v12/"));
+  EXPECT_FALSE(matcher->match("/api/vx/users"));
+  EXPECT_FALSE(matcher->match("x/api/v1/users"));
+  EXPECT_FALSE(matcher->match("/api/v1"));
+  EXPECT_EQ(0, matcher->numCaptureGroups());
+}
+
+TEST(RegexUtility, MatchesBytes) {
+  // Values are matched byte by byte, so invalid UTF-8 is handled like any other input.
+  CompiledMatcherPtr matcher = Utility::parseRegex("a.b");
+  EXPECT_TRUE(matcher->match(std::string("a\xff" "b")));
+  EXPECT_FALSE(matcher->match(std::string("a\xc3\xa9" "b")));
+}
+
+TEST(RegexUtility, SearchCaptures) {
+  CompiledMatcherPtr matcher = Utility::parseRegex("^cluster\\.((.*?)\\.)(?:foo_(\\d+))?");
+  EXPECT_EQ(3, matcher->numCaptureGroups());
+
+  const std::string value = "cluster.ratelimit.upstream_rq";
+  absl::string_view captures[4];
+  ASSERT_TRUE(matcher->search(value, captures, 4));
+  EXPECT_EQ("ratelimit.", captures[0]);
+  EXPECT_EQ("ratelimit", captures[1]);
+  EXPECT_EQ(value.data() + 8, captures[1].data());
+  // The optional group did not participate and the fourth group does not exist.
+  EXPECT_EQ(nullptr, captures[2].data());
+  EXPECT_EQ(nullptr, captures[3].data());
+
+  EXPECT_FALSE(matcher->search("http.cluster.foo", captures, 4));
+}
+
+TEST(RegexUtility, SearchIsUnanchored) {
+  CompiledMatcherPtr matcher = Utility::parseRegex("_(\\d+)");
+  absl::string_view captures[1];
+  ASSERT_TRUE(matcher->search("foo_12_34", captures, 1));
+  EXPECT_EQ("12", captures[0]);
+  EXPECT_TRUE(matcher->search("foo_12_34", nullptr, 0));
+}
+
+TEST(RegexUtility, InvalidRegex) {
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("(+invalid)"), EnvoyException,
+                          "Invalid regex '\\(\\+invalid\\)': .+");
+  // RE2 does not support lookaround assertions or backreferences.
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("^foo\\.((.*?)\\.)(?=bar)"), EnvoyException,
+                          "Invalid regex '.*\\(\\?=bar\\)': .+");
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("(a)\\1"), EnvoyException,
+                          "Invalid regex '\\(a\\)\\\\1': .+");
+}
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common/substring_matcher.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+// Returns the (id, end offset) of every pattern occurrence in input, sorted.
+std::vector<std::pair<uint32_t, size_t>> findAll(const SubstringMatcher& matcher,
+                                                 const std::string& input) {
+  std::vector<std::pair<uint32_t, size_t>> found;
+  size_t offset = 0;
+  SubstringMatcher::State state = SubstringMatcher::InitialState;
+  for (const char c : input) {
+    offset++;
+    state = matcher.scan(state, absl::string_view(&c, 1),
+                         [&found, offset](uint32_t id) { found.emplace_back(id, offset); });
+  }
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+// Finds the same occurrences as findAll() with std::string::find.
+std::vector<std::pair<uint32_t, size_t>> findAllSlow(const std::vector<std::string>& patterns,
+                                                     const std::string& input) {
+  std::vector<std::pair<uint32_t, size_t>> found;
+  for (size_t end = 1; end <= input.size(); end++) {
+    for (uint32_t id = 0; id < patterns.size(); id++) {
+      const std::string& pattern = patterns[id];
+      if (pattern.size() <= end &&
+          input.compare(end - pattern.size(), pattern.size(), pattern) == 0) {
+        found.emplace_back(id, end);
+      }
+    }
+  }
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+TEST(SubstringMatcherTest, Empty) {
+  SubstringMatcher matcher;
+  EXPECT_EQ(0, matcher.size());
+  EXPECT_TRUE(findAll(matcher, "cluster.foo.upstream_rq_200").empty());
+}
+
+TEST(SubstringMatcherTest, DuplicatePatterns) {
+  SubstringMatcher matcher;
+  EXPECT_EQ(0, matcher.add(".grpc."));
+  EXPECT_EQ(1, matcher.add("_rq_"));
+  EXPECT_EQ(0, matcher.add(".grpc."));
+  EXPECT_EQ(2, matcher.size());
+}
+
+TEST(SubstringMatcherTest, OverlappingPatterns) {
+  const std::vector<std::string> patterns{"he", "she", "his", "hers", "s", "_rq_", ".rq."};
+  SubstringMatcher matcher;
+  for (const std::string& pattern : patterns) {
+    matcher.add(pattern);
+  }
+  matcher.compile();
+
+  for (const std::string input : {"ushers", "hishers", "", "h", "shshe",
+                                  "cluster.x.upstream_rq_rq_200", ".rq.rq.", "\xffs"}) {
+    EXPECT_EQ(findAllSlow(patterns, input), findAll(matcher, input)) << input;
+  }
+}
+
+TEST(SubstringMatcherTest, ResumeScan) {
+  SubstringMatcher matcher;
+  const uint32_t ciphers = matcher.add(".ssl.ciphers.");
+  matcher.compile();
+
+  uint32_t matches = 0;
+  auto on_match = [&matches, ciphers](uint32_t id) {
+    EXPECT_EQ(ciphers, id);
+    matches++;
+  };
+  SubstringMatcher::State state =
+      matcher.scan(SubstringMatcher::InitialState, "cluster.foo.ssl.ci", on_match);
+  EXPECT_EQ(0, matches);
+  matcher.scan(state, "phers.ECDHE", on_match);
+  EXPECT_EQ(1, matches);
+}
+
+TEST(SubstringMatcherTest, RandomPatterns) {
+  // Small alphabets make for many overlapping patterns.
+  uint32_t seed = 1;
+  auto next = [&seed](uint32_t bound) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % bound;
+  };
+  for (uint32_t round = 0; round < 100; round++) {
+    std::vector<std::string> patterns;
+    SubstringMatcher matcher;
+    const uint32_t num_patterns = 1 + next(8);
+    while (patterns.size() < num_patterns) {
+      std::string pattern;
+      const uint32_t length = 1 + next(4);
+      for (uint32_t i = 0; i < length; i++) {
+        pattern.push_back("ab._"[next(4)]);
+      }
+      if (matcher.add(pattern) == patterns.size()) {
+        patterns.push_back(pattern);
+      }
+    }
+    matcher.compile();
+
+    std::string input;
+    const uint32_t length = next(40);
+    for (uint32_t i = 0; i < length; i++) {
+      input.push_back("ab._x"[next(5)]);
+    }
+    EXPECT_EQ(findAllSlow(patterns, input), findAll(matcher, input)) << input;
+  }
+}
+
+} // namespace Envoy
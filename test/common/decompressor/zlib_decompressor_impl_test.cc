@@ -251,6 +251,36 @@ TEST_F(ZlibDecompressorImplTest, CompressDecompressOfMultipleSlices) {
   EXPECT_EQ(original_text, decompressed_text);
 }
 
+// Exercises reusing a compressor and a decompressor for a second stream after resetting them in
+// the middle of the first one.
+TEST_F(ZlibDecompressorImplTest, CompressDecompressAfterReset) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl output_buffer;
+
+  Envoy::Compressor::ZlibCompressorImpl compressor;
+  compressor.init(Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                  Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+                  gzip_window_bits, memory_level);
+  ZlibDecompressorImpl decompressor;
+  decompressor.init(gzip_window_bits);
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size, 1);
+  compressor.compress(buffer, Compressor::State::Flush);
+  decompressor.decompress(buffer, output_buffer);
+  drainBuffer(buffer);
+  drainBuffer(output_buffer);
+  compressor.reset();
+  decompressor.reset();
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size * 10, 2);
+  const std::string original_text{TestUtility::bufferToString(buffer)};
+  compressor.compress(buffer, Compressor::State::Finish);
+  decompressor.decompress(buffer, output_buffer);
+
+  ASSERT_EQ(compressor.checksum(), decompressor.checksum());
+  EXPECT_EQ(original_text, TestUtility::bufferToString(output_buffer));
+}
+
 } // namespace
 } // namespace Decompressor
 } // namespace Envoy
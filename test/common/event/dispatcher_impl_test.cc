@@ -1,4 +1,6 @@
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "common/common/lock_guard.h"
 #include "common/common/thread.h"
@@ -113,7 +115,7 @@ TEST_F(DispatcherImplTest, RunPostCallbacksLocking) {
     // Block dispatcher first to ensure that both posted events below are handled
     // by a single call to runPostCallbacks().
     //
-    // This also ensures that the post_lock_ is not held while callbacks are called,
+    // This also ensures that no lock is held while callbacks are called or destroyed,
     // or else this would deadlock.
     Thread::LockGuard lock(mu_);
     dispatcher_->post([this]() { Thread::LockGuard lock(mu_); });
@@ -135,6 +137,67 @@ TEST_F(DispatcherImplTest, RunPostCallbacksLocking) {
   }
 }
 
+// Callbacks posted concurrently from several threads all run, each thread's in the order it posted
+// them.
+TEST_F(DispatcherImplTest, PostFromManyThreads) {
+  const uint32_t num_threads = 4;
+  const uint32_t num_posts = 1000;
+  std::vector<uint32_t> next_sequence(num_threads, 0);
+  uint32_t num_run = 0;
+
+  std::vector<std::unique_ptr<Thread::Thread>> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(new Thread::Thread([&, i]() {
+      for (uint32_t sequence = 0; sequence < num_posts; sequence++) {
+        dispatcher_->post([&, i, sequence]() {
+          // Callbacks run on the dispatcher thread, so no locking is needed.
+          EXPECT_EQ(next_sequence[i]++, sequence);
+          if (++num_run == num_threads * num_posts) {
+            {
+              Thread::LockGuard lock(mu_);
+              work_finished_ = true;
+            }
+            cv_.notifyOne();
+          }
+        });
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  Thread::LockGuard lock(mu_);
+  while (!work_finished_) {
+    cv_.wait(mu_);
+  }
+}
+
+TEST(DispatcherImplPostTest, RunsPendingCallbacksOnRun) {
+  DispatcherImpl dispatcher;
+  ReadyWatcher watcher;
+  dispatcher.post([&]() -> void {
+    watcher.ready();
+    // Callbacks posted by a callback run in the same pass.
+    dispatcher.post([&]() -> void { watcher.ready(); });
+  });
+
+  EXPECT_CALL(watcher, ready()).Times(2);
+  dispatcher.run(Dispatcher::RunType::NonBlock);
+}
+
+TEST(DispatcherImplPostTest, DestroysPendingCallbacks) {
+  auto token = std::make_shared<bool>();
+  std::weak_ptr<bool> weak_token = token;
+  {
+    DispatcherImpl dispatcher;
+    dispatcher.post([token]() -> void { FAIL(); });
+    token.reset();
+    EXPECT_FALSE(weak_token.expired());
+  }
+  EXPECT_TRUE(weak_token.expired());
+}
+
 TEST_F(DispatcherImplTest, Timer) {
   TimerPtr timer;
   dispatcher_->post([this, &timer]() {
@@ -1,7 +1,11 @@
 #include <chrono>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "common/api/os_sys_calls_impl.h"
+#include "common/common/fmt.h"
 #include "common/common/lock_guard.h"
 #include "common/common/thread.h"
 #include "common/event/dispatcher_impl.h"
@@ -14,6 +18,8 @@
 #include "test/test_common/environment.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -27,13 +33,25 @@ using testing::Throw;
 using testing::_;
 
 namespace Envoy {
+namespace {
+
+std::string toString(const iovec* iov, int num_iov) {
+  std::string data;
+  for (int i = 0; i < num_iov; i++) {
+    data.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  }
+  return data;
+}
+
+} // namespace
 
 TEST(FileSystemImpl, BadFile) {
   Event::MockDispatcher dispatcher;
   Thread::MutexBasicLockable lock;
   Stats::IsolatedStoreImpl store;
   EXPECT_CALL(dispatcher, createTimer_(_));
-  EXPECT_THROW(Filesystem::FileImpl("", dispatcher, lock, store, std::chrono::milliseconds(10000)),
+  EXPECT_THROW(Filesystem::FileImpl("", dispatcher, lock, store, std::chrono::milliseconds(10000),
+                                    std::make_shared<Filesystem::FlushService>(1)),
                EnvoyException);
 }
 
@@ -114,16 +132,17 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FlushService>(1));
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("test", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("test");
@@ -135,13 +154,13 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
     }
   }
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("test2", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   // make sure timer is re-enabled on callback call
@@ -167,15 +186,18 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FlushService>(1));
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
 
   // The first write to a given file will start the flush thread, which can flush
   // immediately (race on whether it will or not). So do a write and flush to
   // get that state out of the way, then test that small writes don't trigger a flush.
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int, const void*, size_t num_bytes) -> ssize_t { return num_bytes; }));
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int, const iovec* iov, int num_iov) -> ssize_t {
+        return toString(iov, num_iov).size();
+      }));
   file.write("prime-it");
   file.flush();
   uint32_t expected_writes = 1;
@@ -184,13 +206,13 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
     EXPECT_EQ(expected_writes, os_sys_calls.num_writes_);
   }
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("test", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("test");
@@ -207,13 +229,13 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
     EXPECT_EQ(expected_writes, os_sys_calls.num_writes_);
   }
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("test2", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   // make sure timer is re-enabled on callback call
@@ -241,16 +263,17 @@ TEST(FileSystemImpl, reopenFile) {
 
   Sequence sq;
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FlushService>(1));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .InSequence(sq)
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("before", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("before");
@@ -266,14 +289,14 @@ TEST(FileSystemImpl, reopenFile) {
   EXPECT_CALL(os_sys_calls, close(5)).InSequence(sq);
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(10));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .InSequence(sq)
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("reopened", written);
         EXPECT_EQ(10, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   EXPECT_CALL(os_sys_calls, close(10)).InSequence(sq);
@@ -299,18 +322,18 @@ TEST(FilesystemImpl, reopenThrows) {
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillRepeatedly(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillRepeatedly(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
-        UNREFERENCED_PARAMETER(buffer);
 
-        return num_bytes;
+        return toString(iov, num_iov).size();
       }));
 
   Sequence sq;
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(5));
 
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FlushService>(1));
   EXPECT_CALL(os_sys_calls, close(5)).InSequence(sq);
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(-1));
 
@@ -346,17 +369,18 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FlushService>(1));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
 
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+        const std::string written = toString(iov, num_iov);
         std::string expected("a");
         EXPECT_EQ(expected, written);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("a");
@@ -370,15 +394,15 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
 
   // First write happens without waiting on thread_flush_. Now make a big string and it should be
   // flushed even when timer is not enabled
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
 
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+        const std::string written = toString(iov, num_iov);
         std::string expected(1024 * 64 + 1, 'b');
         EXPECT_EQ(expected, written);
 
-        return num_bytes;
+        return written.size();
       }));
 
   std::string big_string(1024 * 64 + 1, 'b');
@@ -391,4 +415,176 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
     }
   }
 }
+
+TEST(FilesystemImpl, writesFromManyThreads) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Thread::MutexBasicLockable mutex;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  // Calls are serialized by the mock's write_mutex_. While paused, each call waits until it is
+  // allowed through.
+  Thread::MutexBasicLockable gate_lock;
+  Thread::CondVar gate_event;
+  bool paused = false;
+  uint32_t writes_started = 0;
+  uint32_t writes_allowed = 0;
+  std::string written;
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillRepeatedly(Invoke([&](int, const iovec* iov, int num_iov) -> ssize_t {
+        {
+          Thread::LockGuard lock(gate_lock);
+          writes_started++;
+          gate_event.notifyAll();
+          while (paused && writes_allowed < writes_started) {
+            gate_event.wait(gate_lock);
+          }
+        }
+        const std::string data = toString(iov, num_iov);
+        written += data;
+        return data.size();
+      }));
+
+  Filesystem::FlushServiceSharedPtr flush_service =
+      std::make_shared<Filesystem::FlushService>(1);
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            flush_service);
+
+  // The first write starts the flush thread. Later writes go to a ring per writing thread.
+  file.write("first\n");
+  const uint32_t num_threads = 4;
+  const uint32_t num_records = 1000;
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(new Thread::Thread([&file, i, num_records]() -> void {
+      for (uint32_t j = 0; j < num_records; j++) {
+        file.write(fmt::format("{} {}\n", i, j));
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+  file.flush();
+
+  {
+    Thread::LockGuard lock(os_sys_calls.write_mutex_);
+    std::vector<uint32_t> next_record(num_threads);
+    for (absl::string_view line : absl::StrSplit(written, '\n', absl::SkipEmpty())) {
+      if (line == "first") {
+        continue;
+      }
+      const std::vector<std::string> fields = absl::StrSplit(line, ' ');
+      ASSERT_EQ(2, fields.size());
+      const uint32_t thread = std::stoul(fields[0]);
+      ASSERT_LT(thread, num_threads);
+      // Records of a single thread are written in order.
+      EXPECT_EQ(next_record[thread]++, std::stoul(fields[1]));
+    }
+    for (uint32_t i = 0; i < num_threads; i++) {
+      EXPECT_EQ(num_records, next_record[i]);
+    }
+  }
+  EXPECT_EQ(num_threads * num_records + 1,
+            stats_store.counter("filesystem.write_buffered").value());
+  EXPECT_EQ(0, stats_store.gauge("filesystem.write_total_buffered").value());
+
+  // Hold up the flush thread in a write of the quarter full ring that got it to flush.
+  const uint64_t overflows = stats_store.counter("filesystem.write_ring_overflow").value();
+  flush_service->assignThread().cancelFlush(file);
+  {
+    Thread::LockGuard lock(gate_lock);
+    paused = true;
+    writes_allowed = writes_started;
+  }
+  file.write(std::string(1024 * 2, 'r'));
+  {
+    Thread::LockGuard lock(gate_lock);
+    while (writes_started == writes_allowed) {
+      gate_event.wait(gate_lock);
+    }
+  }
+
+  // A record that does not fit in a ring, even a grown one, takes the locked path. It is written
+  // after the ring data before it and before the ring data after it, which goes to the ring right
+  // away.
+  const std::string overflow(1024 * 64 + 1, 'a');
+  file.write("before\n");
+  file.write(overflow);
+  EXPECT_EQ(overflows + 1, stats_store.counter("filesystem.write_ring_overflow").value());
+  file.write("after\n");
+  EXPECT_EQ(overflows + 1, stats_store.counter("filesystem.write_ring_overflow").value());
+  EXPECT_EQ(0, stats_store.counter("filesystem.write_ring_bypassed").value());
+  {
+    Thread::LockGuard lock(gate_lock);
+    paused = false;
+    gate_event.notifyAll();
+  }
+  file.flush();
+  {
+    Thread::LockGuard lock(os_sys_calls.write_mutex_);
+    EXPECT_TRUE(absl::EndsWith(written, "before\n" + overflow + "after\n"));
+  }
+
+  // A ring grows to fit a record while the flush thread is idle.
+  flush_service->assignThread().cancelFlush(file);
+  const std::string grown(1024 * 16, 'g');
+  file.write(grown);
+  EXPECT_EQ(overflows + 1, stats_store.counter("filesystem.write_ring_overflow").value());
+  file.flush();
+  {
+    Thread::LockGuard lock(os_sys_calls.write_mutex_);
+    EXPECT_TRUE(absl::EndsWith(written, grown));
+  }
+  EXPECT_EQ(0, stats_store.gauge("filesystem.write_total_buffered").value());
+}
+
+TEST(FilesystemImpl, filesShareFlushThread) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Thread::MutexBasicLockable mutex;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  // Calls are serialized by the mock's write_mutex_.
+  std::map<int, std::string> written;
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillRepeatedly(Invoke([&written](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string data = toString(iov, num_iov);
+        written[fd] += data;
+        return data.size();
+      }));
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5)).WillOnce(Return(6));
+
+  auto flush_service = std::make_shared<Filesystem::FlushService>(1);
+  auto file1 = std::make_unique<Filesystem::FileImpl>("", dispatcher, mutex, stats_store,
+                                                      std::chrono::milliseconds(40), flush_service);
+  Filesystem::FileImpl file2("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                             flush_service);
+
+  // The first write to each file is flushed right away, by the same thread.
+  file1->write("one");
+  file2->write("two");
+  {
+    Thread::LockGuard lock(os_sys_calls.write_mutex_);
+    while (os_sys_calls.num_writes_ != 2) {
+      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
+    }
+    EXPECT_EQ("one", written[5]);
+    EXPECT_EQ("two", written[6]);
+  }
+
+  // Files can go away while others keep using the thread.
+  file1->write("three");
+  file1.reset();
+  file2.write("four");
+  file2.flush();
+  {
+    Thread::LockGuard lock(os_sys_calls.write_mutex_);
+    EXPECT_EQ("onethree", written[5]);
+    EXPECT_EQ("twofour", written[6]);
+  }
+}
+
 } // namespace Envoy
@@ -0,0 +1,216 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Usage: bazel run -c opt //test/common/http:header_map_impl_speed_test
+//
+// Compares the HeaderMapImpl block/vector layout against the std::list layout it replaced. The
+// list benchmarks replicate the old HeaderMapImpl::HeaderList: one heap node per header, with
+// pseudo headers kept at the front. They skip the O(1) inline header lookup that HeaderMapImpl
+// does on insert, so they are a lower bound on the cost of the old map.
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "common/common/fmt.h"
+#include "common/http/header_map_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+/**
+ * Pre-built key/value pairs resembling a browser request: pseudo headers first, then a few
+ * inline headers, then custom headers up to the requested count.
+ */
+std::vector<std::pair<std::string, std::string>> makeRequestHeaders(size_t count) {
+  std::vector<std::pair<std::string, std::string>> headers = {
+      {":method", "GET"},
+      {":path", "/some/resource/path?with=query&and=more"},
+      {":scheme", "https"},
+      {":authority", "www.example.com"},
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36"},
+      {"accept", "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8"},
+      {"accept-encoding", "gzip, deflate, br"},
+      {"cookie", "session=0123456789abcdef; tracking=fedcba9876543210"},
+  };
+  for (size_t i = headers.size(); i < count; i++) {
+    headers.emplace_back(fmt::format("x-custom-header-{}", i), fmt::format("value-{}", i));
+  }
+  headers.resize(count);
+  return headers;
+}
+
+/**
+ * The layout HeaderMapImpl used before: a std::list of entries keeping pseudo headers in front.
+ */
+class ListLayout {
+public:
+  struct Entry {
+    Entry(HeaderString&& key, HeaderString&& value)
+        : key_(std::move(key)), value_(std::move(value)) {}
+
+    HeaderString key_;
+    HeaderString value_;
+  };
+
+  ListLayout() : pseudo_headers_end_(headers_.end()) {}
+
+  void addViaMove(HeaderString&& key, HeaderString&& value) {
+    const bool is_pseudo_header = key.c_str()[0] == ':';
+    auto i = headers_.emplace(is_pseudo_header ? pseudo_headers_end_ : headers_.end(),
+                              std::move(key), std::move(value));
+    if (!is_pseudo_header && pseudo_headers_end_ == headers_.end()) {
+      pseudo_headers_end_ = i;
+    }
+  }
+
+  const Entry* get(const LowerCaseString& key) const {
+    for (const Entry& entry : headers_) {
+      if (entry.key_ == key.get().c_str()) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  void remove(const LowerCaseString& key) {
+    for (auto i = headers_.begin(); i != headers_.end();) {
+      if (i->key_ == key.get().c_str()) {
+        if (pseudo_headers_end_ == i) {
+          pseudo_headers_end_++;
+        }
+        i = headers_.erase(i);
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  uint64_t byteSize() const {
+    uint64_t byte_size = 0;
+    for (const Entry& entry : headers_) {
+      byte_size += entry.key_.size() + entry.value_.size();
+    }
+    return byte_size;
+  }
+
+private:
+  std::list<Entry> headers_;
+  std::list<Entry>::iterator pseudo_headers_end_;
+};
+
+template <class Map>
+void populate(Map& map, const std::vector<std::pair<std::string, std::string>>& headers) {
+  for (const auto& header : headers) {
+    // Mimic the codecs, which parse into HeaderStrings and then move them into the map.
+    HeaderString key;
+    key.setCopy(header.first.c_str(), header.first.size());
+    HeaderString value;
+    value.setCopy(header.second.c_str(), header.second.size());
+    map.addViaMove(std::move(key), std::move(value));
+  }
+}
+
+// Build and destroy a map, as happens for every request received by a codec.
+static void BM_HeaderMapImplPopulate(benchmark::State& state) {
+  const auto headers = makeRequestHeaders(state.range(0));
+  for (auto _ : state) {
+    HeaderMapImpl map;
+    populate(map, headers);
+    benchmark::DoNotOptimize(map.size());
+  }
+}
+BENCHMARK(BM_HeaderMapImplPopulate)->Arg(8)->Arg(15)->Arg(25)->Arg(50);
+
+static void BM_ListLayoutPopulate(benchmark::State& state) {
+  const auto headers = makeRequestHeaders(state.range(0));
+  for (auto _ : state) {
+    ListLayout map;
+    populate(map, headers);
+    benchmark::DoNotOptimize(map.byteSize());
+  }
+}
+BENCHMARK(BM_ListLayoutPopulate)->Arg(8)->Arg(15)->Arg(25)->Arg(50);
+
+// Walk every header, as the codecs do when encoding and filters do when scanning.
+static void BM_HeaderMapImplIterate(benchmark::State& state) {
+  HeaderMapImpl map;
+  populate(map, makeRequestHeaders(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.byteSize());
+  }
+}
+BENCHMARK(BM_HeaderMapImplIterate)->Arg(8)->Arg(15)->Arg(25)->Arg(50);
+
+static void BM_ListLayoutIterate(benchmark::State& state) {
+  ListLayout map;
+  populate(map, makeRequestHeaders(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.byteSize());
+  }
+}
+BENCHMARK(BM_ListLayoutIterate)->Arg(8)->Arg(15)->Arg(25)->Arg(50);
+
+// Look up a non-inline header that is not present, which scans the whole map.
+static void BM_HeaderMapImplGetMissing(benchmark::State& state) {
+  HeaderMapImpl map;
+  populate(map, makeRequestHeaders(state.range(0)));
+  const LowerCaseString key("x-not-present");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.get(key));
+  }
+}
+BENCHMARK(BM_HeaderMapImplGetMissing)->Arg(8)->Arg(15)->Arg(25)->Arg(50);
+
+static void BM_ListLayoutGetMissing(benchmark::State& state) {
+  ListLayout map;
+  populate(map, makeRequestHeaders(state.range(0)));
+  const LowerCaseString key("x-not-present");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.get(key));
+  }
+}
+BENCHMARK(BM_ListLayoutGetMissing)->Arg(8)->Arg(15)->Arg(25)->Arg(50);
+
+// Remove and re-add a custom header, as header manipulation filters do.
+static void BM_HeaderMapImplRemoveAdd(benchmark::State& state) {
+  HeaderMapImpl map;
+  const auto headers = makeRequestHeaders(state.range(0));
+  populate(map, headers);
+  const LowerCaseString key(headers.back().first);
+  for (auto _ : state) {
+    map.remove(key);
+    map.addReferenceKey(key, headers.back().second);
+  }
+  benchmark::DoNotOptimize(map.size());
+}
+BENCHMARK(BM_HeaderMapImplRemoveAdd)->Arg(15)->Arg(25)->Arg(50);
+
+static void BM_ListLayoutRemoveAdd(benchmark::State& state) {
+  ListLayout map;
+  const auto headers = makeRequestHeaders(state.range(0));
+  populate(map, headers);
+  const LowerCaseString key(headers.back().first);
+  for (auto _ : state) {
+    map.remove(key);
+    map.addViaMove(HeaderString(key), HeaderString(headers.back().second));
+  }
+  benchmark::DoNotOptimize(map.byteSize());
+}
+BENCHMARK(BM_ListLayoutRemoveAdd)->Arg(15)->Arg(25)->Arg(50);
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,5 +1,6 @@
 #include <string>
 
+#include "common/common/fmt.h"
 #include "common/http/header_map_impl.h"
 
 #include "test/test_common/printers.h"
@@ -309,6 +310,68 @@ TEST(HeaderMapImplTest, InlineInsert) {
   EXPECT_STREQ("hello", headers.get(Headers::get().Host)->value().c_str());
 }
 
+// Inline header pointers must remain valid while other headers are added and removed, since the
+// entries are allocated in blocks and the removed slots are reused.
+TEST(HeaderMapImplTest, StableInlinePointers) {
+  TestHeaderMapImpl headers;
+  headers.insertMethod().value(std::string("GET"));
+  headers.insertHost().value(std::string("host"));
+  const HeaderEntry* method = headers.Method();
+  const HeaderEntry* host = headers.Host();
+
+  for (int i = 0; i < 100; i++) {
+    headers.addCopy(fmt::format("x-header-{}", i), "value");
+  }
+  for (int i = 0; i < 100; i += 2) {
+    headers.remove(fmt::format("x-header-{}", i));
+  }
+  for (int i = 0; i < 50; i++) {
+    headers.addCopy(fmt::format("x-other-{}", i), "value");
+  }
+
+  EXPECT_EQ(method, headers.Method());
+  EXPECT_EQ(host, headers.Host());
+  EXPECT_STREQ("GET", method->value().c_str());
+  EXPECT_STREQ("host", host->value().c_str());
+  EXPECT_EQ(102UL, headers.size());
+  EXPECT_FALSE(headers.has("x-header-0"));
+  EXPECT_TRUE(headers.has("x-header-1"));
+  EXPECT_TRUE(headers.has("x-other-49"));
+
+  // Removing a pseudo header keeps the remaining pseudo headers in front.
+  headers.removeMethod();
+  headers.insertPath().value(std::string("/"));
+  std::vector<std::string> keys;
+  headers.iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        static_cast<std::vector<std::string>*>(context)->push_back(header.key().c_str());
+        return HeaderMap::Iterate::Continue;
+      },
+      &keys);
+  ASSERT_EQ(102UL, keys.size());
+  EXPECT_EQ(":authority", keys[0]);
+  EXPECT_EQ(":path", keys[1]);
+  EXPECT_EQ("x-header-1", keys[2]);
+  EXPECT_EQ("x-other-49", keys[101]);
+}
+
+TEST(HeaderMapImplTest, MoveConstruct) {
+  TestHeaderMapImpl headers{{":path", "/"}, {"hello", "world"}};
+  const HeaderEntry* path = headers.Path();
+
+  TestHeaderMapImpl moved(std::move(headers));
+  EXPECT_EQ(path, moved.Path());
+  EXPECT_STREQ("/", moved.Path()->value().c_str());
+  EXPECT_EQ("world", moved.get_("hello"));
+  EXPECT_EQ(2UL, moved.size());
+
+  // Slots freed before the move are reused by the moved-to map.
+  moved.remove("hello");
+  moved.addCopy("foo", "bar");
+  EXPECT_EQ("bar", moved.get_("foo"));
+  EXPECT_EQ(2UL, moved.size());
+}
+
 TEST(HeaderMapImplTest, MoveIntoInline) {
   HeaderMapImpl headers;
   HeaderString key;
@@ -0,0 +1,89 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Usage: bazel run -c opt //test/common/http/http1:parser_speed_test
+//
+// Compares the http_parser based and SIMD request parsers on pipelined requests resembling
+// browser traffic, with callbacks that do no work.
+
+#include <string>
+
+#include "common/common/fmt.h"
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/simd_parser_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+class NullCallbacks : public ParserCallbacks {
+public:
+  // Http1::ParserCallbacks
+  void onMessageBegin() override {}
+  void onUrl(const char*, size_t) override {}
+  void onHeaderField(const char*, size_t) override {}
+  void onHeaderValue(const char*, size_t) override {}
+  void onHeader(absl::string_view, absl::string_view) override {}
+  int onHeadersComplete() override { return 0; }
+  void onBody(const char*, size_t) override {}
+  void onMessageComplete() override { messages_++; }
+
+  uint64_t messages_{};
+};
+
+/**
+ * @return a request with the given number of headers, padded with custom headers.
+ */
+std::string makeRequest(size_t header_count) {
+  std::string request = "GET /some/resource/path?with=query&and=more HTTP/1.1\r\n"
+                        "host: www.example.com\r\n"
+                        "user-agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+                        "accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*\r\n"
+                        "accept-encoding: gzip, deflate, br\r\n"
+                        "cookie: session=0123456789abcdef; tracking=fedcba9876543210\r\n";
+  for (size_t i = 5; i < header_count; i++) {
+    request += fmt::format("x-custom-header-{}: value-{}\r\n", i, i);
+  }
+  return request + "\r\n";
+}
+
+template <class ParserType> void runParser(benchmark::State& state, ParserType& parser) {
+  const std::string request = makeRequest(state.range(0));
+  for (auto _ : state) {
+    parser.execute(request.data(), request.size());
+  }
+  state.SetBytesProcessed(state.iterations() * request.size());
+}
+
+static void BM_LegacyParser(benchmark::State& state) {
+  NullCallbacks callbacks;
+  LegacyParserImpl parser(HTTP_REQUEST, callbacks);
+  runParser(state, parser);
+  benchmark::DoNotOptimize(callbacks.messages_);
+}
+BENCHMARK(BM_LegacyParser)->Arg(5)->Arg(15)->Arg(30);
+
+static void BM_SimdParser(benchmark::State& state) {
+  NullCallbacks callbacks;
+  SimdParserImpl parser(callbacks);
+  runParser(state, parser);
+  benchmark::DoNotOptimize(callbacks.messages_);
+}
+BENCHMARK(BM_SimdParser)->Arg(5)->Arg(15)->Arg(30);
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
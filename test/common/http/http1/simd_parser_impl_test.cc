@@ -0,0 +1,347 @@
+#include <string>
+
+#include "common/http/http1/simd_parser_impl.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::InSequence;
+using testing::InvokeWithoutArgs;
+using testing::Return;
+using testing::StrictMock;
+using testing::_;
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+class MockParserCallbacks : public ParserCallbacks {
+public:
+  MOCK_METHOD0(onMessageBegin, void());
+  MOCK_METHOD1(onUrl_, void(const std::string& url));
+  MOCK_METHOD1(onHeaderField_, void(const std::string& data));
+  MOCK_METHOD1(onHeaderValue_, void(const std::string& data));
+  MOCK_METHOD2(onHeader_, void(const std::string& key, const std::string& value));
+  MOCK_METHOD0(onHeadersComplete, int());
+  MOCK_METHOD1(onBody_, void(const std::string& data));
+  MOCK_METHOD0(onMessageComplete, void());
+
+  void onUrl(const char* data, size_t length) override { onUrl_(std::string(data, length)); }
+  void onHeaderField(const char* data, size_t length) override {
+    onHeaderField_(std::string(data, length));
+  }
+  void onHeaderValue(const char* data, size_t length) override {
+    onHeaderValue_(std::string(data, length));
+  }
+  void onHeader(absl::string_view key, absl::string_view value) override {
+    onHeader_(std::string(key), std::string(value));
+  }
+  void onBody(const char* data, size_t length) override { onBody_(std::string(data, length)); }
+};
+
+class SimdParserImplTest : public testing::Test {
+public:
+  size_t execute(const std::string& data) { return parser_.execute(data.data(), data.size()); }
+
+  // Expect a GET request without headers, parsed by the fast path.
+  void expectGet(const std::string& url) {
+    EXPECT_CALL(callbacks_, onMessageBegin());
+    EXPECT_CALL(callbacks_, onUrl_(url));
+    EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(Return(0));
+    EXPECT_CALL(callbacks_, onMessageComplete());
+  }
+
+  StrictMock<MockParserCallbacks> callbacks_;
+  SimdParserImpl parser_{callbacks_};
+};
+
+TEST_F(SimdParserImplTest, Get) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/path?a=b"));
+  EXPECT_CALL(callbacks_, onHeader_("Host", "example.com"));
+  EXPECT_CALL(callbacks_, onHeader_("Empty", ""));
+  EXPECT_CALL(callbacks_, onHeader_("x-tab", "a\tb \x80 "));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(InvokeWithoutArgs([this]() -> int {
+    EXPECT_EQ(HTTP_GET, parser_.method());
+    EXPECT_EQ(1, parser_.httpMajor());
+    EXPECT_EQ(1, parser_.httpMinor());
+    EXPECT_FALSE(parser_.chunked());
+    EXPECT_EQ(ULLONG_MAX, parser_.contentLength());
+    return 0;
+  }));
+  EXPECT_CALL(callbacks_, onMessageComplete());
+
+  const std::string request =
+      "\r\nGET /path?a=b HTTP/1.1\r\nHost: example.com\r\nEmpty:\r\nx-tab: \ta\tb \x80 \r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ(HPE_OK, parser_.error());
+}
+
+TEST_F(SimdParserImplTest, PostWithBodySplitAcrossCalls) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/"));
+  EXPECT_CALL(callbacks_, onHeader_("Content-Length", "10"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(InvokeWithoutArgs([this]() -> int {
+    EXPECT_EQ(HTTP_POST, parser_.method());
+    EXPECT_EQ(10U, parser_.contentLength());
+    return 0;
+  }));
+  EXPECT_CALL(callbacks_, onBody_("abc"));
+  EXPECT_CALL(callbacks_, onBody_("defghij"));
+  EXPECT_CALL(callbacks_, onMessageComplete());
+  expectGet("/next");
+
+  const std::string first = "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\nabc";
+  EXPECT_EQ(first.size(), execute(first));
+  const std::string rest = "defghijGET /next HTTP/1.1\r\n\r\n";
+  EXPECT_EQ(rest.size(), execute(rest));
+}
+
+TEST_F(SimdParserImplTest, PauseAfterMessageComplete) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/1"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(Return(0));
+  EXPECT_CALL(callbacks_, onMessageComplete()).WillOnce(InvokeWithoutArgs([this]() -> void {
+    parser_.pause(true);
+  }));
+
+  const std::string first = "GET /1 HTTP/1.1\r\n\r\n";
+  const std::string request = first + "GET /2 HTTP/1.1\r\n\r\n";
+  EXPECT_EQ(first.size(), execute(request));
+  EXPECT_EQ(HPE_PAUSED, parser_.error());
+  EXPECT_EQ(0U, execute(request.substr(first.size())));
+
+  expectGet("/2");
+  parser_.pause(false);
+  EXPECT_EQ(request.size() - first.size(), execute(request.substr(first.size())));
+}
+
+// Like http_parser, the final LF of the headers is consumed once parsing resumes.
+TEST_F(SimdParserImplTest, PauseAfterHeadersComplete) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/"));
+  EXPECT_CALL(callbacks_, onHeader_("content-length", "2"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(InvokeWithoutArgs([this]() -> int {
+    parser_.pause(true);
+    return 0;
+  }));
+
+  const std::string request = "PUT / HTTP/1.1\r\ncontent-length: 2\r\n\r\nab";
+  EXPECT_EQ(request.size() - 3, execute(request));
+
+  EXPECT_CALL(callbacks_, onBody_("ab"));
+  EXPECT_CALL(callbacks_, onMessageComplete());
+  parser_.pause(false);
+  EXPECT_EQ(3U, execute(request.substr(request.size() - 3)));
+}
+
+TEST_F(SimdParserImplTest, HeadersCompleteSkipsBody) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/"));
+  EXPECT_CALL(callbacks_, onHeader_("content-length", "2"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(Return(1));
+  EXPECT_CALL(callbacks_, onMessageComplete());
+
+  const std::string request = "POST / HTTP/1.1\r\ncontent-length: 2\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request));
+}
+
+TEST_F(SimdParserImplTest, ConnectionClose) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/"));
+  EXPECT_CALL(callbacks_, onHeader_("Connection", "Close"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(Return(0));
+  EXPECT_CALL(callbacks_, onMessageComplete());
+
+  const std::string request = "GET / HTTP/1.1\r\nConnection: Close\r\n\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request + "GET"));
+  EXPECT_EQ(HPE_CLOSED_CONNECTION, parser_.error());
+}
+
+TEST_F(SimdParserImplTest, Http10) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/"));
+  EXPECT_CALL(callbacks_, onHeader_("connection", "keep-alive"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(InvokeWithoutArgs([this]() -> int {
+    EXPECT_EQ(0, parser_.httpMinor());
+    return 0;
+  }));
+  EXPECT_CALL(callbacks_, onMessageComplete());
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(Return(0));
+  EXPECT_CALL(callbacks_, onMessageComplete());
+
+  // Without keep-alive, an HTTP/1.0 request is the last one on the connection.
+  const std::string request = "GET / HTTP/1.0\r\nconnection: keep-alive\r\n\r\n"
+                              "HEAD / HTTP/1.0\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request + "G"));
+  EXPECT_EQ(HPE_CLOSED_CONNECTION, parser_.error());
+}
+
+TEST_F(SimdParserImplTest, EofInBody) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/"));
+  EXPECT_CALL(callbacks_, onHeader_("content-length", "5"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(Return(0));
+  EXPECT_CALL(callbacks_, onBody_("ab"));
+
+  const std::string request = "POST / HTTP/1.1\r\ncontent-length: 5\r\n\r\nab";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ(0U, parser_.execute(nullptr, 0));
+  EXPECT_EQ(HPE_INVALID_EOF_STATE, parser_.error());
+}
+
+TEST_F(SimdParserImplTest, EofBetweenMessages) {
+  expectGet("/");
+  EXPECT_EQ(18U, execute("GET / HTTP/1.1\r\n\r\n"));
+  EXPECT_EQ(0U, parser_.execute(nullptr, 0));
+  EXPECT_EQ(HPE_OK, parser_.error());
+}
+
+// Requests the fast path does not handle are parsed by http_parser, after which the fast path
+// picks up the next request.
+TEST_F(SimdParserImplTest, FallbackToHttpParser) {
+  const std::string requests[] = {
+      // Chunked.
+      "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n1\r\na\r\n0\r\n\r\n",
+      // Absolute URL.
+      "GET http://host/ HTTP/1.1\r\n\r\n",
+      // Uncommon method.
+      "PURGE / HTTP/1.1\r\n\r\n",
+      // Extra whitespace.
+      "GET  / HTTP/1.1\r\n\r\n",
+      // Bare LF.
+      "GET / HTTP/1.1\nhost: a\r\n\r\n",
+      "GET / HTTP/1.1\r\nhost: a\n\r\n",
+      // Folded header.
+      "GET / HTTP/1.1\r\nhost: a\r\n b\r\n\r\n",
+      // Trailing whitespace in content-length.
+      "POST / HTTP/1.1\r\ncontent-length: 1 \r\n\r\na",
+      // Connection token list.
+      "GET / HTTP/1.1\r\nconnection: keep-alive, te\r\n\r\n",
+  };
+
+  for (const std::string& request : requests) {
+    StrictMock<MockParserCallbacks> callbacks;
+    SimdParserImpl parser(callbacks);
+    {
+      InSequence s;
+      EXPECT_CALL(callbacks, onMessageBegin());
+      EXPECT_CALL(callbacks, onUrl_(_));
+      EXPECT_CALL(callbacks, onHeaderField_(_)).Times(testing::AnyNumber());
+      EXPECT_CALL(callbacks, onHeaderValue_(_)).Times(testing::AnyNumber());
+      EXPECT_CALL(callbacks, onHeadersComplete()).WillOnce(Return(0));
+      EXPECT_CALL(callbacks, onBody_(_)).Times(testing::AnyNumber());
+      EXPECT_CALL(callbacks, onMessageComplete());
+      EXPECT_CALL(callbacks, onMessageBegin());
+      EXPECT_CALL(callbacks, onUrl_("/fast"));
+      EXPECT_CALL(callbacks, onHeader_("a", "b"));
+      EXPECT_CALL(callbacks, onHeadersComplete()).WillOnce(Return(0));
+      EXPECT_CALL(callbacks, onMessageComplete());
+    }
+
+    const std::string data = request + "GET /fast HTTP/1.1\r\na: b\r\n\r\n";
+    EXPECT_EQ(data.size(), parser.execute(data.data(), data.size())) << request;
+    EXPECT_EQ(HPE_OK, parser.error()) << request;
+  }
+}
+
+// A request line and headers split across calls are left to http_parser.
+TEST_F(SimdParserImplTest, FallbackForPartialHeaders) {
+  InSequence s;
+  EXPECT_CALL(callbacks_, onMessageBegin());
+  EXPECT_CALL(callbacks_, onUrl_("/"));
+  EXPECT_CALL(callbacks_, onHeaderField_("host"));
+  EXPECT_CALL(callbacks_, onHeaderValue_("a"));
+  EXPECT_CALL(callbacks_, onHeaderValue_("b"));
+  EXPECT_CALL(callbacks_, onHeadersComplete()).WillOnce(Return(0));
+  EXPECT_CALL(callbacks_, onMessageComplete());
+
+  EXPECT_EQ(23U, execute("GET / HTTP/1.1\r\nhost: a"));
+  EXPECT_EQ(5U, execute("b\r\n\r\n"));
+}
+
+TEST_F(SimdParserImplTest, FallbackErrors) {
+  EXPECT_EQ(0U, execute("get / HTTP/1.1\r\n\r\n"));
+  EXPECT_EQ(HPE_INVALID_METHOD, parser_.error());
+
+  StrictMock<MockParserCallbacks> callbacks;
+  SimdParserImpl parser(callbacks);
+  EXPECT_CALL(callbacks, onMessageBegin());
+  EXPECT_CALL(callbacks, onUrl_("/"));
+  EXPECT_CALL(callbacks, onHeaderField_("host"));
+  EXPECT_CALL(callbacks, onHeaderValue_(_)).Times(testing::AnyNumber());
+  const std::string request = "GET / HTTP/1.1\r\nhost: a\x01\r\n\r\n";
+  parser.execute(request.data(), request.size());
+  EXPECT_EQ(HPE_INVALID_HEADER_TOKEN, parser.error());
+}
+
+// http_parser counts CR and LF bytes before a request towards its header size limit.
+TEST_F(SimdParserImplTest, HeaderSizeLimit) {
+  const std::string line_feeds(HTTP_MAX_HEADER_SIZE, '\n');
+  EXPECT_EQ(line_feeds.size(), execute(line_feeds));
+  EXPECT_EQ(0U, execute("G"));
+  EXPECT_EQ(HPE_HEADER_OVERFLOW, parser_.error());
+}
+
+TEST_F(SimdParserImplTest, HeaderSizeLimitFallback) {
+  StrictMock<MockParserCallbacks> callbacks;
+  SimdParserImpl parser(callbacks);
+  EXPECT_CALL(callbacks, onMessageBegin());
+  EXPECT_CALL(callbacks, onUrl_("/"));
+  EXPECT_CALL(callbacks, onHeaderField_("foo"));
+  EXPECT_CALL(callbacks, onHeaderValue_(_)).Times(testing::AnyNumber());
+
+  const std::string request =
+      "GET / HTTP/1.1\r\nfoo: " + std::string(HTTP_MAX_HEADER_SIZE, 'a') + "\r\n\r\n";
+  parser.execute(request.data(), request.size());
+  EXPECT_EQ(HPE_HEADER_OVERFLOW, parser.error());
+}
+
+TEST(SimdScannerTest, FindValueEnd) {
+  // Cover the vector loops and the scalar tail.
+  for (size_t length = 0; length < 80; length++) {
+    for (size_t position = 0; position < length; position++) {
+      std::string value(length, 'a');
+      for (const char c : {'\t', ' ', '\x80', '\xff', '~'}) {
+        value[position] = c;
+        EXPECT_EQ(value.data() + length,
+                  SimdScanner::findValueEnd(value.data(), value.data() + length));
+      }
+      for (const char c : {'\0', '\r', '\n', '\x1f', '\x7f'}) {
+        value[position] = c;
+        EXPECT_EQ(value.data() + position,
+                  SimdScanner::findValueEnd(value.data(), value.data() + length));
+      }
+    }
+  }
+}
+
+TEST(SimdScannerTest, FindUrlEnd) {
+  for (size_t length = 0; length < 80; length++) {
+    for (size_t position = 0; position < length; position++) {
+      std::string url(length, '/');
+      for (const char c : {'!', '~', '%', '?'}) {
+        url[position] = c;
+        EXPECT_EQ(url.data() + length, SimdScanner::findUrlEnd(url.data(), url.data() + length));
+      }
+      for (const char c : {'\0', ' ', '\t', '\x7f', '\x80', '\xff'}) {
+        url[position] = c;
+        EXPECT_EQ(url.data() + position, SimdScanner::findUrlEnd(url.data(), url.data() + length));
+      }
+    }
+  }
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
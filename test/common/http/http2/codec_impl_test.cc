@@ -361,6 +361,39 @@ TEST_P(Http2CodecImplTest, TrailingHeadersLargeBody) {
   response_encoder_->encodeTrailers(TestHeaderMapImpl{{"trailing", "header"}});
 }
 
+// DATA payloads are moved out of the dispatched buffer. Make sure they arrive intact and in order
+// when frames and slices do not line up.
+TEST_P(Http2CodecImplTest, LargeBodyMovedFromDispatchBuffer) {
+  initialize();
+
+  // Buffer client data so that the server dispatches many frames at once.
+  ON_CALL(client_connection_, write(_, _))
+      .WillByDefault(
+          Invoke([&](Buffer::Instance& data, bool) -> void { server_wrapper_.buffer_.add(data); }));
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  std::string sent;
+  for (uint32_t i = 0; sent.size() < 48 * 1024; i++) {
+    sent += std::to_string(i);
+  }
+  std::string received;
+  EXPECT_CALL(request_decoder_, decodeData(_, _))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> void {
+        received += TestUtility::bufferToString(data);
+        data.drain(data.length());
+      }));
+  Buffer::OwnedImpl body(sent);
+  request_encoder_->encodeData(body, true);
+
+  setupDefaultConnectionMocks();
+  server_wrapper_.dispatch(Buffer::OwnedImpl(), server_);
+  EXPECT_EQ(sent, received);
+}
+
 class Http2CodecImplDeferredResetTest : public Http2CodecImplTest {};
 
 TEST_P(Http2CodecImplDeferredResetTest, DeferredResetClient) {
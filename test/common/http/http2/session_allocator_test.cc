@@ -0,0 +1,94 @@
+#include <cstring>
+#include <vector>
+
+#include "common/http/http2/session_allocator.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+TEST(SessionAllocatorTest, ReusesFreedBlocks) {
+  SessionAllocator allocator;
+  void* block = allocator.allocate(100);
+  ASSERT_NE(nullptr, block);
+  allocator.release(block);
+  EXPECT_EQ(128, allocator.cachedBytes());
+
+  // Any size in the same size class gets the cached block back.
+  EXPECT_EQ(block, allocator.allocate(65));
+  EXPECT_EQ(0, allocator.cachedBytes());
+  void* other_block = allocator.allocate(65);
+  EXPECT_NE(block, other_block);
+  allocator.release(block);
+  allocator.release(other_block);
+}
+
+TEST(SessionAllocatorTest, LargeBlocksAreNotCached) {
+  SessionAllocator allocator;
+  void* block = allocator.allocate(SessionAllocator::MaxCachedBlockSize + 1);
+  ASSERT_NE(nullptr, block);
+  memset(block, 'a', SessionAllocator::MaxCachedBlockSize + 1);
+  allocator.release(block);
+  EXPECT_EQ(0, allocator.cachedBytes());
+}
+
+TEST(SessionAllocatorTest, CachedBytesAreBounded) {
+  SessionAllocator allocator;
+  const uint64_t count = SessionAllocator::MaxCachedBytes / SessionAllocator::MaxCachedBlockSize;
+  std::vector<void*> blocks;
+  for (uint64_t i = 0; i < count + 1; i++) {
+    blocks.push_back(allocator.allocate(SessionAllocator::MaxCachedBlockSize));
+  }
+  for (void* block : blocks) {
+    allocator.release(block);
+  }
+  EXPECT_EQ(SessionAllocator::MaxCachedBytes, allocator.cachedBytes());
+}
+
+TEST(SessionAllocatorTest, AllocateZeroed) {
+  SessionAllocator allocator;
+  char* block = static_cast<char*>(allocator.allocate(64));
+  memset(block, 'a', 64);
+  allocator.release(block);
+
+  char* zeroed = static_cast<char*>(allocator.allocateZeroed(8, 8));
+  EXPECT_EQ(block, zeroed);
+  for (size_t i = 0; i < 64; i++) {
+    EXPECT_EQ(0, zeroed[i]);
+  }
+  EXPECT_EQ(nullptr, allocator.allocateZeroed(SIZE_MAX, 2));
+  allocator.release(zeroed);
+}
+
+TEST(SessionAllocatorTest, Reallocate) {
+  SessionAllocator allocator;
+  char* block = static_cast<char*>(allocator.reallocate(nullptr, 20));
+  memcpy(block, "0123456789", 10);
+
+  // Growing within the size class keeps the block.
+  EXPECT_EQ(block, allocator.reallocate(block, 32));
+
+  char* grown = static_cast<char*>(allocator.reallocate(block, 20000));
+  EXPECT_EQ(0, memcmp(grown, "0123456789", 10));
+  EXPECT_EQ(32, allocator.cachedBytes());
+  allocator.release(grown);
+  allocator.release(nullptr);
+}
+
+TEST(SessionAllocatorTest, NghttpInterface) {
+  SessionAllocator allocator;
+  nghttp2_mem* mem = allocator.mem();
+  void* block = mem->malloc(10, mem->mem_user_data);
+  block = mem->realloc(block, 100, mem->mem_user_data);
+  mem->free(block, mem->mem_user_data);
+  EXPECT_EQ(block, mem->calloc(1, 100, mem->mem_user_data));
+  mem->free(block, mem->mem_user_data);
+  // The 16 byte block that was grown, and the 128 byte block.
+  EXPECT_EQ(16 + 128, allocator.cachedBytes());
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -139,6 +139,15 @@ TEST(HttpUtility, parseHttp2Settings) {
   }
 }
 
+TEST(HttpUtility, parseHttp1SettingsParserEngine) {
+  envoy::api::v2::core::Http1ProtocolOptions config;
+  EXPECT_EQ(Http1Settings::ParserEngine::HttpParser,
+            Utility::parseHttp1Settings(config).parser_engine_);
+
+  config.set_parser_engine(envoy::api::v2::core::Http1ProtocolOptions::SIMD);
+  EXPECT_EQ(Http1Settings::ParserEngine::Simd, Utility::parseHttp1Settings(config).parser_engine_);
+}
+
 TEST(HttpUtility, getLastAddressFromXFF) {
   {
     const std::string first_address = "192.0.2.10";
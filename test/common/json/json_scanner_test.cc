@@ -0,0 +1,159 @@
+#include <string>
+#include <vector>
+
+#include "envoy/json/json_object.h"
+
+#include "common/common/fmt.h"
+#include "common/json/json_scanner.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Json {
+namespace {
+
+// Records the reported keys and values as "<type> <dotted path>[=<value>]".
+class RecordingCallbacks : public StreamingScanner::Callbacks {
+public:
+  // Json::StreamingScanner::Callbacks
+  void onKey(const StreamingScanner::Path& path) override {
+    events_.push_back("key " + join(path));
+  }
+  void onString(const StreamingScanner::Path& path, const std::string& value) override {
+    events_.push_back(fmt::format("string {}={}", join(path), value));
+  }
+  void onNumber(const StreamingScanner::Path& path, double value) override {
+    events_.push_back(fmt::format("number {}={}", join(path), value));
+  }
+
+  std::vector<std::string> events_;
+
+private:
+  static std::string join(const StreamingScanner::Path& path) {
+    std::string joined;
+    for (const std::string& key : path) {
+      joined += (joined.empty() ? "" : ".") + key;
+    }
+    return joined;
+  }
+};
+
+std::vector<std::string> scan(const std::string& document, uint32_t max_depth) {
+  RecordingCallbacks callbacks;
+  StreamingScanner scanner(callbacks, max_depth);
+  scanner.scan(document.data(), document.size());
+  scanner.finish();
+  return callbacks.events_;
+}
+
+// Scan the document a byte at a time, which must not make any difference.
+std::vector<std::string> scanBytewise(const std::string& document, uint32_t max_depth) {
+  RecordingCallbacks callbacks;
+  StreamingScanner scanner(callbacks, max_depth);
+  for (const char c : document) {
+    scanner.scan(&c, 1);
+  }
+  scanner.finish();
+  return callbacks.events_;
+}
+
+void expectInvalid(const std::string& document) {
+  EXPECT_THROW(scan(document, 8), Exception) << document;
+  EXPECT_THROW(scanBytewise(document, 8), Exception) << document;
+}
+
+TEST(JsonStreamingScannerTest, ReportsShallowMembers) {
+  const std::string document = R"EOF(
+  {
+    "TableName": "Pets",
+    "Limit": 25,
+    "ConsistentRead": true,
+    "Key": {
+      "AnimalType": {"S": "Dog"},
+      "Name": {"S": "Fido"}
+    },
+    "AttributesToGet": ["Name", {"Nested": "ignored"}],
+    "ReturnValues": null
+  }
+  )EOF";
+  const std::vector<std::string> expected{"key TableName",
+                                          "string TableName=Pets",
+                                          "key Limit",
+                                          "number Limit=25",
+                                          "key ConsistentRead",
+                                          "key Key",
+                                          "key Key.AnimalType",
+                                          "key Key.Name",
+                                          "key AttributesToGet",
+                                          "key ReturnValues"};
+
+  EXPECT_EQ(expected, scan(document, 2));
+  EXPECT_EQ(expected, scanBytewise(document, 2));
+}
+
+TEST(JsonStreamingScannerTest, MaxDepth) {
+  const std::string document = R"({"a": {"b": {"c": 1.5}, "d": "e"}, "f": "g"})";
+
+  EXPECT_EQ(std::vector<std::string>({"key a", "key f", "string f=g"}), scan(document, 1));
+  EXPECT_EQ(std::vector<std::string>(
+                {"key a", "key a.b", "key a.d", "string a.d=e", "key f", "string f=g"}),
+            scan(document, 2));
+  EXPECT_EQ(std::vector<std::string>({"key a", "key a.b", "key a.b.c", "number a.b.c=1.5",
+                                      "key a.d", "string a.d=e", "key f", "string f=g"}),
+            scan(document, 3));
+}
+
+TEST(JsonStreamingScannerTest, NothingReportedOutsideTopLevelObject) {
+  EXPECT_TRUE(scan(R"([{"a": "b"}])", 8).empty());
+  EXPECT_TRUE(scan(R"("a")", 8).empty());
+  EXPECT_TRUE(scan("-1.5e3", 8).empty());
+  EXPECT_TRUE(scan("  true  ", 8).empty());
+}
+
+TEST(JsonStreamingScannerTest, Escapes) {
+  const std::string document =
+      R"({"a\"b": "\\\/\b\f\n\r\t", "c": "\u0041\u00e9\u20AC\ud83d\ude00", "d": ["\"]"]})";
+  const std::vector<std::string> expected{"key a\"b", "string a\"b=\\/\b\f\n\r\t", "key c",
+                                          "string c=A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80",
+                                          "key d"};
+
+  EXPECT_EQ(expected, scan(document, 1));
+  EXPECT_EQ(expected, scanBytewise(document, 1));
+}
+
+TEST(JsonStreamingScannerTest, Invalid) {
+  expectInvalid("");
+  expectInvalid("   ");
+  expectInvalid("{");
+  expectInvalid(R"({"a": "b")");
+  expectInvalid(R"({"a": "b"}})");
+  expectInvalid(R"({"a": "b"} {})");
+  expectInvalid(R"({"a" "b"})");
+  expectInvalid(R"({"a": "b",})");
+  expectInvalid(R"({a: "b"})");
+  expectInvalid(R"({"a": ["b"}})");
+  expectInvalid(R"({"a": ["b",]})");
+  expectInvalid(R"({"a": tru})");
+  expectInvalid(R"({"a": 01})");
+  expectInvalid(R"({"a": 1.})");
+  expectInvalid(R"({"a": +1})");
+  expectInvalid(R"({"a": 1e})");
+  expectInvalid(R"({"a": "\x"})");
+  expectInvalid(R"({"a": "\u12g4"})");
+  expectInvalid(R"({"a": "\ud83d"})");
+  expectInvalid(R"({"a": "\ude00"})");
+  expectInvalid("{\"a\": \"b\nc\"}");
+}
+
+TEST(JsonStreamingScannerTest, ErrorMessage) {
+  EXPECT_THROW_WITH_MESSAGE(scan(R"({"a" "b"})", 1), Exception,
+                            "JSON supplied is not valid: expected ':'");
+  EXPECT_THROW_WITH_MESSAGE(scan(R"({"a": "b")", 1), Exception,
+                            "JSON supplied is not valid: incomplete document");
+}
+
+} // namespace
+} // namespace Json
+} // namespace Envoy
@@ -214,8 +214,8 @@ TEST(RouteMatcherTest, TestRoutes) {
         {"pattern": "^/rides$", "method": "POST", "name": "ride_request"},
         {"pattern": "^/rides/\\d+$", "method": "PUT", "name": "update_ride"},
         {"pattern": "^/users/\\d+/chargeaccounts$", "method": "POST", "name": "cc_add"},
-        {"pattern": "^/users/\\d+/chargeaccounts/(?!validate)\\w+$", "method": "PUT",
-         "name": "cc_add"},
+        {"pattern": "^/users/\\d+/chargeaccounts/(?:[^v\\W]|v(?:[^a\\W]|a(?:[^l\\W]|l(?:[^i\\W]|i(?:[^d\\W]|d(?:[^a\\W]|a(?:[^t\\W]|t(?:[^e\\W]|$)|$)|$)|$)|$)|$)|$))\\w*$",
+         "method": "PUT", "name": "cc_add"},
         {"pattern": "^/users$", "method": "POST", "name": "create_user_login"},
         {"pattern": "^/users/\\d+$", "method": "PUT", "name": "update_user"},
         {"pattern": "^/users/\\d+/location$", "method": "POST", "name": "ulu"}]
@@ -1772,6 +1772,60 @@ TEST(RouteMatcherTest, Runtime) {
             config.route(genHeaders("www.lyft.com", "/", "GET"), 20)->routeEntry()->clusterName());
 }
 
+// Routes of different kinds are indexed separately; the first one in configuration order that
+// matches must still win.
+TEST(RouteMatcherTest, FirstMatchAcrossRouteKinds) {
+  const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+  - name: www2
+    domains: ["www.lyft.com"]
+    routes:
+      - match:
+          prefix: "/api"
+          headers:
+            - name: x-canary
+              value: "true"
+        route: { cluster: canary }
+      - match: { regex: "/api/v[0-9]+/users" }
+        route: { cluster: users_regex }
+      - match: { path: "/api/v1/users" }
+        route: { cluster: users_path }
+      - match: { prefix: "/API/v2", case_sensitive: false }
+        route: { cluster: v2 }
+      - match:
+          prefix: "/api"
+          query_parameters:
+            - name: debug
+        route: { cluster: debug }
+      - match: { path: "/API/V3/users", case_sensitive: false }
+        route: { cluster: v3_users }
+      - match: { prefix: "/api" }
+        route: { cluster: api }
+      - match: { prefix: "/" }
+        route: { cluster: default }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+
+  auto cluster = [&config](const std::string& path) {
+    return config.route(genHeaders("www.lyft.com", path, "GET"), 0)->routeEntry()->clusterName();
+  };
+  EXPECT_EQ("users_regex", cluster("/api/v1/users"));
+  EXPECT_EQ("users_regex", cluster("/api/v2/users?debug=1"));
+  EXPECT_EQ("v2", cluster("/api/v2/groups?debug=1"));
+  EXPECT_EQ("debug", cluster("/api/v1/groups?debug=1"));
+  EXPECT_EQ("v3_users", cluster("/api/V3/USERS"));
+  EXPECT_EQ("api", cluster("/api/v3/users/1"));
+  EXPECT_EQ("default", cluster("/API/v1/users"));
+  EXPECT_EQ("default", cluster("/"));
+
+  Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v1/users", "GET");
+  headers.addCopy("x-canary", "true");
+  EXPECT_EQ("canary", config.route(headers, 0)->routeEntry()->clusterName());
+}
+
 TEST(RouteMatcherTest, ShadowClusterNotFound) {
   std::string json = R"EOF(
 {
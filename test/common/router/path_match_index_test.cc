@@ -0,0 +1,99 @@
+#include <string>
+#include <vector>
+
+#include "common/router/path_match_index.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+std::vector<uint32_t> candidates(const PathMatchIndex& index, const std::string& path) {
+  std::vector<uint32_t> positions;
+  index.candidates(path, positions);
+  return positions;
+}
+
+TEST(PathMatchIndexTest, Empty) {
+  PathMatchIndex index;
+  EXPECT_EQ(std::vector<uint32_t>(), candidates(index, "/"));
+  EXPECT_EQ(std::vector<uint32_t>(), candidates(index, ""));
+}
+
+TEST(PathMatchIndexTest, Prefixes) {
+  PathMatchIndex index;
+  index.addPrefix("/api/v1", true, 0);
+  index.addPrefix("/api", true, 1);
+  index.addPrefix("/apple", true, 2);
+  index.addPrefix("/", true, 3);
+  index.addPrefix("", true, 4);
+  index.addPrefix("/api/v1/users", true, 5);
+
+  EXPECT_EQ(std::vector<uint32_t>({1, 3, 4}), candidates(index, "/api"));
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 3, 4}), candidates(index, "/api/v1/"));
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 3, 4, 5}), candidates(index, "/api/v1/users?x=y"));
+  EXPECT_EQ(std::vector<uint32_t>({2, 3, 4}), candidates(index, "/apples"));
+  EXPECT_EQ(std::vector<uint32_t>({3, 4}), candidates(index, "/ap"));
+  EXPECT_EQ(std::vector<uint32_t>({3, 4}), candidates(index, "/API"));
+  EXPECT_EQ(std::vector<uint32_t>({4}), candidates(index, "api"));
+  EXPECT_EQ(std::vector<uint32_t>({4}), candidates(index, ""));
+}
+
+TEST(PathMatchIndexTest, CaseInsensitivePrefixes) {
+  PathMatchIndex index;
+  index.addPrefix("/Foo", false, 0);
+  index.addPrefix("/foo/BAR", true, 1);
+  index.addPrefix("/FOO/bar", false, 2);
+
+  EXPECT_EQ(std::vector<uint32_t>({0}), candidates(index, "/fOO"));
+  EXPECT_EQ(std::vector<uint32_t>({0, 2}), candidates(index, "/foo/bar"));
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2}), candidates(index, "/foo/BAR/baz"));
+  EXPECT_EQ(std::vector<uint32_t>(), candidates(index, "/fo"));
+}
+
+TEST(PathMatchIndexTest, Paths) {
+  PathMatchIndex index;
+  index.addPath("/foo", true, 0);
+  index.addPath("/Bar", false, 1);
+  index.addPath("/foo", true, 2);
+
+  EXPECT_EQ(std::vector<uint32_t>({0, 2}), candidates(index, "/foo"));
+  EXPECT_EQ(std::vector<uint32_t>({0, 2}), candidates(index, "/foo?a=b"));
+  EXPECT_EQ(std::vector<uint32_t>(), candidates(index, "/FOO"));
+  EXPECT_EQ(std::vector<uint32_t>(), candidates(index, "/foo/"));
+  EXPECT_EQ(std::vector<uint32_t>({1}), candidates(index, "/bAR?"));
+}
+
+TEST(PathMatchIndexTest, UnindexedAreMergedInOrder) {
+  PathMatchIndex index;
+  index.addUnindexed(3);
+  index.addPrefix("/foo", true, 0);
+  index.addPath("/foo", true, 4);
+  index.addUnindexed(1);
+  index.addPrefix("/", false, 2);
+
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 3, 4}), candidates(index, "/foo"));
+  EXPECT_EQ(std::vector<uint32_t>({1, 2, 3}), candidates(index, "/bar"));
+  EXPECT_EQ(std::vector<uint32_t>({1, 3}), candidates(index, "bar"));
+}
+
+// Splitting an edge must keep the routes attached to both halves reachable.
+TEST(PathMatchIndexTest, EdgeSplits) {
+  PathMatchIndex index;
+  index.addPrefix("/abcdef", true, 0);
+  index.addPrefix("/abcxyz", true, 1);
+  index.addPrefix("/abc", true, 2);
+  index.addPrefix("/ab", true, 3);
+  index.addPrefix("/abcdefgh", true, 4);
+
+  EXPECT_EQ(std::vector<uint32_t>({0, 2, 3, 4}), candidates(index, "/abcdefghi"));
+  EXPECT_EQ(std::vector<uint32_t>({1, 2, 3}), candidates(index, "/abcxyz"));
+  EXPECT_EQ(std::vector<uint32_t>({2, 3}), candidates(index, "/abcdeg"));
+  EXPECT_EQ(std::vector<uint32_t>({3}), candidates(index, "/abd"));
+  EXPECT_EQ(std::vector<uint32_t>(), candidates(index, "/a"));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
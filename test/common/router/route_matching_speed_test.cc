@@ -0,0 +1,81 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Usage: bazel run -c opt //test/common/router:route_matching_speed_test
+//
+// Measures ConfigImpl::route() against a single virtual host with many routes, matching the last
+// route so that every route ahead of it has to be ruled out.
+
+#include <string>
+
+#include "common/common/fmt.h"
+#include "common/router/config_impl.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+/**
+ * Builds a route configuration with num_routes routes, one in every regex_interval of which is a
+ * regex route, and the rest alternating between prefix and exact path routes. The routes are
+ * followed by a catch all prefix route.
+ */
+envoy::api::v2::RouteConfiguration makeRouteConfig(uint32_t num_routes, uint32_t regex_interval) {
+  envoy::api::v2::RouteConfiguration route_config;
+  auto* virtual_host = route_config.add_virtual_hosts();
+  virtual_host->set_name("service");
+  virtual_host->add_domains("*");
+  for (uint32_t i = 0; i < num_routes; i++) {
+    auto* route = virtual_host->add_routes();
+    if (regex_interval > 0 && i % regex_interval == 0) {
+      route->mutable_match()->set_regex(fmt::format("/service_{}/v[0-9]+/.*", i));
+    } else if (i % 2 == 0) {
+      route->mutable_match()->set_prefix(fmt::format("/service_{}/", i));
+    } else {
+      route->mutable_match()->set_path(fmt::format("/service_{}/method", i));
+    }
+    route->mutable_route()->set_cluster(fmt::format("cluster_{}", i));
+  }
+  auto* catch_all = virtual_host->add_routes();
+  catch_all->mutable_match()->set_prefix("/");
+  catch_all->mutable_route()->set_cluster("default");
+  return route_config;
+}
+
+void runRouteBenchmark(benchmark::State& state, uint32_t regex_interval) {
+  const uint32_t num_routes = state.range(0);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(makeRouteConfig(num_routes, regex_interval), factory_context, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority", "www.lyft.com"}, {":path", "/unknown/path?query=1"}, {":method", "GET"}};
+
+  for (auto _ : state) {
+    RouteConstSharedPtr route = config.route(headers, 0);
+    benchmark::DoNotOptimize(route);
+  }
+}
+
+void BM_RoutePrefixAndPath(benchmark::State& state) { runRouteBenchmark(state, 0); }
+BENCHMARK(BM_RoutePrefixAndPath)->Arg(10)->Arg(100)->Arg(1000)->Arg(5000);
+
+// One route in ten uses a regex, and all of those still have to be evaluated.
+void BM_RouteWithRegexes(benchmark::State& state) { runRouteBenchmark(state, 10); }
+BENCHMARK(BM_RouteWithRegexes)->Arg(10)->Arg(100)->Arg(1000)->Arg(5000);
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
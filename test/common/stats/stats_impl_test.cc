@@ -109,6 +109,33 @@ TEST(TagExtractorTest, TwoSubexpressions) {
   EXPECT_EQ("cluster_name", tags.at(0).name_);
 }
 
+// ^prefix\.((.*?)\.) is extracted without the regex, and must agree with an equivalent regex.
+TEST(TagExtractorTest, SecondToken) {
+  TagExtractorImpl tag_extractor("cluster_name", "^cluster\\.((.*?)\\.)");
+  TagExtractorImpl regex_extractor("cluster_name", "^cluster\\.(([^.]*)\\.)");
+  for (const std::string name :
+       {"cluster.test_cluster.upstream_cx_total", "cluster..upstream_cx_total", "cluster.a.b.c",
+        "cluster.test_cluster.", "cluster.test_cluster", "cluster.", "cluster", "clusterx.a.b",
+        "cluster_a.b.c", "http.cluster.a.b", ""}) {
+    std::vector<Tag> tags;
+    IntervalSetImpl<size_t> remove_characters;
+    const bool found = tag_extractor.extractTag(name, tags, remove_characters);
+
+    std::vector<Tag> expected_tags;
+    IntervalSetImpl<size_t> expected_remove_characters;
+    EXPECT_EQ(regex_extractor.extractTag(name, expected_tags, expected_remove_characters), found)
+        << name;
+    EXPECT_EQ(StringUtil::removeCharacters(name, expected_remove_characters),
+              StringUtil::removeCharacters(name, remove_characters))
+        << name;
+    ASSERT_EQ(expected_tags.size(), tags.size()) << name;
+    if (found) {
+      EXPECT_EQ(expected_tags[0].name_, tags[0].name_);
+      EXPECT_EQ(expected_tags[0].value_, tags[0].value_);
+    }
+  }
+}
+
 TEST(TagExtractorTest, SingleSubexpression) {
   TagExtractorImpl tag_extractor("listner_port", "^listener\\.(\\d+?\\.)");
   std::string name = "listener.80.downstream_cx_total";
@@ -477,6 +504,37 @@ TEST(TagProducerTest, CheckConstructor) {
       "No regex specified for tag specifier and no default regex for name: 'test_extractor'");
 }
 
+TEST(MetricImplTest, EncodedNameAndTags) {
+  IsolatedStoreImpl store;
+  HistogramImpl histogram("cluster.foo.bar.upstream_rq_time", store, "cluster.upstream_rq_time",
+                          std::vector<Tag>{{"envoy.cluster_name", "foo.bar"}, {"empty", ""}});
+  EXPECT_EQ("cluster.foo.bar.upstream_rq_time", histogram.name());
+  EXPECT_EQ("cluster.upstream_rq_time", histogram.tagExtractedName());
+  const std::vector<Tag> tags = histogram.tags();
+  ASSERT_EQ(2, tags.size());
+  EXPECT_EQ("envoy.cluster_name", tags[0].name_);
+  EXPECT_EQ("foo.bar", tags[0].value_);
+  EXPECT_EQ("empty", tags[1].name_);
+  EXPECT_EQ("", tags[1].value_);
+
+  // Metrics with the same name have the same encoded name.
+  HistogramImpl other("cluster.foo.bar.upstream_rq_time", store, "", std::vector<Tag>());
+  EXPECT_EQ(histogram.statName(), other.statName());
+  EXPECT_EQ("", other.tagExtractedName());
+  EXPECT_EQ(0, other.tags().size());
+}
+
+// Validate that stats keep the full name they were created with, even though the RawStatData
+// backing them holds a truncated copy.
+TEST(RawStatDataTest, TruncatedStatKeepsFullName) {
+  HeapRawStatDataAllocator alloc;
+  const std::string long_string(RawStatData::maxNameLength() + 1, 'A');
+  CounterSharedPtr counter;
+  EXPECT_LOG_CONTAINS("warning", "is too long with",
+                      counter = alloc.makeCounter(long_string, "", std::vector<Tag>()));
+  EXPECT_EQ(long_string, counter->name());
+}
+
 // Validate truncation behavior of RawStatData.
 TEST(RawStatDataTest, Truncate) {
   HeapRawStatDataAllocator alloc;
@@ -0,0 +1,266 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/common/fmt.h"
+
+#include "common/stats/symbol_table_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+
+class SymbolTableImplTest : public testing::Test {
+protected:
+  ~SymbolTableImplTest() {
+    for (const SymbolVec& symbols : encoded_) {
+      table_.free(symbols);
+    }
+    EXPECT_EQ(0, table_.numSymbols());
+  }
+
+  SymbolVec encode(const std::string& name) {
+    encoded_.push_back(table_.encode(name));
+    return encoded_.back();
+  }
+
+  std::string roundTrip(const std::string& name) {
+    const StatNameStorage storage(encode(name));
+    return table_.toString(storage.statName());
+  }
+
+  SymbolTableImpl table_;
+  std::vector<SymbolVec> encoded_;
+};
+
+TEST_F(SymbolTableImplTest, RoundTrip) {
+  EXPECT_EQ("", roundTrip(""));
+  EXPECT_EQ("a", roundTrip("a"));
+  EXPECT_EQ("cluster.foo.upstream_rq_200", roundTrip("cluster.foo.upstream_rq_200"));
+  EXPECT_EQ(".", roundTrip("."));
+  EXPECT_EQ("..", roundTrip(".."));
+  EXPECT_EQ("a..b", roundTrip("a..b"));
+  EXPECT_EQ(".a.", roundTrip(".a."));
+  EXPECT_EQ("listener.0.0.0.0_80.downstream_cx_total",
+            roundTrip("listener.0.0.0.0_80.downstream_cx_total"));
+}
+
+TEST_F(SymbolTableImplTest, TokensAreShared) {
+  const SymbolVec foo = encode("cluster.foo.upstream_rq_total");
+  const SymbolVec bar = encode("cluster.bar.upstream_rq_total");
+  EXPECT_EQ(4, table_.numSymbols());
+  EXPECT_EQ(foo[0], bar[0]);
+  EXPECT_NE(foo[1], bar[1]);
+  EXPECT_EQ(foo[2], bar[2]);
+
+  // Encoding the same name again only adds references.
+  EXPECT_EQ(foo, encode("cluster.foo.upstream_rq_total"));
+  EXPECT_EQ(4, table_.numSymbols());
+}
+
+TEST_F(SymbolTableImplTest, FreeReleasesUnusedTokens) {
+  const SymbolVec foo = table_.encode("cluster.foo.upstream_rq_total");
+  encode("cluster.bar.upstream_rq_total");
+  EXPECT_EQ(4, table_.numSymbols());
+
+  table_.free(foo);
+  EXPECT_EQ(3, table_.numSymbols());
+  SymbolVec symbols;
+  EXPECT_FALSE(table_.encodeExisting("cluster.foo.upstream_rq_total", symbols));
+}
+
+TEST_F(SymbolTableImplTest, SymbolsAreReused) {
+  const SymbolVec first = table_.encode("foo.bar");
+  const uint64_t foo_serial = table_.serial(first[0]);
+  EXPECT_NE(0, foo_serial);
+  table_.free(first);
+  EXPECT_EQ(0, table_.numSymbols());
+  EXPECT_EQ(0, table_.serial(first[0]));
+
+  // The lowest released symbol is handed out first, under a new serial.
+  const SymbolVec second = encode("baz");
+  EXPECT_EQ(first[0], second[0]);
+  EXPECT_NE(0, table_.serial(second[0]));
+  EXPECT_NE(foo_serial, table_.serial(second[0]));
+  EXPECT_EQ("baz", table_.decode(second));
+
+  const SymbolVec third = encode("foo.qux.bar");
+  EXPECT_EQ(SymbolVec({first[1], 2, 3}), third);
+  EXPECT_EQ("foo.qux.bar", table_.decode(third));
+}
+
+TEST_F(SymbolTableImplTest, SymbolsAreBoundedByLiveTokens) {
+  for (uint32_t i = 0; i < 10000; ++i) {
+    table_.free(table_.encode(fmt::format("a{}.b{}", i, i)));
+  }
+  EXPECT_EQ(SymbolVec({0, 1}), encode("c.d"));
+}
+
+TEST_F(SymbolTableImplTest, AppendTo) {
+  const StatNameStorage foo(encode("cluster.foo.upstream_rq_total"));
+  const StatNameStorage empty(encode(""));
+  std::string out = "prefix:";
+  table_.appendTo(foo.statName(), out);
+  table_.appendTo(empty.statName(), out);
+  EXPECT_EQ("prefix:cluster.foo.upstream_rq_total", out);
+}
+
+TEST_F(SymbolTableImplTest, ManySymbols) {
+  // Enough tokens to span several blocks of the decode table, some of which are released and
+  // their symbols reused.
+  std::vector<SymbolVec> released;
+  for (uint32_t i = 0; i < 150000; ++i) {
+    const std::string name = fmt::format("token{}", i);
+    if (i % 3 == 0) {
+      released.push_back(table_.encode(name));
+    } else {
+      encode(name);
+    }
+    if (released.size() == 1000) {
+      for (const SymbolVec& symbols : released) {
+        table_.free(symbols);
+      }
+      released.clear();
+    }
+  }
+  for (const SymbolVec& symbols : released) {
+    table_.free(symbols);
+  }
+
+  EXPECT_EQ(100000, table_.numSymbols());
+  for (uint32_t i = 0; i < 100000; i += 997) {
+    const uint32_t token = i / 2 * 3 + i % 2 + 1;
+    EXPECT_EQ(fmt::format("token{}", token), table_.decode(encoded_[i]));
+  }
+}
+
+TEST_F(SymbolTableImplTest, DecodeWhileEncoding) {
+  const SymbolVec symbols = encode("cluster.foo.upstream_rq_total");
+
+  // Decoding takes no lock, and must see consistent tokens while other threads add and release
+  // symbols.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([this, t, &symbols]() {
+      for (int i = 0; i < 20000; ++i) {
+        const SymbolVec other = table_.encode(fmt::format("cluster.{}_{}.upstream_rq_total", t, i));
+        EXPECT_EQ("cluster.foo.upstream_rq_total", table_.decode(symbols));
+        table_.free(other);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(3, table_.numSymbols());
+}
+
+TEST_F(SymbolTableImplTest, EncodeExisting) {
+  const SymbolVec encoded = encode("a.b.c");
+  SymbolVec symbols;
+  EXPECT_TRUE(table_.encodeExisting("a.b.c", symbols));
+  EXPECT_EQ(encoded, symbols);
+  EXPECT_TRUE(table_.encodeExisting("c.b", symbols));
+  EXPECT_EQ(SymbolVec({encoded[2], encoded[1]}), symbols);
+  EXPECT_FALSE(table_.encodeExisting("a.b.d", symbols));
+  EXPECT_TRUE(table_.encodeExisting("", symbols));
+  EXPECT_TRUE(symbols.empty());
+
+  // No references were taken.
+  EXPECT_EQ(3, table_.numSymbols());
+}
+
+TEST_F(SymbolTableImplTest, StatNameEquality) {
+  const StatNameStorage foo1(encode("cluster.foo.upstream_rq_total"));
+  const StatNameStorage foo2(encode("cluster.foo.upstream_rq_total"));
+  const StatNameStorage bar(encode("cluster.bar.upstream_rq_total"));
+  const StatNameStorage prefix(encode("cluster.foo"));
+
+  EXPECT_EQ(foo1.statName(), foo2.statName());
+  EXPECT_EQ(StatNameHash()(foo1.statName()), StatNameHash()(foo2.statName()));
+  EXPECT_NE(foo1.statName(), bar.statName());
+  EXPECT_NE(foo1.statName(), prefix.statName());
+
+  StatNameHashMap<int> map;
+  map[foo1.statName()] = 1;
+  map[bar.statName()] = 2;
+  EXPECT_EQ(1, map[foo2.statName()]);
+  EXPECT_EQ(2, map.size());
+}
+
+TEST_F(SymbolTableImplTest, StatNameSize) {
+  // Symbols below 128 take a single byte, after the 2 byte length.
+  const StatNameStorage storage(encode("a.b.c"));
+  EXPECT_EQ(3, storage.statName().dataSize());
+  EXPECT_EQ(5, storage.statName().size());
+}
+
+TEST(SymbolTableImplStaticTest, Varint) {
+  const std::vector<uint64_t> values{0, 1, 127, 128, 300, 16383, 16384, UINT32_MAX, UINT64_MAX};
+  for (uint64_t value : values) {
+    uint8_t buffer[10];
+    uint8_t* end = SymbolTableImpl::writeVarint(value, buffer);
+    EXPECT_EQ(SymbolTableImpl::varintSize(value), end - buffer);
+    const uint8_t* src = buffer;
+    EXPECT_EQ(value, SymbolTableImpl::readVarint(src));
+    EXPECT_EQ(end, src);
+  }
+}
+
+TEST(SymbolTableImplStaticTest, LargeSymbols) {
+  const SymbolVec symbols{0, 127, 128, 70000, UINT32_MAX};
+  const StatNameStorage storage(symbols);
+  EXPECT_EQ(symbols, SymbolTableImpl::symbolsOf(storage.statName()));
+  EXPECT_EQ(SymbolTableImpl::statNameSize(symbols), storage.statName().size());
+}
+
+TEST_F(SymbolTableImplTest, SymbolCache) {
+  SymbolCache cache(table_);
+  StatName stat_name;
+  EXPECT_FALSE(cache.encode("cluster.foo.upstream_rq_total", stat_name));
+
+  const StatNameStorage foo(encode("cluster.foo.upstream_rq_total"));
+  cache.remember("cluster.foo.upstream_rq_total", foo.statName());
+  EXPECT_EQ(3, cache.size());
+  ASSERT_TRUE(cache.encode("cluster.foo.upstream_rq_total", stat_name));
+  EXPECT_EQ(foo.statName(), stat_name);
+
+  // Names made only of remembered tokens can be encoded too.
+  const StatNameStorage reordered(encode("foo.cluster"));
+  ASSERT_TRUE(cache.encode("foo.cluster", stat_name));
+  EXPECT_EQ(reordered.statName(), stat_name);
+  EXPECT_FALSE(cache.encode("cluster.bar.upstream_rq_total", stat_name));
+
+  ASSERT_TRUE(cache.encode("", stat_name));
+  EXPECT_EQ(0, stat_name.dataSize());
+
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_FALSE(cache.encode("cluster.foo.upstream_rq_total", stat_name));
+}
+
+TEST_F(SymbolTableImplTest, SymbolCacheStaleMapping) {
+  SymbolCache cache(table_);
+  const SymbolVec old_symbols = table_.encode("foo.bar");
+  cache.remember("foo.bar", StatNameStorage(old_symbols).statName());
+  table_.free(old_symbols);
+
+  // The released symbols are reused for other tokens. The stale mappings must not encode "foo.bar"
+  // as the name that now uses them.
+  const StatNameStorage reused(encode("baz.qux"));
+  EXPECT_EQ(old_symbols, SymbolTableImpl::symbolsOf(reused.statName()));
+  StatName stat_name;
+  EXPECT_FALSE(cache.encode("foo.bar", stat_name));
+
+  // Nor once "foo" and "bar" are interned again under other symbols.
+  const StatNameStorage current(encode("foo.bar"));
+  EXPECT_FALSE(cache.encode("foo.bar", stat_name));
+
+  cache.remember("foo.bar", current.statName());
+  ASSERT_TRUE(cache.encode("foo.bar", stat_name));
+  EXPECT_EQ(current.statName(), stat_name);
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,74 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Usage: bazel run -c opt //test/common/stats:tag_producer_speed_test
+//
+// Measures TagProducerImpl::produceTags() with the default tag extractors on the stats that are
+// created for each cluster added by CDS.
+
+#include <string>
+#include <vector>
+
+#include "envoy/config/metrics/v2/stats.pb.h"
+
+#include "common/stats/stats_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+const std::vector<std::string>& clusterStatSuffixes() {
+  static const std::vector<std::string>* suffixes = new std::vector<std::string>{
+      "upstream_cx_total",
+      "upstream_cx_active",
+      "upstream_cx_connect_fail",
+      "upstream_rq_total",
+      "upstream_rq_timeout",
+      "upstream_rq_200",
+      "upstream_rq_2xx",
+      "upstream_rq_503",
+      "upstream_rq_5xx",
+      "lb_healthy_panic",
+      "membership_healthy",
+      "ssl.handshake",
+      "ssl.ciphers.ECDHE-RSA-AES128-GCM-SHA256",
+      "grpc.lyft.users.BadCompanions.GetBadCompanions.success",
+      "internal.upstream_rq_200",
+      "canary.upstream_rq_5xx",
+  };
+  return *suffixes;
+}
+
+void BM_ProduceClusterTags(benchmark::State& state) {
+  const TagProducerImpl tag_producer{envoy::config::metrics::v2::StatsConfig()};
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < 100; i++) {
+    for (const std::string& suffix : clusterStatSuffixes()) {
+      names.push_back("cluster.service_" + std::to_string(i) + "." + suffix);
+    }
+  }
+
+  std::vector<Tag> tags;
+  for (auto _ : state) {
+    for (const std::string& name : names) {
+      tags.clear();
+      benchmark::DoNotOptimize(tag_producer.produceTags(name, tags));
+    }
+  }
+}
+BENCHMARK(BM_ProduceClusterTags);
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -314,6 +314,37 @@ TEST_F(StatsThreadLocalStoreTest, ScopeDelete) {
   EXPECT_CALL(*this, free(_));
 }
 
+// Validate that stats are found through the thread local caches after a scope is deleted and
+// recreated, which releases and re-interns the tokens of its stat names.
+TEST_F(StatsThreadLocalStoreTest, ScopeDeleteAndRecreate) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  ScopePtr scope1 = store_->createScope("scope1.");
+  EXPECT_CALL(*this, alloc(_));
+  Counter& c1 = scope1->counter("c1");
+  EXPECT_EQ(&c1, &scope1->counter("c1"));
+
+  EXPECT_CALL(main_thread_dispatcher_, post(_));
+  EXPECT_CALL(tls_, runOnAllThreads(_));
+  EXPECT_CALL(*this, free(_));
+  scope1.reset();
+
+  ScopePtr scope2 = store_->createScope("scope1.");
+  EXPECT_CALL(*this, alloc(_));
+  Counter& c2 = scope2->counter("c1");
+  EXPECT_EQ("scope1.c1", c2.name());
+  EXPECT_EQ(&c2, &scope2->counter("c1"));
+  c2.inc();
+  EXPECT_EQ(1UL, scope2->counter("c1").value());
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+
+  // Includes overflow stat.
+  EXPECT_CALL(*this, free(_)).Times(2);
+}
+
 TEST_F(StatsThreadLocalStoreTest, NestedScopes) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -1,8 +1,17 @@
 // Usage: bazel run //test/common/upstream:load_balancer_benchmark
+//
+// Use --benchmark_filter to select a subset, e.g. --benchmark_filter=BM_ChooseHost/Maglev. The
+// memory_bytes counters are only populated when built with tcmalloc.
 
+#include "envoy/router/router.h"
+
+#include "common/config/metadata.h"
+#include "common/memory/stats.h"
 #include "common/runtime/runtime_impl.h"
+#include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/maglev_lb.h"
 #include "common/upstream/ring_hash_lb.h"
+#include "common/upstream/subset_lb.h"
 #include "common/upstream/upstream_impl.h"
 
 #include "test/common/upstream/utility.h"
@@ -10,29 +19,58 @@
 
 #include "testing/base/public/benchmark.h"
 
+using testing::Return;
+
 namespace Envoy {
 namespace Upstream {
 namespace {
 
+// Number of distinct values of the "version" metadata key that hosts are spread over. Subset
+// benchmarks select one of them.
+const uint64_t NumVersions = 4;
+
 class BaseTester {
 public:
   BaseTester(uint64_t num_hosts) : BaseTester(num_hosts, 0, 0) {}
 
-  // We weight the first weighted_subset_percent of hosts with weight.
-  BaseTester(uint64_t num_hosts, uint32_t weighted_subset_percent, uint32_t weight) {
-    HostSet& host_set = priority_set_.getOrCreateHostSet(0);
-
-    HostVector hosts;
-    ASSERT(num_hosts < 65536);
+  // We weight the first weighted_subset_percent of hosts with weight. Hosts are spread evenly over
+  // num_priorities priority levels.
+  BaseTester(uint64_t num_hosts, uint32_t weighted_subset_percent, uint32_t weight,
+             uint32_t num_priorities = 1, bool with_metadata = false)
+      : with_metadata_(with_metadata) {
+    ASSERT(num_priorities > 0);
+    std::vector<HostVector> hosts(num_priorities);
     for (uint64_t i = 0; i < num_hosts; i++) {
       const bool should_weight = i < num_hosts * (weighted_subset_percent / 100.0);
-      hosts.push_back(makeTestHost(info_, fmt::format("tcp://10.0.{}.{}:6379", i / 256, i % 256),
-                                   should_weight ? weight : 1));
+      hosts[i % num_priorities].push_back(makeHost(i, should_weight ? weight : 1));
+    }
+    next_host_ = num_hosts;
+
+    for (uint32_t priority = 0; priority < num_priorities; ++priority) {
+      HostVectorConstSharedPtr updated_hosts{new HostVector(hosts[priority])};
+      priority_set_.getOrCreateHostSet(priority).updateHosts(
+          updated_hosts, updated_hosts, HostsPerLocalityImpl::empty(),
+          HostsPerLocalityImpl::empty(), {}, hosts[priority], {});
     }
-    HostVectorConstSharedPtr updated_hosts{new HostVector(hosts)};
-    host_set.updateHosts(updated_hosts, updated_hosts, nullptr, nullptr, {}, hosts, {});
   }
 
+  // Addresses are unique for up to 2^24 hosts.
+  HostSharedPtr makeHost(uint64_t i, uint32_t weight) {
+    ASSERT(i < (1 << 24));
+    const std::string url =
+        fmt::format("tcp://10.{}.{}.{}:6379", i / 65536, (i / 256) % 256, i % 256);
+    if (!with_metadata_) {
+      return makeTestHost(info_, url, weight);
+    }
+    envoy::api::v2::core::Metadata metadata;
+    Config::Metadata::mutableMetadataValue(metadata, Config::MetadataFilters::get().ENVOY_LB,
+                                           "version")
+        .set_string_value(fmt::format("v{}", i % NumVersions));
+    return makeTestHost(info_, url, metadata, weight);
+  }
+
+  const bool with_metadata_;
+  uint64_t next_host_{};
   PrioritySetImpl priority_set_;
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
 };
@@ -101,11 +139,14 @@ class TestLoadBalancerContext : public LoadBalancerContext {
 public:
   // Upstream::LoadBalancerContext
   absl::optional<uint64_t> computeHashKey() override { return hash_key_; }
-  const Router::MetadataMatchCriteria* metadataMatchCriteria() override { return nullptr; }
+  const Router::MetadataMatchCriteria* metadataMatchCriteria() override {
+    return metadata_match_criteria_;
+  }
   const Network::Connection* downstreamConnection() const override { return nullptr; }
   const Http::HeaderMap* downstreamHeaders() const override { return nullptr; }
 
   absl::optional<uint64_t> hash_key_;
+  const Router::MetadataMatchCriteria* metadata_match_criteria_{};
 };
 
 void computeHitStats(benchmark::State& state,
@@ -342,6 +383,256 @@ BENCHMARK(BM_MaglevLoadBalancerWeighted)
     ->Args({500, 95, 75, 25, 10000})
     ->Unit(benchmark::kMillisecond);
 
+class TestMetadataMatchCriterion : public Router::MetadataMatchCriterion {
+public:
+  TestMetadataMatchCriterion(const std::string& name, const HashedValue& value)
+      : name_(name), value_(value) {}
+
+  // Router::MetadataMatchCriterion
+  const std::string& name() const override { return name_; }
+  const HashedValue& value() const override { return value_; }
+
+private:
+  const std::string name_;
+  const HashedValue value_;
+};
+
+// Selects the hosts whose "version" is "v0".
+class TestMetadataMatchCriteria : public Router::MetadataMatchCriteria {
+public:
+  TestMetadataMatchCriteria() {
+    ProtobufWkt::Value value;
+    value.set_string_value("v0");
+    matches_.emplace_back(
+        std::make_shared<const TestMetadataMatchCriterion>("version", HashedValue(value)));
+  }
+
+  // Router::MetadataMatchCriteria
+  const std::vector<Router::MetadataMatchCriterionConstSharedPtr>&
+  metadataMatchCriteria() const override {
+    return matches_;
+  }
+  Router::MetadataMatchCriteriaConstPtr
+  mergeMatchCriteria(const ProtobufWkt::Struct&) const override {
+    return nullptr;
+  }
+
+private:
+  std::vector<Router::MetadataMatchCriterionConstSharedPtr> matches_;
+};
+
+// Load balancer policies covered by the generic benchmarks below. Subset uses round robin within
+// each subset.
+enum class Policy { RoundRobin, LeastRequest, Random, RingHash, Maglev, Subset };
+
+// Builds any of the load balancers over a BaseTester host set, and drives host churn the way
+// ClusterManagerImpl does: update the priority set, then re-create the worker LB of thread aware
+// load balancers.
+class LoadBalancerTester : public BaseTester {
+public:
+  // Benchmark args: {num_hosts, weighted, num_priorities}. When weighted, half of the hosts get
+  // weight 4.
+  LoadBalancerTester(Policy policy, const benchmark::State& state)
+      : BaseTester(state.range(0), state.range(1) ? 50 : 0, 4, state.range(2),
+                   policy == Policy::Subset),
+        policy_(policy) {
+    // The EDF schedule is only used when hosts are weighted, see EdfLoadBalancerBase.
+    stats_.max_host_weight_.set(state.range(1) ? 4 : 1);
+    ring_hash_config_ = envoy::api::v2::Cluster::RingHashLbConfig();
+    ring_hash_config_.value().mutable_deprecated_v1()->mutable_use_std_hash()->set_value(false);
+    subset_info_.subset_keys_ = {std::set<std::string>({"version"})};
+    ON_CALL(subset_info_, isEnabled()).WillByDefault(Return(true));
+    context_.metadata_match_criteria_ = &metadata_match_criteria_;
+  }
+
+  void initialize() {
+    switch (policy_) {
+    case Policy::RoundRobin:
+      lb_ = std::make_unique<RoundRobinLoadBalancer>(priority_set_, nullptr, stats_, runtime_,
+                                                     random_, common_config_);
+      break;
+    case Policy::LeastRequest:
+      lb_ = std::make_unique<LeastRequestLoadBalancer>(priority_set_, nullptr, stats_, runtime_,
+                                                       random_, common_config_);
+      break;
+    case Policy::Random:
+      lb_ = std::make_unique<RandomLoadBalancer>(priority_set_, nullptr, stats_, runtime_, random_,
+                                                 common_config_);
+      break;
+    case Policy::RingHash:
+      thread_aware_lb_ = std::make_unique<RingHashLoadBalancer>(
+          priority_set_, stats_, runtime_, random_, ring_hash_config_, common_config_);
+      break;
+    case Policy::Maglev:
+      thread_aware_lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, runtime_,
+                                                              random_, common_config_);
+      break;
+    case Policy::Subset:
+      lb_ = std::make_unique<SubsetLoadBalancer>(LoadBalancerType::RoundRobin, priority_set_,
+                                                 nullptr, stats_, runtime_, random_, subset_info_,
+                                                 ring_hash_config_, common_config_);
+      break;
+    }
+    if (thread_aware_lb_ != nullptr) {
+      thread_aware_lb_->initialize();
+      lb_ = thread_aware_lb_->factory()->create();
+    }
+  }
+
+  HostConstSharedPtr chooseHost(uint64_t hash) {
+    context_.hash_key_ = hash;
+    return lb_->chooseHost(&context_);
+  }
+
+  // Replaces one host in priority 0 with a new one, keeping the host count stable. The new host
+  // lists are prepared up front so that only the update itself is timed.
+  void churn(benchmark::State& state) {
+    state.PauseTiming();
+    HostSet& host_set = priority_set_.getOrCreateHostSet(0);
+    HostVectorSharedPtr hosts(new HostVector(host_set.hosts()));
+    HostVector hosts_removed;
+    if (!hosts->empty()) {
+      const uint64_t index = next_host_ % hosts->size();
+      hosts_removed.push_back((*hosts)[index]);
+      hosts->erase(hosts->begin() + index);
+    }
+    HostVector hosts_added{makeHost(next_host_++, 1)};
+    hosts->push_back(hosts_added[0]);
+    state.ResumeTiming();
+
+    host_set.updateHosts(hosts, hosts, HostsPerLocalityImpl::empty(),
+                         HostsPerLocalityImpl::empty(), {}, hosts_added, hosts_removed);
+    if (thread_aware_lb_ != nullptr) {
+      lb_ = thread_aware_lb_->factory()->create();
+    }
+  }
+
+  // Reports how evenly picks are spread over the hosts that can be selected, after adjusting for
+  // host weight. A relative_stddev_hits of 0 is a perfect distribution.
+  void reportDistribution(benchmark::State& state) {
+    std::unordered_map<const Host*, uint64_t> hits;
+    const HostVector& candidates = priority_set_.hostSetsPerPriority()[0]->healthyHosts();
+    uint64_t total_weight = 0;
+    for (const auto& host : candidates) {
+      if (selectable(*host)) {
+        hits[host.get()] = 0;
+        total_weight += host->weight();
+      }
+    }
+    if (hits.empty()) {
+      return;
+    }
+
+    const uint64_t picks = std::min<uint64_t>(100 * hits.size(), 1000000);
+    for (uint64_t i = 0; i < picks; i++) {
+      hits[chooseHost(hashInt(i)).get()]++;
+    }
+
+    const double mean = 1.0 / total_weight;
+    double variance = 0;
+    for (const auto& host : candidates) {
+      if (selectable(*host)) {
+        const double share = static_cast<double>(hits[host.get()]) / picks / host->weight();
+        variance += std::pow(share - mean, 2);
+      }
+    }
+    variance /= hits.size();
+    state.counters["relative_stddev_hits"] = std::sqrt(variance) / mean;
+  }
+
+  bool selectable(const Host& host) const {
+    if (policy_ != Policy::Subset) {
+      return true;
+    }
+    return Config::Metadata::metadataValue(host.metadata(), Config::MetadataFilters::get().ENVOY_LB,
+                                           "version")
+               .string_value() == "v0";
+  }
+
+  const Policy policy_;
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterStats stats_{ClusterInfoImpl::generateStats(stats_store_)};
+  NiceMock<Runtime::MockLoader> runtime_;
+  Runtime::RandomGeneratorImpl random_;
+  absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> ring_hash_config_;
+  envoy::api::v2::Cluster::CommonLbConfig common_config_;
+  NiceMock<MockLoadBalancerSubsetInfo> subset_info_;
+  TestMetadataMatchCriteria metadata_match_criteria_;
+  TestLoadBalancerContext context_;
+  ThreadAwareLoadBalancerPtr thread_aware_lb_;
+  LoadBalancerPtr lb_;
+};
+
+// Args: {num_hosts, weighted, num_priorities}.
+void loadBalancerArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t num_hosts : {10, 100, 1000, 10000, 100000}) {
+    for (int64_t weighted : {0, 1}) {
+      b->Args({num_hosts, weighted, 1});
+    }
+  }
+  // Several priority levels, all healthy, so that all traffic still lands on priority 0.
+  for (int64_t num_hosts : {1000, 100000}) {
+    b->Args({num_hosts, 0, 3});
+  }
+  b->Unit(benchmark::kMicrosecond);
+}
+
+// Time to build a load balancer from scratch, and the memory it retains.
+void BM_Build(benchmark::State& state, Policy policy) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    LoadBalancerTester tester(policy, state);
+    const uint64_t allocated_before = Memory::Stats::totalCurrentlyAllocated();
+    state.ResumeTiming();
+
+    tester.initialize();
+
+    state.PauseTiming();
+    state.counters["memory_bytes"] = Memory::Stats::totalCurrentlyAllocated() - allocated_before;
+    state.ResumeTiming();
+  }
+}
+BENCHMARK_CAPTURE(BM_Build, RoundRobin, Policy::RoundRobin)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_Build, LeastRequest, Policy::LeastRequest)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_Build, Random, Policy::Random)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_Build, RingHash, Policy::RingHash)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_Build, Maglev, Policy::Maglev)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_Build, Subset, Policy::Subset)->Apply(loadBalancerArgs);
+
+// Throughput of chooseHost(), plus the quality of the resulting load distribution.
+void BM_ChooseHost(benchmark::State& state, Policy policy) {
+  LoadBalancerTester tester(policy, state);
+  tester.initialize();
+  uint64_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tester.chooseHost(hashInt(i++)));
+  }
+  tester.reportDistribution(state);
+}
+BENCHMARK_CAPTURE(BM_ChooseHost, RoundRobin, Policy::RoundRobin)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_ChooseHost, LeastRequest, Policy::LeastRequest)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_ChooseHost, Random, Policy::Random)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_ChooseHost, RingHash, Policy::RingHash)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_ChooseHost, Maglev, Policy::Maglev)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_ChooseHost, Subset, Policy::Subset)->Apply(loadBalancerArgs);
+
+// Cost of a membership update that replaces one host, i.e. continuous EDS churn. Each iteration
+// includes the load balancer's reaction to the update, but not building the new host lists.
+void BM_HostChurn(benchmark::State& state, Policy policy) {
+  LoadBalancerTester tester(policy, state);
+  tester.initialize();
+  for (auto _ : state) {
+    tester.churn(state);
+  }
+  tester.reportDistribution(state);
+}
+BENCHMARK_CAPTURE(BM_HostChurn, RoundRobin, Policy::RoundRobin)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_HostChurn, LeastRequest, Policy::LeastRequest)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_HostChurn, Random, Policy::Random)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_HostChurn, RingHash, Policy::RingHash)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_HostChurn, Maglev, Policy::Maglev)->Apply(loadBalancerArgs);
+BENCHMARK_CAPTURE(BM_HostChurn, Subset, Policy::Subset)->Apply(loadBalancerArgs);
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
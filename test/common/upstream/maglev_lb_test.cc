@@ -3,6 +3,8 @@
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
 
+using testing::Return;
+
 namespace Envoy {
 namespace Upstream {
 
@@ -108,6 +110,41 @@ TEST_F(MaglevLoadBalancerTest, Weighted) {
   }
 }
 
+// A table is kept while the host set hands out the same snapshot, and rebuilt once the snapshot
+// changes. Host weights are only read when the table is built, which makes the rebuild visible.
+TEST_F(MaglevLoadBalancerTest, UnchangedSnapshotKeepsTable) {
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
+                      makeTestHost(info_, "tcp://127.0.0.1:91", 2)};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  HostVectorConstSharedPtr snapshot = std::make_shared<const HostVector>(host_set_.hosts_);
+  ON_CALL(host_set_, hostsPtr()).WillByDefault(Return(snapshot));
+  ON_CALL(host_set_, healthyHostsPtr()).WillByDefault(Return(snapshot));
+  init(17);
+
+  const auto first_host_slots = [this]() -> uint32_t {
+    LoadBalancerPtr lb = lb_->factory()->create();
+    uint32_t slots = 0;
+    for (uint32_t i = 0; i < 17; ++i) {
+      TestLoadBalancerContext context(i);
+      if (lb->chooseHost(&context) == host_set_.hosts_[0]) {
+        slots++;
+      }
+    }
+    return slots;
+  };
+  EXPECT_EQ(6U, first_host_slots());
+
+  host_set_.hosts_[1]->weight(1);
+  host_set_.runCallbacks({}, {});
+  EXPECT_EQ(6U, first_host_slots());
+
+  snapshot = std::make_shared<const HostVector>(host_set_.hosts_);
+  ON_CALL(host_set_, hostsPtr()).WillByDefault(Return(snapshot));
+  ON_CALL(host_set_, healthyHostsPtr()).WillByDefault(Return(snapshot));
+  host_set_.runCallbacks({}, {});
+  EXPECT_EQ(9U, first_host_slots());
+}
+
 // Locality weighted sanity test when localities have the same weights (no
 // different to Weighted above).
 TEST_F(MaglevLoadBalancerTest, LocalityWeightedSameLocalityWeights) {
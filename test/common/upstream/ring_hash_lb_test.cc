@@ -11,6 +11,7 @@
 #include "test/common/upstream/utility.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/logging.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -281,5 +282,57 @@ TEST_P(RingHashLoadBalancerTest, UnevenHosts) {
   }
 }
 
+// Rings that carry over the entries of unchanged hosts match a ring built from scratch.
+TEST_P(RingHashLoadBalancerTest, IncrementalUpdateMatchesFullBuild) {
+  for (uint32_t i = 0; i < 8; ++i) {
+    hostSet().hosts_.push_back(makeTestHost(info_, "tcp://127.0.0.1:" + std::to_string(90 + i)));
+  }
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = (envoy::api::v2::Cluster::RingHashLbConfig());
+  config_.value().mutable_minimum_ring_size()->set_value(64);
+  config_.value().mutable_deprecated_v1()->mutable_use_std_hash()->set_value(false);
+  init();
+
+  // Swap out two hosts. The host count, and with it the number of hashes per host, is unchanged.
+  HostVector hosts_removed{hostSet().hosts_[1], hostSet().hosts_[5]};
+  hostSet().hosts_.erase(hostSet().hosts_.begin() + 5);
+  hostSet().hosts_.erase(hostSet().hosts_.begin() + 1);
+  HostVector hosts_added{makeTestHost(info_, "tcp://127.0.0.1:98"),
+                         makeTestHost(info_, "tcp://127.0.0.1:99")};
+  hostSet().hosts_.insert(hostSet().hosts_.end(), hosts_added.begin(), hosts_added.end());
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks(hosts_added, hosts_removed);
+  LoadBalancerPtr incremental_lb = lb_->factory()->create();
+
+  init();
+  LoadBalancerPtr full_lb = lb_->factory()->create();
+
+  for (uint64_t i = 0; i < 1024; ++i) {
+    TestLoadBalancerContext context(i * 0x9E3779B97F4A7C15);
+    EXPECT_EQ(full_lb->chooseHost(&context), incremental_lb->chooseHost(&context));
+  }
+}
+
+// A ring is kept while the host set hands out the same snapshot, and rebuilt once the snapshot
+// changes.
+TEST_P(RingHashLoadBalancerTest, UnchangedSnapshotKeepsRing) {
+  hostSet().hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90"),
+                      makeTestHost(info_, "tcp://127.0.0.1:91")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  HostVectorConstSharedPtr snapshot = std::make_shared<const HostVector>(hostSet().hosts_);
+  ON_CALL(hostSet(), hostsPtr()).WillByDefault(Return(snapshot));
+  ON_CALL(hostSet(), healthyHostsPtr()).WillByDefault(Return(snapshot));
+  EXPECT_LOG_CONTAINS("info", "ring hash: min_ring_size", init());
+
+  EXPECT_LOG_NOT_CONTAINS("info", "ring hash: min_ring_size", hostSet().runCallbacks({}, {}));
+
+  snapshot = std::make_shared<const HostVector>(hostSet().hosts_);
+  ON_CALL(hostSet(), hostsPtr()).WillByDefault(Return(snapshot));
+  ON_CALL(hostSet(), healthyHostsPtr()).WillByDefault(Return(snapshot));
+  EXPECT_LOG_CONTAINS("info", "ring hash: min_ring_size", hostSet().runCallbacks({}, {}));
+}
+
 } // namespace Upstream
 } // namespace Envoy
@@ -0,0 +1,328 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+#include "envoy/config/filter/ext_authz/v2alpha/check_cache.pb.h"
+
+#include "common/protobuf/utility.h"
+#include "common/stats/stats_impl.h"
+
+#include "extensions/filters/common/ext_authz/check_cache.h"
+
+#include "test/extensions/filters/common/ext_authz/mocks.h"
+#include "test/mocks/common.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/mocks/tracing/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnPointee;
+using testing::WithArg;
+using testing::_;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+namespace {
+
+envoy::service::auth::v2alpha::CheckRequest checkRequest(const std::string& path,
+                                                         const std::string& user = "") {
+  envoy::service::auth::v2alpha::CheckRequest request;
+  auto* http = request.mutable_attributes()->mutable_request()->mutable_http();
+  http->set_method("GET");
+  http->set_path(path);
+  if (!user.empty()) {
+    (*http->mutable_headers())["x-user"] = user;
+  }
+  return request;
+}
+
+TEST(CheckKeyBuilderTest, Attributes) {
+  envoy::config::filter::ext_authz::v2alpha::CheckCache config;
+  config.add_key_attributes("request.http.path");
+  config.add_key_attributes("request.http.headers.X-User");
+  CheckKeyBuilder builder(config.key_attributes());
+
+  EXPECT_EQ(builder.build(checkRequest("/foo", "alice")),
+            builder.build(checkRequest("/foo", "alice")));
+  EXPECT_NE(builder.build(checkRequest("/foo", "alice")),
+            builder.build(checkRequest("/foo", "bob")));
+  EXPECT_NE(builder.build(checkRequest("/foo", "alice")),
+            builder.build(checkRequest("/bar", "alice")));
+  // Values of adjacent attributes can't run into each other.
+  EXPECT_NE(builder.build(checkRequest("/fo", "oalice")),
+            builder.build(checkRequest("/foo", "alice")));
+
+  // A missing header is not the same as an empty one.
+  envoy::service::auth::v2alpha::CheckRequest empty_user = checkRequest("/foo");
+  auto* http = empty_user.mutable_attributes()->mutable_request()->mutable_http();
+  (*http->mutable_headers())["x-user"] = "";
+  EXPECT_NE(builder.build(checkRequest("/foo")), builder.build(empty_user));
+}
+
+TEST(CheckKeyBuilderTest, UnsupportedAttribute) {
+  envoy::config::filter::ext_authz::v2alpha::CheckCache config;
+  config.add_key_attributes("request.http.body");
+  EXPECT_THROW_WITH_MESSAGE(CheckKeyBuilder builder(config.key_attributes()), EnvoyException,
+                            "ext_authz: unsupported check cache key attribute 'request.http.body'");
+}
+
+class CheckCacheTest : public testing::Test {
+public:
+  CheckCacheTest() { ON_CALL(time_source_, currentTime()).WillByDefault(ReturnPointee(&now_)); }
+
+  void setup(const std::string& yaml) {
+    envoy::config::filter::ext_authz::v2alpha::CheckCache proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    config_ = std::make_shared<CheckCacheConfig>(proto_config, tls_, stats_store_, "ext_authz.",
+                                                 time_source_);
+  }
+
+  // Every client sent to the authorization service by a caching client is recorded, along with
+  // the callbacks it must complete.
+  ClientPtr createCachingClient() {
+    return std::make_unique<CachingClientImpl>(config_, [this]() -> ClientPtr {
+      MockClient* client = new NiceMock<MockClient>();
+      EXPECT_CALL(*client, check(_, _, _))
+          .WillOnce(WithArg<0>(Invoke([this](RequestCallbacks& callbacks) -> void {
+            backend_callbacks_.push_back(&callbacks);
+          })));
+      backend_clients_.push_back(client);
+      return ClientPtr{client};
+    });
+  }
+
+  // Complete the last check request sent to the authorization service.
+  void completeBackend(CheckStatus status, std::chrono::milliseconds ttl) {
+    ASSERT_FALSE(backend_callbacks_.empty());
+    RequestCallbacks* callbacks = backend_callbacks_.back();
+    backend_callbacks_.pop_back();
+    if (ttl.count() > 0) {
+      callbacks->onCacheTtl(ttl);
+    }
+    callbacks->onComplete(status);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("ext_authz." + name).value();
+  }
+
+  const std::string default_yaml_ = R"EOF(
+  key_attributes:
+    - request.http.path
+  )EOF";
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  MonotonicTime now_;
+  CheckCacheConfigSharedPtr config_;
+  NiceMock<Tracing::MockSpan> span_;
+  std::vector<MockClient*> backend_clients_;
+  std::vector<RequestCallbacks*> backend_callbacks_;
+};
+
+TEST_F(CheckCacheTest, CachesDecisionForTtl) {
+  setup(default_yaml_);
+  MockRequestCallbacks callbacks;
+
+  ClientPtr client = createCachingClient();
+  client->check(callbacks, checkRequest("/foo"), span_);
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::Denied));
+  completeBackend(CheckStatus::Denied, std::chrono::milliseconds(1000));
+  EXPECT_EQ(1U, config_->cache().size());
+
+  // The decision comes from the cache until it expires.
+  now_ += std::chrono::milliseconds(999);
+  client = createCachingClient();
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::Denied));
+  client->check(callbacks, checkRequest("/foo"), span_);
+  EXPECT_EQ(1U, backend_clients_.size());
+  EXPECT_EQ(1U, counter("cache_hit"));
+
+  now_ += std::chrono::milliseconds(1);
+  client = createCachingClient();
+  client->check(callbacks, checkRequest("/foo"), span_);
+  EXPECT_EQ(2U, backend_clients_.size());
+  EXPECT_EQ(2U, counter("cache_miss"));
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::OK));
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(0));
+}
+
+TEST_F(CheckCacheTest, MaxTtl) {
+  setup(R"EOF(
+  key_attributes:
+    - request.http.path
+  max_ttl: 1s
+  )EOF");
+  MockRequestCallbacks callbacks;
+
+  ClientPtr client = createCachingClient();
+  client->check(callbacks, checkRequest("/foo"), span_);
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::OK));
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(60000));
+
+  now_ += std::chrono::milliseconds(1000);
+  client = createCachingClient();
+  client->check(callbacks, checkRequest("/foo"), span_);
+  EXPECT_EQ(2U, backend_clients_.size());
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::OK));
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(0));
+}
+
+TEST_F(CheckCacheTest, ErrorOrNoTtlIsNotCached) {
+  setup(default_yaml_);
+  MockRequestCallbacks callbacks;
+
+  ClientPtr client = createCachingClient();
+  client->check(callbacks, checkRequest("/foo"), span_);
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::Error));
+  completeBackend(CheckStatus::Error, std::chrono::milliseconds(1000));
+
+  client = createCachingClient();
+  client->check(callbacks, checkRequest("/foo"), span_);
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::OK));
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(0));
+
+  EXPECT_EQ(0U, config_->cache().size());
+  EXPECT_EQ(2U, backend_clients_.size());
+  EXPECT_EQ(0U, counter("cache_hit"));
+}
+
+TEST_F(CheckCacheTest, CoalescesIdenticalChecks) {
+  setup(default_yaml_);
+  MockRequestCallbacks callbacks1;
+  MockRequestCallbacks callbacks2;
+  MockRequestCallbacks callbacks3;
+
+  ClientPtr client1 = createCachingClient();
+  ClientPtr client2 = createCachingClient();
+  ClientPtr client3 = createCachingClient();
+  client1->check(callbacks1, checkRequest("/foo"), span_);
+  client2->check(callbacks2, checkRequest("/foo"), span_);
+  client3->check(callbacks3, checkRequest("/bar"), span_);
+  EXPECT_EQ(2U, backend_clients_.size());
+  EXPECT_EQ(1U, counter("coalesced"));
+
+  EXPECT_CALL(callbacks3, onComplete(CheckStatus::OK));
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(0));
+
+  EXPECT_CALL(callbacks1, onComplete(CheckStatus::Denied));
+  EXPECT_CALL(callbacks2, onComplete(CheckStatus::Denied));
+  completeBackend(CheckStatus::Denied, std::chrono::milliseconds(0));
+
+  // Once the check is complete, an identical one is sent again.
+  client1 = createCachingClient();
+  client1->check(callbacks1, checkRequest("/foo"), span_);
+  EXPECT_EQ(3U, backend_clients_.size());
+  EXPECT_CALL(callbacks1, onComplete(CheckStatus::OK));
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(0));
+}
+
+TEST_F(CheckCacheTest, CancelWaiter) {
+  setup(default_yaml_);
+  MockRequestCallbacks callbacks1;
+  MockRequestCallbacks callbacks2;
+
+  ClientPtr client1 = createCachingClient();
+  ClientPtr client2 = createCachingClient();
+  client1->check(callbacks1, checkRequest("/foo"), span_);
+  client2->check(callbacks2, checkRequest("/foo"), span_);
+
+  // The check request is still sent on behalf of the remaining waiter.
+  EXPECT_CALL(*backend_clients_[0], cancel()).Times(0);
+  client1->cancel();
+
+  EXPECT_CALL(callbacks1, onComplete(_)).Times(0);
+  EXPECT_CALL(callbacks2, onComplete(CheckStatus::OK));
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(0));
+}
+
+TEST_F(CheckCacheTest, CancelLastWaiter) {
+  setup(default_yaml_);
+  MockRequestCallbacks callbacks1;
+  MockRequestCallbacks callbacks2;
+
+  ClientPtr client1 = createCachingClient();
+  ClientPtr client2 = createCachingClient();
+  client1->check(callbacks1, checkRequest("/foo"), span_);
+  client2->check(callbacks2, checkRequest("/foo"), span_);
+
+  client1->cancel();
+  EXPECT_CALL(*backend_clients_[0], cancel());
+  client2->cancel();
+
+  // The next identical check request is not coalesced with the canceled one.
+  client1 = createCachingClient();
+  client1->check(callbacks1, checkRequest("/foo"), span_);
+  EXPECT_EQ(2U, backend_clients_.size());
+  EXPECT_CALL(callbacks1, onComplete(CheckStatus::OK));
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(0));
+}
+
+TEST_F(CheckCacheTest, EvictsLeastRecentlyUsed) {
+  setup(R"EOF(
+  key_attributes:
+    - request.http.path
+  max_entries: 2
+  )EOF");
+  MockRequestCallbacks callbacks;
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::OK)).Times(testing::AnyNumber());
+
+  for (const std::string path : {"/a", "/b"}) {
+    ClientPtr client = createCachingClient();
+    client->check(callbacks, checkRequest(path), span_);
+    completeBackend(CheckStatus::OK, std::chrono::milliseconds(1000));
+  }
+
+  // Using /a makes /b the least recently used decision.
+  ClientPtr client = createCachingClient();
+  client->check(callbacks, checkRequest("/a"), span_);
+  client = createCachingClient();
+  client->check(callbacks, checkRequest("/c"), span_);
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(1000));
+  EXPECT_EQ(2U, config_->cache().size());
+  EXPECT_EQ(1U, counter("cache_evicted"));
+
+  client = createCachingClient();
+  client->check(callbacks, checkRequest("/a"), span_);
+  EXPECT_EQ(3U, backend_clients_.size());
+  client = createCachingClient();
+  client->check(callbacks, checkRequest("/b"), span_);
+  EXPECT_EQ(4U, backend_clients_.size());
+  completeBackend(CheckStatus::OK, std::chrono::milliseconds(0));
+}
+
+TEST_F(CheckCacheTest, InlineDecision) {
+  setup(default_yaml_);
+  MockRequestCallbacks callbacks;
+
+  ClientPtr client = std::make_unique<CachingClientImpl>(config_, [this]() -> ClientPtr {
+    MockClient* backend_client = new NiceMock<MockClient>();
+    EXPECT_CALL(*backend_client, check(_, _, _))
+        .WillOnce(WithArg<0>(Invoke([](RequestCallbacks& backend_callbacks) -> void {
+          backend_callbacks.onCacheTtl(std::chrono::milliseconds(1000));
+          backend_callbacks.onComplete(CheckStatus::Denied);
+        })));
+    backend_clients_.push_back(backend_client);
+    return ClientPtr{backend_client};
+  });
+  EXPECT_CALL(callbacks, onComplete(CheckStatus::Denied));
+  client->check(callbacks, checkRequest("/foo"), span_);
+  EXPECT_EQ(1U, config_->cache().size());
+}
+
+} // namespace
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
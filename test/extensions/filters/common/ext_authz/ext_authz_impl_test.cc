@@ -9,6 +9,7 @@
 
 #include "extensions/filters/common/ext_authz/ext_authz_impl.h"
 
+#include "test/extensions/filters/common/ext_authz/mocks.h"
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/network/mocks.h"
@@ -22,6 +23,7 @@
 #include "gtest/gtest.h"
 
 using testing::AtLeast;
+using testing::InSequence;
 using testing::Invoke;
 using testing::Ref;
 using testing::Return;
@@ -36,11 +38,6 @@ namespace Filters {
 namespace Common {
 namespace ExtAuthz {
 
-class MockRequestCallbacks : public RequestCallbacks {
-public:
-  MOCK_METHOD1(onComplete, void(CheckStatus status));
-};
-
 class ExtAuthzGrpcClientTest : public testing::Test {
 public:
   ExtAuthzGrpcClientTest()
@@ -72,6 +69,23 @@ TEST_F(ExtAuthzGrpcClientTest, BasicOK) {
   client_.onSuccess(std::move(response), span_);
 }
 
+TEST_F(ExtAuthzGrpcClientTest, CacheTtl) {
+  envoy::service::auth::v2alpha::CheckRequest request;
+  std::unique_ptr<envoy::service::auth::v2alpha::CheckResponse> response;
+  EXPECT_CALL(*async_client_, send(_, ProtoEq(request), _, _, _)).WillOnce(Return(&async_request_));
+
+  client_.check(request_callbacks_, request, Tracing::NullSpan::instance());
+
+  response = std::make_unique<envoy::service::auth::v2alpha::CheckResponse>();
+  response->mutable_status()->set_code(Grpc::Status::GrpcStatus::Ok);
+  response->mutable_cache_ttl()->set_seconds(5);
+  EXPECT_CALL(span_, setTag("ext_authz_status", "ext_authz_ok"));
+  InSequence s;
+  EXPECT_CALL(request_callbacks_, onCacheTtl(std::chrono::milliseconds(5000)));
+  EXPECT_CALL(request_callbacks_, onComplete(CheckStatus::OK));
+  client_.onSuccess(std::move(response), span_);
+}
+
 TEST_F(ExtAuthzGrpcClientTest, BasicDenied) {
   envoy::service::auth::v2alpha::CheckRequest request;
   std::unique_ptr<envoy::service::auth::v2alpha::CheckResponse> response;
@@ -6,6 +6,9 @@ namespace Filters {
 namespace Common {
 namespace ExtAuthz {
 
+MockRequestCallbacks::MockRequestCallbacks() {}
+MockRequestCallbacks::~MockRequestCallbacks() {}
+
 MockClient::MockClient() {}
 MockClient::~MockClient() {}
 
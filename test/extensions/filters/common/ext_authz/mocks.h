@@ -13,6 +13,16 @@ namespace Filters {
 namespace Common {
 namespace ExtAuthz {
 
+class MockRequestCallbacks : public RequestCallbacks {
+public:
+  MockRequestCallbacks();
+  ~MockRequestCallbacks();
+
+  // ExtAuthz::RequestCallbacks
+  MOCK_METHOD1(onCacheTtl, void(std::chrono::milliseconds ttl));
+  MOCK_METHOD1(onComplete, void(CheckStatus status));
+};
+
 class MockClient : public Client {
 public:
   MockClient();
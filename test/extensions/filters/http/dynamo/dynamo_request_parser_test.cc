@@ -1,8 +1,11 @@
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "envoy/json/json_object.h"
+
+#include "common/buffer/buffer_impl.h"
 #include "common/http/header_map_impl.h"
-#include "common/json/json_loader.h"
 
 #include "extensions/filters/http/dynamo/dynamo_request_parser.h"
 
@@ -42,6 +45,28 @@ TEST(DynamoRequestParser, parseOperation) {
   }
 }
 
+RequestParser::TableDescriptor parseTable(const std::string& operation,
+                                         const std::string& json_string) {
+  RequestBodyParser parser(operation);
+  // The body may arrive in any number of parts.
+  Buffer::OwnedImpl first(json_string.substr(0, json_string.size() / 2));
+  Buffer::OwnedImpl second(json_string.substr(json_string.size() / 2));
+  parser.parse(first);
+  parser.parse(second);
+  parser.finish();
+  return parser.table();
+}
+
+std::unique_ptr<ResponseBodyParser> parseResponse(const std::string& json_string) {
+  std::unique_ptr<ResponseBodyParser> parser = std::make_unique<ResponseBodyParser>();
+  for (const char c : json_string) {
+    Buffer::OwnedImpl data(&c, 1);
+    parser->parse(data);
+  }
+  parser->finish();
+  return parser;
+}
+
 TEST(DynamoRequestParser, parseTableNameSingleOperation) {
   std::vector<std::string> supported_single_operations{"GetItem", "Query",      "Scan",
                                                        "PutItem", "UpdateItem", "DeleteItem"};
@@ -56,40 +81,63 @@ TEST(DynamoRequestParser, parseTableNameSingleOperation) {
       }
     }
     )EOF";
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString(json_string);
 
     // Supported operation
     for (const std::string& operation : supported_single_operations) {
-      EXPECT_EQ("Pets", RequestParser::parseTable(operation, *json_data).table_name);
+      EXPECT_EQ("Pets", parseTable(operation, json_string).table_name);
     }
 
     // Not supported operation
-    EXPECT_EQ("", RequestParser::parseTable("NotSupportedOperation", *json_data).table_name);
+    EXPECT_EQ("", parseTable("NotSupportedOperation", json_string).table_name);
   }
 
   {
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString("{\"TableName\":\"Pets\"}");
-    EXPECT_EQ("Pets", RequestParser::parseTable("GetItem", *json_data).table_name);
+    EXPECT_EQ("Pets", parseTable("GetItem", "{\"TableName\":\"Pets\"}").table_name);
+  }
+
+  // Only the top level TableName counts.
+  {
+    std::string json_string = R"EOF(
+    {
+      "Item": {"TableName": {"S": "Other"}},
+      "TableName": "Pets"
+    }
+    )EOF";
+    EXPECT_EQ("Pets", parseTable("PutItem", json_string).table_name);
+  }
+
+  {
+    EXPECT_THROW(parseTable("GetItem", "{\"TableName\":\"Pets\""), Json::Exception);
   }
 }
 
 TEST(DynamoRequestParser, parseErrorType) {
   {
     EXPECT_EQ("ResourceNotFoundException",
-              RequestParser::parseErrorType(*Json::Factory::loadFromString(
-                  "{\"__type\":\"com.amazonaws.dynamodb.v20120810#ResourceNotFoundException\"}")));
+              parseResponse(
+                  "{\"__type\":\"com.amazonaws.dynamodb.v20120810#ResourceNotFoundException\"}")
+                  ->errorType());
   }
 
   {
     EXPECT_EQ("ResourceNotFoundException",
-              RequestParser::parseErrorType(*Json::Factory::loadFromString(
+              parseResponse(
                   "{\"__type\":\"com.amazonaws.dynamodb.v20120810#ResourceNotFoundException\","
-                  "\"message\":\"Requested resource not found: Table: tablename not found\"}")));
+                  "\"message\":\"Requested resource not found: Table: tablename not found\"}")
+                  ->errorType());
+  }
+
+  {
+    EXPECT_EQ("", parseResponse("{\"__type\":\"UnKnownError\"}")->errorType());
+  }
+
+  {
+    EXPECT_EQ("", parseResponse("{}")->errorType());
   }
 
   {
-    EXPECT_EQ("", RequestParser::parseErrorType(
-                      *Json::Factory::loadFromString("{\"__type\":\"UnKnownError\"}")));
+    EXPECT_EQ("ValidationException",
+              RequestParser::parseErrorType("com.amazon.coral.validate#ValidationException"));
   }
 }
 
@@ -103,9 +151,8 @@ TEST(DynamoRequestParser, parseTableNameBatchOperation) {
       }
     }
     )EOF";
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString(json_string);
 
-    RequestParser::TableDescriptor table = RequestParser::parseTable("BatchGetItem", *json_data);
+    RequestParser::TableDescriptor table = parseTable("BatchGetItem", json_string);
     EXPECT_EQ("", table.table_name);
     EXPECT_FALSE(table.is_single_table);
   }
@@ -119,9 +166,8 @@ TEST(DynamoRequestParser, parseTableNameBatchOperation) {
       }
     }
     )EOF";
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString(json_string);
 
-    RequestParser::TableDescriptor table = RequestParser::parseTable("BatchGetItem", *json_data);
+    RequestParser::TableDescriptor table = parseTable("BatchGetItem", json_string);
     EXPECT_EQ("table_2", table.table_name);
     EXPECT_TRUE(table.is_single_table);
   }
@@ -136,9 +182,8 @@ TEST(DynamoRequestParser, parseTableNameBatchOperation) {
       }
     }
     )EOF";
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString(json_string);
 
-    RequestParser::TableDescriptor table = RequestParser::parseTable("BatchGetItem", *json_data);
+    RequestParser::TableDescriptor table = parseTable("BatchGetItem", json_string);
     EXPECT_EQ("", table.table_name);
     EXPECT_FALSE(table.is_single_table);
   }
@@ -152,51 +197,45 @@ TEST(DynamoRequestParser, parseTableNameBatchOperation) {
       }
     }
     )EOF";
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString(json_string);
 
-    RequestParser::TableDescriptor table = RequestParser::parseTable("BatchWriteItem", *json_data);
+    RequestParser::TableDescriptor table = parseTable("BatchWriteItem", json_string);
     EXPECT_EQ("table_2", table.table_name);
     EXPECT_TRUE(table.is_single_table);
   }
 
   {
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString("{}");
-    RequestParser::TableDescriptor table =
-        RequestParser::parseTable("BatchWriteItem", *Json::Factory::loadFromString("{}"));
+    RequestParser::TableDescriptor table = parseTable("BatchWriteItem", "{}");
     EXPECT_EQ("", table.table_name);
     EXPECT_TRUE(table.is_single_table);
   }
 
   {
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString("{\"RequestItems\":{}}");
-    RequestParser::TableDescriptor table = RequestParser::parseTable("BatchWriteItem", *json_data);
+    RequestParser::TableDescriptor table = parseTable("BatchWriteItem", "{\"RequestItems\":{}}");
     EXPECT_EQ("", table.table_name);
     EXPECT_TRUE(table.is_single_table);
   }
 
   {
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString("{}");
-    RequestParser::TableDescriptor table = RequestParser::parseTable("BatchGetItem", *json_data);
+    RequestParser::TableDescriptor table = parseTable("BatchGetItem", "{}");
     EXPECT_EQ("", table.table_name);
     EXPECT_TRUE(table.is_single_table);
   }
 }
+
 TEST(DynamoRequestParser, parseBatchUnProcessedKeys) {
   {
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString("{}");
-    std::vector<std::string> unprocessed_tables =
-        RequestParser::parseBatchUnProcessedKeys(*json_data);
+    std::vector<std::string> unprocessed_tables = parseResponse("{}")->unprocessedTables();
     EXPECT_EQ(0u, unprocessed_tables.size());
   }
   {
-    std::vector<std::string> unprocessed_tables = RequestParser::parseBatchUnProcessedKeys(
-        *Json::Factory::loadFromString("{\"UnprocessedKeys\":{}}"));
+    std::vector<std::string> unprocessed_tables =
+        parseResponse("{\"UnprocessedKeys\":{}}")->unprocessedTables();
     EXPECT_EQ(0u, unprocessed_tables.size());
   }
 
   {
-    std::vector<std::string> unprocessed_tables = RequestParser::parseBatchUnProcessedKeys(
-        *Json::Factory::loadFromString("{\"UnprocessedKeys\":{\"table_1\" :{}}}"));
+    std::vector<std::string> unprocessed_tables =
+        parseResponse("{\"UnprocessedKeys\":{\"table_1\" :{}}}")->unprocessedTables();
     EXPECT_EQ("table_1", unprocessed_tables[0]);
     EXPECT_EQ(1u, unprocessed_tables.size());
   }
@@ -210,10 +249,8 @@ TEST(DynamoRequestParser, parseBatchUnProcessedKeys) {
       }
     }
     )EOF";
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString(json_string);
 
-    std::vector<std::string> unprocessed_tables =
-        RequestParser::parseBatchUnProcessedKeys(*json_data);
+    std::vector<std::string> unprocessed_tables = parseResponse(json_string)->unprocessedTables();
     EXPECT_TRUE(find(unprocessed_tables.begin(), unprocessed_tables.end(), "table_1") !=
                 unprocessed_tables.end());
     EXPECT_TRUE(find(unprocessed_tables.begin(), unprocessed_tables.end(), "table_2") !=
@@ -224,18 +261,17 @@ TEST(DynamoRequestParser, parseBatchUnProcessedKeys) {
 
 TEST(DynamoRequestParser, parsePartitionIds) {
   {
-    std::vector<RequestParser::PartitionDescriptor> partitions =
-        RequestParser::parsePartitions(*Json::Factory::loadFromString("{}"));
+    std::vector<RequestParser::PartitionDescriptor> partitions = parseResponse("{}")->partitions();
     EXPECT_EQ(0u, partitions.size());
   }
   {
     std::vector<RequestParser::PartitionDescriptor> partitions =
-        RequestParser::parsePartitions(*Json::Factory::loadFromString("{\"ConsumedCapacity\":{}}"));
+        parseResponse("{\"ConsumedCapacity\":{}}")->partitions();
     EXPECT_EQ(0u, partitions.size());
   }
   {
-    std::vector<RequestParser::PartitionDescriptor> partitions = RequestParser::parsePartitions(
-        *Json::Factory::loadFromString("{\"ConsumedCapacity\":{ \"Partitions\":{}}}"));
+    std::vector<RequestParser::PartitionDescriptor> partitions =
+        parseResponse("{\"ConsumedCapacity\":{ \"Partitions\":{}}}")->partitions();
     EXPECT_EQ(0u, partitions.size());
   }
   {
@@ -249,10 +285,9 @@ TEST(DynamoRequestParser, parsePartitionIds) {
       }
     }
     )EOF";
-    Json::ObjectSharedPtr json_data = Json::Factory::loadFromString(json_string);
 
     std::vector<RequestParser::PartitionDescriptor> partitions =
-        RequestParser::parsePartitions(*json_data);
+        parseResponse(json_string)->partitions();
     for (const RequestParser::PartitionDescriptor& partition : partitions) {
       if (partition.partition_id_ == "partition_1") {
         EXPECT_EQ(1u, partition.capacity_);
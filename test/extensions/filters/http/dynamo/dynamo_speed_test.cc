@@ -0,0 +1,181 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Usage: bazel run -c opt //test/extensions/filters/http/dynamo:dynamo_speed_test
+//
+// Compares buffering a BatchGetItem request or response and loading it into a JSON document, as
+// the filter used to, with parsing it as it streams in 16KiB chunks.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/fmt.h"
+#include "common/json/json_loader.h"
+
+#include "extensions/filters/http/dynamo/dynamo_request_parser.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Dynamo {
+namespace {
+
+const uint64_t ChunkSize = 16384;
+
+std::string makeItem(uint64_t i) {
+  return fmt::format(R"EOF({{
+        "ForumName": {{"S": "Amazon DynamoDB"}},
+        "Subject": {{"S": "How do I update multiple items? ({})"}},
+        "LastPostDateTime": {{"S": "2015-09-22T19:58:22.514Z"}},
+        "Views": {{"N": "{}"}},
+        "Tags": {{"SS": ["Update", "Multiple Items", "HelpMe"]}}
+      }})EOF",
+                     i, i * 7);
+}
+
+// A request for num_items items spread over two tables.
+std::string makeRequest(uint64_t num_items) {
+  std::string keys[2];
+  for (uint64_t i = 0; i < num_items; i++) {
+    std::string& table_keys = keys[i % 2];
+    table_keys += fmt::format(R"EOF({}{{"ForumName": {{"S": "Amazon DynamoDB"}},
+        "Subject": {{"S": "How do I update multiple items? ({})"}}}})EOF",
+                              table_keys.empty() ? "" : ",", i);
+  }
+  return fmt::format(R"EOF({{
+  "RequestItems": {{
+    "Forum": {{"Keys": [{}], "ProjectionExpression": "Name, Threads, Messages, Views"}},
+    "Thread": {{"Keys": [{}], "ProjectionExpression": "Tags, Message"}}
+  }},
+  "ReturnConsumedCapacity": "TOTAL"
+}})EOF",
+                     keys[0], keys[1]);
+}
+
+// A response returning num_items items, with unprocessed keys left for one table.
+std::string makeResponse(uint64_t num_items) {
+  std::string items;
+  for (uint64_t i = 0; i < num_items; i++) {
+    items += (i == 0 ? "" : ",") + makeItem(i);
+  }
+  return fmt::format(R"EOF({{
+  "Responses": {{"Forum": [{}]}},
+  "UnprocessedKeys": {{
+    "Thread": {{"Keys": [{{"ForumName": {{"S": "Amazon DynamoDB"}}}}]}}
+  }},
+  "ConsumedCapacity": {{"Partitions": {{"partition_1": 2.5, "partition_2": 12.0}}}}
+}})EOF",
+                     items);
+}
+
+std::vector<Buffer::InstancePtr> toChunks(const std::string& body) {
+  std::vector<Buffer::InstancePtr> chunks;
+  for (uint64_t offset = 0; offset < body.size(); offset += ChunkSize) {
+    chunks.emplace_back(new Buffer::OwnedImpl(body.substr(offset, ChunkSize)));
+  }
+  return chunks;
+}
+
+std::string bufferChunks(const std::vector<Buffer::InstancePtr>& chunks) {
+  Buffer::OwnedImpl buffered;
+  for (const Buffer::InstancePtr& chunk : chunks) {
+    buffered.add(*chunk);
+  }
+  return buffered.toString();
+}
+
+static void BM_RequestJsonLoader(benchmark::State& state) {
+  const std::string body = makeRequest(state.range(0));
+  const std::vector<Buffer::InstancePtr> chunks = toChunks(body);
+  uint64_t tables = 0;
+  for (auto _ : state) {
+    Json::ObjectSharedPtr json = Json::Factory::loadFromString(bufferChunks(chunks));
+    json->getObject("RequestItems")->iterate([&tables](const std::string&, const Json::Object&) {
+      tables++;
+      return true;
+    });
+  }
+  benchmark::DoNotOptimize(tables);
+  state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_RequestJsonLoader)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_RequestStreaming(benchmark::State& state) {
+  const std::string body = makeRequest(state.range(0));
+  const std::vector<Buffer::InstancePtr> chunks = toChunks(body);
+  uint64_t tables = 0;
+  for (auto _ : state) {
+    RequestBodyParser parser("BatchGetItem");
+    for (const Buffer::InstancePtr& chunk : chunks) {
+      parser.parse(*chunk);
+    }
+    parser.finish();
+    tables += parser.table().is_single_table ? 1 : 2;
+  }
+  benchmark::DoNotOptimize(tables);
+  state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_RequestStreaming)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_ResponseJsonLoader(benchmark::State& state) {
+  const std::string body = makeResponse(state.range(0));
+  const std::vector<Buffer::InstancePtr> chunks = toChunks(body);
+  uint64_t found = 0;
+  for (auto _ : state) {
+    Json::ObjectSharedPtr json = Json::Factory::loadFromString(bufferChunks(chunks));
+    found += json->getString("__type", "").size();
+    json->getObject("UnprocessedKeys", true)
+        ->iterate([&found](const std::string&, const Json::Object&) {
+          found++;
+          return true;
+        });
+    json->getObject("ConsumedCapacity", true)
+        ->getObject("Partitions", true)
+        ->iterate([&found](const std::string&, const Json::Object& capacity) {
+          found += static_cast<uint64_t>(capacity.asDouble());
+          return true;
+        });
+  }
+  benchmark::DoNotOptimize(found);
+  state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_ResponseJsonLoader)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_ResponseStreaming(benchmark::State& state) {
+  const std::string body = makeResponse(state.range(0));
+  const std::vector<Buffer::InstancePtr> chunks = toChunks(body);
+  uint64_t found = 0;
+  for (auto _ : state) {
+    ResponseBodyParser parser;
+    for (const Buffer::InstancePtr& chunk : chunks) {
+      parser.parse(*chunk);
+    }
+    parser.finish();
+    found += parser.errorType().size() + parser.unprocessedTables().size();
+    for (const RequestParser::PartitionDescriptor& partition : parser.partitions()) {
+      found += partition.capacity_;
+    }
+  }
+  benchmark::DoNotOptimize(found);
+  state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_ResponseStreaming)->Arg(100)->Arg(1000)->Arg(10000);
+
+} // namespace
+} // namespace Dynamo
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
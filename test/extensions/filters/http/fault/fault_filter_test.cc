@@ -7,6 +7,7 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/empty_string.h"
+#include "common/common/fmt.h"
 #include "common/config/filter_json.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
@@ -18,6 +19,7 @@
 #include "test/common/http/common.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
 
@@ -131,7 +133,7 @@ public:
 
   void SetUpTest(const std::string json) {
     envoy::config::filter::http::fault::v2::HTTPFault fault = convertJsonStrToProtoConfig(json);
-    config_.reset(new FaultFilterConfig(fault, runtime_, "prefix.", stats_));
+    config_.reset(new FaultFilterConfig(fault, runtime_, "prefix.", stats_, tls_));
     filter_.reset(new FaultFilter(config_));
     filter_->setDecoderFilterCallbacks(filter_callbacks_);
   }
@@ -152,6 +154,7 @@ public:
   Buffer::OwnedImpl data_;
   Stats::IsolatedStoreImpl stats_;
   NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
   Event::MockTimer* timer_{};
 };
 
@@ -464,6 +467,68 @@ TEST_F(FaultFilterTest, FixedDelayAndAbortDownstream) {
   EXPECT_EQ(1UL, stats_.counter("prefix.fault.cluster.aborts_injected").value());
 }
 
+TEST_F(FaultFilterTest, DownstreamClusterKeys) {
+  SetUpTest(fixed_delay_and_abort_json);
+
+  const DownstreamClusterKeys* keys = config_->downstreamClusterKeys("cluster");
+  ASSERT_NE(nullptr, keys);
+  EXPECT_EQ("cluster", keys->cluster_);
+  EXPECT_EQ("fault.http.cluster.delay.fixed_delay_percent", keys->delay_percent_key_);
+  EXPECT_EQ("fault.http.cluster.abort.abort_percent", keys->abort_percent_key_);
+  EXPECT_EQ("fault.http.cluster.delay.fixed_duration_ms", keys->delay_duration_key_);
+  EXPECT_EQ("fault.http.cluster.abort.http_status", keys->abort_http_status_key_);
+  EXPECT_EQ("prefix.fault.cluster.delays_injected", keys->delays_injected_stat_);
+  EXPECT_EQ("prefix.fault.cluster.aborts_injected", keys->aborts_injected_stat_);
+
+  // Later requests from the same cluster share the keys.
+  EXPECT_EQ(keys, config_->downstreamClusterKeys(std::string("cluster")));
+  EXPECT_NE(keys, config_->downstreamClusterKeys("other_cluster"));
+}
+
+TEST_F(FaultFilterTest, DownstreamClusterKeysBounded) {
+  SetUpTest(abort_only_json);
+
+  for (uint64_t i = 0; i < DownstreamClusterKeyTable::MAX_DOWNSTREAM_CLUSTERS; i++) {
+    const std::string cluster = fmt::format("cluster_{}", i);
+    const DownstreamClusterKeys* keys = config_->downstreamClusterKeys(cluster);
+    ASSERT_NE(nullptr, keys);
+    EXPECT_EQ(keys, config_->downstreamClusterKeys(cluster));
+  }
+
+  // Clusters already in the table are still found, new ones are not added.
+  EXPECT_NE(nullptr, config_->downstreamClusterKeys("cluster_0"));
+  EXPECT_EQ(nullptr, config_->downstreamClusterKeys("cluster"));
+
+  // A request from a new cluster still uses the cluster's runtime keys and counters.
+  request_headers_.addCopy("x-envoy-downstream-service-cluster", "cluster");
+
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled("fault.http.delay.fixed_delay_percent", 0))
+      .WillOnce(Return(false));
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled("fault.http.cluster.delay.fixed_delay_percent", 0))
+      .WillOnce(Return(false));
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled("fault.http.abort.abort_percent", 100))
+      .WillOnce(Return(false));
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled("fault.http.cluster.abort.abort_percent", 100))
+      .WillOnce(Return(true));
+  EXPECT_CALL(runtime_.snapshot_, getInteger("fault.http.abort.http_status", 429))
+      .WillOnce(Return(429));
+  EXPECT_CALL(runtime_.snapshot_, getInteger("fault.http.cluster.abort.http_status", 429))
+      .WillOnce(Return(503));
+
+  Http::TestHeaderMapImpl response_headers{
+      {":status", "503"}, {"content-length", "18"}, {"content-type", "text/plain"}};
+  EXPECT_CALL(filter_callbacks_, encodeHeaders_(HeaderMapEqualRef(&response_headers), false));
+  EXPECT_CALL(filter_callbacks_, encodeData(_, true));
+  EXPECT_CALL(filter_callbacks_.request_info_,
+              setResponseFlag(RequestInfo::ResponseFlag::FaultInjected));
+
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers_, false));
+
+  EXPECT_EQ(1UL, config_->stats().aborts_injected_.value());
+  EXPECT_EQ(1UL, stats_.counter("prefix.fault.cluster.aborts_injected").value());
+}
+
 TEST_F(FaultFilterTest, FixedDelayAndAbort) {
   SetUpTest(fixed_delay_and_abort_json);
 
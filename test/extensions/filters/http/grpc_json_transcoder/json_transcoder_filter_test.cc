@@ -8,6 +8,7 @@
 #include "common/grpc/common.h"
 #include "common/http/header_map_impl.h"
 #include "common/protobuf/protobuf.h"
+#include "common/stats/stats_impl.h"
 
 #include "extensions/filters/http/grpc_json_transcoder/json_transcoder_filter.h"
 
@@ -103,17 +104,22 @@ public:
     descriptor_set.clear_file();
     descriptor_set.add_file()->Swap(&file_descriptor);
   }
+
+  Stats::IsolatedStoreImpl stats_;
 };
 
 TEST_F(GrpcJsonTranscoderConfigTest, ParseConfig) {
-  EXPECT_NO_THROW(JsonTranscoderConfig config(getProtoConfig(
-      TestEnvironment::runfilesPath("test/proto/bookstore.descriptor"), "bookstore.Bookstore")));
+  EXPECT_NO_THROW(JsonTranscoderConfig config(
+      getProtoConfig(TestEnvironment::runfilesPath("test/proto/bookstore.descriptor"),
+                     "bookstore.Bookstore"),
+      "", stats_));
 }
 
 TEST_F(GrpcJsonTranscoderConfigTest, ParseConfigSkipRecalculating) {
   EXPECT_NO_THROW(JsonTranscoderConfig config(
       getProtoConfig(TestEnvironment::runfilesPath("test/proto/bookstore.descriptor"),
-                     "bookstore.Bookstore", true)));
+                     "bookstore.Bookstore", true),
+      "", stats_));
 }
 
 TEST_F(GrpcJsonTranscoderConfigTest, ParseBinaryConfig) {
@@ -121,14 +127,15 @@ TEST_F(GrpcJsonTranscoderConfigTest, ParseBinaryConfig) {
   proto_config.set_proto_descriptor_bin(
       Filesystem::fileReadToEnd(TestEnvironment::runfilesPath("test/proto/bookstore.descriptor")));
   proto_config.add_services("bookstore.Bookstore");
-  EXPECT_NO_THROW(JsonTranscoderConfig config(proto_config));
+  EXPECT_NO_THROW(JsonTranscoderConfig config(proto_config, "", stats_));
 }
 
 TEST_F(GrpcJsonTranscoderConfigTest, UnknownService) {
   EXPECT_THROW_WITH_MESSAGE(
       JsonTranscoderConfig config(
           getProtoConfig(TestEnvironment::runfilesPath("test/proto/bookstore.descriptor"),
-                         "grpc.service.UnknownService")),
+                         "grpc.service.UnknownService"),
+          "", stats_),
       EnvoyException,
       "transcoding_filter: Could not find 'grpc.service.UnknownService' in the proto descriptor");
 }
@@ -138,22 +145,26 @@ TEST_F(GrpcJsonTranscoderConfigTest, IncompleteProto) {
       JsonTranscoderConfig config(getProtoConfig(makeProtoDescriptor([&](FileDescriptorSet& pb) {
                                                    stripImports(pb, "test/proto/bookstore.proto");
                                                  }),
-                                                 "bookstore.Bookstore")),
+                                                 "bookstore.Bookstore"),
+                                  "", stats_),
       EnvoyException, "transcoding_filter: Unable to build proto descriptor pool");
 }
 
 TEST_F(GrpcJsonTranscoderConfigTest, NonProto) {
-  EXPECT_THROW_WITH_MESSAGE(JsonTranscoderConfig config(getProtoConfig(
-                                TestEnvironment::runfilesPath("test/proto/bookstore.proto"),
-                                "grpc.service.UnknownService")),
-                            EnvoyException, "transcoding_filter: Unable to parse proto descriptor");
+  EXPECT_THROW_WITH_MESSAGE(
+      JsonTranscoderConfig config(
+          getProtoConfig(TestEnvironment::runfilesPath("test/proto/bookstore.proto"),
+                         "grpc.service.UnknownService"),
+          "", stats_),
+      EnvoyException, "transcoding_filter: Unable to parse proto descriptor");
 }
 
 TEST_F(GrpcJsonTranscoderConfigTest, NonBinaryProto) {
   envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder proto_config;
   proto_config.set_proto_descriptor_bin("This is invalid proto");
   proto_config.add_services("bookstore.Bookstore");
-  EXPECT_THROW_WITH_MESSAGE(JsonTranscoderConfig config(proto_config), EnvoyException,
+  EXPECT_THROW_WITH_MESSAGE(JsonTranscoderConfig config(proto_config, "", stats_),
+                            EnvoyException,
                             "transcoding_filter: Unable to parse proto descriptor");
 }
 
@@ -161,16 +172,20 @@ TEST_F(GrpcJsonTranscoderConfigTest, InvalidHttpTemplate) {
   HttpRule http_rule;
   http_rule.set_get("/book/{");
   EXPECT_THROW_WITH_MESSAGE(
-      JsonTranscoderConfig config(getProtoConfig(
-          makeProtoDescriptor([&](FileDescriptorSet& pb) { setGetBookHttpRule(pb, http_rule); }),
-          "bookstore.Bookstore")),
+      JsonTranscoderConfig config(
+          getProtoConfig(makeProtoDescriptor(
+                             [&](FileDescriptorSet& pb) { setGetBookHttpRule(pb, http_rule); }),
+                         "bookstore.Bookstore"),
+          "", stats_),
       EnvoyException,
       "transcoding_filter: Cannot register 'bookstore.Bookstore.GetBook' to path matcher");
 }
 
 TEST_F(GrpcJsonTranscoderConfigTest, CreateTranscoder) {
-  JsonTranscoderConfig config(getProtoConfig(
-      TestEnvironment::runfilesPath("test/proto/bookstore.descriptor"), "bookstore.Bookstore"));
+  JsonTranscoderConfig config(
+      getProtoConfig(TestEnvironment::runfilesPath("test/proto/bookstore.descriptor"),
+                     "bookstore.Bookstore"),
+      "", stats_);
 
   Http::TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/shelves"}};
 
@@ -188,9 +203,11 @@ TEST_F(GrpcJsonTranscoderConfigTest, CreateTranscoder) {
 TEST_F(GrpcJsonTranscoderConfigTest, InvalidVariableBinding) {
   HttpRule http_rule;
   http_rule.set_get("/book/{b}");
-  JsonTranscoderConfig config(getProtoConfig(
-      makeProtoDescriptor([&](FileDescriptorSet& pb) { setGetBookHttpRule(pb, http_rule); }),
-      "bookstore.Bookstore"));
+  JsonTranscoderConfig config(
+      getProtoConfig(makeProtoDescriptor(
+                         [&](FileDescriptorSet& pb) { setGetBookHttpRule(pb, http_rule); }),
+                     "bookstore.Bookstore"),
+      "", stats_);
 
   Http::TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/book/1"}};
 
@@ -209,7 +226,7 @@ TEST_F(GrpcJsonTranscoderConfigTest, InvalidVariableBinding) {
 class GrpcJsonTranscoderFilterTest : public testing::Test {
 public:
   GrpcJsonTranscoderFilterTest(const bool match_incoming_request_route = false)
-      : config_(bookstoreProtoConfig(match_incoming_request_route)), filter_(config_) {
+      : config_(bookstoreProtoConfig(match_incoming_request_route), "", stats_), filter_(config_) {
     filter_.setDecoderFilterCallbacks(decoder_callbacks_);
     filter_.setEncoderFilterCallbacks(encoder_callbacks_);
   }
@@ -230,6 +247,7 @@ public:
   }
 
   // TODO(lizan): Add a mock of JsonTranscoderConfig and test more error cases.
+  Stats::IsolatedStoreImpl stats_;
   JsonTranscoderConfig config_;
   JsonTranscoderFilter filter_;
   NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
@@ -512,6 +530,78 @@ TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryError) {
   EXPECT_EQ(0, request_data.length());
 }
 
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryRequestBytesInFlight) {
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", "application/json"}, {":method", "POST"}, {":path", "/shelf"}};
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl request_data{"{\"theme\": "};
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_data, false));
+  EXPECT_EQ(0, request_data.length());
+  EXPECT_EQ(10, stats_.gauge("grpc_json_transcoder.request_bytes_in_flight").value());
+
+  request_data.add("\"Children\"}");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_data, true));
+  EXPECT_EQ(0, stats_.gauge("grpc_json_transcoder.request_bytes_in_flight").value());
+
+  Grpc::Decoder decoder;
+  std::vector<Grpc::Frame> frames;
+  decoder.decode(request_data, frames);
+  EXPECT_EQ(1, frames.size());
+}
+
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryRequestTooLarge) {
+  ON_CALL(decoder_callbacks_, decoderBufferLimit()).WillByDefault(Return(8));
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", "application/json"}, {":method", "POST"}, {":path", "/shelf"}};
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl request_data{"{\"theme\": \"Children\""};
+
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false))
+      .WillOnce(Invoke([](Http::HeaderMap& headers, bool end_stream) {
+        EXPECT_STREQ("413", headers.Status()->value().c_str());
+        EXPECT_FALSE(end_stream);
+      }));
+  EXPECT_CALL(decoder_callbacks_, encodeData(_, true));
+
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer,
+            filter_.decodeData(request_data, false));
+  EXPECT_EQ(1, stats_.counter("grpc_json_transcoder.request_too_large").value());
+  EXPECT_EQ(20, stats_.gauge("grpc_json_transcoder.request_bytes_in_flight").value());
+
+  filter_.onDestroy();
+  EXPECT_EQ(0, stats_.gauge("grpc_json_transcoder.request_bytes_in_flight").value());
+}
+
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryResponseTooLarge) {
+  ON_CALL(encoder_callbacks_, encoderBufferLimit()).WillByDefault(Return(8));
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", "application/json"}, {":method", "GET"}, {":path", "/shelves/20"}};
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, true));
+
+  Http::TestHeaderMapImpl response_headers{{"content-type", "application/grpc"},
+                                           {":status", "200"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_.encodeHeaders(response_headers, false));
+
+  bookstore::Shelf response;
+  response.set_id(20);
+  response.set_theme("Children");
+
+  // Only the first part of the message arrives, which the transcoder has to hold.
+  Buffer::OwnedImpl response_data{
+      TestUtility::bufferToString(*Grpc::Common::serializeBody(response)).substr(0, 10)};
+
+  EXPECT_CALL(encoder_callbacks_, resetStream());
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer,
+            filter_.encodeData(response_data, false));
+  EXPECT_EQ(1, stats_.counter("grpc_json_transcoder.response_too_large").value());
+}
+
 TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryTimeout) {
   Http::TestHeaderMapImpl request_headers{
       {"content-type", "application/json"}, {":method", "POST"}, {":path", "/shelf"}};
@@ -563,7 +653,7 @@ public:
         Json::Factory::loadFromString(TestEnvironment::substitute(GetParam().config_json_));
     envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder proto_config{};
     Envoy::Config::FilterJson::translateGrpcJsonTranscoder(*json_config, proto_config);
-    config_ = new JsonTranscoderConfig(proto_config);
+    config_ = new JsonTranscoderConfig(proto_config, "", stats_);
     filter_ = new JsonTranscoderFilter(*config_);
     filter_->setDecoderFilterCallbacks(decoder_callbacks_);
     filter_->setEncoderFilterCallbacks(encoder_callbacks_);
@@ -574,6 +664,7 @@ public:
     delete config_;
   }
 
+  Stats::IsolatedStoreImpl stats_;
   JsonTranscoderConfig* config_;
   JsonTranscoderFilter* filter_;
   NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
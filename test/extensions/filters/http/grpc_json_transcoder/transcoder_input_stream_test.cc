@@ -46,6 +46,21 @@ TEST_F(TranscoderInputStreamTest, BackUp) {
   EXPECT_EQ(3, stream_.BytesAvailable());
 }
 
+TEST_F(TranscoderInputStreamTest, BytesInFlight) {
+  EXPECT_EQ(4, stream_.bytesInFlight());
+
+  EXPECT_TRUE(stream_.Next(&data_, &size_));
+  stream_.BackUp(1);
+  EXPECT_EQ(4, stream_.bytesInFlight());
+
+  stream_.markTranscoded();
+  EXPECT_EQ(1, stream_.bytesInFlight());
+
+  Buffer::OwnedImpl buffer{"efgh"};
+  stream_.move(buffer);
+  EXPECT_EQ(5, stream_.bytesInFlight());
+}
+
 } // namespace
 } // namespace GrpcJsonTranscoder
 } // namespace HttpFilters
@@ -7,6 +7,7 @@
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -62,7 +63,7 @@ protected:
     Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
     envoy::config::filter::http::gzip::v2::Gzip gzip;
     MessageUtil::loadFromJson(json, gzip);
-    config_.reset(new GzipFilterConfig(gzip, "test.", stats_, runtime_));
+    config_.reset(new GzipFilterConfig(gzip, "test.", stats_, runtime_, tls_));
     filter_.reset(new GzipFilter(config_));
   }
 
@@ -117,6 +118,7 @@ protected:
     EXPECT_EQ(1, stats_.counter("test.gzip.not_compressed").value());
   }
 
+  NiceMock<ThreadLocal::MockInstance> tls_;
   GzipFilterConfigSharedPtr config_;
   std::unique_ptr<GzipFilter> filter_;
   Buffer::OwnedImpl data_;
@@ -147,6 +149,7 @@ TEST_F(GzipFilterTest, DefaultConfigValues) {
   EXPECT_EQ(Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
             config_->compressionLevel());
   EXPECT_EQ(8, config_->contentTypeValues().size());
+  EXPECT_EQ(16, config_->compressorPoolSize());
 }
 
 // Acceptance Testing with default configuration.
@@ -704,6 +707,79 @@ TEST_F(GzipFilterTest, RemoveAcceptEncodingHeader) {
   }
 }
 
+// Verifies that a compressor is returned to the pool at the end of the response and used again by
+// the next one.
+TEST_F(GzipFilterTest, CompressorReused) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  doResponseCompression({{":method", "get"}, {"content-length", "256"}});
+  EXPECT_EQ(1, stats_.counter("test.gzip.compressor_pool_miss").value());
+  filter_->onDestroy();
+
+  filter_.reset(new GzipFilter(config_));
+  expected_str_.clear();
+  decompressed_data_.drain(decompressed_data_.length());
+  Decompressor::ZlibDecompressorImpl decompressor;
+  decompressor.init(31);
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  feedBuffer(512);
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "512"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, true));
+  decompressor.decompress(data_, decompressed_data_);
+  EXPECT_EQ(expected_str_, TestUtility::bufferToString(decompressed_data_));
+  EXPECT_EQ(1, stats_.counter("test.gzip.compressor_pool_hit").value());
+  EXPECT_EQ(1, stats_.counter("test.gzip.compressor_pool_miss").value());
+  EXPECT_EQ(0, stats_.counter("test.gzip.compressor_pool_overflow").value());
+}
+
+// Verifies that a compressor in the middle of a stream is reset before it is reused.
+TEST_F(GzipFilterTest, CompressorReleasedOnDestroy) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "256"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  feedBuffer(128);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, false));
+  filter_->onDestroy();
+
+  filter_.reset(new GzipFilter(config_));
+  drainBuffer();
+  expected_str_.clear();
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  feedBuffer(256);
+  Http::TestHeaderMapImpl response_headers{{":method", "get"}, {"content-length", "256"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, true));
+  decompressor_.decompress(data_, decompressed_data_);
+  EXPECT_EQ(expected_str_, TestUtility::bufferToString(decompressed_data_));
+  EXPECT_EQ(1, stats_.counter("test.gzip.compressor_pool_hit").value());
+}
+
+// Verifies that compressors are not kept when the pool is disabled.
+TEST_F(GzipFilterTest, CompressorPoolDisabled) {
+  setUpFilter(R"EOF({"compressor_pool_size": 0})EOF");
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  doResponseCompression({{":method", "get"}, {"content-length", "256"}});
+  EXPECT_EQ(1, stats_.counter("test.gzip.compressor_pool_overflow").value());
+  filter_->onDestroy();
+
+  filter_.reset(new GzipFilter(config_));
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "256"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_EQ(0, stats_.counter("test.gzip.compressor_pool_hit").value());
+  EXPECT_EQ(2, stats_.counter("test.gzip.compressor_pool_miss").value());
+}
+
+// Verifies that the minimum content length can be raised at runtime.
+TEST_F(GzipFilterTest, RuntimeMinimumContentLength) {
+  EXPECT_CALL(runtime_.snapshot_, getInteger("gzip.min_content_length", 30))
+      .WillRepeatedly(Return(1024));
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+  doResponseNoCompression({{":method", "get"}, {"content-length", "256"}});
+  EXPECT_EQ(1, stats_.counter("test.gzip.content_length_too_small").value());
+  EXPECT_EQ(0, stats_.counter("test.gzip.compressor_pool_miss").value());
+}
+
 } // namespace Gzip
 } // namespace HttpFilters
 } // namespace Extensions
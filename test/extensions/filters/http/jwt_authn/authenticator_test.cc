@@ -89,6 +89,72 @@ TEST_F(AuthenticatorTest, TestOkJWTandCache) {
   }
 
   EXPECT_EQ(mock_pubkey.called_count(), 1);
+  // The token is only verified once.
+  EXPECT_EQ(1U, filter_config_->stats().token_cache_miss_.value());
+  EXPECT_EQ(9U, filter_config_->stats().token_cache_hit_.value());
+}
+
+// This test verifies a cached token is verified again once its issuer has new keys.
+TEST_F(AuthenticatorTest, TestTokenCacheWithNewJwks) {
+  MockUpstream mock_pubkey(mock_factory_ctx_.cluster_manager_, PublicKey);
+
+  auto verify_good_token = [this]() {
+    auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+    MockAuthenticatorCallbacks mock_cb;
+    EXPECT_CALL(mock_cb, onComplete(_)).WillOnce(Invoke([](const Status& status) {
+      ASSERT_EQ(status, Status::Ok);
+    }));
+    auth_->verify(headers, &mock_cb);
+    EXPECT_EQ(headers.get_("sec-istio-auth-userinfo"), ExpectedPayloadValue);
+  };
+
+  verify_good_token();
+  verify_good_token();
+  EXPECT_EQ(1U, filter_config_->stats().token_cache_miss_.value());
+  EXPECT_EQ(1U, filter_config_->stats().token_cache_hit_.value());
+
+  auto jwks_data = filter_config_->getCache().getJwksCache().findByIssuer("https://example.com");
+  EXPECT_EQ(jwks_data->setRemoteJwks(PublicKey), Status::Ok);
+  verify_good_token();
+  EXPECT_EQ(2U, filter_config_->stats().token_cache_miss_.value());
+  EXPECT_EQ(1U, filter_config_->stats().token_cache_hit_.value());
+}
+
+// This test verifies a failed verification is cached too.
+TEST_F(AuthenticatorTest, TestTokenCacheWithFailedJwt) {
+  MockUpstream mock_pubkey(mock_factory_ctx_.cluster_manager_, PublicKey);
+
+  for (int i = 0; i < 2; i++) {
+    auto headers =
+        Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(NonExistKidToken)}};
+    MockAuthenticatorCallbacks mock_cb;
+    EXPECT_CALL(mock_cb, onComplete(_)).WillOnce(Invoke([](const Status& status) {
+      ASSERT_EQ(status, Status::JwtVerificationFail);
+    }));
+    auth_->verify(headers, &mock_cb);
+  }
+
+  EXPECT_EQ(1U, filter_config_->stats().token_cache_miss_.value());
+  EXPECT_EQ(1U, filter_config_->stats().token_cache_hit_.value());
+}
+
+// This test verifies tokens are verified every time if the token cache is disabled.
+TEST_F(AuthenticatorTest, TestTokenCacheDisabled) {
+  proto_config_.mutable_token_cache_size()->set_value(0);
+  CreateAuthenticator();
+
+  MockUpstream mock_pubkey(mock_factory_ctx_.cluster_manager_, PublicKey);
+  for (int i = 0; i < 2; i++) {
+    auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+    MockAuthenticatorCallbacks mock_cb;
+    EXPECT_CALL(mock_cb, onComplete(_)).WillOnce(Invoke([](const Status& status) {
+      ASSERT_EQ(status, Status::Ok);
+    }));
+    auth_->verify(headers, &mock_cb);
+  }
+
+  EXPECT_EQ(0U, filter_config_->stats().token_cache_miss_.value());
+  EXPECT_EQ(0U, filter_config_->stats().token_cache_hit_.value());
 }
 
 // This test verifies the Jwt is forwarded if "forward" flag is set.
@@ -44,9 +44,15 @@ TEST_F(JwksCacheTest, TestSetRemoteJwks) {
   auto jwks = cache_->findByIssuer("https://example.com");
   EXPECT_TRUE(jwks->getJwksObj() == nullptr);
 
+  EXPECT_EQ(jwks->getJwksGeneration(), 0);
   EXPECT_EQ(jwks->setRemoteJwks(PublicKey), Status::Ok);
   EXPECT_FALSE(jwks->getJwksObj() == nullptr);
   EXPECT_FALSE(jwks->isExpired());
+  EXPECT_EQ(jwks->getJwksGeneration(), 1);
+
+  // A bad Jwks keeps the current one.
+  EXPECT_NE(jwks->setRemoteJwks("BAD-JWKS"), Status::Ok);
+  EXPECT_EQ(jwks->getJwksGeneration(), 1);
 
   // cache duration is 1 second, sleep two seconds to expire it
   std::this_thread::sleep_for(std::chrono::seconds(2));
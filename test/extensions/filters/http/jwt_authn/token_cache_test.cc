@@ -0,0 +1,94 @@
+#include "extensions/filters/http/jwt_authn/token_cache.h"
+
+#include "test/extensions/filters/http/jwt_authn/test_common.h"
+
+#include "gtest/gtest.h"
+
+using ::google::jwt_verify::Jwt;
+using ::google::jwt_verify::Status;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+// The "exp" claim of GoodToken.
+const int64_t GoodTokenExp = 2001001001;
+
+class TokenCacheTest : public ::testing::Test {
+public:
+  TokenCacheTest() {
+    auto jwt = std::make_shared<Jwt>();
+    EXPECT_EQ(Status::Ok, jwt->parseFromString(GoodToken));
+    jwt_ = jwt;
+  }
+
+  TokenCache::Entry entry(Status status, uint64_t jwks_generation) {
+    return {jwt_, status, jwks_generation};
+  }
+
+  std::shared_ptr<const Jwt> jwt_;
+};
+
+TEST_F(TokenCacheTest, Digest) {
+  EXPECT_EQ(32, TokenCache::digest(GoodToken).size());
+  EXPECT_EQ(TokenCache::digest(GoodToken), TokenCache::digest(GoodToken));
+  EXPECT_NE(TokenCache::digest(GoodToken), TokenCache::digest(ExpiredToken));
+}
+
+TEST_F(TokenCacheTest, InsertAndLookup) {
+  TokenCache cache(10);
+  EXPECT_TRUE(cache.enabled());
+  EXPECT_EQ(nullptr, cache.lookup("a", 0));
+
+  EXPECT_FALSE(cache.insert("a", entry(Status::Ok, 1)));
+  const TokenCache::Entry* found = cache.lookup("a", 0);
+  ASSERT_NE(nullptr, found);
+  EXPECT_EQ(jwt_, found->jwt_);
+  EXPECT_EQ(Status::Ok, found->status_);
+  EXPECT_EQ(1, found->jwks_generation_);
+
+  // Inserting the same key replaces the entry.
+  EXPECT_FALSE(cache.insert("a", entry(Status::JwtVerificationFail, 2)));
+  EXPECT_EQ(1, cache.size());
+  found = cache.lookup("a", 0);
+  ASSERT_NE(nullptr, found);
+  EXPECT_EQ(Status::JwtVerificationFail, found->status_);
+  EXPECT_EQ(2, found->jwks_generation_);
+}
+
+TEST_F(TokenCacheTest, EvictsLeastRecentlyUsed) {
+  TokenCache cache(2);
+  EXPECT_FALSE(cache.insert("a", entry(Status::Ok, 1)));
+  EXPECT_FALSE(cache.insert("b", entry(Status::Ok, 1)));
+  // "a" becomes the most recently used, so "b" is evicted.
+  EXPECT_NE(nullptr, cache.lookup("a", 0));
+  EXPECT_TRUE(cache.insert("c", entry(Status::Ok, 1)));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_NE(nullptr, cache.lookup("a", 0));
+  EXPECT_EQ(nullptr, cache.lookup("b", 0));
+  EXPECT_NE(nullptr, cache.lookup("c", 0));
+}
+
+TEST_F(TokenCacheTest, ExpiresAtExp) {
+  TokenCache cache(10);
+  cache.insert("a", entry(Status::Ok, 1));
+  EXPECT_NE(nullptr, cache.lookup("a", GoodTokenExp));
+  EXPECT_EQ(nullptr, cache.lookup("a", GoodTokenExp + 1));
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST_F(TokenCacheTest, Disabled) {
+  TokenCache cache(0);
+  EXPECT_FALSE(cache.enabled());
+  EXPECT_FALSE(cache.insert("a", entry(Status::Ok, 1)));
+  EXPECT_EQ(nullptr, cache.lookup("a", 0));
+  EXPECT_EQ(0, cache.size());
+}
+
+} // namespace
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -79,6 +79,144 @@ TEST(BufferHelperTest, InvalidSize) {
   }
 }
 
+TEST(LazyDocumentImplTest, Decode) {
+  Field::ObjectId object_id;
+  object_id.fill(7);
+  DocumentSharedPtr doc =
+      DocumentImpl::create()
+          ->addDouble("double", 2.5)
+          ->addString("string", "hello")
+          ->addDocument("document", DocumentImpl::create()->addInt32("_id", 1))
+          ->addArray("array", DocumentImpl::create()->addInt64("0", 2)->addInt64("1", 3))
+          ->addBinary("binary", "\x01\x02")
+          ->addObjectId("object_id", std::move(object_id))
+          ->addBoolean("boolean", true)
+          ->addDatetime("datetime", 4)
+          ->addNull("null")
+          ->addRegex("regex", {"^a", "i"})
+          ->addInt32("int32", 5)
+          ->addTimestamp("timestamp", 6)
+          ->addInt64("int64", 7);
+
+  Buffer::OwnedImpl buffer;
+  doc->encode(buffer);
+  const std::string encoded = buffer.toString();
+  DocumentSharedPtr lazy = LazyDocumentImpl::create(buffer);
+  EXPECT_EQ(0U, buffer.length());
+
+  // Sizes and encoding come straight from the encoded bytes.
+  EXPECT_EQ(doc->byteSize(), lazy->byteSize());
+  lazy->encode(buffer);
+  EXPECT_EQ(encoded, buffer.toString());
+
+  EXPECT_EQ(5, lazy->find("int32")->asInt32());
+  EXPECT_EQ(lazy->find("int32"), lazy->find("int32", Field::Type::INT32));
+  EXPECT_EQ(nullptr, lazy->find("int32", Field::Type::INT64));
+  EXPECT_EQ(nullptr, lazy->find("missing"));
+  EXPECT_EQ("hello", lazy->find("string", Field::Type::STRING)->asString());
+  EXPECT_EQ(6, lazy->find("timestamp")->asTimestamp());
+  EXPECT_EQ(1, lazy->find("document")->asDocument().find("_id")->asInt32());
+  EXPECT_EQ(3, lazy->find("array")->asArray().find("1")->asInt64());
+  EXPECT_EQ("^a", lazy->find("regex")->asRegex().pattern_);
+
+  EXPECT_EQ(doc->toString(), lazy->toString());
+  EXPECT_TRUE(*doc == *lazy);
+  EXPECT_TRUE(*lazy == *doc);
+  EXPECT_EQ(13U, lazy->values().size());
+}
+
+TEST(LazyDocumentImplTest, Add) {
+  Buffer::OwnedImpl buffer;
+  DocumentImpl::create()->addString("hello", "world")->encode(buffer);
+  DocumentSharedPtr lazy = LazyDocumentImpl::create(buffer);
+  const Field* hello = lazy->find("hello");
+
+  EXPECT_EQ(lazy, lazy->addInt32("answer", 42));
+  EXPECT_EQ("world", hello->asString());
+  EXPECT_EQ(42, lazy->find("answer")->asInt32());
+
+  DocumentSharedPtr doc =
+      DocumentImpl::create()->addString("hello", "world")->addInt32("answer", 42);
+  EXPECT_EQ(doc->byteSize(), lazy->byteSize());
+  Buffer::OwnedImpl expected;
+  doc->encode(expected);
+  lazy->encode(buffer);
+  EXPECT_EQ(expected.toString(), buffer.toString());
+}
+
+TEST(LazyDocumentImplTest, Invalid) {
+  {
+    Buffer::OwnedImpl buffer;
+    BufferHelper::writeInt32(buffer, 100);
+    EXPECT_THROW(LazyDocumentImpl::create(buffer), EnvoyException);
+  }
+
+  {
+    Buffer::OwnedImpl buffer;
+    BufferHelper::writeInt32(buffer, 5);
+    uint8_t invalid_document_end = 0x1;
+    buffer.add(&invalid_document_end, sizeof(invalid_document_end));
+    EXPECT_THROW(LazyDocumentImpl::create(buffer), EnvoyException);
+  }
+
+  {
+    Buffer::OwnedImpl buffer;
+    std::string key_name("hello");
+    BufferHelper::writeInt32(buffer, 4 + 1 + key_name.size() + 1 + 1);
+    uint8_t invalid_element_type = 0x20;
+    buffer.add(&invalid_element_type, sizeof(invalid_element_type));
+    BufferHelper::writeCString(buffer, key_name);
+    uint8_t document_end = 0;
+    buffer.add(&document_end, sizeof(document_end));
+    EXPECT_THROW(LazyDocumentImpl::create(buffer), EnvoyException);
+  }
+
+  {
+    // A string that claims to be longer than the document.
+    Buffer::OwnedImpl buffer;
+    BufferHelper::writeInt32(buffer, 4 + 1 + 2 + 4 + 1);
+    uint8_t string_type = 0x02;
+    buffer.add(&string_type, sizeof(string_type));
+    BufferHelper::writeCString(buffer, "s");
+    BufferHelper::writeInt32(buffer, 100);
+    uint8_t document_end = 0;
+    buffer.add(&document_end, sizeof(document_end));
+    EXPECT_THROW(LazyDocumentImpl::create(buffer), EnvoyException);
+  }
+
+  {
+    // A corrupt element in an embedded document.
+    Buffer::OwnedImpl buffer;
+    DocumentImpl::create()
+        ->addString("string", "hello")
+        ->addDocument("document", DocumentImpl::create()->addInt32("_id", 1))
+        ->encode(buffer);
+    std::string encoded = buffer.toString();
+    const size_t id = encoded.find(std::string("\x10_id", 4));
+    ASSERT_NE(std::string::npos, id);
+    encoded[id] = 0x20;
+    buffer.drain(buffer.length());
+    buffer.add(encoded);
+    EXPECT_THROW(LazyDocumentImpl::create(buffer), EnvoyException);
+  }
+
+  {
+    // An embedded document that runs past the end of the document that contains it.
+    Buffer::OwnedImpl buffer;
+    DocumentImpl::create()
+        ->addDocument("document", DocumentImpl::create()->addInt32("_id", 1))
+        ->addString("string", "hello")
+        ->encode(buffer);
+    std::string encoded = buffer.toString();
+    const size_t document = encoded.find(std::string("\x03" "document\0", 10));
+    ASSERT_NE(std::string::npos, document);
+    encoded[document + 10] = 100;
+    buffer.drain(buffer.length());
+    buffer.add(encoded);
+    EXPECT_THROW(LazyDocumentImpl::create(buffer), EnvoyException);
+  }
+}
+
 } // namespace Bson
 } // namespace MongoProxy
 } // namespace NetworkFilters
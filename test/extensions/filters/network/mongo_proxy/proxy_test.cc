@@ -427,6 +427,31 @@ TEST_F(MongoProxyFilterTest, DecodeError) {
   EXPECT_EQ(1U, store_.counter("test.decoding_error").value());
 }
 
+TEST_F(MongoProxyFilterTest, DecodeErrorCorruptElement) {
+  initializeFilter();
+
+  QueryMessageImpl message(1, 0);
+  message.fullCollectionName("db.test");
+  message.query(Bson::DocumentImpl::create()->addInt32("hello", 1));
+  Buffer::OwnedImpl buffer;
+  EncoderImpl(buffer).encodeQuery(message);
+
+  // Replace the type of the query's only element with an invalid one.
+  std::string encoded = buffer.toString();
+  const size_t element = encoded.find(std::string("\x10hello", 6));
+  ASSERT_NE(std::string::npos, element);
+  encoded[element] = 0x20;
+  fake_data_.add(encoded);
+
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    DecoderImpl(*filter_->callbacks_).onData(data);
+  }));
+  filter_->onData(fake_data_, false);
+
+  EXPECT_EQ(1U, store_.counter("test.decoding_error").value());
+  EXPECT_EQ(0U, store_.counter("test.op_query").value());
+}
+
 TEST_F(MongoProxyFilterTest, ConcurrentQueryWithDrainClose) {
   initializeFilter();
 
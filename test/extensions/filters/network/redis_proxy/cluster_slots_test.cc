@@ -0,0 +1,122 @@
+#include <string>
+#include <vector>
+
+#include "extensions/filters/network/redis_proxy/cluster_slots.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+namespace {
+
+RespValue integer(int64_t value) {
+  RespValue ret;
+  ret.type(RespType::Integer);
+  ret.asInteger() = value;
+  return ret;
+}
+
+RespValue bulkString(const std::string& value) {
+  RespValue ret;
+  ret.type(RespType::BulkString);
+  ret.asString() = value;
+  return ret;
+}
+
+RespValue array(std::vector<RespValue>&& values) {
+  RespValue ret;
+  ret.type(RespType::Array);
+  ret.asArray().swap(values);
+  return ret;
+}
+
+RespValue slotRange(int64_t start, int64_t end, const std::string& ip, int64_t port) {
+  return array({integer(start), integer(end), array({bulkString(ip), integer(port)})});
+}
+
+RespValue error(const std::string& message) {
+  RespValue ret;
+  ret.type(RespType::Error);
+  ret.asString() = message;
+  return ret;
+}
+
+} // namespace
+
+TEST(RedisSlotMapTest, KeySlot) {
+  EXPECT_EQ(12739, SlotMap::keySlot("123456789"));
+  EXPECT_EQ(12182, SlotMap::keySlot("foo"));
+  EXPECT_EQ(11058, SlotMap::keySlot("somekey"));
+
+  // Only the hash tag is hashed.
+  EXPECT_EQ(3443, SlotMap::keySlot("user1000"));
+  EXPECT_EQ(3443, SlotMap::keySlot("{user1000}.following"));
+  EXPECT_EQ(3443, SlotMap::keySlot("{user1000}.followers"));
+  EXPECT_EQ(4015, SlotMap::keySlot("foo{{bar}}zap"));
+
+  // An empty or unterminated hash tag hashes the whole key.
+  EXPECT_EQ(8363, SlotMap::keySlot("foo{}{bar}"));
+  EXPECT_EQ(15278, SlotMap::keySlot("foo{bar"));
+}
+
+TEST(RedisSlotMapTest, Create) {
+  RespValue response = array({slotRange(0, 5460, "10.0.0.1", 6379),
+                              slotRange(5461, 10922, "10.0.0.2", 6379),
+                              slotRange(10923, 16000, "10.0.0.1", 6379)});
+  SlotMapConstSharedPtr slot_map = SlotMap::create(response);
+  ASSERT_NE(nullptr, slot_map);
+
+  EXPECT_EQ("10.0.0.1:6379", *slot_map->primary(0));
+  EXPECT_EQ("10.0.0.1:6379", *slot_map->primary(5460));
+  EXPECT_EQ("10.0.0.2:6379", *slot_map->primary(5461));
+  EXPECT_EQ("10.0.0.2:6379", *slot_map->primary(10922));
+  EXPECT_EQ("10.0.0.1:6379", *slot_map->primary(10923));
+  EXPECT_EQ(nullptr, slot_map->primary(16001));
+  EXPECT_EQ(nullptr, slot_map->primary(SlotMap::SLOT_COUNT - 1));
+}
+
+TEST(RedisSlotMapTest, CreateIgnoresReplicas) {
+  RespValue primary =
+      array({bulkString("10.0.0.1"), integer(6379), bulkString("09dbe9720cda62f7865eabc5fd")});
+  RespValue replica = array({bulkString("10.0.0.2"), integer(6380)});
+  RespValue response = array({array({integer(0), integer(16383), primary, replica})});
+  SlotMapConstSharedPtr slot_map = SlotMap::create(response);
+  ASSERT_NE(nullptr, slot_map);
+  EXPECT_EQ("10.0.0.1:6379", *slot_map->primary(0));
+  EXPECT_EQ("10.0.0.1:6379", *slot_map->primary(16383));
+}
+
+TEST(RedisSlotMapTest, CreateInvalid) {
+  EXPECT_EQ(nullptr, SlotMap::create(error("ERR This instance has cluster support disabled")));
+  EXPECT_EQ(nullptr, SlotMap::create(array({integer(0)})));
+  EXPECT_EQ(nullptr, SlotMap::create(array({slotRange(10, 5, "10.0.0.1", 6379)})));
+  EXPECT_EQ(nullptr, SlotMap::create(array({slotRange(0, 16384, "10.0.0.1", 6379)})));
+  EXPECT_EQ(nullptr, SlotMap::create(array({slotRange(0, 100, "10.0.0.1", 0)})));
+  EXPECT_EQ(nullptr, SlotMap::create(array({slotRange(0, 100, "redis-1", 6379)})));
+}
+
+TEST(RedisSlotMapTest, ParseRedirection) {
+  absl::optional<Redirection> moved = SlotMap::parseRedirection(error("MOVED 3999 10.0.0.1:6381"));
+  ASSERT_TRUE(moved.has_value());
+  EXPECT_FALSE(moved.value().ask_);
+  EXPECT_EQ(3999, moved.value().slot_);
+  EXPECT_EQ("10.0.0.1:6381", moved.value().address_);
+
+  absl::optional<Redirection> ask = SlotMap::parseRedirection(error("ASK 3999 [::1]:6381"));
+  ASSERT_TRUE(ask.has_value());
+  EXPECT_TRUE(ask.value().ask_);
+  EXPECT_EQ("[::1]:6381", ask.value().address_);
+
+  EXPECT_FALSE(SlotMap::parseRedirection(bulkString("MOVED 3999 10.0.0.1:6381")).has_value());
+  EXPECT_FALSE(SlotMap::parseRedirection(error("ERR unknown command")).has_value());
+  EXPECT_FALSE(SlotMap::parseRedirection(error("MOVED 16384 10.0.0.1:6381")).has_value());
+  EXPECT_FALSE(SlotMap::parseRedirection(error("MOVED 3999 :6381")).has_value());
+}
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
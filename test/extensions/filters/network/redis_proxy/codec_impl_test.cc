@@ -158,6 +158,31 @@ TEST_F(RedisEncoderDecoderImplTest, NestedArray) {
   EXPECT_EQ(value, *decoded_values_[0]);
 }
 
+TEST_F(RedisEncoderDecoderImplTest, OwnedArray) {
+  const std::string large_string(EncoderImpl::MIN_MOVED_BULK_STRING_SIZE, 'a');
+  std::vector<RespValue> values(4);
+  values[0].type(RespType::BulkString);
+  values[0].asString() = "hello";
+  values[1].type(RespType::BulkString);
+  values[1].asString() = large_string;
+  values[2].type(RespType::Integer);
+  values[2].asInteger() = -5;
+
+  RespValuePtr value(new RespValue());
+  value->type(RespType::Array);
+  value->asArray().swap(values);
+  Buffer::OwnedImpl expected;
+  encoder_.encode(*value, expected);
+
+  // The large string is handed over to the buffer, which has to produce the same bytes.
+  encoder_.encode(std::move(value), buffer_);
+  EXPECT_EQ(nullptr, value);
+  EXPECT_EQ(TestUtility::bufferToString(expected), TestUtility::bufferToString(buffer_));
+  decoder_.decode(buffer_);
+  EXPECT_EQ(large_string, decoded_values_[0]->asArray()[1].asString());
+  EXPECT_EQ(0UL, buffer_.length());
+}
+
 TEST_F(RedisEncoderDecoderImplTest, NullArray) {
   buffer_.add("*-1\r\n");
   decoder_.decode(buffer_);
@@ -6,6 +6,7 @@
 
 #include "extensions/filters/network/redis_proxy/conn_pool_impl.h"
 
+#include "test/common/upstream/utility.h"
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
@@ -15,6 +16,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::DoAll;
 using testing::Eq;
 using testing::InSequence;
 using testing::Invoke;
@@ -22,6 +24,7 @@ using testing::Ref;
 using testing::Return;
 using testing::ReturnRef;
 using testing::SaveArg;
+using testing::WithArg;
 using testing::_;
 
 namespace Envoy {
@@ -300,6 +303,12 @@ TEST_F(RedisClientImplTest, ConnectFail) {
 class ConfigOutlierDisabled : public Config {
   bool disableOutlierEvents() const override { return true; }
   std::chrono::milliseconds opTimeout() const override { return std::chrono::milliseconds(25); }
+  bool enableBatching() const override { return false; }
+  uint32_t maxBufferSizeBeforeFlush() const override { return 0; }
+  uint32_t maxRequestsBeforeFlush() const override { return 0; }
+  std::chrono::milliseconds bufferFlushTimeout() const override {
+    return std::chrono::milliseconds(0);
+  }
 };
 
 TEST_F(RedisClientImplTest, OutlierDisabled) {
@@ -366,6 +375,136 @@ TEST_F(RedisClientImplTest, OpTimeout) {
   EXPECT_EQ(1UL, host_->stats_.rq_timeout_.value());
 }
 
+envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings
+createBatchingConnPoolSettings(uint32_t max_buffer_size, uint32_t max_requests) {
+  envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings setting =
+      createConnPoolSettings();
+  auto* batch_settings = setting.mutable_batch_settings();
+  batch_settings->set_max_buffer_size_before_flush(max_buffer_size);
+  batch_settings->set_max_requests_before_flush(max_requests);
+  return setting;
+}
+
+TEST(RedisConfigImplTest, BatchSettings) {
+  {
+    ConfigImpl config(createConnPoolSettings());
+    EXPECT_FALSE(config.enableBatching());
+  }
+  {
+    envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings setting =
+        createBatchingConnPoolSettings(1024, 16);
+    setting.mutable_batch_settings()->mutable_buffer_flush_timeout()->CopyFrom(
+        Protobuf::util::TimeUtil::MillisecondsToDuration(3));
+    ConfigImpl config(setting);
+    EXPECT_TRUE(config.enableBatching());
+    EXPECT_EQ(1024U, config.maxBufferSizeBeforeFlush());
+    EXPECT_EQ(16U, config.maxRequestsBeforeFlush());
+    EXPECT_EQ(std::chrono::milliseconds(3), config.bufferFlushTimeout());
+  }
+}
+
+TEST_F(RedisClientImplTest, BatchFlushOnTimer) {
+  InSequence s;
+
+  setup(std::make_unique<ConfigImpl>(createBatchingConnPoolSettings(0, 0)));
+
+  RespValue request1;
+  MockPoolCallbacks callbacks1;
+  EXPECT_CALL(*encoder_, encode(Ref(request1), _));
+  // The flush timer is created with the first batch.
+  Event::MockTimer* flush_timer = new Event::MockTimer(&dispatcher_);
+  EXPECT_CALL(*flush_timer, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_CALL(*upstream_connection_, write(_, _)).Times(0);
+  EXPECT_NE(nullptr, client_->makeRequest(request1, callbacks1));
+
+  RespValue request2;
+  MockPoolCallbacks callbacks2;
+  EXPECT_CALL(*encoder_, encode(Ref(request2), _));
+  EXPECT_NE(nullptr, client_->makeRequest(request2, callbacks2));
+
+  EXPECT_CALL(*upstream_connection_, write(_, false));
+  flush_timer->callback_();
+
+  // The next request opens a new batch.
+  RespValue request3;
+  MockPoolCallbacks callbacks3;
+  EXPECT_CALL(*encoder_, encode(Ref(request3), _));
+  EXPECT_CALL(*flush_timer, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_NE(nullptr, client_->makeRequest(request3, callbacks3));
+
+  EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks1, onFailure());
+  EXPECT_CALL(callbacks2, onFailure());
+  EXPECT_CALL(callbacks3, onFailure());
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  EXPECT_CALL(*flush_timer, disableTimer());
+  client_->close();
+}
+
+TEST_F(RedisClientImplTest, BatchFlushOnRequestLimit) {
+  InSequence s;
+
+  setup(std::make_unique<ConfigImpl>(createBatchingConnPoolSettings(0, 2)));
+
+  RespValue request1;
+  MockPoolCallbacks callbacks1;
+  EXPECT_CALL(*encoder_, encode(Ref(request1), _));
+  // The flush timer is created with the first batch.
+  Event::MockTimer* flush_timer = new Event::MockTimer(&dispatcher_);
+  EXPECT_CALL(*flush_timer, enableTimer(_));
+  EXPECT_CALL(*upstream_connection_, write(_, _)).Times(0);
+  EXPECT_NE(nullptr, client_->makeRequest(request1, callbacks1));
+
+  RespValue request2;
+  MockPoolCallbacks callbacks2;
+  EXPECT_CALL(*encoder_, encode(Ref(request2), _));
+  EXPECT_CALL(*flush_timer, disableTimer());
+  EXPECT_CALL(*upstream_connection_, write(_, false));
+  EXPECT_NE(nullptr, client_->makeRequest(request2, callbacks2));
+
+  EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks1, onFailure());
+  EXPECT_CALL(callbacks2, onFailure());
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  EXPECT_CALL(*flush_timer, disableTimer());
+  client_->close();
+}
+
+TEST_F(RedisClientImplTest, BatchFlushOnBufferLimit) {
+  InSequence s;
+
+  setup(std::make_unique<ConfigImpl>(createBatchingConnPoolSettings(8, 0)));
+  const auto encode_five_bytes = [](const RespValue&, Buffer::Instance& out) -> void {
+    out.add("12345");
+  };
+
+  RespValue request1;
+  MockPoolCallbacks callbacks1;
+  EXPECT_CALL(*encoder_, encode(Ref(request1), _)).WillOnce(Invoke(encode_five_bytes));
+  Event::MockTimer* flush_timer = new Event::MockTimer(&dispatcher_);
+  EXPECT_CALL(*flush_timer, enableTimer(_));
+  EXPECT_CALL(*upstream_connection_, write(_, _)).Times(0);
+  EXPECT_NE(nullptr, client_->makeRequest(request1, callbacks1));
+
+  RespValue request2;
+  MockPoolCallbacks callbacks2;
+  EXPECT_CALL(*encoder_, encode(Ref(request2), _)).WillOnce(Invoke(encode_five_bytes));
+  EXPECT_CALL(*flush_timer, disableTimer());
+  EXPECT_CALL(*upstream_connection_, write(_, false))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ(10U, data.length());
+        data.drain(data.length());
+      }));
+  EXPECT_NE(nullptr, client_->makeRequest(request2, callbacks2));
+
+  EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks1, onFailure());
+  EXPECT_CALL(callbacks2, onFailure());
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  EXPECT_CALL(*flush_timer, disableTimer());
+  client_->close();
+}
+
 TEST(RedisClientFactoryImplTest, Basic) {
   ClientFactoryImpl factory;
   Upstream::MockHost::MockCreateConnectionData conn_info;
@@ -381,7 +520,8 @@ TEST(RedisClientFactoryImplTest, Basic) {
 class RedisConnPoolImplTest : public testing::Test, public ClientFactory {
 public:
   RedisConnPoolImplTest() {
-    conn_pool_.reset(new InstanceImpl(cluster_name_, cm_, *this, tls_, createConnPoolSettings()));
+    conn_pool_.reset(
+        new InstanceImpl(cluster_name_, cm_, *this, tls_, dispatcher_, createConnPoolSettings()));
   }
 
   // RedisProxy::ConnPool::ClientFactory
@@ -394,6 +534,7 @@ public:
   const std::string cluster_name_{"foo"};
   NiceMock<Upstream::MockClusterManager> cm_;
   NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
   InstancePtr conn_pool_;
 };
 
@@ -494,6 +635,286 @@ TEST_F(RedisConnPoolImplTest, RemoteClose) {
   tls_.shutdownThread();
 }
 
+
+RespValue bulkStringArray(const std::vector<std::string>& strings) {
+  std::vector<RespValue> values(strings.size());
+  for (uint64_t i = 0; i < strings.size(); i++) {
+    values[i].type(RespType::BulkString);
+    values[i].asString() = strings[i];
+  }
+
+  RespValue value;
+  value.type(RespType::Array);
+  value.asArray().swap(values);
+  return value;
+}
+
+RespValuePtr error(const std::string& message) {
+  RespValuePtr value(new RespValue());
+  value->type(RespType::Error);
+  value->asString() = message;
+  return value;
+}
+
+class RedisClusterConnPoolImplTest : public RedisConnPoolImplTest {
+public:
+  RedisClusterConnPoolImplTest() {
+    cm_.thread_local_cluster_.cluster_.prioritySet().getMockHostSet(0)->hosts_ = {host1_, host2_};
+
+    envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings settings =
+        createConnPoolSettings();
+    settings.mutable_redis_cluster();
+    refresh_timer_ = new Event::MockTimer(&dispatcher_);
+    EXPECT_CALL(*refresh_timer_, enableTimer(std::chrono::milliseconds(0)));
+    conn_pool_.reset(new InstanceImpl(cluster_name_, cm_, *this, tls_, dispatcher_, settings));
+  }
+
+  // Fetches a slot map in which host1_ serves slots 0-8191 and host2_ serves slots 8192-16383.
+  void refreshSlots() {
+    MockClient* client = new NiceMock<MockClient>();
+    MockPoolRequest active_request;
+    PoolCallbacks* callbacks{};
+    EXPECT_CALL(*this, create_(Eq(host1_))).WillOnce(Return(client));
+    EXPECT_CALL(*client, makeRequest(_, _))
+        .WillOnce(Invoke([&](const RespValue& request, PoolCallbacks& cb) -> PoolRequest* {
+          EXPECT_EQ(bulkStringArray({"CLUSTER", "SLOTS"}).toString(), request.toString());
+          callbacks = &cb;
+          return &active_request;
+        }));
+    refresh_timer_->callback_();
+
+    RespValuePtr response(new RespValue());
+    response->type(RespType::Array);
+    response->asArray().resize(2);
+    slotRange(response->asArray()[0], 0, 8191, "10.0.0.1");
+    slotRange(response->asArray()[1], 8192, 16383, "10.0.0.2");
+    EXPECT_CALL(*refresh_timer_, enableTimer(std::chrono::milliseconds(5000)));
+    callbacks->onResponse(std::move(response));
+  }
+
+  void slotRange(RespValue& value, int64_t start, int64_t end, const std::string& ip) {
+    value.type(RespType::Array);
+    value.asArray().resize(3);
+    value.asArray()[0].type(RespType::Integer);
+    value.asArray()[0].asInteger() = start;
+    value.asArray()[1].type(RespType::Integer);
+    value.asArray()[1].asInteger() = end;
+    RespValue& node = value.asArray()[2];
+    node.type(RespType::Array);
+    node.asArray().resize(2);
+    node.asArray()[0].type(RespType::BulkString);
+    node.asArray()[0].asString() = ip;
+    node.asArray()[1].type(RespType::Integer);
+    node.asArray()[1].asInteger() = 6379;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return cm_.thread_local_cluster_.cluster_.info_->stats_store_.counter(name).value();
+  }
+
+  Upstream::HostSharedPtr host1_{Upstream::makeTestHost(cm_.thread_local_cluster_.cluster_.info_,
+                                                        "tcp://10.0.0.1:6379")};
+  Upstream::HostSharedPtr host2_{Upstream::makeTestHost(cm_.thread_local_cluster_.cluster_.info_,
+                                                        "tcp://10.0.0.2:6379")};
+  Event::MockTimer* refresh_timer_;
+};
+
+TEST_F(RedisClusterConnPoolImplTest, NoSlotMap) {
+  RespValue value = bulkStringArray({"GET", "foo"});
+  MockPoolRequest active_request;
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+
+  // Until the slot map is known, the load balancer picks the host.
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(host1_));
+  EXPECT_CALL(*this, create_(Eq(host1_))).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(Ref(value), _)).WillOnce(Return(&active_request));
+  PoolRequest* request = conn_pool_->makeRequest("foo", value, callbacks);
+  EXPECT_NE(nullptr, request);
+
+  EXPECT_CALL(active_request, cancel());
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  request->cancel();
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, RouteBySlot) {
+  refreshSlots();
+
+  RespValue value = bulkStringArray({"GET", "foo"});
+  MockPoolRequest active_request;
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+  PoolCallbacks* client_callbacks{};
+
+  // "foo" hashes to slot 12182.
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).Times(0);
+  EXPECT_CALL(*this, create_(Eq(host2_))).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(Ref(value), _))
+      .WillOnce(DoAll(WithArg<1>(Invoke([&](PoolCallbacks& cb) { client_callbacks = &cb; })),
+                      Return(&active_request)));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  RespValuePtr response(new RespValue());
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(callbacks, onResponse_(Ref(response)));
+  client_callbacks->onResponse(std::move(response));
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, Moved) {
+  refreshSlots();
+
+  RespValue value = bulkStringArray({"GET", "foo"});
+  MockPoolCallbacks callbacks;
+  MockClient* client1 = new NiceMock<MockClient>();
+  MockClient* client2 = new NiceMock<MockClient>();
+  MockPoolRequest active_request1;
+  MockPoolRequest active_request2;
+  PoolCallbacks* client_callbacks1{};
+  PoolCallbacks* client_callbacks2{};
+
+  EXPECT_CALL(*this, create_(Eq(host2_))).WillOnce(Return(client2));
+  EXPECT_CALL(*client2, makeRequest(Ref(value), _))
+      .WillOnce(DoAll(WithArg<1>(Invoke([&](PoolCallbacks& cb) { client_callbacks2 = &cb; })),
+                      Return(&active_request2)));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  // The request is sent again to the node named by the redirection.
+  EXPECT_CALL(*this, create_(Eq(host1_))).WillOnce(Return(client1));
+  EXPECT_CALL(*client1, makeRequest(_, _))
+      .WillOnce(Invoke([&](const RespValue& redirected, PoolCallbacks& cb) -> PoolRequest* {
+        EXPECT_EQ(value.toString(), redirected.toString());
+        client_callbacks1 = &cb;
+        return &active_request1;
+      }));
+  client_callbacks2->onResponse(error("MOVED 12182 10.0.0.1:6379"));
+  EXPECT_EQ(1UL, counter("redis.upstream_moved"));
+
+  // A second redirection is passed through.
+  RespValuePtr response = error("MOVED 12182 10.0.0.2:6379");
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(callbacks, onResponse_(Ref(response)));
+  client_callbacks1->onResponse(std::move(response));
+  EXPECT_EQ(1UL, counter("redis.upstream_moved"));
+
+  EXPECT_CALL(*client1, close());
+  EXPECT_CALL(*client2, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, Ask) {
+  refreshSlots();
+
+  RespValue value = bulkStringArray({"GET", "foo"});
+  MockPoolCallbacks callbacks;
+  MockClient* client1 = new NiceMock<MockClient>();
+  MockClient* client2 = new NiceMock<MockClient>();
+  MockPoolRequest active_request1;
+  MockPoolRequest active_request2;
+  PoolCallbacks* client_callbacks2{};
+
+  EXPECT_CALL(*this, create_(Eq(host2_))).WillOnce(Return(client2));
+  EXPECT_CALL(*client2, makeRequest(Ref(value), _))
+      .WillOnce(DoAll(WithArg<1>(Invoke([&](PoolCallbacks& cb) { client_callbacks2 = &cb; })),
+                      Return(&active_request2)));
+  PoolRequest* request = conn_pool_->makeRequest("foo", value, callbacks);
+  EXPECT_NE(nullptr, request);
+
+  // The redirected request is preceded by ASKING.
+  InSequence s;
+  EXPECT_CALL(*this, create_(Eq(host1_))).WillOnce(Return(client1));
+  EXPECT_CALL(*client1, makeRequest(_, _))
+      .WillOnce(Invoke([&](const RespValue& asking, PoolCallbacks&) -> PoolRequest* {
+        EXPECT_EQ(bulkStringArray({"ASKING"}).toString(), asking.toString());
+        return &active_request1;
+      }));
+  EXPECT_CALL(*client1, makeRequest(_, _))
+      .WillOnce(Invoke([&](const RespValue& redirected, PoolCallbacks&) -> PoolRequest* {
+        EXPECT_EQ(value.toString(), redirected.toString());
+        return &active_request1;
+      }));
+  client_callbacks2->onResponse(error("ASK 12182 10.0.0.1:6379"));
+  EXPECT_EQ(1UL, counter("redis.upstream_ask"));
+
+  EXPECT_CALL(active_request1, cancel());
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  request->cancel();
+
+  EXPECT_CALL(*client1, close());
+  EXPECT_CALL(*client2, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, RedirectToUnknownHost) {
+  refreshSlots();
+
+  RespValue value = bulkStringArray({"GET", "foo"});
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+  MockPoolRequest active_request;
+  PoolCallbacks* client_callbacks{};
+
+  EXPECT_CALL(*this, create_(Eq(host2_))).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(Ref(value), _))
+      .WillOnce(DoAll(WithArg<1>(Invoke([&](PoolCallbacks& cb) { client_callbacks = &cb; })),
+                      Return(&active_request)));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  // Nodes that are not hosts of the cluster are never connected to.
+  RespValuePtr response = error("MOVED 12182 10.0.0.3:6379");
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(callbacks, onResponse_(Ref(response)));
+  client_callbacks->onResponse(std::move(response));
+  EXPECT_EQ(0UL, counter("redis.upstream_moved"));
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, RefreshFailure) {
+  MockClient* client = new NiceMock<MockClient>();
+  MockPoolRequest active_request;
+  PoolCallbacks* callbacks{};
+  EXPECT_CALL(*this, create_(Eq(host1_))).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(_, _))
+      .WillOnce(DoAll(WithArg<1>(Invoke([&](PoolCallbacks& cb) { callbacks = &cb; })),
+                      Return(&active_request)));
+  refresh_timer_->callback_();
+
+  EXPECT_CALL(*refresh_timer_, enableTimer(std::chrono::milliseconds(5000)));
+  callbacks->onFailure();
+
+  // The next refresh asks the next host once the connection is closed.
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  client->raiseEvent(Network::ConnectionEvent::RemoteClose);
+
+  client = new NiceMock<MockClient>();
+  EXPECT_CALL(*this, create_(Eq(host2_))).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(_, _)).WillOnce(Return(&active_request));
+  refresh_timer_->callback_();
+
+  EXPECT_CALL(active_request, cancel());
+  EXPECT_CALL(*client, close());
+  conn_pool_.reset();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, SlotMapPostedAfterDestroy) {
+  // Hold back the slot map update posted to the worker.
+  Event::PostCb update;
+  EXPECT_CALL(tls_.dispatcher_, post(_)).WillOnce(SaveArg<0>(&update));
+  refreshSlots();
+
+  // The pool is destroyed, e.g. when its listener is removed, before the worker runs the update.
+  conn_pool_.reset();
+  update();
+  tls_.shutdownThread();
+}
+
 } // namespace ConnPool
 } // namespace RedisProxy
 } // namespace NetworkFilters
@@ -30,6 +30,8 @@ public:
   MockEncoder();
   ~MockEncoder();
 
+  // Owned values are encoded through the const overload so that tests can match on them.
+  void encode(RespValuePtr&& value, Buffer::Instance& out) override { encode(*value, out); }
   MOCK_METHOD2(encode, void(const RespValue& value, Buffer::Instance& out));
 
 private:
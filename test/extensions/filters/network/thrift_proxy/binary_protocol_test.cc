@@ -627,6 +627,61 @@ TEST(BinaryProtocolTest, ReadBinary) {
   EXPECT_EQ(buffer.length(), 0);
 }
 
+TEST(BinaryProtocolTest, SkipString) {
+  StrictMock<MockProtocolCallbacks> cb;
+  BinaryProtocolImpl proto(cb);
+
+  // Insufficient data to read length
+  {
+    Buffer::OwnedImpl buffer;
+    addRepeated(buffer, 3, 0);
+
+    EXPECT_FALSE(proto.skipString(buffer));
+    EXPECT_EQ(buffer.length(), 3);
+  }
+
+  // Insufficient data to skip string
+  {
+    Buffer::OwnedImpl buffer;
+    addInt32(buffer, 6);
+    addString(buffer, "str");
+
+    EXPECT_FALSE(proto.skipString(buffer));
+    EXPECT_EQ(buffer.length(), 7);
+  }
+
+  // Invalid length
+  {
+    Buffer::OwnedImpl buffer;
+    addInt32(buffer, -1);
+
+    EXPECT_THROW_WITH_MESSAGE(proto.skipString(buffer), EnvoyException,
+                              "negative binary protocol string/binary length -1");
+    EXPECT_EQ(buffer.length(), 4);
+  }
+
+  // empty string
+  {
+    Buffer::OwnedImpl buffer;
+    addInt32(buffer, 0);
+    addString(buffer, "next");
+
+    EXPECT_TRUE(proto.skipString(buffer));
+    EXPECT_EQ(TestUtility::bufferToString(buffer), "next");
+  }
+
+  // non-empty string
+  {
+    Buffer::OwnedImpl buffer;
+    addInt32(buffer, 6);
+    addString(buffer, "string");
+    addString(buffer, "next");
+
+    EXPECT_TRUE(proto.skipString(buffer));
+    EXPECT_EQ(TestUtility::bufferToString(buffer), "next");
+  }
+}
+
 TEST(LaxBinaryProtocolTest, Name) {
   StrictMock<MockProtocolCallbacks> cb;
   LaxBinaryProtocolImpl proto(cb);
@@ -1023,6 +1023,67 @@ TEST(CompactProtocolTest, ReadBinary) {
   EXPECT_EQ(buffer.length(), 0);
 }
 
+TEST(CompactProtocolTest, SkipString) {
+  StrictMock<MockProtocolCallbacks> cb;
+  CompactProtocolImpl proto(cb);
+
+  // Insufficient data
+  {
+    Buffer::OwnedImpl buffer;
+    EXPECT_FALSE(proto.skipString(buffer));
+    EXPECT_EQ(buffer.length(), 0);
+  }
+
+  // Insufficient data to read length
+  {
+    Buffer::OwnedImpl buffer;
+    addInt8(buffer, 0x81);
+
+    EXPECT_FALSE(proto.skipString(buffer));
+    EXPECT_EQ(buffer.length(), 1);
+  }
+
+  // Insufficient data to skip string
+  {
+    Buffer::OwnedImpl buffer;
+    addInt8(buffer, 0x8); // zigzag(8) = 4
+
+    EXPECT_FALSE(proto.skipString(buffer));
+    EXPECT_EQ(buffer.length(), 1);
+  }
+
+  // Invalid length
+  {
+    Buffer::OwnedImpl buffer;
+    addInt8(buffer, 0x01); // zigzag(1) = -1
+
+    EXPECT_THROW_WITH_MESSAGE(proto.skipString(buffer), EnvoyException,
+                              "negative compact protocol string/binary length -1");
+    EXPECT_EQ(buffer.length(), 1);
+  }
+
+  // empty string
+  {
+    Buffer::OwnedImpl buffer;
+    addInt8(buffer, 0);
+    addString(buffer, "next");
+
+    EXPECT_TRUE(proto.skipString(buffer));
+    EXPECT_EQ(TestUtility::bufferToString(buffer), "next");
+  }
+
+  // non-empty string
+  {
+    Buffer::OwnedImpl buffer;
+    addInt8(buffer, 0x0C); // zigzag(0x0C) = 0x06
+    addString(buffer, "string");
+    addString(buffer, "next");
+
+    EXPECT_TRUE(proto.skipString(buffer));
+    EXPECT_EQ(TestUtility::bufferToString(buffer), "next");
+  }
+}
+
 class CompactProtocolFieldTypeTest : public TestWithParam<uint8_t> {};
 
 TEST_P(CompactProtocolFieldTypeTest, ConvertsToFieldType) {
@@ -3,6 +3,7 @@
 #include "extensions/filters/network/thrift_proxy/decoder.h"
 
 #include "test/extensions/filters/network/thrift_proxy/mocks.h"
+#include "test/extensions/filters/network/thrift_proxy/utility.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
 
@@ -15,6 +16,7 @@ using testing::DoAll;
 using testing::Expectation;
 using testing::ExpectationSet;
 using testing::InSequence;
+using testing::Invoke;
 using testing::NiceMock;
 using testing::Ref;
 using testing::Return;
@@ -579,6 +581,122 @@ TEST_P(DecoderStateMachineNestingTest, NestedTypes) {
   EXPECT_EQ(dsm.currentState(), ProtocolState::Done);
 }
 
+TEST(DecoderStateMachineTest, PassthroughFramed) {
+  Buffer::OwnedImpl buffer;
+  NiceMock<MockProtocol> proto;
+  InSequence dummy;
+
+  addRepeated(buffer, 30, 'x');
+
+  EXPECT_CALL(proto, readMessageBegin(Ref(buffer), _, _, _))
+      .WillOnce(Invoke([](Buffer::Instance& data, std::string&, MessageType&, int32_t&) -> bool {
+        data.drain(8);
+        return true;
+      }));
+  EXPECT_CALL(proto, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(proto, readFieldBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<2>(FieldType::String), SetArgReferee<3>(0), Return(true)));
+  EXPECT_CALL(proto, readString(_, _)).Times(0);
+  EXPECT_CALL(proto, skipString(_)).Times(0);
+  EXPECT_CALL(proto, readMessageEnd(Ref(buffer))).WillOnce(Return(true));
+
+  DecoderStateMachine dsm(proto, true, 20U);
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::Done);
+  EXPECT_EQ(buffer.length(), 10);
+}
+
+TEST(DecoderStateMachineTest, PassthroughFramedResumes) {
+  Buffer::OwnedImpl buffer;
+  NiceMock<MockProtocol> proto;
+  InSequence dummy;
+
+  addRepeated(buffer, 10, 'x');
+
+  EXPECT_CALL(proto, readMessageBegin(Ref(buffer), _, _, _))
+      .WillOnce(Invoke([](Buffer::Instance& data, std::string&, MessageType&, int32_t&) -> bool {
+        data.drain(4);
+        return true;
+      }));
+  EXPECT_CALL(proto, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(proto, readFieldBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<2>(FieldType::Struct), SetArgReferee<3>(1), Return(true)));
+
+  DecoderStateMachine dsm(proto, true, 20U);
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::WaitForData);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::PassthroughData);
+  EXPECT_EQ(buffer.length(), 0);
+
+  EXPECT_CALL(proto, readMessageEnd(Ref(buffer))).WillOnce(Return(true));
+
+  addRepeated(buffer, 20, 'x');
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+  EXPECT_EQ(buffer.length(), 10);
+}
+
+TEST(DecoderStateMachineTest, PassthroughFrameTooSmall) {
+  Buffer::OwnedImpl buffer;
+  NiceMock<MockProtocol> proto;
+  InSequence dummy;
+
+  addRepeated(buffer, 10, 'x');
+
+  EXPECT_CALL(proto, readMessageBegin(Ref(buffer), _, _, _))
+      .WillOnce(Invoke([](Buffer::Instance& data, std::string&, MessageType&, int32_t&) -> bool {
+        data.drain(8);
+        return true;
+      }));
+  EXPECT_CALL(proto, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(proto, readFieldBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<2>(FieldType::I32), SetArgReferee<3>(1), Return(true)));
+
+  DecoderStateMachine dsm(proto, true, 4U);
+
+  EXPECT_THROW_WITH_MESSAGE(dsm.run(buffer), EnvoyException,
+                            "thrift message header exceeds frame size 4");
+}
+
+TEST(DecoderStateMachineTest, PassthroughEmptyStruct) {
+  Buffer::OwnedImpl buffer;
+  NiceMock<MockProtocol> proto;
+  InSequence dummy;
+
+  EXPECT_CALL(proto, readMessageBegin(Ref(buffer), _, _, _)).WillOnce(Return(true));
+  EXPECT_CALL(proto, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(proto, readFieldBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<2>(FieldType::Stop), Return(true)));
+  EXPECT_CALL(proto, readStructEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(proto, readMessageEnd(Ref(buffer))).WillOnce(Return(true));
+
+  DecoderStateMachine dsm(proto, true, 20U);
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+}
+
+TEST(DecoderStateMachineTest, PassthroughUnframed) {
+  Buffer::OwnedImpl buffer;
+  NiceMock<MockProtocol> proto;
+  InSequence dummy;
+
+  EXPECT_CALL(proto, readMessageBegin(Ref(buffer), _, _, _)).WillOnce(Return(true));
+  EXPECT_CALL(proto, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(proto, readFieldBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<2>(FieldType::String), SetArgReferee<3>(1), Return(true)));
+  EXPECT_CALL(proto, readString(_, _)).Times(0);
+  EXPECT_CALL(proto, skipString(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(proto, readFieldEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(proto, readFieldBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<2>(FieldType::Stop), Return(true)));
+  EXPECT_CALL(proto, readStructEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(proto, readMessageEnd(Ref(buffer))).WillOnce(Return(true));
+
+  DecoderStateMachine dsm(proto, true, absl::nullopt);
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+}
+
 TEST(DecoderTest, OnData) {
   NiceMock<MockTransport>* transport = new NiceMock<MockTransport>();
   NiceMock<MockProtocol>* proto = new NiceMock<MockProtocol>();
@@ -655,6 +773,31 @@ TEST(DecoderTest, OnDataResumesTransportFrameEnd) {
   decoder.onData(buffer);
 }
 
+TEST(DecoderTest, OnDataPassthrough) {
+  NiceMock<MockTransport>* transport = new NiceMock<MockTransport>();
+  NiceMock<MockProtocol>* proto = new NiceMock<MockProtocol>();
+  InSequence dummy;
+  Decoder decoder(TransportPtr{transport}, ProtocolPtr{proto}, true);
+  Buffer::OwnedImpl buffer;
+
+  addRepeated(buffer, 10, 'x');
+
+  EXPECT_CALL(*transport, decodeFrameStart(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(*transport, frameSize()).WillOnce(Return(10U));
+  EXPECT_CALL(*proto, readMessageBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<1>("name"), SetArgReferee<2>(MessageType::Call),
+                      SetArgReferee<3>(100), Return(true)));
+  EXPECT_CALL(*proto, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(*proto, readFieldBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<2>(FieldType::I32), SetArgReferee<3>(1), Return(true)));
+  EXPECT_CALL(*proto, readMessageEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(*transport, decodeFrameEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(*transport, decodeFrameStart(Ref(buffer))).WillOnce(Return(false));
+
+  decoder.onData(buffer);
+  EXPECT_EQ(buffer.length(), 0);
+}
+
 #define TEST_NAME(X) EXPECT_EQ(ProtocolStateNameValues::name(ProtocolState::X), #X);
 
 TEST(ProtocolStateNameValuesTest, ValidNames) { ALL_PROTOCOL_STATES(TEST_NAME) }
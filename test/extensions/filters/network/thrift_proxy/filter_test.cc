@@ -109,7 +109,7 @@ public:
     uint8_t s4 = seq_id & 0xFF;
 
     addSeq(buffer, {
-                       0x00, 0x00, 0x00, 0x23,                     // framed: 35 bytes
+                       0x00, 0x00, 0x00, 0x1f,                     // framed: 31 bytes
                        0x80, 0x01, 0x00, 0x02,                     // binary proto, reply
                        0x00, 0x00, 0x00, 0x04, 'n', 'a', 'm', 'e', // message name
                        s1,   s2,   s3,   s4,                       // sequence id
@@ -165,24 +165,23 @@ TEST_F(ThriftFilterTest, OnDataHandlesFrameSplitAcrossBuffers) {
 
   EXPECT_EQ(filter_->onData(buffer_, false), Network::FilterStatus::Continue);
 
-  // Filter passes on the partial buffer, up to the last 4 bytes which it needs to resume the
-  // decoder on the next call.
+  // Filter passes on the whole partial buffer: once the first field of the message is decoded, the
+  // remainder of the frame is passed through without being decoded.
   std::string contents = bufferToString(buffer_);
-  EXPECT_EQ(len - 4, buffer_.length());
-  EXPECT_EQ(expected_contents.substr(0, len - 4), contents);
+  EXPECT_EQ(len, buffer_.length());
+  EXPECT_EQ(expected_contents, contents);
 
   buffer_.drain(buffer_.length());
 
   // Complete the buffer
   writePartialFramedBinaryMessage(buffer_, MessageType::Call, 0x10, false);
-  expected_contents = expected_contents.substr(len - 4) + bufferToString(buffer_);
+  expected_contents = bufferToString(buffer_);
   len = buffer_.length();
 
   EXPECT_EQ(filter_->onData(buffer_, false), Network::FilterStatus::Continue);
 
-  // Filter buffered bytes from end of first buffer and passes them on now.
   contents = bufferToString(buffer_);
-  EXPECT_EQ(len + 4, buffer_.length());
+  EXPECT_EQ(len, buffer_.length());
   EXPECT_EQ(expected_contents, contents);
 
   EXPECT_EQ(1U, store_.counter("test.request_call").value());
@@ -333,24 +332,23 @@ TEST_F(ThriftFilterTest, OnWriteHandlesFrameSplitAcrossBuffers) {
 
   EXPECT_EQ(filter_->onWrite(write_buffer_, false), Network::FilterStatus::Continue);
 
-  // Filter passes on the partial buffer, up to the last 4 bytes which it needs to resume the
-  // decoder on the next call.
+  // Filter passes on the whole partial buffer: once the first field of the message is decoded, the
+  // remainder of the frame is passed through without being decoded.
   std::string contents = bufferToString(write_buffer_);
-  EXPECT_EQ(len - 4, write_buffer_.length());
-  EXPECT_EQ(expected_contents.substr(0, len - 4), contents);
+  EXPECT_EQ(len, write_buffer_.length());
+  EXPECT_EQ(expected_contents, contents);
 
   write_buffer_.drain(write_buffer_.length());
 
   // Complete the buffer
   writePartialFramedBinaryMessage(write_buffer_, MessageType::Reply, 0x0F, false);
-  expected_contents = expected_contents.substr(len - 4) + bufferToString(write_buffer_);
+  expected_contents = bufferToString(write_buffer_);
   len = write_buffer_.length();
 
   EXPECT_EQ(filter_->onWrite(write_buffer_, false), Network::FilterStatus::Continue);
 
-  // Filter buffered bytes from end of first buffer and passes them on now.
   contents = bufferToString(write_buffer_);
-  EXPECT_EQ(len + 4, write_buffer_.length());
+  EXPECT_EQ(len, write_buffer_.length());
   EXPECT_EQ(expected_contents, contents);
 
   EXPECT_EQ(1U, store_.counter("test.response").value());
@@ -399,6 +397,37 @@ TEST_F(ThriftFilterTest, OnWriteHandlesIDLException) {
   EXPECT_EQ(0U, store_.gauge("test.request_active").value());
 }
 
+TEST_F(ThriftFilterTest, OnWriteHandlesUnframedReply) {
+  initializeFilter();
+  addSeq(buffer_, {
+                      0x80, 0x01, 0x00, 0x01,                     // binary proto, call
+                      0x00, 0x00, 0x00, 0x04, 'n', 'a', 'm', 'e', // message name
+                      0x00, 0x00, 0x00, 0x0F,                     // sequence id
+                      0x00,                                       // stop field
+                  });
+  EXPECT_EQ(filter_->onData(buffer_, false), Network::FilterStatus::Continue);
+  EXPECT_EQ(1U, store_.counter("test.request_call").value());
+
+  // Without a frame size, the reply is walked to its end, but values are not decoded.
+  addSeq(write_buffer_, {
+                            0x80, 0x01, 0x00, 0x02,                     // binary proto, reply
+                            0x00, 0x00, 0x00, 0x04, 'n', 'a', 'm', 'e', // message name
+                            0x00, 0x00, 0x00, 0x0F,                     // sequence id
+                            0x0B, 0x00, 0x00,                           // begin string field
+                            0x00, 0x00, 0x00, 0x03, 'f', 'o', 'o',      // string
+                            0x00,                                       // stop field
+                        });
+  uint64_t len = write_buffer_.length();
+  EXPECT_EQ(filter_->onWrite(write_buffer_, false), Network::FilterStatus::Continue);
+  EXPECT_EQ(len, write_buffer_.length());
+
+  EXPECT_EQ(1U, store_.counter("test.response").value());
+  EXPECT_EQ(1U, store_.counter("test.response_reply").value());
+  EXPECT_EQ(1U, store_.counter("test.response_success").value());
+  EXPECT_EQ(0U, store_.counter("test.response_decoding_error").value());
+  EXPECT_EQ(0U, store_.gauge("test.request_active").value());
+}
+
 TEST_F(ThriftFilterTest, OnWriteHandlesInvalidMsgType) {
   initializeFilter();
   writeFramedBinaryMessage(buffer_, MessageType::Call, 0x0F);
@@ -31,6 +31,7 @@ public:
   MOCK_CONST_METHOD0(name, const std::string&());
   MOCK_METHOD1(decodeFrameStart, bool(Buffer::Instance&));
   MOCK_METHOD1(decodeFrameEnd, bool(Buffer::Instance&));
+  MOCK_CONST_METHOD0(frameSize, absl::optional<uint32_t>());
 
   std::string name_{"mock"};
 };
@@ -78,6 +79,7 @@ public:
   MOCK_METHOD2(readDouble, bool(Buffer::Instance& buffer, double& value));
   MOCK_METHOD2(readString, bool(Buffer::Instance& buffer, std::string& value));
   MOCK_METHOD2(readBinary, bool(Buffer::Instance& buffer, std::string& value));
+  MOCK_METHOD1(skipString, bool(Buffer::Instance& buffer));
 
   std::string name_{"mock"};
 };
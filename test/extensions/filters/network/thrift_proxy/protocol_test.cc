@@ -228,6 +228,12 @@ TEST(AutoProtocolTest, Delegation) {
     EXPECT_CALL(*proto, readBinary(Ref(buffer), Ref(value))).WillOnce(Return(true));
     EXPECT_TRUE(auto_proto.readBinary(buffer, value));
   }
+
+  // skipString
+  {
+    EXPECT_CALL(*proto, skipString(Ref(buffer))).WillOnce(Return(true));
+    EXPECT_TRUE(auto_proto.skipString(buffer));
+  }
 }
 
 TEST(AutoProtocolTest, Name) {
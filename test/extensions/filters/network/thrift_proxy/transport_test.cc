@@ -63,6 +63,7 @@ TEST(FramedTransportTest, DecodeFrameStart) {
   EXPECT_CALL(cb, transportFrameStart(absl::optional<uint32_t>(100U)));
 
   FramedTransportImpl transport(cb);
+  EXPECT_FALSE(transport.frameSize().has_value());
 
   Buffer::OwnedImpl buffer;
   addInt32(buffer, 100);
@@ -70,6 +71,7 @@ TEST(FramedTransportTest, DecodeFrameStart) {
   EXPECT_EQ(buffer.length(), 4);
   EXPECT_TRUE(transport.decodeFrameStart(buffer));
   EXPECT_EQ(buffer.length(), 0);
+  EXPECT_EQ(transport.frameSize(), absl::optional<uint32_t>(100U));
 }
 
 TEST(FramedTransportTest, DecodeFrameEnd) {
@@ -101,6 +103,7 @@ TEST(UnframedTransportTest, DecodeFrameStart) {
   EXPECT_EQ(buffer.length(), 4);
   EXPECT_TRUE(transport.decodeFrameStart(buffer));
   EXPECT_EQ(buffer.length(), 4);
+  EXPECT_FALSE(transport.frameSize().has_value());
 }
 
 TEST(UnframedTransportTest, DecodeFrameEnd) {
@@ -161,10 +164,12 @@ TEST(AutoTransportTest, DecodeFrameStart) {
     addInt16(buffer, 0x8001);
     addInt16(buffer, 0);
 
+    EXPECT_FALSE(transport.frameSize().has_value());
     EXPECT_CALL(cb, transportFrameStart(absl::optional<uint32_t>(255U)));
     EXPECT_TRUE(transport.decodeFrameStart(buffer));
     EXPECT_EQ(transport.name(), "framed(auto)");
     EXPECT_EQ(buffer.length(), 4);
+    EXPECT_EQ(transport.frameSize(), absl::optional<uint32_t>(255U));
   }
 
   // Framed transport + compact protocol
@@ -192,6 +197,7 @@ TEST(AutoTransportTest, DecodeFrameStart) {
     EXPECT_TRUE(transport.decodeFrameStart(buffer));
     EXPECT_EQ(transport.name(), "unframed(auto)");
     EXPECT_EQ(buffer.length(), 8);
+    EXPECT_FALSE(transport.frameSize().has_value());
   }
 
   // Unframed transport + compact protocol
@@ -0,0 +1,158 @@
+#include <string>
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/simd_parser_impl.h"
+
+#include "test/fuzz/fuzz_runner.h"
+#include "test/integration/capture_fuzz.pb.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+/**
+ * Records parser callbacks as text, joining up URLs and headers that are delivered in pieces, and
+ * pauses after each message like ServerConnectionImpl.
+ */
+class RecordingCallbacks : public ParserCallbacks {
+public:
+  void setParser(Parser& parser) { parser_ = &parser; }
+  const std::string& log() const { return log_; }
+
+  // Http1::ParserCallbacks
+  void onMessageBegin() override { log_ += "begin\n"; }
+  void onUrl(const char* data, size_t length) override { url_.append(data, length); }
+  void onHeaderField(const char* data, size_t length) override {
+    flushUrl();
+    if (in_value_) {
+      flushHeader();
+    }
+    field_.append(data, length);
+  }
+  void onHeaderValue(const char* data, size_t length) override {
+    in_value_ = true;
+    value_.append(data, length);
+  }
+  void onHeader(absl::string_view key, absl::string_view value) override {
+    flushUrl();
+    log_ += fmt::format("header {}: {}\n", key, value);
+  }
+  int onHeadersComplete() override {
+    flushUrl();
+    flushHeader();
+    log_ += fmt::format("headers complete {} {}.{} chunked={} content_length={}\n",
+                        http_method_str(parser_->method()), parser_->httpMajor(),
+                        parser_->httpMinor(), parser_->chunked(), parser_->contentLength());
+    return 0;
+  }
+  void onBody(const char* data, size_t length) override { body_.append(data, length); }
+  void onMessageComplete() override {
+    log_ += fmt::format("body {}\ncomplete\n", body_);
+    body_.clear();
+    parser_->pause(true);
+  }
+
+private:
+  void flushUrl() {
+    if (!url_.empty()) {
+      log_ += fmt::format("url {}\n", url_);
+      url_.clear();
+    }
+  }
+
+  void flushHeader() {
+    if (!field_.empty()) {
+      log_ += fmt::format("header {}: {}\n", field_, value_);
+    }
+    field_.clear();
+    value_.clear();
+    in_value_ = false;
+  }
+
+  Parser* parser_{};
+  std::string log_;
+  std::string url_;
+  std::string field_;
+  std::string value_;
+  bool in_value_{};
+  std::string body_;
+};
+
+/**
+ * Feeds the same data to both parsers, the way ConnectionImpl::dispatch() does and redispatching
+ * unconsumed data like the connection manager, and requires identical callbacks, consumption and
+ * errors.
+ */
+class DifferentialParser {
+public:
+  DifferentialParser() {
+    legacy_callbacks_.setParser(legacy_);
+    simd_callbacks_.setParser(simd_);
+  }
+
+  /**
+   * @return bool whether both parsers can accept more data.
+   */
+  bool dispatch(const std::string& data) {
+    pending_ += data;
+    do {
+      legacy_.pause(false);
+      simd_.pause(false);
+      const size_t consumed = execute(pending_.data(), pending_.size());
+      if (!ok()) {
+        return false;
+      }
+      pending_.erase(0, consumed);
+      if (consumed == 0) {
+        break;
+      }
+    } while (!pending_.empty());
+    return true;
+  }
+
+  void endStream() {
+    legacy_.pause(false);
+    simd_.pause(false);
+    execute(nullptr, 0);
+  }
+
+private:
+  size_t execute(const char* data, size_t length) {
+    const size_t legacy_consumed = legacy_.execute(data, length);
+    const size_t simd_consumed = simd_.execute(data, length);
+    RELEASE_ASSERT(legacy_.error() == simd_.error());
+    RELEASE_ASSERT(legacy_callbacks_.log() == simd_callbacks_.log());
+    // Consumption only matters if parsing can continue.
+    RELEASE_ASSERT(!ok() || legacy_consumed == simd_consumed);
+    return legacy_consumed;
+  }
+
+  bool ok() const { return legacy_.error() == HPE_OK || legacy_.error() == HPE_PAUSED; }
+
+  RecordingCallbacks legacy_callbacks_;
+  RecordingCallbacks simd_callbacks_;
+  LegacyParserImpl legacy_{HTTP_REQUEST, legacy_callbacks_};
+  SimdParserImpl simd_{simd_callbacks_};
+  std::string pending_;
+};
+
+} // namespace
+
+// Replay the downstream bytes of H1 captures into the http_parser and SIMD request parsers.
+DEFINE_PROTO_FUZZER(const test::integration::CaptureFuzzTestCase& input) {
+  DifferentialParser parser;
+  for (const auto& event : input.events()) {
+    if (event.event_selector_case() == test::integration::Event::kDownstreamSendBytes &&
+        !parser.dispatch(event.downstream_send_bytes())) {
+      return;
+    }
+  }
+  parser.endStream();
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -57,6 +57,7 @@ public:
   std::chrono::milliseconds fileFlushIntervalMsec() const override {
     return std::chrono::milliseconds(50);
   }
+  uint32_t fileFlushThreads() const override { return 1; }
   Mode mode() const override { return Mode::Serve; }
   const std::string& serviceClusterName() const override { return service_cluster_name_; }
   const std::string& serviceNodeName() const override { return service_node_name_; }
@@ -56,7 +56,7 @@ IntegrationUtil::makeSingleRequest(const Network::Address::InstanceConstSharedPt
                                    const std::string& method, const std::string& url,
                                    const std::string& body, Http::CodecClient::Type type,
                                    const std::string& host, const std::string& content_type) {
-  Api::Impl api(std::chrono::milliseconds(9000));
+  Api::Impl api(std::chrono::milliseconds(9000), 1);
   Event::DispatcherPtr dispatcher(api.allocateDispatcher());
   std::shared_ptr<Upstream::MockClusterInfo> cluster{new NiceMock<Upstream::MockClusterInfo>()};
   Upstream::HostDescriptionConstSharedPtr host_description{
@@ -104,7 +104,7 @@ IntegrationUtil::makeSingleRequest(uint32_t port, const std::string& method, con
 RawConnectionDriver::RawConnectionDriver(uint32_t port, Buffer::Instance& initial_data,
                                          ReadCallback data_callback,
                                          Network::Address::IpVersion version) {
-  api_.reset(new Api::Impl(std::chrono::milliseconds(10000)));
+  api_.reset(new Api::Impl(std::chrono::milliseconds(10000), 1));
   dispatcher_ = api_->allocateDispatcher();
   client_ = dispatcher_->createClientConnection(
       Network::Utility::resolveUrl(
@@ -40,6 +40,16 @@ ssize_t MockOsSysCalls::write(int fd, const void* buffer, size_t num_bytes) {
   return result;
 }
 
+ssize_t MockOsSysCalls::writev(int fd, const iovec* iovec, int num_iovec) {
+  Thread::LockGuard lock(write_mutex_);
+
+  ssize_t result = writev_(fd, iovec, num_iovec);
+  num_writes_++;
+  write_event_.notifyOne();
+
+  return result;
+}
+
 int MockOsSysCalls::setsockopt(int sockfd, int level, int optname, const void* optval,
                                socklen_t optlen) {
   ASSERT(optlen == sizeof(int));
@@ -25,13 +25,22 @@ public:
   MOCK_METHOD1(add, void(uint64_t amount));
   MOCK_METHOD0(inc, void());
   MOCK_METHOD0(latch, uint64_t());
-  MOCK_CONST_METHOD0(name, const std::string&());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
+  MOCK_CONST_METHOD0(name, std::string());
+  MOCK_CONST_METHOD0(statName, StatName());
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
   MOCK_METHOD0(reset, void());
   MOCK_CONST_METHOD0(used, bool());
   MOCK_CONST_METHOD0(value, uint64_t());
 
+  void appendName(std::string& out) const override { out.append(name()); }
+  void appendTagExtractedName(std::string& out) const override { out.append(tagExtractedName()); }
+  void iterateTags(std::string&, const TagCb& cb) const override {
+    for (const Tag& tag : tags()) {
+      cb(tag.name_, tag.value_);
+    }
+  }
+
   bool used_;
   uint64_t value_;
   uint64_t latch_;
@@ -47,14 +56,23 @@ public:
   MOCK_METHOD1(add, void(uint64_t amount));
   MOCK_METHOD0(dec, void());
   MOCK_METHOD0(inc, void());
-  MOCK_CONST_METHOD0(name, const std::string&());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
+  MOCK_CONST_METHOD0(name, std::string());
+  MOCK_CONST_METHOD0(statName, StatName());
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
   MOCK_METHOD1(set, void(uint64_t value));
   MOCK_METHOD1(sub, void(uint64_t amount));
   MOCK_CONST_METHOD0(used, bool());
   MOCK_CONST_METHOD0(value, uint64_t());
 
+  void appendName(std::string& out) const override { out.append(name()); }
+  void appendTagExtractedName(std::string& out) const override { out.append(tagExtractedName()); }
+  void iterateTags(std::string&, const TagCb& cb) const override {
+    for (const Tag& tag : tags()) {
+      cb(tag.name_, tag.value_);
+    }
+  }
+
   bool used_;
   uint64_t value_;
   std::string name_;
@@ -68,13 +86,22 @@ public:
 
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
-  const std::string& name() const override { return name_; };
+  std::string name() const override { return name_; };
 
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
+  MOCK_CONST_METHOD0(statName, StatName());
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
   MOCK_METHOD1(recordValue, void(uint64_t value));
   MOCK_CONST_METHOD0(used, bool());
 
+  void appendName(std::string& out) const override { out.append(name()); }
+  void appendTagExtractedName(std::string& out) const override { out.append(tagExtractedName()); }
+  void iterateTags(std::string&, const TagCb& cb) const override {
+    for (const Tag& tag : tags()) {
+      cb(tag.name_, tag.value_);
+    }
+  }
+
   std::string name_;
   std::vector<Tag> tags_;
   Store* store_;
@@ -87,17 +114,26 @@ public:
 
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
-  const std::string& name() const override { return name_; };
+  std::string name() const override { return name_; };
   void merge() override {}
   const std::string summary() const override { return ""; };
 
   MOCK_CONST_METHOD0(used, bool());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
+  MOCK_CONST_METHOD0(statName, StatName());
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
   MOCK_METHOD1(recordValue, void(uint64_t value));
   MOCK_CONST_METHOD0(cumulativeStatistics, const HistogramStatistics&());
   MOCK_CONST_METHOD0(intervalStatistics, const HistogramStatistics&());
 
+  void appendName(std::string& out) const override { out.append(name()); }
+  void appendTagExtractedName(std::string& out) const override { out.append(tagExtractedName()); }
+  void iterateTags(std::string&, const TagCb& cb) const override {
+    for (const Tag& tag : tags()) {
+      cb(tag.name_, tag.value_);
+    }
+  }
+
   std::string name_;
   std::vector<Tag> tags_;
   bool used_;